@@ -25,10 +25,16 @@ cd "$PROJECT_ROOT" || exit
 VIDEO_UUID=$(uuidgen | tr '[:upper:]' '[:lower:]')
 FILE_UUID=$(uuidgen | tr '[:upper:]' '[:lower:]')
 
-# Get video duration using ffprobe
+# Get video metadata using ffprobe (길이, 비트레이트, 해상도, 코덱)
 echo "📹 비디오 정보 추출 중..."
-DURATION=$(ffprobe -v error -show_entries format=duration -of default=noprint_wrappers=1:nokey=1 "$VIDEO_FILE" 2>/dev/null)
+IFS=, read -r DURATION BITRATE <<< "$(ffprobe -v error -show_entries format=duration,bit_rate -of csv=p=0 "$VIDEO_FILE" 2>/dev/null)"
+[[ "$DURATION" =~ ^[0-9.]+$ ]] || DURATION=0
+[[ "$BITRATE" =~ ^[0-9]+$ ]] || BITRATE=0
 DURATION_SEC=$(printf "%.0f" "$DURATION")
+BITRATE_KBPS=$(( BITRATE / 1000 ))
+IFS=, read -r VIDEO_CODEC WIDTH HEIGHT <<< "$(ffprobe -v error -select_streams v:0 -show_entries stream=codec_name,width,height -of csv=p=0 "$VIDEO_FILE" 2>/dev/null)"
+AUDIO_CODEC=$(ffprobe -v error -select_streams a:0 -show_entries stream=codec_name -of csv=p=0 "$VIDEO_FILE" 2>/dev/null)
+RESOLUTION="${WIDTH}x${HEIGHT}"
 
 # Get file size
 FILE_SIZE=$(stat -f%z "$VIDEO_FILE" 2>/dev/null || stat -c%s "$VIDEO_FILE" 2>/dev/null)
@@ -50,10 +56,11 @@ echo "💾 데이터베이스에 비디오 정보 저장 중..."
 cd server-c || exit
 sqlite3 app.db <<EOF
 INSERT INTO videos (id, title, description, duration_sec, mime_type)
-VALUES ('$VIDEO_UUID', '$TITLE', '$DESCRIPTION', $DURATION_SEC, 'video/mp4');
+VALUES (unhex(replace('$VIDEO_UUID', '-', '')), '$TITLE', '$DESCRIPTION', $DURATION_SEC, 'video/mp4');
 
-INSERT INTO video_files (id, video_id, file_path, file_size, bitrate_kbps, resolution)
-VALUES ('$FILE_UUID', '$VIDEO_UUID', '$VIDEO_PATH', $FILE_SIZE, 2000, '1920x1080');
+INSERT INTO video_files (id, video_id, file_path, file_size, bitrate_kbps, resolution, video_codec, audio_codec)
+VALUES (unhex(replace('$FILE_UUID', '-', '')), unhex(replace('$VIDEO_UUID', '-', '')), '$VIDEO_PATH', $FILE_SIZE,
+        $BITRATE_KBPS, nullif('$RESOLUTION', 'x'), nullif('$VIDEO_CODEC', ''), nullif('$AUDIO_CODEC', ''));
 EOF
 
 if [ $? -ne 0 ]; then
@@ -62,20 +69,29 @@ if [ $? -ne 0 ]; then
     exit 1
 fi
 
-# Generate thumbnail
+# Generate thumbnail variants (너비별 WebP + JPEG, 높이는 실제 결과에서 읽음)
 echo "🖼️  썸네일 생성 중..."
-THUMB_PATH="../media/thumbnails/${VIDEO_UUID}.jpg"
-ACTUAL_VIDEO_PATH="../media/videos/${VIDEO_FILENAME}"
-ffmpeg -ss 1 -i "$ACTUAL_VIDEO_PATH" -vframes 1 -vf scale=320:-1 -update 1 "../media/thumbnails/${VIDEO_UUID}.jpg" -y 2>&1 > /dev/null
-
-ACTUAL_THUMB_PATH="../media/thumbnails/${VIDEO_UUID}.jpg"
-if [ -f "$ACTUAL_THUMB_PATH" ]; then
-    THUMB_UUID=$(uuidgen | tr '[:upper:]' '[:lower:]')
-    sqlite3 app.db <<EOF
-INSERT INTO thumbnails (id, video_id, file_path, width, height)
-VALUES ('$THUMB_UUID', '$VIDEO_UUID', '$THUMB_PATH', 320, 180);
+THUMB_COUNT=0
+for WIDTH in 160 320 640; do
+    for FORMAT in "webp:image/webp:-c:v libwebp -quality 75" "jpg:image/jpeg:-q:v 4"; do
+        IFS=: read -r EXT MIME CODEC_ARGS <<< "$FORMAT"
+        THUMB_PATH="../media/thumbnails/${VIDEO_UUID}_${WIDTH}.${EXT}"
+        # shellcheck disable=SC2086
+        ffmpeg -v error -ss 1 -i "../media/videos/${VIDEO_FILENAME}" -frames:v 1 \
+            -vf "scale='min(${WIDTH},iw)':-2" $CODEC_ARGS -update 1 "$THUMB_PATH" -y || continue
+        IFS=, read -r THUMB_W THUMB_H <<< "$(ffprobe -v error -show_entries stream=width,height -of csv=p=0 "$THUMB_PATH" 2>/dev/null)"
+        [[ "$THUMB_W" =~ ^[0-9]+$ && "$THUMB_H" =~ ^[0-9]+$ ]] || continue
+        THUMB_UUID=$(uuidgen | tr '[:upper:]' '[:lower:]')
+        sqlite3 app.db <<EOF
+INSERT INTO thumbnails (id, video_id, file_path, width, height, mime_type)
+VALUES (unhex(replace('$THUMB_UUID', '-', '')), unhex(replace('$VIDEO_UUID', '-', '')), '$THUMB_PATH', $THUMB_W, $THUMB_H, '$MIME');
 EOF
-    echo "✅ 썸네일 생성 완료"
+        THUMB_COUNT=$((THUMB_COUNT + 1))
+    done
+done
+
+if [ "$THUMB_COUNT" -gt 0 ]; then
+    echo "✅ 썸네일 변형 ${THUMB_COUNT}개 생성 완료"
 else
     echo "⚠️  썸네일 생성 실패 (계속 진행)"
 fi
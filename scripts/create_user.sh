@@ -78,7 +78,7 @@ UUID=$(uuidgen | tr '[:upper:]' '[:lower:]')
 # Insert user into database
 sqlite3 app.db <<EOF
 INSERT INTO users (id, login_id, password_hash, display_name)
-VALUES ('$UUID', '$LOGIN_ID', '$HASHED_PASSWORD', '$DISPLAY_NAME');
+VALUES (unhex(replace('$UUID', '-', '')), '$LOGIN_ID', '$HASHED_PASSWORD', '$DISPLAY_NAME');
 EOF
 
 if [ $? -eq 0 ]; then
@@ -48,7 +48,7 @@ echo "👤 샘플 사용자 생성 중..."
 sqlite3 app.db <<EOF
 INSERT INTO users (id, login_id, password_hash, display_name)
 VALUES (
-    '00000000-0000-0000-0000-000000000001',
+    unhex('00000000000000000000000000000001'),
     'test',
     '\$argon2id\$v=19\$m=65536,t=2,p=1\$SomeRandomSalt123456\$HashedPasswordGoesHere',
     '테스트 사용자'
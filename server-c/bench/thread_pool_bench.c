@@ -0,0 +1,277 @@
+// 스레드 풀 벤치마크: 작업 훔치기 풀(src/thread_pool.c)과 이전 단일 큐 풀 비교
+//
+// 사용법: ./thread_pool_bench [-n 작업 수] [-d fork-join 깊이] [-w 작업당 반복] [-r 반복 횟수] [-t 최대 스레드]
+//   flat      : 외부 스레드 하나가 작은 작업 n개를 넣고 기다린다 (요청 스레드 → 풀 경로)
+//   fork-join : 작업 안에서 두 개씩 다시 넣어 깊이 d의 이진 트리를 만든다 (등록 파이프라인/재귀 분할 경로)
+// 스레드 수 1, 2, 4, ... 최대까지 각 부하를 r번 돌려 가장 빠른 값을 작업당 ns로 출력한다.
+// 숫자는 코어 수보다 스레드가 많으면 의미가 줄어드므로 결과와 함께 nproc을 기록한다.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "thread_pool.h"
+#include "logger.h"
+
+// 이전 풀 (작업 훔치기 이전): 뮤텍스 하나와 조건 변수로 보호하는 연결 리스트 큐, 작업마다 malloc
+typedef struct ref_task {
+    task_func_t function;
+    void *arg;
+    struct ref_task *next;
+} ref_task_t;
+
+typedef struct {
+    pthread_t *threads;
+    int thread_count;
+    ref_task_t *head;
+    ref_task_t *tail;
+    int active_tasks;
+    bool shutdown;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    pthread_cond_t empty_cond;
+} ref_pool_t;
+
+static void* ref_pool_worker(void *arg) {
+    ref_pool_t *pool = arg;
+    for (;;) {
+        pthread_mutex_lock(&pool->mutex);
+        while (pool->head == NULL && !pool->shutdown) {
+            pthread_cond_wait(&pool->cond, &pool->mutex);
+        }
+        if (pool->shutdown && pool->head == NULL) {
+            pthread_mutex_unlock(&pool->mutex);
+            return NULL;
+        }
+        ref_task_t *task = pool->head;
+        pool->head = task->next;
+        if (pool->head == NULL) {
+            pool->tail = NULL;
+        }
+        pthread_mutex_unlock(&pool->mutex);
+
+        task->function(task->arg);
+        free(task);
+
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->active_tasks == 0) {
+            pthread_cond_broadcast(&pool->empty_cond);
+        }
+        pthread_mutex_unlock(&pool->mutex);
+    }
+}
+
+static ref_pool_t* ref_pool_create(int num_threads) {
+    ref_pool_t *pool = calloc(1, sizeof(*pool));
+    if (pool == NULL) {
+        return NULL;
+    }
+    pool->threads = malloc(sizeof(pthread_t) * (size_t)num_threads);
+    if (pool->threads == NULL) {
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+    pthread_cond_init(&pool->empty_cond, NULL);
+    for (int i = 0; i < num_threads; i++) {
+        if (pthread_create(&pool->threads[i], NULL, ref_pool_worker, pool) != 0) {
+            break;
+        }
+        pool->thread_count++;
+    }
+    return pool;
+}
+
+static int ref_pool_submit(ref_pool_t *pool, task_func_t function, void *arg) {
+    ref_task_t *task = malloc(sizeof(*task));
+    if (task == NULL) {
+        return -1;
+    }
+    task->function = function;
+    task->arg = arg;
+    task->next = NULL;
+
+    pthread_mutex_lock(&pool->mutex);
+    if (pool->tail == NULL) {
+        pool->head = task;
+    } else {
+        pool->tail->next = task;
+    }
+    pool->tail = task;
+    pool->active_tasks++;
+    pthread_cond_signal(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+    return 0;
+}
+
+static void ref_pool_wait(ref_pool_t *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    while (pool->active_tasks > 0) {
+        pthread_cond_wait(&pool->empty_cond, &pool->mutex);
+    }
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static void ref_pool_destroy(ref_pool_t *pool) {
+    pthread_mutex_lock(&pool->mutex);
+    pool->shutdown = true;
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+    for (int i = 0; i < pool->thread_count; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->cond);
+    pthread_cond_destroy(&pool->empty_cond);
+    free(pool->threads);
+    free(pool);
+}
+
+// 두 풀을 같은 부하 코드로 돌리기 위한 얇은 인터페이스
+typedef struct {
+    const char *name;
+    void* (*create)(int num_threads);
+    int (*submit)(void *pool, task_func_t function, void *arg);
+    void (*wait)(void *pool);
+    void (*destroy)(void *pool);
+} bench_pool_ops_t;
+
+static void* new_create(int n) { return thread_pool_create(n); }
+static int new_submit(void *p, task_func_t f, void *a) { return thread_pool_submit(p, f, a); }
+static void new_wait(void *p) { thread_pool_wait(p); }
+static void new_destroy(void *p) { thread_pool_destroy(p); }
+
+static void* ref_create(int n) { return ref_pool_create(n); }
+static int ref_submit(void *p, task_func_t f, void *a) { return ref_pool_submit(p, f, a); }
+static void ref_wait(void *p) { ref_pool_wait(p); }
+static void ref_destroy(void *p) { ref_pool_destroy(p); }
+
+static const bench_pool_ops_t pools[] = {
+    { "old", ref_create, ref_submit, ref_wait, ref_destroy },
+    { "new", new_create, new_submit, new_wait, new_destroy },
+};
+
+static struct {
+    const bench_pool_ops_t *ops;
+    void *pool;
+    long work;                      // 작업당 빈 반복 (작업 크기)
+    atomic_long executed;
+} bench;
+
+static void bench_spin(void) {
+    for (volatile long i = 0; i < bench.work; i++) {
+    }
+}
+
+static void flat_task(void *arg) {
+    (void)arg;
+    bench_spin();
+    atomic_fetch_add_explicit(&bench.executed, 1, memory_order_relaxed);
+}
+
+static void fork_task(void *arg) {
+    long depth = (long)(intptr_t)arg;
+    bench_spin();
+    atomic_fetch_add_explicit(&bench.executed, 1, memory_order_relaxed);
+    if (depth > 0) {
+        bench.ops->submit(bench.pool, fork_task, (void*)(intptr_t)(depth - 1));
+        bench.ops->submit(bench.pool, fork_task, (void*)(intptr_t)(depth - 1));
+    }
+}
+
+static double bench_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+// 작업당 ns (실행 수가 맞지 않으면 -1)
+static double bench_flat(long tasks) {
+    atomic_store(&bench.executed, 0);
+    double start = bench_now();
+    for (long i = 0; i < tasks; i++) {
+        bench.ops->submit(bench.pool, flat_task, NULL);
+    }
+    bench.ops->wait(bench.pool);
+    double elapsed = bench_now() - start;
+    return atomic_load(&bench.executed) == tasks ? elapsed / (double)tasks * 1e9 : -1.0;
+}
+
+static double bench_fork_join(int depth) {
+    long tasks = (1L << (depth + 1)) - 1;
+    atomic_store(&bench.executed, 0);
+    double start = bench_now();
+    bench.ops->submit(bench.pool, fork_task, (void*)(intptr_t)depth);
+    bench.ops->wait(bench.pool);
+    double elapsed = bench_now() - start;
+    return atomic_load(&bench.executed) == tasks ? elapsed / (double)tasks * 1e9 : -1.0;
+}
+
+static double bench_best(double best, double ns) {
+    return (ns >= 0 && (best < 0 || ns < best)) ? ns : best;
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "사용법: %s [-n 작업 수] [-d fork-join 깊이] [-w 작업당 반복] [-r 반복 횟수] [-t 최대 스레드]\n",
+            prog);
+}
+
+int main(int argc, char *argv[]) {
+    long tasks = 1000000;
+    int depth = 19;
+    int reps = 3;
+    int max_threads = 64;
+    bench.work = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:d:w:r:t:")) != -1) {
+        switch (opt) {
+        case 'n': tasks = atol(optarg); break;
+        case 'd': depth = atoi(optarg); break;
+        case 'w': bench.work = atol(optarg); break;
+        case 'r': reps = atoi(optarg); break;
+        case 't': max_threads = atoi(optarg); break;
+        default:
+            print_usage(argv[0]);
+            return 1;
+        }
+    }
+    if (tasks <= 0 || depth < 0 || depth > 24 || reps <= 0 || max_threads <= 0) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    logger_init(LOG_ERROR);
+    printf("# nproc %ld, flat %ld개, fork-join 깊이 %d (%ld개), 작업당 반복 %ld, %d회 중 최솟값\n",
+           sysconf(_SC_NPROCESSORS_ONLN), tasks, depth, (1L << (depth + 1)) - 1, bench.work, reps);
+    printf("%7s  %14s %14s %8s  %14s %14s %8s\n", "threads", "flat old ns", "flat new ns", "speedup",
+           "fork old ns", "fork new ns", "speedup");
+
+    for (int threads = 1; threads <= max_threads; threads *= 2) {
+        double flat[2] = { -1, -1 };
+        double fork[2] = { -1, -1 };
+        for (size_t p = 0; p < sizeof(pools) / sizeof(pools[0]); p++) {
+            bench.ops = &pools[p];
+            bench.pool = bench.ops->create(threads);
+            if (bench.pool == NULL) {
+                fprintf(stderr, "%s 풀 생성 실패 (스레드 %d)\n", bench.ops->name, threads);
+                return 1;
+            }
+            for (int r = 0; r < reps; r++) {
+                flat[p] = bench_best(flat[p], bench_flat(tasks));
+                fork[p] = bench_best(fork[p], bench_fork_join(depth));
+            }
+            bench.ops->destroy(bench.pool);
+        }
+        printf("%7d  %14.1f %14.1f %7.2fx  %14.1f %14.1f %7.2fx\n", threads,
+               flat[0], flat[1], flat[0] / flat[1], fork[0], fork[1], fork[0] / fork[1]);
+        fflush(stdout);
+    }
+    return 0;
+}
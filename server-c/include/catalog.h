@@ -0,0 +1,117 @@
+#ifndef CATALOG_H
+#define CATALOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "types.h"
+#include "db.h"
+#include "video_page.h"
+
+// 카탈로그 스냅샷
+// videos / video_files / thumbnails 전체를 하나의 불변 메모리 블록으로 적재한다.
+// 요청 스레드는 잠금 없이 읽고, 변경이 감지되면 새 스냅샷을 만들어 원자적으로 교체한다.
+// 교체된 이전 스냅샷은 모든 읽기가 끝난 뒤에 해제된다 (RCU 방식).
+
+// 문자열 아레나 내 위치 (NUL 종료 문자열)
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+} catalog_str_t;
+
+typedef struct {
+    catalog_str_t id;
+    catalog_str_t title;
+    catalog_str_t description;
+    mime_id_t mime;                 // 인터닝된 MIME 타입
+    int32_t duration_sec;
+    int64_t created_at;
+    uint32_t first_file;            // files 배열 내 시작 위치
+    uint32_t file_count;
+    uint32_t first_thumbnail;       // thumbnails 배열 내 시작 위치
+    uint32_t thumbnail_count;
+} catalog_video_t;
+
+typedef struct {
+    catalog_str_t id;
+    catalog_str_t file_path;
+    catalog_str_t resolution;
+    catalog_str_t content_hash;     // 강한 ETag (빈 문자열: 해시 이전 파일)
+    int64_t file_size;
+    int32_t bitrate_kbps;
+} catalog_file_t;
+
+typedef struct {
+    catalog_str_t id;
+    catalog_str_t file_path;
+    int32_t width;
+    int32_t height;
+    mime_id_t mime;                 // 이미지 형식 (같은 동영상에 너비/형식별 변형이 여러 개)
+    thumb_pack_ref_t pack;          // 팩 안의 위치 (pack_id 0: file_path의 개별 파일)
+} catalog_thumbnail_t;
+
+// 불변 스냅샷: 헤더와 모든 배열이 하나의 할당 블록에 연속으로 배치된다
+// 파일에서 매핑한 스냅샷은 헤더만 따로 할당되고 배열은 매핑 영역을 가리킨다
+typedef struct {
+    int64_t generation;
+    int64_t instance;               // DB 고유 식별값 (catalog_stats 'instance')
+    uint32_t video_count;           // videos는 목록 순서 (created_at DESC, id DESC)
+    uint32_t file_count;
+    uint32_t thumbnail_count;
+    uint32_t index_size;            // 2의 거듭제곱, 0은 빈 슬롯 (동영상 인덱스 + 1 저장)
+    uint32_t strings_size;
+    const catalog_video_t *videos;
+    const catalog_file_t *files;
+    const catalog_thumbnail_t *thumbnails;
+    const uint32_t *index;
+    const char *strings;
+    void *mapping;                  // 스냅샷 파일 매핑 (NULL: 메모리에서 빌드)
+    size_t mapping_size;
+} catalog_snapshot_t;
+
+// 읽기 참조 (catalog_acquire로 얻고 반드시 catalog_release로 반환)
+typedef struct {
+    const catalog_snapshot_t *snapshot;
+    unsigned int slot;
+} catalog_ref_t;
+
+// 카탈로그 초기화
+// 스냅샷 파일이 유효하면 매핑해서 바로 게시하고 DB와의 일치 여부는 백그라운드에서 확인한다.
+// 파일이 없거나 손상되었으면 DB에서 적재한다.
+int catalog_init(void);
+
+// 카탈로그 종료 (시작 시 검증 스레드가 끝나기를 기다리므로 db_close 전에 호출)
+void catalog_shutdown(void);
+
+// DB 세대 번호나 instance가 바뀌었으면 새 스냅샷을 만들어 게시 (1: 교체됨, 0: 변경 없음, -1: 실패)
+int catalog_refresh_if_changed(void);
+
+// 무조건 새 스냅샷을 만들어 게시
+int catalog_refresh(void);
+
+// 현재 스냅샷을 파일로 저장 (임시 파일에 쓰고 fsync 후 rename)
+int catalog_save(const char *path);
+
+// 마지막 저장 이후 스냅샷이 바뀌었으면 저장 (1: 저장함, 0: 변경 없음, -1: 실패)
+int catalog_save_if_changed(const char *path);
+
+// 현재 스냅샷 읽기 시작/종료 (잠금 없음, 느린 I/O 전에 반환할 것)
+catalog_ref_t catalog_acquire(void);
+void catalog_release(catalog_ref_t *ref);
+
+// 스냅샷 문자열 접근
+static inline const char* catalog_str(const catalog_snapshot_t *snap, catalog_str_t str) {
+    return snap->strings + str.offset;
+}
+
+// ID로 동영상 검색 (없으면 NULL)
+const catalog_video_t* catalog_find_video(const catalog_snapshot_t *snap, const char *video_id);
+
+// 스냅샷 항목을 API 구조체로 복사
+void catalog_copy_file(const catalog_snapshot_t *snap, const catalog_video_t *cv,
+                       const catalog_file_t *cf, video_file_t *file);
+
+// 최신순 목록 페이지 (db_list_videos와 같은 커서/반환 규약, -2: 잘못된 커서)
+int catalog_list_videos(const catalog_snapshot_t *snap, const char *cursor, int page_size,
+                        video_page_t *page, int *total, char next_cursor[DB_CURSOR_LEN]);
+
+#endif // CATALOG_H
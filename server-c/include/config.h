@@ -4,9 +4,73 @@
 #define SERVER_PORT "8080"
 #define SERVER_THREADS 4
 #define DB_PATH "app.db"
+#define MIGRATIONS_DIR "migrations"
+#define DB_SCHEMA_VERSION 13             // 서버가 요구하는 최소 스키마 버전
+#define DB_MAX_READ_CONNECTIONS 16    // 읽기 전용 연결 최대 개수 (기본값: CPU 코어 수)
+#define DB_BUSY_TIMEOUT_MS 5000
+#define DB_MMAP_SIZE (256LL * 1024 * 1024)
+#define DB_CACHE_SIZE_KB 16384          // 연결당 페이지 캐시 (KiB)
+#define DB_MAINT_INTERVAL_SEC 30        // 백그라운드 체크포인트 주기
+#define DB_OPTIMIZE_INTERVAL_SEC 3600   // PRAGMA optimize / 증분 VACUUM 주기
+#define DB_WAL_TRUNCATE_BYTES (64LL * 1024 * 1024)  // WAL이 이보다 크면 TRUNCATE 체크포인트
+#define DB_VACUUM_PAGES 2048            // 증분 VACUUM 한 번에 반환하는 최대 페이지 수
+#define DB_SLOW_QUERY_MS 50             // 이 시간 이상 걸린 SQL 문장은 경고 로그로 남긴다
+#define DB_BATCH_ROWS 5000              // 일괄 등록 시 한 트랜잭션에 넣는 최대 동영상 수
+#define INGEST_PROBE_WORKERS 4          // 일괄 등록 파이프라인 단계별 워커 수 (0: CPU 수)
+#define INGEST_COPY_WORKERS 4
+#define INGEST_THUMBNAIL_WORKERS 0
+#define INGEST_QUEUE_CAPACITY 64        // 단계 사이 큐 용량 (가득 차면 앞 단계가 대기)
+#define INGEST_COMMIT_INTERVAL_MS 2000  // 등록 트랜잭션 커밋 최대 간격 (중단 후 다시 실행하면 여기부터 이어감)
+#define CATALOG_SNAPSHOT_PATH "catalog.snap"  // 재시작 시 바로 매핑하는 카탈로그 스냅샷 파일
+#define CATALOG_SAVE_INTERVAL_SEC 300   // 변경된 스냅샷을 파일로 저장하는 주기
+#define CATALOG_REFRESH_INTERVAL_MS 1000  // 카탈로그 세대 번호 확인 주기
+#define BACKGROUND_THREADS 2            // 유지보수/주기 작업용 백그라운드 스레드 풀 크기
+#define BACKGROUND_QUEUE_CAPACITY 256   // 백그라운드 풀의 우선순위별 큐 용량
+#define CPU_PIN_HTTP "numa"             // HTTP 워커 CPU 고정: "" (안 함), "numa" (노드를 번갈아 배정), CPU 목록 ("0-7,16-23")
+#define CPU_PIN_POOL "numa"             // 스레드 풀 워커
+#define CPU_PIN_IO ""                   // 저널 기록, 타이머, CivetWeb 수신 스레드
+#define JOURNAL_DIR "journal"           // 시청 이벤트 저널 세그먼트 디렉터리
+#define JOURNAL_SEGMENT_BYTES (64LL * 1024 * 1024)  // 세그먼트 교체 크기
+#define JOURNAL_BUFFER_EVENTS 4096      // 쓰기 버퍼 하나에 담는 이벤트 수 (버퍼 2개)
+#define JOURNAL_FLUSH_INTERVAL_MS 1000  // 버퍼를 파일로 내보내는 최대 간격
+#define ANALYTICS_DB_PATH "analytics.db" // 저널 집계 결과 (서비스 DB와 분리)
 #define MEDIA_DIR "../media"
 #define VIDEO_DIR "../media/videos"
 #define THUMBNAIL_DIR "../media/thumbnails"
+#define MEDIA_BLOB_DIR "../media/blobs" // 내용 주소 저장소 (<해시 앞 두 자리>/<BLAKE2b 해시>)
+#define MEDIA_BLOB_RECLAIM_GRACE_SEC 86400 // 참조가 0이 된 뒤 이만큼 지난 저장 파일만 지운다 (진행 중인 등록 보호)
+#define MEDIA_PLACE_BUFFER_SIZE (8 * 1024 * 1024) // 링크/리플링크/copy_file_range가 안 될 때 복사 버퍼
+#define THUMBNAIL_WIDTHS { 160, 320, 640 } // 썸네일 변형 너비 (오름차순, 원본보다 넓으면 원본 너비까지만)
+#define THUMBNAIL_DEFAULT_WIDTH 320     // ?w= 힌트가 없는 요청에 고르는 너비
+#define THUMBNAIL_AVIF 0                // AVIF 변형도 생성 (libaom 인코딩이 WebP보다 훨씬 느려 기본은 끔)
+#define THUMBNAIL_ONDEMAND_WORKERS 2    // 요청 시 썸네일을 만드는 동시 작업 수 (디코딩 CPU 상한)
+#define THUMBNAIL_ONDEMAND_QUEUE 32     // 대기 작업 상한 (넘치면 예약하지 않고 다음 요청 때 다시 시도)
+#define THUMBNAIL_ONDEMAND_SLOTS 64     // 진행 중/최근 실패로 기억하는 동영상 수
+#define THUMBNAIL_ONDEMAND_RETRY_SEC 300 // 생성에 실패한 동영상을 다시 시도하기까지의 시간
+#define THUMBNAIL_PLACEHOLDER_RETRY_SEC 2 // 자리 표시 이미지 응답의 Retry-After
+#define THUMBNAIL_PACK_MAX_BYTES (1024LL * 1024 * 1024) // 썸네일 팩 하나의 크기 (넘으면 다음 팩에 추가)
+#define THUMBNAIL_PACK_MAX_OPEN 64      // 읽기용으로 열어 두는 팩 수
+#define THUMBNAIL_PACK_COMPACT_INTERVAL_SEC 3600 // 팩 압축 확인 주기
+#define THUMBNAIL_PACK_COMPACT_RATIO 0.5 // 살아 있는 바이트가 이 비율 미만인 지난 팩을 압축
+#define THUMBNAIL_PACK_COMPACT_GRACE_SEC 3600 // 마지막 추가 후 이만큼 지난 팩만 압축 (아직 커밋 전인 이미지 보호)
+#define TRICKPLAY_INTERVAL_MS 10000     // 탐색 미리보기 타일 간격
+#define TRICKPLAY_TILE_WIDTH 160        // 타일 너비 (32의 배수로 두면 시트 안 타일 시작 위치가 정렬됨)
+#define TRICKPLAY_COLUMNS 10            // 스프라이트 시트 하나의 타일 배치 (10×10)
+#define TRICKPLAY_ROWS 10
+#define TRICKPLAY_CACHE_MAX_AGE_SEC 86400 // 시트/VTT 응답의 Cache-Control max-age
+#define FFMPEG_PATH "ffmpeg"             // 트랜스코딩에 쓰는 ffmpeg 실행 파일 (PATH에서 찾음)
+// 트랜스코딩 래더 { 이름, 높이, 동영상 kbps } (원본보다 낮은 단계만 만든다)
+#define TRANSCODE_LADDER { { "1080p", 1080, 5000 }, { "720p", 720, 2800 }, { "480p", 480, 1200 }, \
+                           { "360p", 360, 700 }, { "240p", 240, 400 } }
+#define TRANSCODE_AUDIO_KBPS 128
+#define TRANSCODE_PRESET "veryfast"     // libx264 프리셋
+#define TRANSCODE_MAX_JOBS 1            // 동시에 돌리는 ffmpeg 수 (CPU 예산 = 작업 수 × 스레드 수)
+#define TRANSCODE_THREADS 2             // ffmpeg 하나의 인코딩 스레드 수
+#define TRANSCODE_NICE 10               // ffmpeg 프로세스 nice 값 (요청 처리 스레드보다 낮은 우선순위)
+#define TRANSCODE_MAX_ATTEMPTS 3        // 이 횟수만큼 실패하면 failed로 둔다
+#define TRANSCODE_RETRY_DELAY_SEC 60    // 첫 재시도 대기 (시도할 때마다 두 배)
+#define TRANSCODE_POLL_INTERVAL_SEC 10  // 대기 작업 확인 주기
+#define TRANSCODE_WORK_DIR "../media/transcode" // 인코딩 중인 출력 (끝나면 저장소로 옮김, 같은 볼륨에 둘 것)
 #define WEB_DIR "../web"
 
 #define MAX_PATH_LEN 1024
@@ -0,0 +1,30 @@
+#ifndef CPU_AFFINITY_H
+#define CPU_AFFINITY_H
+
+// 스레드 종류별 CPU 고정과 NUMA 노드 배치
+// config.h의 CPU_PIN_* 설정에 따라 스레드를 노드 단위("numa") 또는 지정한 CPU 목록으로 고정한다.
+// 메모리는 처음 쓰는 스레드의 노드에 배치되므로(first-touch), 스레드별 버퍼와 캐시 샤드는
+// 고정된 스레드가 직접 할당하고 채우게 하면 노드 로컬이 된다.
+// 리눅스 외 플랫폼에서는 설정을 무시한다 (macOS에는 스레드를 CPU에 고정하는 API가 없음).
+
+typedef enum {
+    CPU_CLASS_HTTP = 0,             // CivetWeb 요청 워커
+    CPU_CLASS_POOL,                 // thread_pool 워커
+    CPU_CLASS_IO,                   // 저널 기록, 타이머, CivetWeb 수신 스레드
+    CPU_CLASS_COUNT
+} cpu_class_t;
+
+// NUMA 토폴로지를 읽고 설정을 해석한다 (스레드를 만들기 전에 한 번 호출)
+int cpu_affinity_init(void);
+
+// 현재 스레드를 종류별 설정에 따라 고정 (같은 종류의 스레드는 노드/CPU를 번갈아 배정)
+// 반환: 배정된 노드 번호, 고정하지 않았으면 -1
+int cpu_affinity_pin_current(cpu_class_t cls);
+
+// 현재 스레드가 있는 노드 (고정되지 않은 스레드는 지금 실행 중인 CPU 기준, 모르면 0)
+int cpu_affinity_current_node(void);
+
+// 사용 가능한 노드 수 (NUMA가 아니면 1)
+int cpu_affinity_node_count(void);
+
+#endif // CPU_AFFINITY_H
@@ -4,12 +4,27 @@
 #include <sqlite3.h>
 #include <stdbool.h>
 #include <pthread.h>
+#include <stdatomic.h>
 #include "types.h"
+#include "video_page.h"
 
-// 데이터베이스 연결 풀 (스레드 안전성)
+// 카탈로그 목록 커서 버퍼 크기 (불투명 문자열, NUL 포함)
+#define DB_CURSOR_LEN 128
+
+// 개별 SQLite 연결 (연결마다 독립된 잠금)
 typedef struct {
     sqlite3 *db;
     pthread_mutex_t mutex;
+} db_conn_t;
+
+// 데이터베이스 연결 풀
+// - writer: 모든 쓰기를 직렬화하는 단일 읽기/쓰기 연결
+// - readers: WAL 모드에서 동시에 SELECT를 수행하는 읽기 전용 연결들
+typedef struct {
+    db_conn_t writer;
+    db_conn_t *readers;
+    int reader_count;
+    atomic_uint next_reader;
 } db_pool_t;
 
 // 데이터베이스 초기화
@@ -18,31 +33,167 @@ int db_init(const char *db_path);
 // 데이터베이스 종료
 void db_close(void);
 
-// 데이터베이스 연결 가져오기 (스레드 안전)
+// 쓰기 연결 가져오기 (스레드 안전, 쓰기 작업 전용)
 sqlite3* db_get_connection(void);
 
-// 데이터베이스 연결 반환
+// 쓰기 연결 반환
 void db_release_connection(sqlite3 *db);
 
+// 쓰기 연결에서 PRAGMA optimize 실행 (읽기 전용 연결은 건너뜀)
+int db_optimize(void);
+
+// 읽기 전용 연결 가져오기 (스레드별 기본 슬롯 우선, 경합 시 다른 슬롯 시도)
+sqlite3* db_get_read_connection(void);
+
+// 읽기 전용 연결 반환
+void db_release_read_connection(sqlite3 *db);
+
 // 사용자 관련 작업
 int db_create_user(const char *login_id, const char *password_hash, const char *display_name, ott_uuid_t out_id);
 int db_get_user_by_login(const char *login_id, user_t *user);
 int db_get_user_by_id(const char *user_id, user_t *user);
 
 // 동영상 관련 작업
-int db_create_video(const char *title, const char *description, int duration_sec, ott_uuid_t out_id);
+// mime_type이 NULL이면 기본값 video/mp4
+int db_create_video(const char *title, const char *description, int duration_sec,
+                    const char *mime_type, ott_uuid_t out_id);
 int db_get_video(const char *video_id, video_t *video);
-int db_list_videos(int page, int page_size, video_t **videos, int *count, int *total);
-int db_search_videos(const char *query, int page, int page_size, video_t **videos, int *count, int *total);
+// 키셋 페이지네이션: cursor가 NULL 또는 빈 문자열이면 첫 페이지.
+// next_cursor는 다음 페이지가 없으면 빈 문자열. 반환값: 0 성공, -1 DB 오류, -2 잘못된 커서
+// page는 성공/실패와 관계없이 video_page_free로 해제한다
+int db_list_videos(const char *cursor, int page_size, video_page_t *page, int *total,
+                   char next_cursor[DB_CURSOR_LEN]);
+// 검색 total은 첫 페이지에서만 계산 (이후 페이지는 -1)
+int db_search_videos(const char *query, const char *cursor, int page_size, video_page_t *page,
+                     int *total, char next_cursor[DB_CURSOR_LEN]);
+
+// 목록 커서 인코딩/디코딩 (정렬 키 두 개 → 불투명 16진수 문자열)
+void db_encode_cursor(const char *key1, const char *key2, char out[DB_CURSOR_LEN]);
+int db_decode_cursor(const char *cursor, char *key1, size_t key1_len, char *key2, size_t key2_len);
 
 // 동영상 파일 관련 작업
+// resolution, video_codec, audio_codec은 NULL 가능 (알 수 없음)
+// content_hash: 내용 주소 저장소에 넣은 파일의 해시 (16진수, NULL 가능). media_blobs 행을 함께 만든다.
 int db_create_video_file(const char *video_id, const char *file_path, int64_t file_size, 
-                         int bitrate_kbps, const char *resolution, ott_uuid_t out_id);
+                         int bitrate_kbps, const char *resolution, const char *video_codec,
+                         const char *audio_codec, const char *content_hash, ott_uuid_t out_id);
+// 동영상의 파일 목록 (등록 순, *files는 호출자가 free, 없으면 NULL과 0)
 int db_get_video_files(const char *video_id, video_file_t **files, int *count);
 
 // 썸네일 관련 작업
-int db_create_thumbnail(const char *video_id, const char *file_path, int width, int height, ott_uuid_t out_id);
+// mime_type이 NULL이면 image/jpeg
+int db_create_thumbnail(const char *video_id, const char *file_path, int width, int height,
+                        const char *mime_type, ott_uuid_t out_id);
 int db_get_thumbnail(const char *video_id, thumbnail_t *thumbnail);
+// 팩 하나에 든 썸네일 방문 (pack_id 0: 팩이 아닌 개별 파일 썸네일, 음수 반환 시 중단)
+int db_scan_pack_thumbnails(int32_t pack_id, int (*visit)(void *ctx, const thumbnail_t *thumbnail), void *ctx);
+// 팩별로 살아 있는 이미지 바이트 합계 (행이 하나도 없는 팩은 방문하지 않는다)
+int db_scan_pack_usage(int (*visit)(void *ctx, int32_t pack_id, int64_t live_bytes), void *ctx);
+
+// Trickplay operations (동영상당 한 행, 다시 만들면 교체)
+int db_save_trickplay(const trickplay_t *trickplay);
+int db_get_trickplay(const char *video_id, trickplay_t *trickplay);
+
+// 트랜스코딩 작업 큐
+// 같은 (동영상, 단계)는 한 번만 들어간다 (이미 있으면 무시)
+int db_enqueue_transcode(const char *video_id, const char *rung, int height, int bitrate_kbps);
+// 서버가 비정상 종료해 running으로 남은 작업을 다시 대기열로 (반환: 되돌린 수)
+int db_transcode_requeue_running(void);
+// 실행할 수 있는 작업 하나를 running으로 바꾸고 가져온다 (반환: 1 가져옴, 0 없음, -1 오류)
+int db_transcode_claim(transcode_job_t *job);
+int db_transcode_set_progress(int64_t job_id, double progress);
+// 출력 파일 행 추가와 완료 표시를 한 트랜잭션으로
+int db_transcode_complete(const transcode_job_t *job, const char *file_path, int64_t file_size,
+                          int bitrate_kbps, const char *resolution, const char *video_codec,
+                          const char *audio_codec, const char *content_hash);
+// 실패 기록: attempts가 max_attempts에 닿으면 failed, 아니면 retry_delay_sec 뒤에 다시 시도
+int db_transcode_fail(int64_t job_id, const char *error, int max_attempts, int retry_delay_sec);
+// 종료로 중단된 작업을 시도 횟수를 되돌려 대기열로
+int db_transcode_release(int64_t job_id);
+// 동영상의 작업 목록 방문 (음수 반환 시 중단)
+int db_scan_transcode_jobs(const char *video_id, int (*visit)(void *ctx, const transcode_job_t *job), void *ctx);
+
+// 일괄 삽입 배치
+// 쓰기 연결을 점유한 채 하나의 트랜잭션 안에서 준비된 문장을 재사용하며,
+// 커밋 시 한 번만 동기화한다. 한 행이라도 실패하면 커밋 대신 전체를 롤백한다.
+typedef struct {
+    sqlite3 *db;
+    sqlite3_stmt *insert_video;
+    sqlite3_stmt *insert_file;
+    sqlite3_stmt *insert_blob;
+    sqlite3_stmt *insert_thumbnail;
+    sqlite3_stmt *insert_trickplay;
+    sqlite3_stmt *insert_source;
+    sqlite3_stmt *insert_transcode;
+    sqlite3_stmt *move_thumbnail;
+    int row_count;
+    bool failed;
+} db_batch_t;
+
+int db_batch_begin(db_batch_t *batch);
+int db_batch_add_video(db_batch_t *batch, const char *title, const char *description,
+                       int duration_sec, const char *mime_type, ott_uuid_t out_id);
+// 미리 정한 ID로 등록 (파일 이름을 ID로 먼저 만든 경우)
+int db_batch_add_video_id(db_batch_t *batch, const char *video_id, const char *title,
+                          const char *description, int duration_sec, const char *mime_type);
+int db_batch_add_video_file(db_batch_t *batch, const char *video_id, const char *file_path,
+                            int64_t file_size, int bitrate_kbps, const char *resolution,
+                            const char *video_codec, const char *audio_codec, const char *content_hash,
+                            ott_uuid_t out_id);
+// pack이 NULL이거나 pack_id가 0이면 file_path의 개별 파일
+int db_batch_add_thumbnail(db_batch_t *batch, const char *video_id, const char *file_path,
+                           int width, int height, const char *mime_type, const thumb_pack_ref_t *pack,
+                           ott_uuid_t out_id);
+// 썸네일을 from 위치(pack_id 0: 개별 파일)에서 팩의 to 위치로 (그사이 행이 바뀌었으면 그대로 둔다)
+int db_batch_move_thumbnail(db_batch_t *batch, const char *thumbnail_id, const thumb_pack_ref_t *from,
+                            const thumb_pack_ref_t *to);
+int db_batch_add_trickplay(db_batch_t *batch, const trickplay_t *trickplay);
+
+// 일괄 등록 파이프라인이 처리한 원본 경로 (동영상 행과 같은 트랜잭션에 기록해 재시작 시 정확히 건너뛴다)
+// 이미 있는 경로는 무시한다 (동시에 돌던 다른 등록이 먼저 기록해도 배치 전체가 롤백되지 않도록)
+int db_batch_add_ingest_source(db_batch_t *batch, const char *source_path, const char *video_id);
+int db_batch_add_transcode(db_batch_t *batch, const char *video_id, const char *rung, int height,
+                           int bitrate_kbps);
+
+// 배치 커밋 (실패한 행이 있었으면 롤백 후 -1)
+int db_batch_commit(db_batch_t *batch);
+
+// 배치 취소
+void db_batch_rollback(db_batch_t *batch);
+
+// 이미 등록된 원본 경로 방문 (음수 반환 시 중단)
+int db_scan_ingest_sources(int (*visit)(void *ctx, const char *source_path), void *ctx);
+
+// 카탈로그 스냅샷 관련 작업
+// 카탈로그 동영상 행
+// 제목/설명은 고정 길이 없이 SQLite 컬럼을 그대로 가리키며 방문 콜백 안에서만 유효하다
+typedef struct {
+    ott_uuid_t id;
+    const char *title;
+    size_t title_len;
+    const char *description;
+    size_t description_len;
+    const char *mime_type;
+    int duration_sec;
+    int64_t created_at;
+} db_catalog_video_t;
+
+// 카탈로그 행 방문자: 동영상(목록 순서) → 파일 → 썸네일 순으로 호출, 음수 반환 시 중단
+typedef struct {
+    int (*video)(void *ctx, const db_catalog_video_t *video);
+    int (*file)(void *ctx, const video_file_t *file);
+    int (*thumbnail)(void *ctx, const thumbnail_t *thumbnail);
+    void *ctx;
+} db_catalog_visitor_t;
+
+// 카탈로그 세대 번호 (videos/video_files/thumbnails가 바뀔 때마다 트리거로 증가)
+int db_get_catalog_generation(int64_t *generation);
+
+// 데이터베이스 고유 식별값 (DB를 새로 만들면 바뀜, 스냅샷 파일 검증용)
+int db_get_catalog_instance(int64_t *instance);
+
+// 하나의 읽기 트랜잭션에서 카탈로그 전체를 순회
+int db_scan_catalog(const db_catalog_visitor_t *visitor, int64_t *generation);
 
 // 시청 이력 관련 작업
 int db_upsert_watch_history(const char *user_id, const char *video_id, int position_sec, bool completed);
@@ -0,0 +1,38 @@
+#ifndef DB_MAINT_H
+#define DB_MAINT_H
+
+#include <stdint.h>
+#include <time.h>
+#include "thread_pool.h"
+
+// 백그라운드 DB 유지보수
+// 요청 경로에서 자동 체크포인트가 일어나지 않도록 쓰기 연결의 wal_autocheckpoint를 끄고,
+// 전용 연결로 주기적으로 체크포인트, 증분 VACUUM, 참조 없는 저장 파일 회수를 수행하고 쓰기 연결에서 PRAGMA optimize를 돌린다.
+// 별도 스레드 대신 백그라운드 스레드 풀의 주기 작업으로 실행된다.
+
+typedef struct {
+    time_t last_checkpoint;         // 0: 아직 실행 안 됨
+    time_t last_truncate;
+    time_t last_optimize;
+    time_t last_vacuum;
+    int64_t wal_size_bytes;         // 마지막 검사 시점의 WAL 파일 크기
+    int last_wal_frames;            // 마지막 체크포인트 시점의 WAL 프레임 수
+    int last_checkpointed_frames;   // 그중 DB 파일로 옮겨진 프레임 수
+    int64_t checkpoints;
+    int64_t busy_checkpoints;       // 읽기가 남아 있어 끝까지 진행하지 못한 횟수
+    int64_t freelist_pages;
+    int64_t vacuumed_pages;
+    int64_t reclaimed_blobs;        // 참조가 없어 지운 내용 주소 저장 파일 수
+    int incremental_vacuum;         // auto_vacuum = INCREMENTAL 여부
+} db_maint_status_t;
+
+// 유지보수 작업 예약 (db_init 이후 호출)
+int db_maint_start(const char *db_path, thread_pool_t *pool);
+
+// 유지보수 작업 취소 (실행 중인 회차를 기다린 뒤 마지막으로 TRUNCATE 체크포인트 수행, 풀 종료 전에 호출)
+void db_maint_stop(void);
+
+// 현재 상태 복사
+void db_maint_get_status(db_maint_status_t *status);
+
+#endif // DB_MAINT_H
@@ -0,0 +1,58 @@
+#ifndef DB_TRACE_H
+#define DB_TRACE_H
+
+#include <sqlite3.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// SQL 문장별 실행 통계
+// sqlite3_trace_v2(PROFILE/ROW)와 sqlite3_stmt_status로 수집하며,
+// 문장별 카운터와 log2 히스토그램은 원자적 연산으로만 갱신한다 (잠금 없음).
+
+#define DB_TRACE_MAX_STATEMENTS 128     // 추적하는 서로 다른 SQL 문장 수 (초과분은 하나로 합산)
+#define DB_TRACE_BUCKETS 32             // 히스토그램 버킷 i: [2^(i-1), 2^i) 마이크로초
+#define DB_TRACE_SQL_LEN 256
+
+typedef struct {
+    char sql[DB_TRACE_SQL_LEN];
+    uint64_t calls;
+    uint64_t total_ns;
+    uint64_t max_ns;
+    uint64_t rows;
+    uint64_t fullscan_steps;
+    uint64_t sorts;
+    uint64_t autoindexes;
+    uint64_t wait_ns;               // 이 문장 직전에 연결 잠금을 기다린 시간 합계
+    uint64_t latency_hist[DB_TRACE_BUCKETS];
+    uint64_t wait_hist[DB_TRACE_BUCKETS];
+} db_trace_stat_t;
+
+// 연결 풀 잠금 대기 통계
+typedef struct {
+    uint64_t acquires;
+    uint64_t contended;
+    uint64_t total_wait_ns;
+    uint64_t max_wait_ns;
+    uint64_t wait_hist[DB_TRACE_BUCKETS];
+} db_trace_pool_stat_t;
+
+// 연결에 추적 콜백 등록
+void db_trace_attach(sqlite3 *db);
+
+// 단조 시계 (나노초)
+uint64_t db_trace_now_ns(void);
+
+// 연결 잠금 대기 기록 (writer: 쓰기 연결 여부)
+// 대기 시간은 같은 스레드에서 다음으로 실행되는 문장에도 귀속된다
+void db_trace_record_wait(bool writer, bool contended, uint64_t wait_ns);
+
+// 문장별 통계 복사 (총 실행 시간 내림차순), 복사한 개수 반환
+int db_trace_collect(db_trace_stat_t *out, int max);
+
+// 연결 풀 대기 통계 복사
+void db_trace_collect_pool(db_trace_pool_stat_t *writer, db_trace_pool_stat_t *readers);
+
+// 히스토그램 백분위 (해당 버킷의 상한, 마이크로초)
+uint64_t db_trace_percentile_us(const uint64_t hist[DB_TRACE_BUCKETS], double pct);
+
+#endif // DB_TRACE_H
@@ -17,8 +17,12 @@ int handle_auth_check(struct mg_connection *conn, void *cbdata);
 int handle_videos_list(struct mg_connection *conn, void *cbdata);
 int handle_video_detail(struct mg_connection *conn, void *cbdata);
 int handle_video_thumbnail(struct mg_connection *conn, void *cbdata);
+int handle_video_trickplay_vtt(struct mg_connection *conn, void *cbdata);
+int handle_video_trickplay_sheet(struct mg_connection *conn, void *cbdata);
 int handle_video_stream(struct mg_connection *conn, void *cbdata);
+int handle_video_transcode(struct mg_connection *conn, void *cbdata);
 int handle_watch_history_get(struct mg_connection *conn, void *cbdata);
 int handle_watch_progress_post(struct mg_connection *conn, void *cbdata);
+int handle_db_stats(struct mg_connection *conn, void *cbdata);
 
 #endif // HTTP_HANDLER_H
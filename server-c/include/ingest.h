@@ -0,0 +1,70 @@
+#ifndef INGEST_H
+#define INGEST_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "media_place.h"
+
+// 일괄 등록 파이프라인
+// 파일마다 프로브 → 저장(해시 + media_blob) → 썸네일 → DB 단계를 거치며, 단계마다 용량 제한 스레드 풀을 둔다.
+// 앞 단계 워커는 다음 단계 큐에 넣고 바로 다음 파일로 넘어가므로 디스크(복사)와 CPU(디코딩)가
+// 동시에 일한다. 큐가 가득 차면 앞 단계가 기다려 메모리 사용량이 제한된다.
+// DB 단계는 스레드 하나가 배치 트랜잭션 하나에 모아 DB_BATCH_ROWS개 또는
+// INGEST_COMMIT_INTERVAL_MS마다 커밋한다. 처리한 원본 경로(ingest_sources)도 같은 트랜잭션에
+// 기록하므로, 중단된 뒤 같은 목록으로 다시 실행하면 커밋된 파일은 건너뛴다.
+// 파일 하나의 실패는 그 파일만 건너뛰고 계속한다.
+
+typedef enum {
+    INGEST_STAGE_PROBE = 0,
+    INGEST_STAGE_COPY,
+    INGEST_STAGE_THUMBNAIL,
+    INGEST_STAGE_DB,
+    INGEST_STAGE_COUNT
+} ingest_stage_t;
+
+typedef struct {
+    long submitted;                 // 파이프라인에 들어간 파일
+    long skipped;                   // 이전 실행에서 이미 등록된 파일
+    long completed;                 // 커밋된 파일
+    long failed;
+    int64_t bytes;                  // 저장소에 넣은 파일 크기 합계 (중복 포함)
+    int64_t copied_bytes;           // 그중 실제로 데이터를 복사한 바이트 (링크/리플링크 제외)
+    long placed[MEDIA_PLACE_METHOD_COUNT];  // 배치 방법별 파일 수 (새로 저장한 파일)
+    long deduped;                   // 저장소에 같은 내용이 있어 새로 저장하지 않은 파일
+    int64_t deduped_bytes;
+    double elapsed_sec;
+    double busy_sec[INGEST_STAGE_COUNT];  // 단계별 작업 시간 합계 (워커 수로 나누면 가동률)
+} ingest_report_t;
+
+typedef struct {
+    int workers[INGEST_STAGE_COUNT];  // 0: CPU 수 (DB 단계는 항상 1)
+    bool copy;                      // 내용 주소 저장소에 놓기 (false: 원본 경로 그대로 등록)
+    bool move;                      // 같은 볼륨이면 원본을 옮긴다 (false: 하드 링크부터 시도)
+    bool thumbnails;                // 썸네일 변형과 탐색 미리보기 생성
+    // 커밋할 때마다 DB 스레드에서 호출 (NULL 가능)
+    void (*progress)(const ingest_report_t *report, void *ctx);
+    void *progress_ctx;
+} ingest_options_t;
+
+typedef struct ingest ingest_t;
+
+// 보고서 출력용 단계 이름
+const char* ingest_stage_name(ingest_stage_t stage);
+
+// config.h의 INGEST_* 기본값
+void ingest_options_default(ingest_options_t *options);
+
+// 단계별 풀을 만들고 이미 등록된 원본 목록을 읽는다
+ingest_t* ingest_start(const ingest_options_t *options);
+
+// 파일 하나를 파이프라인에 넣는다 (첫 단계 큐가 가득 차면 대기)
+// thumbnail_path: 이미 있는 썸네일 (NULL이면 생성), duration_hint: 양수면 프로브 결과 대신 사용
+// 반환: 0 제출, 1 이미 등록되었거나 이번 실행에서 이미 넣어 건너뜀, -1 실패
+int ingest_add(ingest_t *ingest, const char *source_path, const char *title, const char *description,
+               int duration_hint, const char *thumbnail_path);
+
+// 모든 단계가 끝날 때까지 기다린 뒤 마지막 배치를 커밋하고 해제한다
+// 반환: 실패한 파일이 없으면 0
+int ingest_finish(ingest_t *ingest, ingest_report_t *report);
+
+#endif // INGEST_H
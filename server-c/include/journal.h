@@ -0,0 +1,74 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "types.h"
+
+// 시청 이벤트 저널
+// 재생 이벤트를 서비스 DB와 분리된 추가 전용 바이너리 세그먼트 파일에 기록한다.
+// 요청 스레드는 메모리 버퍼에 복사만 하고, 파일 쓰기는 전용 스레드가 모아서 처리한다.
+// 버퍼가 가득 차면 요청을 막지 않고 이벤트를 버린다 (dropped 카운터 증가).
+//
+// 세그먼트 파일: <dir>/events-<seq 8자리>.log
+//   [journal_segment_header_t][journal_event_t]...
+// 집계 도구(journal_agg)가 세그먼트를 순서대로 읽어 증분 집계한다.
+
+#define JOURNAL_MAGIC "OTTJRNL1"
+#define JOURNAL_VERSION 1
+
+typedef enum {
+    JOURNAL_EVENT_START = 1,
+    JOURNAL_EVENT_PROGRESS = 2,
+    JOURNAL_EVENT_SEEK = 3,
+    JOURNAL_EVENT_COMPLETE = 4
+} journal_event_type_t;
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t event_size;            // sizeof(journal_event_t)
+    uint64_t sequence;
+    int64_t created_ms;
+} journal_segment_header_t;
+
+// 고정 길이 레코드 (checksum으로 잘린 쓰기를 감지)
+typedef struct {
+    int64_t timestamp_ms;
+    uint8_t user_id[OTT_UUID_BYTES];
+    uint8_t video_id[OTT_UUID_BYTES];
+    uint32_t position_sec;
+    uint32_t from_sec;              // SEEK: 이동 전 위치
+    uint16_t type;                  // journal_event_type_t
+    uint16_t reserved;
+    uint32_t checksum;
+} journal_event_t;
+
+typedef struct {
+    uint64_t recorded;
+    uint64_t dropped;
+    uint64_t written;
+    uint64_t segment_sequence;
+    uint64_t segment_bytes;
+} journal_stats_t;
+
+// 저널 시작 (디렉터리가 없으면 생성, 마지막 세그먼트 다음 번호부터 기록)
+int journal_init(const char *dir);
+
+// 남은 이벤트를 기록하고 종료
+void journal_shutdown(void);
+
+// 이벤트 기록 (잠금은 버퍼 복사 동안만, 파일 I/O 없음)
+int journal_record(journal_event_type_t type, const char *user_id, const char *video_id,
+                   int position_sec, int from_sec);
+
+// 통계
+void journal_get_stats(journal_stats_t *stats);
+
+// 레코드 체크섬 (checksum 필드 제외)
+uint32_t journal_event_checksum(const journal_event_t *event);
+
+// 세그먼트 파일 경로
+void journal_segment_path(const char *dir, uint64_t sequence, char *out, size_t out_len);
+
+#endif // JOURNAL_H
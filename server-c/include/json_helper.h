@@ -3,12 +3,22 @@
 
 #include "cJSON.h"
 #include "types.h"
-
-// Create JSON response for video
-cJSON* json_create_video(const video_t *video, const char *thumbnail_url);
-
-// Create JSON response for video list
-cJSON* json_create_video_list(video_t *videos, int count, int page, int page_size, int total);
+#include "video_page.h"
+#include "catalog.h"
+#include "db_trace.h"
+#include "db_maint.h"
+#include "journal.h"
+
+// Create JSON response for a video from a catalog snapshot entry
+// Strings are copied in full, so the snapshot may be released before the response is sent
+cJSON* json_create_video(const catalog_snapshot_t *snap, const catalog_video_t *cv,
+                         const char *thumbnail_url);
+
+// Create JSON response for a video list page
+// Strings reference the page arena, so the page must outlive the cJSON tree.
+// total < 0 omits the field; empty next_cursor means there is no next page
+cJSON* json_create_video_page(const video_page_t *page, int page_size, int total,
+                              const char *next_cursor);
 
 // Create JSON response for user
 cJSON* json_create_user(const user_t *user);
@@ -16,6 +26,19 @@ cJSON* json_create_user(const user_t *user);
 // Create JSON response for watch history
 cJSON* json_create_watch_history(const watch_history_t *history);
 
+// Create JSON response for a transcoding job (one ladder rung)
+cJSON* json_create_transcode_job(const transcode_job_t *job);
+
+// Create JSON response for per-statement DB stats
+cJSON* json_create_db_stats(const db_trace_stat_t *stats, int count,
+                            const db_trace_pool_stat_t *writer, const db_trace_pool_stat_t *readers);
+
+// Create JSON response for DB maintenance status
+cJSON* json_create_db_maint_status(const db_maint_status_t *status);
+
+// Create JSON response for watch event journal stats
+cJSON* json_create_journal_stats(const journal_stats_t *stats);
+
 // Create JSON error response
 cJSON* json_create_error(const char *code, const char *message);
 
@@ -0,0 +1,31 @@
+#ifndef MEDIA_BLOB_H
+#define MEDIA_BLOB_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "media_place.h"
+
+// 내용 주소 저장소
+// 원본을 BLAKE2b-256으로 해시해 MEDIA_BLOB_DIR/<해시 앞 두 자리>/<해시>에 한 번만 저장한다.
+// 같은 마스터를 다른 제목으로 다시 올리면 기존 파일을 그대로 가리키므로 디스크와 페이지 캐시를
+// 한 벌만 쓴다. 해시는 스트림의 강한 ETag로도 쓴다.
+// 경로가 내용으로 정해지므로 파일이 있으면 곧 같은 내용이다 (임시 파일 + 이름 변경으로만 생김).
+// 원본과 inode를 공유하지 않도록 하드 링크 대신 이동, 리플링크, 복사로만 놓고 읽기 전용으로 둔다.
+
+#define MEDIA_HASH_BYTES 32
+#define MEDIA_HASH_HEX_LEN (MEDIA_HASH_BYTES * 2 + 1)
+
+// 파일 전체를 읽어 해시 (16진수 소문자), size: 읽은 바이트 (NULL 가능)
+int media_hash_file(const char *path, char hash_hex[MEDIA_HASH_HEX_LEN], int64_t *size);
+
+// 해시에 해당하는 저장 경로
+void media_blob_path(const char *hash_hex, char *out, size_t out_len);
+
+// src를 해시 경로에 저장 (이미 있으면 아무것도 하지 않고 deduped = true)
+// move/method/copied는 media_place와 같다 (중복이면 method는 건드리지 않고 copied는 0)
+// 반환: 0 성공, -1 실패
+int media_blob_store(const char *src, const char *hash_hex, int64_t size, bool move,
+                     char *out_path, size_t out_len, bool *deduped,
+                     media_place_method_t *method, int64_t *copied);
+
+#endif // MEDIA_BLOB_H
@@ -0,0 +1,35 @@
+#ifndef MEDIA_PLACE_H
+#define MEDIA_PLACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// 원본 파일을 미디어 디렉토리에 놓는다 (셸 cp 대체)
+// 가장 싼 방법부터 시도하고, 파일 시스템이 지원하지 않으면 다음 방법으로 넘어간다:
+//   이동(move일 때) → 하드 링크(allow_link일 때) → 리플링크(FICLONE / clonefile) → copy_file_range → 버퍼 복사
+// 같은 볼륨이면 크기와 상관없이 메타데이터 연산 한 번으로 끝난다.
+// 복사하는 경우에는 작업마다 다른 임시 파일에 쓰고 fsync한 뒤 이름을 바꾸므로, 중간에 끊겨도 dest에
+// 잘린 파일이 남지 않는다.
+// 하드 링크는 원본과 같은 inode를 공유하므로 원본을 제자리에서 고치면 배포 파일도 바뀐다.
+// 내용이 바뀌면 안 되는 대상(내용 주소 저장소)은 allow_link 없이 부른다.
+
+typedef enum {
+    MEDIA_PLACE_RENAME = 0,
+    MEDIA_PLACE_LINK,
+    MEDIA_PLACE_CLONE,
+    MEDIA_PLACE_COPY_RANGE,         // 커널 안에서 복사 (NFS/SMB는 서버 쪽 복사)
+    MEDIA_PLACE_COPY,               // 사용자 공간 버퍼 복사
+    MEDIA_PLACE_METHOD_COUNT
+} media_place_method_t;
+
+// src를 dest에 놓는다 (dest가 이미 있으면 실패)
+// move: 같은 파일 시스템이면 원본을 옮긴다 (원본이 사라짐)
+// allow_link: 원본과 inode를 공유하는 하드 링크를 허용
+// method: 사용한 방법 (NULL 가능), bytes: 실제로 복사한 바이트 (링크/리플링크는 0, NULL 가능)
+// 반환: 0 성공, -1 실패 (dest와 임시 파일은 남지 않음)
+int media_place(const char *src, const char *dest, bool move, bool allow_link, media_place_method_t *method,
+                int64_t *bytes);
+
+const char* media_place_method_name(media_place_method_t method);
+
+#endif // MEDIA_PLACE_H
@@ -0,0 +1,23 @@
+#ifndef MEDIA_PROBE_H
+#define MEDIA_PROBE_H
+
+#include <stdint.h>
+
+// 프로세스 안에서 libavformat으로 컨테이너를 열어 메타데이터를 한 번에 읽는다
+// (ffprobe 프로세스를 띄우고 출력을 파싱하던 방식 대체)
+
+typedef struct {
+    double duration_sec;            // 0: 알 수 없음
+    int bitrate_kbps;               // 컨테이너 전체 비트레이트 (없으면 파일 크기 / 길이로 계산)
+    int width;                      // 0: 동영상 스트림 없음
+    int height;
+    char resolution[32];            // "1920x1080" (동영상 스트림이 없으면 빈 문자열)
+    char video_codec[32];           // "h264", "hevc", "vp9" ... (없으면 빈 문자열)
+    char audio_codec[32];           // "aac", "opus" ... (없으면 빈 문자열)
+    char mime_type[64];             // 컨테이너 기준 MIME 타입
+} media_info_t;
+
+// 0: 성공, -1: 파일을 열 수 없거나 미디어가 아님
+int media_probe(const char *path, media_info_t *info);
+
+#endif // MEDIA_PROBE_H
@@ -0,0 +1,13 @@
+#ifndef MIGRATE_H
+#define MIGRATE_H
+
+#include <sqlite3.h>
+
+// 현재 스키마 버전 (PRAGMA user_version)
+int migrate_get_version(sqlite3 *db);
+
+// migrations_dir의 V<n>__*.sql 중 현재 버전보다 높은 파일을 버전 순서대로 적용
+// 파일마다 하나의 트랜잭션으로 실행하고 성공하면 user_version = n 으로 기록
+int migrate_run(sqlite3 *db, const char *migrations_dir);
+
+#endif // MIGRATE_H
@@ -9,8 +9,13 @@
 int streaming_parse_range(const char *range_header, int64_t file_size, http_range_t *range);
 
 // Stream video file with range support
+// etag: 따옴표를 뺀 강한 ETag (NULL 또는 빈 문자열이면 보내지 않음)
 int streaming_send_video(struct mg_connection *conn, const char *file_path, 
-                         const http_range_t *range, const char *mime_type);
+                         const http_range_t *range, const char *mime_type, const char *etag);
+
+// If-None-Match / If-Range 헤더 값이 etag와 일치하는지 (목록과 "*" 지원)
+// weak: W/ 접두사를 무시할지 (If-None-Match는 약한 비교, If-Range는 강한 비교)
+bool streaming_etag_matches(const char *header, const char *etag, bool weak);
 
 // Calculate start position from query parameter (e.g., ?start=630)
 int streaming_parse_start_param(const char *start_param, int64_t *offset_bytes, 
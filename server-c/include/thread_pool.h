@@ -3,40 +3,192 @@
 
 #include <pthread.h>
 #include <stdbool.h>
+#include <stdatomic.h>
+
+// 작업 훔치기(work-stealing) 스레드 풀
+// 워커마다 Chase-Lev 덱을 두고, 워커 안에서 제출한 작업은 자기 덱에 넣는다 (LIFO로 꺼냄).
+// 외부 스레드의 제출은 공유 주입 큐로 들어가고, 할 일이 없는 워커는 다른 워커의 덱에서 훔친다.
+// 작업 노드는 풀에서 재사용하고, 유휴 워커는 조건 변수에서 잠들었다가 제출 시 하나씩 깨어난다.
+//
+// 용량 제한 풀(thread_pool_create_bounded)은 덱과 주입 큐 대신 고정 크기 MPMC 링만 사용한다.
+// 작업당 힙 할당이 없고, 가득 차면 제출이 대기(submit), 실패(try_submit), 시간 제한 대기(submit_timed)한다.
+//
+// 우선순위: INTERACTIVE 작업은 항상 다른 작업보다 먼저 꺼내고, BATCH는 가장 나중에 꺼낸다.
+// 굶주림 방지를 위해 워커는 일정 횟수마다 한 번 낮은 우선순위부터 확인한다.
+// 작업 덱은 NORMAL 전용이며, 우선순위마다 주입 큐(용량 제한 풀은 링)가 따로 있다.
+//
+// 지연/주기 작업: 풀마다 계층형 타이머 휠(timer_wheel.h)과 타이머 스레드 하나를 둔다.
+// 타이머 스레드는 첫 예약 때 시작하고, 다음 만료 시각까지 잠들었다가 만료된 작업을 워커에 제출한다.
+
+#define TP_TIMER_TICK_MS 10         // 타이머 휠 한 칸의 시간
 
 // Task function type
 typedef void (*task_func_t)(void *arg);
 
-// Task structure
+typedef enum {
+    TP_PRIORITY_INTERACTIVE = 0,    // 요청 경로에서 기다리는 작업 (온디맨드 썸네일, 프로브)
+    TP_PRIORITY_NORMAL = 1,         // 기본값 (thread_pool_submit)
+    TP_PRIORITY_BATCH = 2,          // 대량 작업 (트랜스코드, VACUUM)
+    TP_PRIORITY_COUNT = 3
+} tp_priority_t;
+
+typedef enum {
+    TP_FUTURE_PENDING = 0,
+    TP_FUTURE_RUNNING,
+    TP_FUTURE_DONE,
+    TP_FUTURE_CANCELLED
+} tp_future_state_t;
+
+// 완료 핸들 (thread_pool_submit_ex가 반환, thread_pool_future_release로 반환)
+typedef struct thread_pool_future thread_pool_future_t;
+
+// 예약 작업 핸들 (thread_pool_schedule_*가 반환, thread_pool_timer_release로 반환)
+typedef struct thread_pool_timer thread_pool_timer_t;
+
+// 작업 그룹: 여러 작업을 묶어 풀 전체와 별개로 기다린다 (호출자가 메모리 소유)
+typedef struct {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    atomic_long pending;
+} thread_pool_group_t;
+
+// Task structure (풀 내부에서 재사용되는 노드)
 typedef struct task {
     task_func_t function;
     void *arg;
+    thread_pool_future_t *future;
+    thread_pool_group_t *group;
     struct task *next;
 } task_t;
 
+struct tp_worker;
+struct tp_task_chunk;
+struct tp_ring;
+struct tp_timers;
+
 // Thread pool structure
 typedef struct {
-    pthread_t *threads;
+    struct tp_worker *workers;
     int thread_count;
-    task_t *task_queue_head;
-    task_t *task_queue_tail;
+
+    // 우선순위별 주입 큐 + 전역 노드 프리 리스트 (queue_mutex로 보호)
     pthread_mutex_t queue_mutex;
-    pthread_cond_t queue_cond;
+    task_t *task_queue_head[TP_PRIORITY_COUNT];
+    task_t *task_queue_tail[TP_PRIORITY_COUNT];
+    atomic_int injected[TP_PRIORITY_COUNT];  // 주입 큐 길이 (잠금 없이 비었는지 확인용)
+    task_t *free_tasks;
+    struct tp_task_chunk *chunks;
+
+    // 용량 제한 모드 (NULL이면 무제한, 우선순위마다 링 하나)
+    struct tp_ring *rings[TP_PRIORITY_COUNT];
+    pthread_mutex_t space_mutex;
+    pthread_cond_t space_cond;
+    atomic_int space_waiters;       // 링이 가득 차 대기 중인 제출자 수
+
+    // 유휴 워커 대기
+    pthread_mutex_t park_mutex;
+    pthread_cond_t park_cond;
+    atomic_int sleepers;            // 잠들었거나 잠들기 직전인 워커 수
+    atomic_int searching;           // 작업을 찾는 중인 워커 수 (있으면 새로 깨우지 않음)
+    int wakeups;                    // 깨우기 토큰 (park_mutex로 보호, 받은 워커는 searching 상태로 시작)
+
+    // thread_pool_wait
+    pthread_mutex_t wait_mutex;
     pthread_cond_t queue_empty_cond;
-    bool shutdown;
-    int active_tasks;
+    atomic_long active_tasks;       // 제출되었지만 아직 끝나지 않은 작업 수
+
+    // 지연/주기 작업 (타이머 휠 + 타이머 스레드)
+    struct tp_timers *timers;
+
+    // 통계
+    atomic_ulong submitted;
+    atomic_ulong rejected;          // 가득 차서 거절된 제출 (try/timed)
+    atomic_ulong blocked;           // 가득 차서 대기한 제출
+    atomic_ulong cancelled;         // 시작 전에 취소된 작업
+
+    atomic_bool shutdown;
 } thread_pool_t;
 
+typedef struct {
+    int threads;
+    long capacity;                  // 우선순위별 링 용량 (0: 무제한)
+    long queue_depth;               // 대기 중인 작업 수 (덱 포함)
+    long class_depth[TP_PRIORITY_COUNT];  // 우선순위별 공유 큐 깊이 (덱 제외)
+    long active_tasks;              // 대기 + 실행 중
+    unsigned long submitted;
+    unsigned long rejected;
+    unsigned long blocked;
+    unsigned long cancelled;
+    long timers;                    // 휠에서 대기 중인 예약 작업 수
+    unsigned long timer_fires;      // 만료되어 제출된 횟수
+    unsigned long timer_overruns;   // 이전 회차가 아직 실행 중이거나 늦어서 건너뛴 주기 작업 회차
+} thread_pool_stats_t;
+
 // Initialize thread pool
 thread_pool_t* thread_pool_create(int num_threads);
 
-// Submit task to thread pool
+// 용량 제한 풀 생성 (capacity는 2의 거듭제곱으로 올림, 우선순위별로 적용)
+thread_pool_t* thread_pool_create_bounded(int num_threads, int capacity);
+
+// Submit task to thread pool (워커 안에서 호출하면 그 워커의 덱에 들어간다)
+// 용량 제한 풀이 가득 차면 자리가 날 때까지 대기한다. 워커 안에서는 대기 대신 그 자리에서 실행한다.
 int thread_pool_submit(thread_pool_t *pool, task_func_t function, void *arg);
 
+// 가득 차 있으면 기다리지 않고 -1 (무제한 풀에서는 thread_pool_submit과 같음)
+int thread_pool_try_submit(thread_pool_t *pool, task_func_t function, void *arg);
+
+// 최대 timeout_ms 동안 자리를 기다리고, 그래도 가득 차 있으면 -1
+int thread_pool_submit_timed(thread_pool_t *pool, task_func_t function, void *arg, int timeout_ms);
+
+// 우선순위/그룹/완료 핸들을 지정한 제출
+// group, future는 NULL 가능. future를 받으면 반드시 thread_pool_future_release로 반환한다.
+// timeout_ms: 용량 제한 풀이 가득 찼을 때 대기 시간 (음수: 무한 대기, 0: 바로 실패)
+int thread_pool_submit_ex(thread_pool_t *pool, task_func_t function, void *arg,
+                          tp_priority_t priority, thread_pool_group_t *group,
+                          int timeout_ms, thread_pool_future_t **future);
+
+// 완료 대기 (0: 실행 완료, -1: 시간 초과, -2: 취소됨; timeout_ms가 음수면 무한 대기)
+int thread_pool_future_wait(thread_pool_future_t *future, int timeout_ms);
+
+// 시작 전이면 취소 (true: 취소됨, false: 이미 실행 중이거나 끝남)
+bool thread_pool_future_cancel(thread_pool_future_t *future);
+
+tp_future_state_t thread_pool_future_state(thread_pool_future_t *future);
+
+void thread_pool_future_release(thread_pool_future_t *future);
+
+// delay_ms 뒤에 한 번 실행 (타이머 해상도 TP_TIMER_TICK_MS)
+// timer는 NULL 가능. 받으면 반드시 thread_pool_timer_release로 반환한다.
+int thread_pool_schedule_after(thread_pool_t *pool, int delay_ms, task_func_t function, void *arg,
+                               tp_priority_t priority, thread_pool_timer_t **timer);
+
+// interval_ms마다 실행 (첫 실행은 interval_ms 뒤)
+// 이전 회차가 끝나지 않았으면 그 회차는 건너뛰므로 같은 작업이 동시에 두 번 실행되지 않는다.
+int thread_pool_schedule_every(thread_pool_t *pool, int interval_ms, task_func_t function, void *arg,
+                               tp_priority_t priority, thread_pool_timer_t **timer);
+
+// 예약 취소 (true: 이후 실행이 없음을 보장, false: 한 번 실행 작업이 이미 제출됨)
+// wait가 true면 실행 중인 회차가 끝날 때까지 기다린다 (그 작업 안에서 wait로 호출하면 안 됨).
+// 풀을 종료하기 전에 호출해야 한다.
+bool thread_pool_timer_cancel(thread_pool_timer_t *timer, bool wait);
+
+void thread_pool_timer_release(thread_pool_timer_t *timer);
+
+// 작업 그룹
+void thread_pool_group_init(thread_pool_group_t *group);
+
+// 그룹의 작업이 모두 끝날 때까지 대기 (0: 완료, -1: 시간 초과; timeout_ms가 음수면 무한 대기)
+int thread_pool_group_wait(thread_pool_group_t *group, int timeout_ms);
+
+void thread_pool_group_destroy(thread_pool_group_t *group);
+
+// 큐 깊이와 거절/대기 횟수
+void thread_pool_get_stats(thread_pool_t *pool, thread_pool_stats_t *stats);
+
 // Wait for all tasks to complete
 void thread_pool_wait(thread_pool_t *pool);
 
-// Destroy thread pool
+// Destroy thread pool (이미 제출된 작업은 모두 실행한 뒤 종료, 아직 만료되지 않은 예약은 버린다)
 void thread_pool_destroy(thread_pool_t *pool);
 
 #endif // THREAD_POOL_H
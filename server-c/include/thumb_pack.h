@@ -0,0 +1,43 @@
+#ifndef THUMB_PACK_H
+#define THUMB_PACK_H
+
+#include <stddef.h>
+#include "types.h"
+#include "thread_pool.h"
+
+// 썸네일 팩 파일
+// 이미지마다 파일을 두지 않고 THUMBNAIL_DIR/pack-<번호>.pack에 이어 붙인다 (추가 전용).
+// 레코드: 헤더(매직, 길이 8바이트) + 이미지 바이트. thumbnails 행이 (pack_id, pack_offset, pack_length)로
+// 이미지를 가리키고 카탈로그 스냅샷이 메모리 색인 역할을 하므로, 응답 한 번에 열어 둔 팩에서 pread 한 번이면 된다.
+// 번호가 가장 큰 팩에만 추가하고, THUMBNAIL_PACK_MAX_BYTES를 넘으면 다음 번호로 넘어간다.
+// 같은 팩에 여러 프로세스(서버, add_video)가 추가할 수 있어 추가는 flock으로 직렬화한다.
+// 압축: 지난 팩 중 살아 있는 바이트가 적은 팩의 이미지를 현재 팩으로 옮기고 행을 고친 뒤 지운다.
+
+#define THUMB_PACK_RECORD_HEADER 8
+
+// 팩 파일 경로
+void thumb_pack_path(int32_t pack_id, char *out, size_t out_len);
+
+// 이미지를 현재 팩 끝에 추가
+int thumb_pack_append(const void *data, size_t length, thumb_pack_ref_t *ref);
+
+// 지금까지 추가한 레코드를 디스크에 내린다 (레코드를 가리키는 행을 커밋하기 전에 호출)
+int thumb_pack_sync(void);
+
+// 이미지 읽기 (buffer는 ref->length 이상, 반환: 0 성공, -1 실패)
+int thumb_pack_read(const thumb_pack_ref_t *ref, void *buffer);
+
+// 살아 있는 바이트 비율이 THUMBNAIL_PACK_COMPACT_RATIO 미만인 지난 팩을 압축 (반환: 압축한 팩 수, -1 실패)
+// 비운 팩 파일은 이전 스냅샷의 요청이 끝나도록 다음 압축 때 지운다
+int thumb_pack_compact(void);
+
+// 개별 파일 썸네일을 팩으로 옮긴다 (THUMBNAIL_DIR 안의 파일은 지운다, 반환: 옮긴 수, -1 실패)
+int thumb_pack_import_files(void);
+
+// 압축 주기 작업 예약 (서버 전용, 옮긴 위치는 카탈로그를 새로 고쳐 바로 게시한다)
+int thumb_pack_start(thread_pool_t *background);
+
+// 예약 취소 후 열어 둔 팩을 닫는다
+void thumb_pack_stop(void);
+
+#endif // THUMB_PACK_H
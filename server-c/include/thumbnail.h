@@ -3,14 +3,48 @@
 
 #include "types.h"
 
-// Generate thumbnail for a video file
-int thumbnail_generate(const char *video_path, const char *output_path, 
-                      int width, double offset_sec);
+// 썸네일 변형: 같은 프레임을 THUMBNAIL_WIDTHS의 너비마다 WebP(/AVIF)와 JPEG로 인코딩한 결과
+// 너비 3개 × 형식 3개
+#define THUMBNAIL_MAX_VARIANTS 9
 
-// Get video duration using ffprobe
+typedef struct {
+    char file_path[512];            // 개별 파일 경로 (팩에 넣은 변형은 빈 문자열)
+    thumb_pack_ref_t pack;          // 썸네일 팩 안의 위치
+    const char *mime_type;          // "image/webp", "image/avif", "image/jpeg"
+    int width;
+    int height;                     // 원본 화면 비율(SAR 반영)로 계산한 실제 높이
+} thumbnail_variant_t;
+
+// offset_sec 위치의 프레임을 한 번만 디코딩해서 모든 변형을 만들고 썸네일 팩에 추가한다
+// 반환: 만든 변형 수, 하나도 만들지 못하면 -1
+int thumbnail_generate_variants(const char *video_path, double offset_sec,
+                                thumbnail_variant_t *variants, int max_variants);
+
+// 대표 프레임 위치 (길이의 10%, 최대 5초)
+double thumbnail_default_offset(double duration_sec);
+
+// 동영상 전체를 한 번 디코딩하면서 TRICKPLAY_INTERVAL_MS마다 프레임 하나를 타일로 모아
+// 스프라이트 시트(<output_prefix>_<n>.<확장자>)를 만든다. tp에 시트 배치를 채운다 (video_id 제외).
+int thumbnail_generate_trickplay(const char *video_path, const char *output_prefix, trickplay_t *tp);
+
+// 시트 파일 0 .. sheet_count-1 삭제
+void thumbnail_remove_trickplay(const trickplay_t *tp, int sheet_count);
+
+// 탐색 미리보기 생성 후 DB에 기록
+int thumbnail_trickplay_and_save(const char *video_id, const char *video_path);
+
+// 이미지 MIME 타입의 파일 확장자 ("image/webp" → "webp", 모르면 "jpg")
+const char* thumbnail_mime_extension(const char *mime_type);
+
+static inline int trickplay_sheet_count(const trickplay_t *tp) {
+    int per_sheet = tp->columns * tp->rows;
+    return per_sheet > 0 ? (tp->tile_count + per_sheet - 1) / per_sheet : 0;
+}
+
+// Get video duration (media_probe로 컨테이너를 직접 읽음)
 int thumbnail_get_duration(const char *video_path, double *duration_sec);
 
-// Generate thumbnail for video and save to database
+// Generate thumbnail variants for video and save to database
 int thumbnail_generate_and_save(const char *video_id, const char *video_path);
 
 #endif // THUMBNAIL_H
@@ -0,0 +1,23 @@
+#ifndef THUMBNAIL_QUEUE_H
+#define THUMBNAIL_QUEUE_H
+
+// 요청 시 썸네일 생성
+// 등록할 때 썸네일을 만들지 못했거나 건너뛴 동영상은 첫 요청에서 백그라운드로 만든다.
+// 같은 동영상의 동시 요청은 작업 하나로 합치고(single-flight), 동시 디코딩 수는 전용 풀의
+// 워커 수(THUMBNAIL_ONDEMAND_WORKERS)로, 밀린 작업 수는 풀 용량(THUMBNAIL_ONDEMAND_QUEUE)으로 제한한다.
+
+typedef enum {
+    THUMBNAIL_QUEUE_PENDING = 0,    // 생성 중 (이번 요청이 예약했거나 이미 진행 중)
+    THUMBNAIL_QUEUE_FAILED,         // 최근에 실패 (THUMBNAIL_ONDEMAND_RETRY_SEC 동안 다시 시도하지 않음) 또는 시작 전
+    THUMBNAIL_QUEUE_BUSY            // 대기열이 가득 차 예약하지 못함 (다음 요청 때 다시 시도)
+} thumbnail_queue_status_t;
+
+int thumbnail_queue_start(void);
+
+// 썸네일이 없는 동영상의 생성을 예약 (끝나면 카탈로그를 바로 새로 고친다)
+thumbnail_queue_status_t thumbnail_queue_request(const char *video_id, const char *video_path);
+
+// 아직 시작하지 않은 작업은 버리고 진행 중인 작업이 끝나기를 기다린다 (db_close 전에 호출)
+void thumbnail_queue_stop(void);
+
+#endif // THUMBNAIL_QUEUE_H
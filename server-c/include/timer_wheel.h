@@ -0,0 +1,57 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// 계층형 타이머 휠
+// 4단계 × 64칸. 단계 0은 틱 단위, 단계 n은 64^n 틱 단위 칸이다.
+// 추가/삭제는 O(1)이고, 상위 단계 칸은 하위 단계 인덱스가 0으로 돌아올 때 한 칸씩 내려온다(cascade).
+// 스레드 안전하지 않다 (호출자가 잠금).
+
+#define TIMER_WHEEL_BITS 6
+#define TIMER_WHEEL_SLOTS (1 << TIMER_WHEEL_BITS)
+#define TIMER_WHEEL_LEVELS 4
+#define TIMER_WHEEL_MAX_TICKS ((1ULL << (TIMER_WHEEL_BITS * TIMER_WHEEL_LEVELS)) - 1)
+
+// 침투형 노드 (사용하는 구조체에 포함시킨다)
+typedef struct timer_node {
+    struct timer_node *prev;
+    struct timer_node *next;
+    uint64_t expires;               // 만료 틱
+} timer_node_t;
+
+typedef struct {
+    uint64_t now;                   // 다음에 처리할 틱
+    uint64_t count;                 // 휠에 있는 노드 수
+    timer_node_t slots[TIMER_WHEEL_LEVELS][TIMER_WHEEL_SLOTS];  // 원형 리스트 머리
+} timer_wheel_t;
+
+void timer_wheel_init(timer_wheel_t *wheel, uint64_t now);
+
+// 노드 초기화 (어느 리스트에도 없는 상태)
+void timer_node_init(timer_node_t *node);
+
+// 휠에 들어 있는지
+static inline bool timer_node_pending(const timer_node_t *node) {
+    return node->next != node;
+}
+
+// expires 틱에 만료되도록 추가 (지난 틱이면 다음 진행에서 바로 만료, 너무 멀면 최대값으로 자름)
+void timer_wheel_add(timer_wheel_t *wheel, timer_node_t *node, uint64_t expires);
+
+void timer_wheel_remove(timer_wheel_t *wheel, timer_node_t *node);
+
+// now 틱 직전까지 진행하며 만료된 노드를 expired 리스트(원형 리스트 머리)로 옮긴다
+void timer_wheel_advance(timer_wheel_t *wheel, uint64_t now, timer_node_t *expired);
+
+// 남은 노드를 모두 expired 리스트로 옮기고 휠을 비운다 (종료 시)
+void timer_wheel_drain(timer_wheel_t *wheel, timer_node_t *expired);
+
+// 다음에 처리가 필요한 틱 (만료 또는 상위 단계 내림). 비어 있으면 false
+bool timer_wheel_next(const timer_wheel_t *wheel, uint64_t *tick);
+
+// 원형 리스트 머리에서 첫 노드를 꺼낸다 (비었으면 NULL)
+timer_node_t* timer_list_pop(timer_node_t *head);
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,34 @@
+#ifndef TRANSCODE_H
+#define TRANSCODE_H
+
+#include "thread_pool.h"
+
+// 백그라운드 트랜스코딩
+// 등록할 때 원본보다 낮은 래더 단계(TRANSCODE_LADDER)를 transcode_jobs에 넣고, 서버는 백그라운드
+// 풀의 주기 작업으로 대기 작업을 가져와 전용 워커에서 ffmpeg를 실행한다.
+// 결과는 내용 주소 저장소로 옮긴 뒤 실제 비트레이트/해상도로 video_files에 추가되므로,
+// 카탈로그 세대가 바뀌어 다음 새로 고침부터 스트림 요청이 낮은 비트레이트 파일을 고를 수 있다.
+// CPU 예산: 동시 작업 TRANSCODE_MAX_JOBS개 × 인코딩 스레드 TRANSCODE_THREADS개, nice TRANSCODE_NICE.
+
+#define TRANSCODE_MAX_RUNGS 8       // TRANSCODE_LADDER 단계 수 상한
+
+typedef struct {
+    const char *name;               // "720p"
+    int height;
+    int bitrate_kbps;
+} transcode_rung_t;
+
+// 원본 높이보다 낮은 단계 목록 (높은 단계부터, 반환: 개수, 높이를 모르면 0)
+int transcode_ladder_for(int source_height, const transcode_rung_t **rungs, int max_rungs);
+
+// 원본 높이에 맞는 단계를 대기열에 넣는다 (단일 등록용, 일괄 등록은 배치에 함께 기록)
+// 반환: 넣은 단계 수, -1 실패
+int transcode_enqueue(const char *video_id, int source_height);
+
+// 중단된 작업을 되돌리고 주기 작업 예약 (db_init 이후 호출)
+int transcode_start(thread_pool_t *background);
+
+// 예약 취소 후 실행 중인 ffmpeg를 멈추고 그 작업을 대기열로 되돌린다 (백그라운드 풀 종료 전에 호출)
+void transcode_stop(void);
+
+#endif // TRANSCODE_H
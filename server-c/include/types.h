@@ -8,6 +8,9 @@
 // UUID 타입 (36자 + null 종료문자)
 typedef char ott_uuid_t[37];
 
+// DB에 저장되는 UUID 바이트 수 (BLOB 키)
+#define OTT_UUID_BYTES 16
+
 // 사용자 구조체
 typedef struct {
     ott_uuid_t id;
@@ -37,22 +40,60 @@ typedef struct {
     int64_t file_size;
     int bitrate_kbps;
     char resolution[32];
+    char content_hash[65];          // BLAKE2b-256 16진수 (강한 ETag, 해시 이전 파일은 빈 문자열)
     time_t created_at;
 } video_file_t;
 
+// 팩 파일 안의 이미지 위치 (pack_id 0: 팩이 아닌 개별 파일)
+typedef struct {
+    int32_t pack_id;
+    int32_t length;
+    int64_t offset;                 // 이미지 바이트 시작 (레코드 헤더 다음)
+} thumb_pack_ref_t;
+
 // 썸네일
 typedef struct {
     ott_uuid_t id;
     ott_uuid_t video_id;
-    char file_path[512];
+    char file_path[512];            // 팩에 든 썸네일은 빈 문자열
+    thumb_pack_ref_t pack;
     int width;
     int height;
+    char mime_type[32];             // image/jpeg, image/webp, image/avif
     time_t created_at;
 } thumbnail_t;
 
+// 탐색 미리보기 (스프라이트 시트 + WebVTT 색인)
+// 타일 i는 시트 i / (columns × rows)에 있고 [i × interval_ms, (i + 1) × interval_ms) 구간을 보여 준다
+typedef struct {
+    ott_uuid_t video_id;
+    char path_prefix[512];          // 시트 n: <path_prefix>_<n>.<확장자>
+    char mime_type[32];
+    int interval_ms;
+    int tile_width;
+    int tile_height;
+    int columns;
+    int rows;
+    int tile_count;
+} trickplay_t;
+
+// 트랜스코딩 작업 (동영상 × 래더 단계 하나)
+typedef struct {
+    int64_t id;
+    ott_uuid_t video_id;
+    char rung[16];                  // 단계 이름 ("720p")
+    int height;                     // 출력 높이 (너비는 비율 유지)
+    int bitrate_kbps;               // 목표 동영상 비트레이트
+    char state[16];                 // queued, running, done, failed
+    int attempts;                   // 시작한 횟수 (이번 시도 포함)
+    double progress;                // 0~1
+    char error[256];
+    char source_path[512];          // 원본 파일 (동영상의 첫 파일)
+    double duration_sec;            // 진행률 계산용 (0: 알 수 없음)
+} transcode_job_t;
+
 // 시청 이력
 typedef struct {
-    ott_uuid_t id;
     ott_uuid_t user_id;
     ott_uuid_t video_id;
     int last_position_sec;
@@ -1,9 +1,19 @@
 #ifndef UUID_H
 #define UUID_H
 
+#include <stdint.h>
 #include "types.h"
 
 // UUIDv4 생성
 void uuid_generate(ott_uuid_t out);
 
+// UUIDv7 생성 (밀리초 타임스탬프 + 단조 증가 카운터, 생성 순서대로 정렬됨)
+void uuid_generate_v7(ott_uuid_t out);
+
+// 문자열 UUID → 16바이트 (형식 오류 시 -1)
+int uuid_parse(const char *str, uint8_t out[OTT_UUID_BYTES]);
+
+// 16바이트 → 문자열 UUID
+void uuid_format(const uint8_t bytes[OTT_UUID_BYTES], ott_uuid_t out);
+
 #endif // UUID_H
@@ -0,0 +1,63 @@
+#ifndef VIDEO_PAGE_H
+#define VIDEO_PAGE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "types.h"
+
+// 목록/검색 페이지용 가변 길이 레코드
+// 고정 길이 video_t(약 1.4KB) 대신 문자열은 페이지 아레나에 (offset, length)로 한 번만 복사하고,
+// JSON 계층은 복사 없이 아레나를 참조한다 (cJSON_CreateStringReference).
+
+// 인터닝된 MIME 타입 (프로세스 수명 동안 유지되는 문자열)
+#define MIME_MAX_TYPES 32
+typedef uint16_t mime_id_t;
+
+// MIME 문자열 → ID (처음 보는 타입은 등록, 테이블이 가득 차면 기본값 video/mp4)
+mime_id_t mime_intern(const char *mime_type);
+
+// ID → MIME 문자열
+const char* mime_name(mime_id_t id);
+
+// 아레나 내 문자열 위치 (NUL 종료)
+typedef struct {
+    uint32_t offset;
+    uint32_t length;
+} page_str_t;
+
+typedef struct {
+    ott_uuid_t id;
+    page_str_t title;
+    page_str_t description;
+    page_str_t thumbnail_url;
+    int32_t duration_sec;
+    mime_id_t mime;
+    int64_t created_at;             // 카탈로그 목록에서만 채움 (DB 조회 경로는 0)
+} video_record_t;
+
+typedef struct {
+    video_record_t *items;
+    int count;
+    int capacity;
+    char *arena;
+    size_t arena_size;
+    size_t arena_cap;
+} video_page_t;
+
+// 최대 capacity개 레코드를 담는 페이지 준비
+int video_page_init(video_page_t *page, int capacity);
+
+// 레코드 추가 (길이를 아는 문자열을 그대로 복사, strlen 없음)
+int video_page_add(video_page_t *page, const char *id,
+                   const char *title, size_t title_len,
+                   const char *description, size_t description_len,
+                   mime_id_t mime, int duration_sec, int64_t created_at);
+
+// 페이지 해제
+void video_page_free(video_page_t *page);
+
+static inline const char* video_page_str(const video_page_t *page, page_str_t str) {
+    return page->arena + str.offset;
+}
+
+#endif // VIDEO_PAGE_H
@@ -0,0 +1,10 @@
+-- Source files already registered by the batch ingest pipeline
+-- (add_video --dir / --manifest). Rows are written in the same transaction as
+-- the video rows, so an interrupted run resumes by skipping exactly the
+-- sources whose videos were committed.
+CREATE TABLE IF NOT EXISTS ingest_sources (
+  source_path TEXT PRIMARY KEY,
+  video_id    BLOB NOT NULL,
+  ingested_at INTEGER NOT NULL DEFAULT (unixepoch()),
+  FOREIGN KEY (video_id) REFERENCES videos(id) ON DELETE CASCADE
+) WITHOUT ROWID;
@@ -0,0 +1,31 @@
+-- Content-addressed media storage.
+-- Ingest hashes each source with BLAKE2b-256 and stores it once under
+-- media/blobs/<first two hex digits>/<hash>. Re-uploads of the same master
+-- link to the existing blob instead of copying it. The hash also serves as
+-- the strong ETag of the stream. refcount counts the video_files rows that
+-- point at a blob and is kept by triggers, so blobs at 0 can be reclaimed.
+-- Files registered before this migration keep content_hash NULL.
+CREATE TABLE IF NOT EXISTS media_blobs (
+  hash       BLOB PRIMARY KEY CHECK (length(hash) = 32),
+  file_path  TEXT NOT NULL,
+  file_size  INTEGER NOT NULL CHECK (file_size >= 0),
+  refcount   INTEGER NOT NULL DEFAULT 0,
+  created_at INTEGER NOT NULL DEFAULT (unixepoch())
+) WITHOUT ROWID;
+
+ALTER TABLE video_files ADD COLUMN content_hash BLOB REFERENCES media_blobs(hash);
+
+CREATE INDEX IF NOT EXISTS idx_video_files_hash ON video_files(content_hash)
+  WHERE content_hash IS NOT NULL;
+
+CREATE TRIGGER IF NOT EXISTS trg_video_files_blob_insert AFTER INSERT ON video_files
+WHEN NEW.content_hash IS NOT NULL
+BEGIN
+  UPDATE media_blobs SET refcount = refcount + 1 WHERE hash = NEW.content_hash;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_video_files_blob_delete AFTER DELETE ON video_files
+WHEN OLD.content_hash IS NOT NULL
+BEGIN
+  UPDATE media_blobs SET refcount = refcount - 1 WHERE hash = OLD.content_hash;
+END;
@@ -0,0 +1,26 @@
+-- Background transcoding queue: one row per (video, ladder rung).
+-- Ingest enqueues the rungs below the source height. The server claims
+-- queued rows whose not_before has passed, runs ffmpeg, and on success adds
+-- the output as another video_files row in the same transaction that marks
+-- the job done. Failed attempts go back to 'queued' with a growing not_before
+-- until attempts reaches the configured limit. Jobs left 'running' by a
+-- crashed server are re-queued at startup.
+CREATE TABLE IF NOT EXISTS transcode_jobs (
+  id           INTEGER PRIMARY KEY,
+  video_id     BLOB NOT NULL,
+  rung         TEXT NOT NULL,
+  height       INTEGER NOT NULL CHECK (height > 0),
+  bitrate_kbps INTEGER NOT NULL CHECK (bitrate_kbps > 0),
+  state        TEXT NOT NULL DEFAULT 'queued' CHECK (state IN ('queued', 'running', 'done', 'failed')),
+  attempts     INTEGER NOT NULL DEFAULT 0,
+  progress     REAL NOT NULL DEFAULT 0,
+  error        TEXT,
+  not_before   INTEGER NOT NULL DEFAULT (unixepoch()),
+  created_at   INTEGER NOT NULL DEFAULT (unixepoch()),
+  updated_at   INTEGER NOT NULL DEFAULT (unixepoch()),
+  UNIQUE (video_id, rung),
+  FOREIGN KEY (video_id) REFERENCES videos(id) ON DELETE CASCADE
+);
+
+CREATE INDEX IF NOT EXISTS idx_transcode_jobs_ready ON transcode_jobs(not_before)
+  WHERE state = 'queued';
@@ -0,0 +1,12 @@
+-- Thumbnails are appended to shared pack files (media/thumbnails/pack-<id>.pack)
+-- instead of one file per image. A packed row stores the pack number and the
+-- byte range of the image; file_path is empty. Rows with a NULL pack_id still
+-- point at a standalone file (older ingests, manifest-supplied thumbnails).
+-- Compaction moves live images out of mostly-dead packs and rewrites these
+-- columns; the index lets it find a pack's rows and sum its live bytes.
+ALTER TABLE thumbnails ADD COLUMN pack_id INTEGER;
+ALTER TABLE thumbnails ADD COLUMN pack_offset INTEGER;
+ALTER TABLE thumbnails ADD COLUMN pack_length INTEGER;
+
+CREATE INDEX IF NOT EXISTS idx_thumbnails_pack ON thumbnails(pack_id, pack_offset)
+  WHERE pack_id IS NOT NULL;
@@ -0,0 +1,41 @@
+-- Reclaiming unreferenced content-addressed blobs.
+-- V11 kept refcount only on INSERT and DELETE of video_files, so re-pointing
+-- a file row at another hash left both counts wrong. The triggers are rebuilt
+-- here with an UPDATE OF content_hash case, and counts are recomputed once.
+-- released_at records when a blob's refcount last dropped to 0. Background
+-- maintenance deletes blobs that have stayed at 0 for a grace period. The grace
+-- period covers an ingest that found the blob file already present but has
+-- not committed its video_files row yet.
+ALTER TABLE media_blobs ADD COLUMN released_at INTEGER;
+
+UPDATE media_blobs SET refcount = (SELECT count(*) FROM video_files WHERE content_hash = media_blobs.hash);
+UPDATE media_blobs SET released_at = unixepoch() WHERE refcount = 0;
+
+CREATE INDEX IF NOT EXISTS idx_media_blobs_released ON media_blobs(released_at)
+  WHERE refcount = 0;
+
+DROP TRIGGER IF EXISTS trg_video_files_blob_insert;
+DROP TRIGGER IF EXISTS trg_video_files_blob_delete;
+
+CREATE TRIGGER IF NOT EXISTS trg_video_files_blob_insert AFTER INSERT ON video_files
+WHEN NEW.content_hash IS NOT NULL
+BEGIN
+  UPDATE media_blobs SET refcount = refcount + 1, released_at = NULL WHERE hash = NEW.content_hash;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_video_files_blob_delete AFTER DELETE ON video_files
+WHEN OLD.content_hash IS NOT NULL
+BEGIN
+  UPDATE media_blobs SET refcount = refcount - 1,
+    released_at = CASE WHEN refcount = 1 THEN unixepoch() ELSE released_at END
+  WHERE hash = OLD.content_hash;
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_video_files_blob_update AFTER UPDATE OF content_hash ON video_files
+WHEN OLD.content_hash IS NOT NEW.content_hash
+BEGIN
+  UPDATE media_blobs SET refcount = refcount - 1,
+    released_at = CASE WHEN refcount = 1 THEN unixepoch() ELSE released_at END
+  WHERE hash = OLD.content_hash;
+  UPDATE media_blobs SET refcount = refcount + 1, released_at = NULL WHERE hash = NEW.content_hash;
+END;
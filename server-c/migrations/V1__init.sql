@@ -1,7 +1,5 @@
-PRAGMA foreign_keys = ON;
-PRAGMA journal_mode = WAL;
-PRAGMA synchronous = NORMAL;
-PRAGMA temp_store = MEMORY;
+-- Connection settings (foreign_keys, WAL, synchronous, temp_store) are applied
+-- by the server on every connection, not here: migrations run inside a transaction.
 
 -- Users table
 CREATE TABLE IF NOT EXISTS users (
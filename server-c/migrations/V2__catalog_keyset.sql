@@ -0,0 +1,21 @@
+-- Keyset pagination index for catalog listing (newest first)
+CREATE INDEX IF NOT EXISTS idx_videos_created_id ON videos(created_at DESC, id DESC);
+
+-- Incrementally maintained catalog counters
+CREATE TABLE IF NOT EXISTS catalog_stats (
+  name  TEXT PRIMARY KEY,
+  value INTEGER NOT NULL DEFAULT 0
+) WITHOUT ROWID;
+
+INSERT OR IGNORE INTO catalog_stats (name, value)
+SELECT 'video_count', COUNT(*) FROM videos;
+
+CREATE TRIGGER IF NOT EXISTS trg_videos_count_insert AFTER INSERT ON videos
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'video_count';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_videos_count_delete AFTER DELETE ON videos
+BEGIN
+  UPDATE catalog_stats SET value = value - 1 WHERE name = 'video_count';
+END;
@@ -0,0 +1,35 @@
+-- Full-text search over title and description.
+-- trigram tokenizer matches substrings, so Hangul works without word segmentation.
+CREATE VIRTUAL TABLE IF NOT EXISTS videos_fts USING fts5(
+  title,
+  description,
+  content = 'videos',
+  content_rowid = 'rowid',
+  tokenize = 'trigram'
+);
+
+CREATE TRIGGER IF NOT EXISTS trg_videos_fts_insert AFTER INSERT ON videos
+BEGIN
+  INSERT INTO videos_fts (rowid, title, description)
+  VALUES (new.rowid, new.title, new.description);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_videos_fts_delete AFTER DELETE ON videos
+BEGIN
+  INSERT INTO videos_fts (videos_fts, rowid, title, description)
+  VALUES ('delete', old.rowid, old.title, old.description);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_videos_fts_update AFTER UPDATE OF title, description ON videos
+BEGIN
+  INSERT INTO videos_fts (videos_fts, rowid, title, description)
+  VALUES ('delete', old.rowid, old.title, old.description);
+  INSERT INTO videos_fts (rowid, title, description)
+  VALUES (new.rowid, new.title, new.description);
+END;
+
+-- Index rows that existed before this migration
+INSERT INTO videos_fts (videos_fts) VALUES ('rebuild');
+
+-- Superseded by videos_fts (LIKE '%...%' could never use it)
+DROP INDEX IF EXISTS idx_videos_title;
@@ -0,0 +1,150 @@
+-- Compact keys: 16-byte BLOB UUIDs instead of 36-char TEXT, and integer
+-- unix-epoch timestamps instead of TEXT datetime('now').
+-- New rows get time-ordered UUIDv7 ids from the server; existing ids are
+-- converted in place. Requires foreign_keys = OFF (the migration runner
+-- disables it and runs foreign_key_check before committing).
+
+-- Rebuilt below against the new stable rowid (videos.seq)
+DROP TABLE IF EXISTS videos_fts;
+
+CREATE TABLE users_new (
+  id            BLOB PRIMARY KEY CHECK (length(id) = 16),
+  login_id      TEXT NOT NULL UNIQUE,
+  password_hash TEXT NOT NULL,
+  display_name  TEXT NOT NULL,
+  created_at    INTEGER NOT NULL DEFAULT (unixepoch()),
+  updated_at    INTEGER NOT NULL DEFAULT (unixepoch())
+);
+
+INSERT INTO users_new (id, login_id, password_hash, display_name, created_at, updated_at)
+SELECT unhex(replace(id, '-', '')), login_id, password_hash, display_name,
+       coalesce(unixepoch(created_at), unixepoch()), coalesce(unixepoch(updated_at), unixepoch())
+FROM users;
+
+-- seq is an explicit INTEGER PRIMARY KEY so VACUUM cannot renumber the
+-- rowids that videos_fts points at
+CREATE TABLE videos_new (
+  seq           INTEGER PRIMARY KEY,
+  id            BLOB NOT NULL UNIQUE CHECK (length(id) = 16),
+  title         TEXT NOT NULL,
+  description   TEXT,
+  duration_sec  INTEGER CHECK (duration_sec >= 0),
+  mime_type     TEXT DEFAULT 'video/mp4',
+  created_at    INTEGER NOT NULL DEFAULT (unixepoch()),
+  updated_at    INTEGER NOT NULL DEFAULT (unixepoch())
+);
+
+INSERT INTO videos_new (seq, id, title, description, duration_sec, mime_type, created_at, updated_at)
+SELECT rowid, unhex(replace(id, '-', '')), title, description, duration_sec, mime_type,
+       coalesce(unixepoch(created_at), unixepoch()), coalesce(unixepoch(updated_at), unixepoch())
+FROM videos;
+
+CREATE TABLE video_files_new (
+  id           BLOB PRIMARY KEY CHECK (length(id) = 16),
+  video_id     BLOB NOT NULL,
+  file_path    TEXT NOT NULL,
+  file_size    INTEGER CHECK (file_size >= 0),
+  bitrate_kbps INTEGER,
+  resolution   TEXT,
+  created_at   INTEGER NOT NULL DEFAULT (unixepoch()),
+  FOREIGN KEY (video_id) REFERENCES videos(id) ON DELETE CASCADE
+);
+
+INSERT INTO video_files_new (id, video_id, file_path, file_size, bitrate_kbps, resolution, created_at)
+SELECT unhex(replace(id, '-', '')), unhex(replace(video_id, '-', '')), file_path, file_size,
+       bitrate_kbps, resolution, coalesce(unixepoch(created_at), unixepoch())
+FROM video_files;
+
+CREATE TABLE thumbnails_new (
+  id         BLOB PRIMARY KEY CHECK (length(id) = 16),
+  video_id   BLOB NOT NULL,
+  file_path  TEXT NOT NULL,
+  width      INTEGER,
+  height     INTEGER,
+  created_at INTEGER NOT NULL DEFAULT (unixepoch()),
+  FOREIGN KEY (video_id) REFERENCES videos(id) ON DELETE CASCADE
+);
+
+INSERT INTO thumbnails_new (id, video_id, file_path, width, height, created_at)
+SELECT unhex(replace(id, '-', '')), unhex(replace(video_id, '-', '')), file_path, width, height,
+       coalesce(unixepoch(created_at), unixepoch())
+FROM thumbnails;
+
+-- Clustered on (user_id, video_id): one b-tree per upsert, no surrogate id
+-- and no separate UNIQUE index
+CREATE TABLE watch_history_new (
+  user_id           BLOB NOT NULL,
+  video_id          BLOB NOT NULL,
+  last_position_sec INTEGER NOT NULL DEFAULT 0,
+  completed         INTEGER NOT NULL DEFAULT 0,
+  updated_at        INTEGER NOT NULL DEFAULT (unixepoch()),
+  PRIMARY KEY (user_id, video_id),
+  FOREIGN KEY (user_id) REFERENCES users(id) ON DELETE CASCADE,
+  FOREIGN KEY (video_id) REFERENCES videos(id) ON DELETE CASCADE
+) WITHOUT ROWID;
+
+INSERT INTO watch_history_new (user_id, video_id, last_position_sec, completed, updated_at)
+SELECT unhex(replace(user_id, '-', '')), unhex(replace(video_id, '-', '')), last_position_sec,
+       completed, coalesce(unixepoch(updated_at), unixepoch())
+FROM watch_history;
+
+DROP TABLE watch_history;
+DROP TABLE thumbnails;
+DROP TABLE video_files;
+DROP TABLE videos;
+DROP TABLE users;
+
+ALTER TABLE users_new RENAME TO users;
+ALTER TABLE videos_new RENAME TO videos;
+ALTER TABLE video_files_new RENAME TO video_files;
+ALTER TABLE thumbnails_new RENAME TO thumbnails;
+ALTER TABLE watch_history_new RENAME TO watch_history;
+
+-- Indexes
+-- (watch_history needs no extra index: its primary key already leads with user_id;
+--  deleting a video scans it, which is rare compared to progress upserts)
+CREATE INDEX IF NOT EXISTS idx_videos_created_id ON videos(created_at DESC, id DESC);
+CREATE INDEX IF NOT EXISTS idx_video_files_video ON video_files(video_id);
+CREATE INDEX IF NOT EXISTS idx_thumbnails_video ON thumbnails(video_id);
+
+-- Catalog counter triggers (dropped together with the old videos table)
+CREATE TRIGGER IF NOT EXISTS trg_videos_count_insert AFTER INSERT ON videos
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'video_count';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_videos_count_delete AFTER DELETE ON videos
+BEGIN
+  UPDATE catalog_stats SET value = value - 1 WHERE name = 'video_count';
+END;
+
+-- Full-text search, now keyed by videos.seq
+CREATE VIRTUAL TABLE IF NOT EXISTS videos_fts USING fts5(
+  title,
+  description,
+  content = 'videos',
+  content_rowid = 'seq',
+  tokenize = 'trigram'
+);
+
+CREATE TRIGGER IF NOT EXISTS trg_videos_fts_insert AFTER INSERT ON videos
+BEGIN
+  INSERT INTO videos_fts (rowid, title, description)
+  VALUES (new.seq, new.title, new.description);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_videos_fts_delete AFTER DELETE ON videos
+BEGIN
+  INSERT INTO videos_fts (videos_fts, rowid, title, description)
+  VALUES ('delete', old.seq, old.title, old.description);
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_videos_fts_update AFTER UPDATE OF title, description ON videos
+BEGIN
+  INSERT INTO videos_fts (videos_fts, rowid, title, description)
+  VALUES ('delete', old.seq, old.title, old.description);
+  INSERT INTO videos_fts (rowid, title, description)
+  VALUES (new.seq, new.title, new.description);
+END;
+
+INSERT INTO videos_fts (videos_fts) VALUES ('rebuild');
@@ -0,0 +1,49 @@
+-- Catalog generation counter: bumped on every change to videos, video_files
+-- or thumbnails so the server can tell when its in-memory snapshot is stale
+-- (including writes made by other processes such as add_video).
+INSERT OR IGNORE INTO catalog_stats (name, value) VALUES ('generation', 1);
+
+CREATE TRIGGER IF NOT EXISTS trg_catalog_gen_videos_insert AFTER INSERT ON videos
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'generation';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_catalog_gen_videos_update AFTER UPDATE ON videos
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'generation';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_catalog_gen_videos_delete AFTER DELETE ON videos
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'generation';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_catalog_gen_files_insert AFTER INSERT ON video_files
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'generation';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_catalog_gen_files_update AFTER UPDATE ON video_files
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'generation';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_catalog_gen_files_delete AFTER DELETE ON video_files
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'generation';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_catalog_gen_thumbnails_insert AFTER INSERT ON thumbnails
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'generation';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_catalog_gen_thumbnails_update AFTER UPDATE ON thumbnails
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'generation';
+END;
+
+CREATE TRIGGER IF NOT EXISTS trg_catalog_gen_thumbnails_delete AFTER DELETE ON thumbnails
+BEGIN
+  UPDATE catalog_stats SET value = value + 1 WHERE name = 'generation';
+END;
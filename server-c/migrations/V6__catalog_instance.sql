@@ -0,0 +1,4 @@
+-- Random per-database identity for the catalog. The on-disk catalog snapshot
+-- records it together with the generation, so a snapshot written against a
+-- different (e.g. reset) database is never mistaken for a current one.
+INSERT OR IGNORE INTO catalog_stats (name, value) VALUES ('instance', abs(random()));
@@ -0,0 +1,5 @@
+-- Codec names recorded by the in-process media probe at ingest time.
+-- bitrate_kbps/resolution (video_files) and duration_sec/mime_type (videos)
+-- already exist and are now filled from the container instead of defaults.
+ALTER TABLE video_files ADD COLUMN video_codec TEXT;
+ALTER TABLE video_files ADD COLUMN audio_codec TEXT;
@@ -0,0 +1,4 @@
+-- Thumbnails are now stored as several variants per video (widths x formats).
+-- The HTTP handler picks one by Accept and ?w=, so each row records its format.
+-- Existing rows were produced as JPEG by the ffmpeg subprocess.
+ALTER TABLE thumbnails ADD COLUMN mime_type TEXT NOT NULL DEFAULT 'image/jpeg';
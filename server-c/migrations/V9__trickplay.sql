@@ -0,0 +1,17 @@
+-- Trickplay (scrub preview) sprite sheets, one row per video.
+-- Sheet n is <path_prefix>_<n>.<ext>; tile i sits in sheet i / (columns * rows)
+-- and shows [i * interval_ms, (i + 1) * interval_ms). The WebVTT index is
+-- rendered from this row on request, so it never goes stale against the sheets.
+CREATE TABLE IF NOT EXISTS trickplay (
+  video_id    BLOB PRIMARY KEY,
+  path_prefix TEXT NOT NULL,
+  mime_type   TEXT NOT NULL,
+  interval_ms INTEGER NOT NULL,
+  tile_width  INTEGER NOT NULL,
+  tile_height INTEGER NOT NULL,
+  columns     INTEGER NOT NULL,
+  rows        INTEGER NOT NULL,
+  tile_count  INTEGER NOT NULL,
+  created_at  INTEGER NOT NULL DEFAULT (unixepoch()),
+  FOREIGN KEY (video_id) REFERENCES videos(id) ON DELETE CASCADE
+) WITHOUT ROWID;
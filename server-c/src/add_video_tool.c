@@ -1,16 +1,318 @@
+#ifdef __linux__
+#define _XOPEN_SOURCE 700               // nftw, sigaction
+#endif
+
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <signal.h>
+#include <ftw.h>
+#include <unistd.h>
 #include <sys/stat.h>
 #include "db.h"
+#include "ingest.h"
 #include "uuid.h"
 #include "thumbnail.h"
+#include "media_probe.h"
+#include "media_place.h"
+#include "media_blob.h"
+#include "transcode.h"
+#include "thumb_pack.h"
 #include "logger.h"
 #include "config.h"
 
+// 매니페스트 한 줄을 탭으로 분리 (빈 필드 허용, 개행 제거)
+static int split_manifest_line(char *line, char *fields[], int max_fields) {
+    line[strcspn(line, "\r\n")] = '\0';
+    
+    int n = 0;
+    char *p = line;
+    while (n < max_fields) {
+        fields[n++] = p;
+        char *tab = strchr(p, '\t');
+        if (tab == NULL) {
+            break;
+        }
+        *tab = '\0';
+        p = tab + 1;
+    }
+    return n;
+}
+
+// 컨테이너를 한 번 열어 길이/비트레이트/해상도/코덱/MIME을 얻는다 (실패하면 알 수 없는 값으로 둔다)
+// duration_hint가 양수면 길이는 그 값을 쓴다
+static void probe_video(const char *path, int64_t file_size, int duration_hint, media_info_t *info) {
+    if (media_probe(path, info) < 0) {
+        memset(info, 0, sizeof(*info));
+    }
+    if (duration_hint > 0) {
+        info->duration_sec = duration_hint;
+    }
+    if (info->bitrate_kbps <= 0 && info->duration_sec > 0) {
+        info->bitrate_kbps = (int)(file_size * 8 / info->duration_sec / 1000);
+    }
+}
+
+// 빈 문자열은 NULL로 저장 (알 수 없음)
+static const char* or_null(const char *s) {
+    return (s != NULL && s[0] != '\0') ? s : NULL;
+}
+
+// Ctrl+C: 새 파일 투입만 멈추고 이미 들어간 파일은 끝까지 처리해 커밋한다
+// (다시 실행하면 커밋된 파일은 건너뛰고 이어서 등록)
+static volatile sig_atomic_t stop_requested = 0;
+
+static void handle_sigint(int sig) {
+    (void)sig;
+    stop_requested = 1;
+}
+
+static void print_progress(const ingest_report_t *report, void *ctx) {
+    (void)ctx;
+    printf("   %ld/%ld개 등록 (실패 %ld)...\n", report->completed, report->submitted, report->failed);
+    fflush(stdout);
+}
+
+static void print_report(const ingest_report_t *r, const ingest_options_t *options) {
+    double elapsed = r->elapsed_sec > 0 ? r->elapsed_sec : 1e-9;
+    printf("\n%s 일괄 등록 %s: 완료 %ld, 건너뜀 %ld, 실패 %ld (%.2f초)\n",
+           r->failed == 0 && !stop_requested ? "✅" : "⚠️ ", stop_requested ? "중단" : "종료",
+           r->completed, r->skipped, r->failed, r->elapsed_sec);
+    printf("   처리량: %.1f개/초, %.1f MB/초\n", r->completed / elapsed, r->bytes / elapsed / (1024.0 * 1024.0));
+    if (options->copy) {
+        printf("   배치:");
+        for (int m = 0; m < MEDIA_PLACE_METHOD_COUNT; m++) {
+            if (r->placed[m] > 0) {
+                printf(" %s %ld", media_place_method_name(m), r->placed[m]);
+            }
+        }
+        printf(" (실제 복사 %.1f MB)\n", r->copied_bytes / (1024.0 * 1024.0));
+        if (r->deduped > 0) {
+            printf("   중복: %ld개는 저장소의 같은 파일을 가리킴 (%.1f MB 절약)\n", r->deduped,
+                   r->deduped_bytes / (1024.0 * 1024.0));
+        }
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int stage = 0; stage < INGEST_STAGE_COUNT; stage++) {
+        if ((stage == INGEST_STAGE_COPY && !options->copy) ||
+            (stage == INGEST_STAGE_THUMBNAIL && !options->thumbnails)) {
+            continue;
+        }
+        int workers = (stage == INGEST_STAGE_DB) ? 1 : options->workers[stage];
+        if (workers <= 0) {
+            workers = cpus > 0 ? (int)cpus : 1;
+        }
+        // 가동률이 100%에 가까운 단계가 병목 (워커를 늘릴 곳)
+        printf("   %-6s 워커 %2d개, 가동률 %5.1f%%\n", ingest_stage_name(stage), workers,
+               100.0 * r->busy_sec[stage] / (workers * elapsed));
+    }
+}
+
+// 매니페스트 일괄 등록
+// 형식 (탭 구분, #으로 시작하는 줄은 주석):
+//   video_path  title  description  [duration_sec]  [thumbnail_path]
+// 파일은 이미 미디어 디렉토리에 있다고 보고 경로 그대로 등록한다 (복사 없음).
+// 형식이 잘못된 줄은 건너뛰고 계속한다.
+static void add_from_manifest(ingest_t *ingest, const char *manifest_path, int *errors) {
+    FILE *fp = fopen(manifest_path, "r");
+    if (fp == NULL) {
+        fprintf(stderr, "❌ 매니페스트를 열 수 없습니다: %s\n", manifest_path);
+        (*errors)++;
+        return;
+    }
+
+    int line_no = 0;
+    char line[4096];
+    while (!stop_requested && fgets(line, sizeof(line), fp) != NULL) {
+        line_no++;
+        if (line[0] == '#' || line[0] == '\n' || line[0] == '\r') {
+            continue;
+        }
+
+        char *fields[5] = {NULL};
+        int nfields = split_manifest_line(line, fields, 5);
+        if (nfields < 3 || fields[0][0] == '\0' || fields[1][0] == '\0') {
+            fprintf(stderr, "❌ %d번째 줄: 형식 오류 (경로, 제목, 설명이 필요합니다)\n", line_no);
+            (*errors)++;
+            continue;
+        }
+        ingest_add(ingest, fields[0], fields[1], fields[2], (nfields > 3) ? atoi(fields[3]) : 0,
+                   (nfields > 4) ? fields[4] : NULL);
+    }
+    fclose(fp);
+}
+
+// 디렉토리 일괄 등록: 하위 디렉토리까지 동영상 확장자 파일을 찾아 파일 이름을 제목으로 등록한다
+static const char *const video_extensions[] = { "mp4", "m4v", "mkv", "mov", "webm", "avi", "ts" };
+
+static ingest_t *walk_ingest;
+
+static int visit_file(const char *path, const struct stat *st, int type, struct FTW *ftw) {
+    (void)st;
+    (void)ftw;
+    if (stop_requested) {
+        return 1;
+    }
+    if (type != FTW_F) {
+        return 0;
+    }
+
+    const char *name = strrchr(path, '/');
+    name = (name != NULL) ? name + 1 : path;
+    const char *dot = strrchr(name, '.');
+    if (dot == NULL || dot == name) {
+        return 0;
+    }
+    for (size_t i = 0; i < sizeof(video_extensions) / sizeof(video_extensions[0]); i++) {
+        if (strcasecmp(dot + 1, video_extensions[i]) == 0) {
+            char title[256];
+            snprintf(title, sizeof(title), "%.*s", (int)(dot - name), name);
+            ingest_add(walk_ingest, path, title, "", 0, NULL);
+            break;
+        }
+    }
+    return 0;
+}
+
+static void add_from_directory(ingest_t *ingest, const char *dir, int *errors) {
+    walk_ingest = ingest;
+    if (nftw(dir, visit_file, 32, FTW_PHYS) < 0) {
+        fprintf(stderr, "❌ 디렉토리를 읽을 수 없습니다: %s\n", dir);
+        (*errors)++;
+    }
+}
+
+static int parse_workers(const char *value, int *out) {
+    char *end;
+    long n = strtol(value, &end, 10);
+    if (*end != '\0' || n < 0 || n > 256) {
+        return -1;
+    }
+    *out = (int)n;
+    return 0;
+}
+
+// --manifest / --dir 모드 (옵션 순서 무관)
+static int run_batch(int argc, char *argv[]) {
+    ingest_options_t options;
+    ingest_options_default(&options);
+    options.progress = print_progress;
+
+    const char *manifest = NULL;
+    const char *dir = NULL;
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+        int rc = 0;
+        if (strcmp(arg, "--no-thumbnails") == 0) {
+            options.thumbnails = false;
+            continue;
+        } else if (strcmp(arg, "--move") == 0) {
+            options.move = true;
+            continue;
+        }
+        if (value == NULL) {
+            rc = -1;
+        } else if (strcmp(arg, "--manifest") == 0) {
+            manifest = value;
+        } else if (strcmp(arg, "--dir") == 0) {
+            dir = value;
+        } else if (strcmp(arg, "--probe-workers") == 0) {
+            rc = parse_workers(value, &options.workers[INGEST_STAGE_PROBE]);
+        } else if (strcmp(arg, "--copy-workers") == 0) {
+            rc = parse_workers(value, &options.workers[INGEST_STAGE_COPY]);
+        } else if (strcmp(arg, "--thumb-workers") == 0) {
+            rc = parse_workers(value, &options.workers[INGEST_STAGE_THUMBNAIL]);
+        } else {
+            rc = -1;
+        }
+        if (rc < 0) {
+            fprintf(stderr, "❌ 잘못된 옵션: %s\n", arg);
+            return 1;
+        }
+        i++;
+    }
+    if ((manifest == NULL) == (dir == NULL)) {
+        fprintf(stderr, "❌ --manifest와 --dir 중 하나를 지정해야 합니다\n");
+        return 1;
+    }
+    // 매니페스트의 파일은 이미 미디어 디렉토리에 있으므로 경로 그대로 등록한다
+    options.copy = (dir != NULL);
+
+    logger_init(LOG_WARN);
+    if (db_init(DB_PATH) < 0) {
+        fprintf(stderr, "❌ 데이터베이스 초기화 실패\n");
+        return 1;
+    }
+    ingest_t *ingest = ingest_start(&options);
+    if (ingest == NULL) {
+        fprintf(stderr, "❌ 등록 파이프라인 시작 실패\n");
+        db_close();
+        return 1;
+    }
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler = handle_sigint;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGINT, &sa, NULL);
+
+    int errors = 0;
+    if (manifest != NULL) {
+        add_from_manifest(ingest, manifest, &errors);
+    } else {
+        add_from_directory(ingest, dir, &errors);
+    }
+    if (stop_requested) {
+        printf("\n⏹️  중단 요청: 진행 중인 파일만 마저 등록합니다...\n");
+    }
+
+    ingest_report_t report;
+    int rc = ingest_finish(ingest, &report);
+    print_report(&report, &options);
+    db_close();
+    return (rc == 0 && errors == 0 && !stop_requested) ? 0 : 1;
+}
+
+// --pack-thumbnails: 개별 파일로 남아 있는 썸네일을 팩으로 옮긴다
+static int run_pack_thumbnails(void) {
+    logger_init(LOG_WARN);
+    if (db_init(DB_PATH) < 0) {
+        fprintf(stderr, "❌ 데이터베이스 초기화 실패\n");
+        return 1;
+    }
+    int moved = thumb_pack_import_files();
+    thumb_pack_stop();
+    db_close();
+    if (moved < 0) {
+        fprintf(stderr, "❌ 썸네일을 팩으로 옮기지 못했습니다\n");
+        return 1;
+    }
+    printf("✅ 썸네일 %d개를 팩으로 옮겼습니다\n", moved);
+    return 0;
+}
+
+static void print_usage(const char *prog) {
+    fprintf(stderr, "사용법: %s <video_path> <title> <description> [duration_sec]\n", prog);
+    fprintf(stderr, "        %s --manifest <manifest.tsv> [옵션]\n", prog);
+    fprintf(stderr, "        %s --dir <directory> [옵션]\n", prog);
+    fprintf(stderr, "        %s --pack-thumbnails (개별 파일 썸네일을 팩으로 옮김)\n", prog);
+    fprintf(stderr, "옵션: --probe-workers N  --copy-workers N  --thumb-workers N (0: CPU 수)  --no-thumbnails\n");
+    fprintf(stderr, "      --move (--dir: 같은 볼륨이면 원본을 미디어 디렉토리로 옮김)\n");
+}
+
 int main(int argc, char *argv[]) {
+    if (argc == 2 && strcmp(argv[1], "--pack-thumbnails") == 0) {
+        return run_pack_thumbnails();
+    }
+    if (argc > 1 && strncmp(argv[1], "--", 2) == 0) {
+        return run_batch(argc, argv);
+    }
+    
     if (argc < 4) {
-        fprintf(stderr, "사용법: %s <video_path> <title> <description> [duration_sec]\n", argv[0]);
+        print_usage(argv[0]);
         return 1;
     }
     
@@ -35,17 +337,14 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
-    // Duration 가져오기 (제공되지 않은 경우)
-    if (duration_sec == 0) {
-        double duration_double;
-        if (thumbnail_get_duration(source_path, &duration_double) == 0) {
-            duration_sec = (int)duration_double;
-        }
-    }
+    // 메타데이터 읽기 (길이는 인자로 주어지면 그 값 사용)
+    media_info_t info;
+    probe_video(source_path, st.st_size, duration_sec, &info);
+    duration_sec = (int)info.duration_sec;
     
     // 비디오 생성
     ott_uuid_t video_id;
-    if (db_create_video(title, description, duration_sec, video_id) < 0) {
+    if (db_create_video(title, description, duration_sec, or_null(info.mime_type), video_id) < 0) {
         fprintf(stderr, "❌ 비디오 생성 실패\n");
         db_close();
         return 1;
@@ -53,27 +352,29 @@ int main(int argc, char *argv[]) {
     
     printf("✅ 비디오 생성 완료: %s\n", video_id);
     
-    // 비디오 파일 복사
-    char video_filename[128];
-    snprintf(video_filename, sizeof(video_filename), "%s.mp4", video_id);
-    
+    // 내용 해시로 저장소 경로를 정한다 (같은 마스터가 이미 있으면 그 파일을 가리킨다)
+    char content_hash[MEDIA_HASH_HEX_LEN];
     char dest_path[1024];
-    snprintf(dest_path, sizeof(dest_path), "../media/videos/%s", video_filename);
-    
-    // 파일 복사 (간단한 cp 명령 사용)
-    char copy_cmd[2048];
-    snprintf(copy_cmd, sizeof(copy_cmd), "cp \"%s\" \"%s\"", source_path, dest_path);
-    if (system(copy_cmd) != 0) {
+    media_place_method_t method;
+    bool deduped;
+    if (media_hash_file(source_path, content_hash, NULL) < 0 ||
+        media_blob_store(source_path, content_hash, st.st_size, false, dest_path, sizeof(dest_path),
+                         &deduped, &method, NULL) < 0) {
         fprintf(stderr, "❌ 파일 복사 실패\n");
         db_close();
         return 1;
     }
     
-    printf("✅ 파일 복사 완료: %s\n", dest_path);
+    if (deduped) {
+        printf("✅ 같은 내용의 파일이 이미 있어 재사용: %s\n", dest_path);
+    } else {
+        printf("✅ 파일 배치 완료 (%s): %s\n", media_place_method_name(method), dest_path);
+    }
     
     // 비디오 파일 정보 DB에 추가
     ott_uuid_t file_id;
-    if (db_create_video_file(video_id, dest_path, st.st_size, 2000, "1920x1080", file_id) < 0) {
+    if (db_create_video_file(video_id, dest_path, st.st_size, info.bitrate_kbps, or_null(info.resolution),
+                             or_null(info.video_codec), or_null(info.audio_codec), content_hash, file_id) < 0) {
         fprintf(stderr, "❌ 비디오 파일 정보 저장 실패\n");
         db_close();
         return 1;
@@ -81,6 +382,14 @@ int main(int argc, char *argv[]) {
     
     printf("✅ 비디오 파일 정보 저장 완료\n");
     
+    // 낮은 비트레이트 단계 예약 (서버가 백그라운드에서 인코딩)
+    int rungs = transcode_enqueue(video_id, info.height);
+    if (rungs > 0) {
+        printf("✅ 트랜스코딩 %d단계 예약 (서버가 백그라운드에서 처리)\n", rungs);
+    } else if (rungs < 0) {
+        fprintf(stderr, "⚠️  트랜스코딩 예약 실패 (계속 진행)\n");
+    }
+    
     // 썸네일 자동 생성
     printf("🖼️  썸네일 생성 중...\n");
     if (thumbnail_generate_and_save(video_id, dest_path) == 0) {
@@ -89,11 +398,22 @@ int main(int argc, char *argv[]) {
         fprintf(stderr, "⚠️  썸네일 생성 실패 (계속 진행)\n");
     }
     
+    printf("🎞️  탐색 미리보기 생성 중...\n");
+    if (thumbnail_trickplay_and_save(video_id, dest_path) == 0) {
+        printf("✅ 탐색 미리보기 생성 완료\n");
+    } else {
+        fprintf(stderr, "⚠️  탐색 미리보기 생성 실패 (계속 진행)\n");
+    }
+    
     // 완료
     printf("\n✅ 비디오 추가 완료!\n");
     printf("   ID: %s\n", video_id);
     printf("   제목: %s\n", title);
     printf("   길이: %d초\n", duration_sec);
+    if (info.resolution[0] != '\0') {
+        printf("   형식: %s, %s/%s, %d kbps\n", info.resolution, info.video_codec,
+               info.audio_codec[0] != '\0' ? info.audio_codec : "-", info.bitrate_kbps);
+    }
     
     db_close();
     return 0;
@@ -0,0 +1,888 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "catalog.h"
+#include "db.h"
+#include "config.h"
+#include "logger.h"
+
+#define CATALOG_NOT_FOUND UINT32_MAX
+
+// 게시된 스냅샷과 읽기 카운터
+// 읽기 스레드는 현재 epoch 슬롯의 카운터만 올리고 내린다.
+// 게시자는 포인터를 바꾼 뒤 epoch를 뒤집고, 이전 슬롯이 0이 될 때까지 기다린 후 해제한다.
+static _Atomic(catalog_snapshot_t *) current_snapshot = NULL;
+static atomic_uint reader_epoch = 0;
+static atomic_long reader_counts[2];
+static pthread_mutex_t publish_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+// 스냅샷 빌드 중 임시 데이터
+typedef struct {
+    catalog_file_t file;
+    ott_uuid_t video_id;
+} pending_file_t;
+
+typedef struct {
+    catalog_thumbnail_t thumbnail;
+    ott_uuid_t video_id;
+} pending_thumbnail_t;
+
+typedef struct {
+    catalog_video_t *videos;
+    size_t video_count, video_cap;
+    pending_file_t *files;
+    size_t file_count, file_cap;
+    pending_thumbnail_t *thumbnails;
+    size_t thumbnail_count, thumbnail_cap;
+    char *strings;
+    size_t strings_size, strings_cap;
+    bool failed;
+} catalog_builder_t;
+
+// FNV-1a
+static uint32_t catalog_hash(const char *s) {
+    uint32_t h = 2166136261u;
+    while (*s) {
+        h ^= (unsigned char)*s++;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static bool catalog_grow(void **items, size_t *cap, size_t need, size_t item_size) {
+    if (need <= *cap) {
+        return true;
+    }
+    size_t new_cap = *cap ? *cap * 2 : 64;
+    while (new_cap < need) {
+        new_cap *= 2;
+    }
+    void *p = realloc(*items, new_cap * item_size);
+    if (p == NULL) {
+        return false;
+    }
+    *items = p;
+    *cap = new_cap;
+    return true;
+}
+
+static catalog_str_t catalog_intern_len(catalog_builder_t *b, const char *s, size_t len) {
+    catalog_str_t str = {0, 0};
+
+    if (b->strings_size + len + 1 > UINT32_MAX ||
+        !catalog_grow((void**)&b->strings, &b->strings_cap, b->strings_size + len + 1, 1)) {
+        b->failed = true;
+        return str;
+    }
+
+    str.offset = (uint32_t)b->strings_size;
+    str.length = (uint32_t)len;
+    memcpy(b->strings + b->strings_size, s, len);
+    b->strings[b->strings_size + len] = '\0';
+    b->strings_size += len + 1;
+    return str;
+}
+
+static catalog_str_t catalog_intern(catalog_builder_t *b, const char *s) {
+    return catalog_intern_len(b, s, strlen(s));
+}
+
+static int catalog_visit_video(void *ctx, const db_catalog_video_t *video) {
+    catalog_builder_t *b = ctx;
+    if (!catalog_grow((void**)&b->videos, &b->video_cap, b->video_count + 1, sizeof(catalog_video_t))) {
+        b->failed = true;
+        return -1;
+    }
+
+    catalog_video_t *cv = &b->videos[b->video_count++];
+    memset(cv, 0, sizeof(*cv));
+    cv->id = catalog_intern(b, video->id);
+    cv->title = catalog_intern_len(b, video->title, video->title_len);
+    cv->description = catalog_intern_len(b, video->description, video->description_len);
+    cv->mime = mime_intern(video->mime_type);
+    cv->duration_sec = video->duration_sec;
+    cv->created_at = video->created_at;
+    return b->failed ? -1 : 0;
+}
+
+static int catalog_visit_file(void *ctx, const video_file_t *file) {
+    catalog_builder_t *b = ctx;
+    if (!catalog_grow((void**)&b->files, &b->file_cap, b->file_count + 1, sizeof(pending_file_t))) {
+        b->failed = true;
+        return -1;
+    }
+
+    pending_file_t *pf = &b->files[b->file_count++];
+    memcpy(pf->video_id, file->video_id, sizeof(pf->video_id));
+    pf->file.id = catalog_intern(b, file->id);
+    pf->file.file_path = catalog_intern(b, file->file_path);
+    pf->file.resolution = catalog_intern(b, file->resolution);
+    pf->file.content_hash = catalog_intern(b, file->content_hash);
+    pf->file.file_size = file->file_size;
+    pf->file.bitrate_kbps = file->bitrate_kbps;
+    return b->failed ? -1 : 0;
+}
+
+static int catalog_visit_thumbnail(void *ctx, const thumbnail_t *thumbnail) {
+    catalog_builder_t *b = ctx;
+    if (!catalog_grow((void**)&b->thumbnails, &b->thumbnail_cap, b->thumbnail_count + 1,
+                      sizeof(pending_thumbnail_t))) {
+        b->failed = true;
+        return -1;
+    }
+
+    pending_thumbnail_t *pt = &b->thumbnails[b->thumbnail_count++];
+    memcpy(pt->video_id, thumbnail->video_id, sizeof(pt->video_id));
+    pt->thumbnail.id = catalog_intern(b, thumbnail->id);
+    pt->thumbnail.file_path = catalog_intern(b, thumbnail->file_path);
+    pt->thumbnail.width = thumbnail->width;
+    pt->thumbnail.height = thumbnail->height;
+    pt->thumbnail.mime = mime_intern(thumbnail->mime_type);
+    pt->thumbnail.pack = thumbnail->pack;
+    return b->failed ? -1 : 0;
+}
+
+static void catalog_builder_free(catalog_builder_t *b) {
+    free(b->videos);
+    free(b->files);
+    free(b->thumbnails);
+    free(b->strings);
+}
+
+static uint32_t catalog_lookup(const catalog_snapshot_t *snap, const char *video_id) {
+    if (snap->index_size == 0) {
+        return CATALOG_NOT_FOUND;
+    }
+
+    // 빈 슬롯이 반드시 있지만 (catalog_file_valid) 탐사는 index_size번을 넘지 않는다
+    uint32_t mask = snap->index_size - 1;
+    uint32_t pos = catalog_hash(video_id) & mask;
+    for (uint32_t step = 0; step < snap->index_size; step++, pos = (pos + 1) & mask) {
+        uint32_t slot = snap->index[pos];
+        if (slot == 0) {
+            return CATALOG_NOT_FOUND;
+        }
+        const catalog_video_t *cv = &snap->videos[slot - 1];
+        if (strcmp(catalog_str(snap, cv->id), video_id) == 0) {
+            return slot - 1;
+        }
+    }
+    return CATALOG_NOT_FOUND;
+}
+
+static size_t catalog_align(size_t n) {
+    return (n + 7) & ~(size_t)7;
+}
+
+// 빌더 내용을 단일 블록 스냅샷으로 변환
+// 배치: [헤더][videos][files][thumbnails][index][strings]
+static catalog_snapshot_t* catalog_build(catalog_builder_t *b, int64_t generation, int64_t instance) {
+    uint32_t index_size = 16;
+    while (index_size < b->video_count * 2) {
+        index_size <<= 1;
+    }
+
+    size_t videos_off = catalog_align(sizeof(catalog_snapshot_t));
+    size_t files_off = videos_off + catalog_align(b->video_count * sizeof(catalog_video_t));
+    size_t thumbs_off = files_off + catalog_align(b->file_count * sizeof(catalog_file_t));
+    size_t index_off = thumbs_off + catalog_align(b->thumbnail_count * sizeof(catalog_thumbnail_t));
+    size_t strings_off = index_off + catalog_align(index_size * sizeof(uint32_t));
+    size_t total_size = strings_off + b->strings_size;
+
+    char *block = calloc(1, total_size);
+    uint32_t *file_owner = malloc((b->file_count + b->thumbnail_count + 1) * sizeof(uint32_t));
+    if (block == NULL || file_owner == NULL) {
+        log_error("카탈로그 스냅샷 메모리 할당 실패 (%zu bytes)", total_size);
+        free(block);
+        free(file_owner);
+        return NULL;
+    }
+    uint32_t *thumb_owner = file_owner + b->file_count;
+
+    catalog_snapshot_t *snap = (catalog_snapshot_t*)block;
+    catalog_video_t *videos = (catalog_video_t*)(block + videos_off);
+    catalog_file_t *files = (catalog_file_t*)(block + files_off);
+    catalog_thumbnail_t *thumbnails = (catalog_thumbnail_t*)(block + thumbs_off);
+    uint32_t *index = (uint32_t*)(block + index_off);
+    char *strings = block + strings_off;
+
+    snap->generation = generation;
+    snap->instance = instance;
+    snap->video_count = (uint32_t)b->video_count;
+    snap->index_size = index_size;
+    snap->strings_size = (uint32_t)b->strings_size;
+    snap->videos = videos;
+    snap->files = files;
+    snap->thumbnails = thumbnails;
+    snap->index = index;
+    snap->strings = strings;
+
+    if (b->strings_size > 0) {
+        memcpy(strings, b->strings, b->strings_size);
+    }
+    if (b->video_count > 0) {
+        memcpy(videos, b->videos, b->video_count * sizeof(catalog_video_t));
+    }
+
+    // ID 인덱스 (선형 탐사)
+    uint32_t mask = index_size - 1;
+    for (uint32_t i = 0; i < snap->video_count; i++) {
+        uint32_t pos = catalog_hash(catalog_str(snap, videos[i].id)) & mask;
+        while (index[pos] != 0) {
+            pos = (pos + 1) & mask;
+        }
+        index[pos] = i + 1;
+    }
+
+    // 파일/썸네일을 동영상별로 연속 배치 (계수 정렬, 동영상 내 순서는 rowid 순 유지)
+    for (size_t i = 0; i < b->file_count; i++) {
+        file_owner[i] = catalog_lookup(snap, b->files[i].video_id);
+        if (file_owner[i] != CATALOG_NOT_FOUND) {
+            videos[file_owner[i]].file_count++;
+        }
+    }
+    for (size_t i = 0; i < b->thumbnail_count; i++) {
+        thumb_owner[i] = catalog_lookup(snap, b->thumbnails[i].video_id);
+        if (thumb_owner[i] != CATALOG_NOT_FOUND) {
+            videos[thumb_owner[i]].thumbnail_count++;
+        }
+    }
+
+    uint32_t next_file = 0, next_thumb = 0;
+    for (uint32_t i = 0; i < snap->video_count; i++) {
+        videos[i].first_file = next_file;
+        videos[i].first_thumbnail = next_thumb;
+        next_file += videos[i].file_count;
+        next_thumb += videos[i].thumbnail_count;
+        videos[i].file_count = 0;
+        videos[i].thumbnail_count = 0;
+    }
+    snap->file_count = next_file;
+    snap->thumbnail_count = next_thumb;
+
+    for (size_t i = 0; i < b->file_count; i++) {
+        if (file_owner[i] == CATALOG_NOT_FOUND) continue;
+        catalog_video_t *cv = &videos[file_owner[i]];
+        files[cv->first_file + cv->file_count++] = b->files[i].file;
+    }
+    for (size_t i = 0; i < b->thumbnail_count; i++) {
+        if (thumb_owner[i] == CATALOG_NOT_FOUND) continue;
+        catalog_video_t *cv = &videos[thumb_owner[i]];
+        thumbnails[cv->first_thumbnail + cv->thumbnail_count++] = b->thumbnails[i].thumbnail;
+    }
+
+    free(file_owner);
+    return snap;
+}
+
+static catalog_snapshot_t* catalog_load(void) {
+    catalog_builder_t builder;
+    memset(&builder, 0, sizeof(builder));
+
+    db_catalog_visitor_t visitor = {
+        .video = catalog_visit_video,
+        .file = catalog_visit_file,
+        .thumbnail = catalog_visit_thumbnail,
+        .ctx = &builder
+    };
+
+    int64_t generation = 0;
+    int64_t instance = 0;
+    catalog_snapshot_t *snap = NULL;
+    db_get_catalog_instance(&instance);
+    if (db_scan_catalog(&visitor, &generation) == 0 && !builder.failed) {
+        snap = catalog_build(&builder, generation, instance);
+    } else {
+        log_error("카탈로그 적재 실패");
+    }
+
+    catalog_builder_free(&builder);
+    return snap;
+}
+
+static void catalog_free_snapshot(catalog_snapshot_t *snap) {
+    if (snap->mapping != NULL) {
+        munmap(snap->mapping, snap->mapping_size);
+    }
+    free(snap);
+}
+
+// 스냅샷 파일 형식
+// [헤더][videos][files][thumbnails][index][strings], 각 구간은 8바이트 정렬.
+// 구조체를 그대로 기록하므로 구조체 크기가 다른 빌드의 파일은 버전 불일치로 거부한다.
+#define CATALOG_FILE_MAGIC "OTTCATS\0"
+#define CATALOG_FILE_VERSION 4
+#define CATALOG_FILE_MIME_LEN 64
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t video_size;            // sizeof(catalog_video_t)
+    uint32_t file_size;             // sizeof(catalog_file_t)
+    uint32_t thumbnail_size;        // sizeof(catalog_thumbnail_t)
+    uint32_t mime_count;
+    int64_t generation;
+    int64_t instance;
+    uint32_t video_count;
+    uint32_t file_count;
+    uint32_t thumbnail_count;
+    uint32_t index_size;
+    uint32_t strings_size;
+    uint32_t reserved;
+    uint64_t videos_off;
+    uint64_t files_off;
+    uint64_t thumbnails_off;
+    uint64_t index_off;
+    uint64_t strings_off;
+    uint64_t total_size;
+    uint64_t checksum;              // videos_off부터 파일 끝까지
+    char mime_names[MIME_MAX_TYPES][CATALOG_FILE_MIME_LEN];  // 기록 당시의 MIME ID → 이름
+} catalog_file_header_t;
+
+static int64_t catalog_saved_generation = -1;
+static int64_t catalog_saved_instance = -1;
+
+// 8바이트 단위 FNV-1a 변형 (구간 길이는 마지막 구간을 제외하고 8의 배수)
+static uint64_t catalog_checksum_update(uint64_t h, const void *data, size_t len) {
+    const unsigned char *p = data;
+    size_t words = len / 8;
+    for (size_t i = 0; i < words; i++) {
+        uint64_t w;
+        memcpy(&w, p + i * 8, 8);
+        h = (h ^ w) * 1099511628211ull;
+    }
+    for (size_t i = words * 8; i < len; i++) {
+        h = (h ^ p[i]) * 1099511628211ull;
+    }
+    return h;
+}
+
+static void catalog_file_layout(const catalog_snapshot_t *snap, catalog_file_header_t *hdr) {
+    memset(hdr, 0, sizeof(*hdr));
+    memcpy(hdr->magic, CATALOG_FILE_MAGIC, sizeof(hdr->magic));
+    hdr->version = CATALOG_FILE_VERSION;
+    hdr->header_size = sizeof(catalog_file_header_t);
+    hdr->video_size = sizeof(catalog_video_t);
+    hdr->file_size = sizeof(catalog_file_t);
+    hdr->thumbnail_size = sizeof(catalog_thumbnail_t);
+    hdr->mime_count = MIME_MAX_TYPES;
+    hdr->generation = snap->generation;
+    hdr->instance = snap->instance;
+    hdr->video_count = snap->video_count;
+    hdr->file_count = snap->file_count;
+    hdr->thumbnail_count = snap->thumbnail_count;
+    hdr->index_size = snap->index_size;
+    hdr->strings_size = snap->strings_size;
+
+    hdr->videos_off = catalog_align(sizeof(catalog_file_header_t));
+    hdr->files_off = hdr->videos_off + catalog_align(snap->video_count * sizeof(catalog_video_t));
+    hdr->thumbnails_off = hdr->files_off + catalog_align(snap->file_count * sizeof(catalog_file_t));
+    hdr->index_off = hdr->thumbnails_off + catalog_align(snap->thumbnail_count * sizeof(catalog_thumbnail_t));
+    hdr->strings_off = hdr->index_off + catalog_align(snap->index_size * sizeof(uint32_t));
+    hdr->total_size = hdr->strings_off + snap->strings_size;
+
+    for (int i = 0; i < MIME_MAX_TYPES; i++) {
+        snprintf(hdr->mime_names[i], CATALOG_FILE_MIME_LEN, "%s", mime_name((mime_id_t)i));
+    }
+}
+
+// 구간을 0으로 패딩해 기록하고 체크섬에 반영
+static int catalog_write_section(FILE *fp, const void *data, size_t len, bool pad, uint64_t *checksum) {
+    static const char zeros[8] = {0};
+    size_t padded = pad ? catalog_align(len) : len;
+
+    if (len > 0 && fwrite(data, 1, len, fp) != len) {
+        return -1;
+    }
+    if (padded > len && fwrite(zeros, 1, padded - len, fp) != padded - len) {
+        return -1;
+    }
+
+    *checksum = catalog_checksum_update(*checksum, data, len);
+    if (padded > len) {
+        *checksum = catalog_checksum_update(*checksum, zeros, padded - len);
+    }
+    return 0;
+}
+
+static int catalog_write_file(const catalog_snapshot_t *snap, const char *path) {
+    char tmp_path[MAX_PATH_LEN];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    FILE *fp = fopen(tmp_path, "wb");
+    if (fp == NULL) {
+        log_error("카탈로그 스냅샷 파일 생성 실패: %s", tmp_path);
+        return -1;
+    }
+
+    catalog_file_header_t hdr;
+    catalog_file_layout(snap, &hdr);
+
+    // 헤더 자리를 먼저 비워 두고 본문을 쓰면서 체크섬을 계산한 뒤 헤더를 기록한다
+    uint64_t checksum = 14695981039346656037ull;
+    int rc = fseek(fp, (long)hdr.videos_off, SEEK_SET);
+    if (rc == 0) rc = catalog_write_section(fp, snap->videos, snap->video_count * sizeof(catalog_video_t), true, &checksum);
+    if (rc == 0) rc = catalog_write_section(fp, snap->files, snap->file_count * sizeof(catalog_file_t), true, &checksum);
+    if (rc == 0) rc = catalog_write_section(fp, snap->thumbnails, snap->thumbnail_count * sizeof(catalog_thumbnail_t), true, &checksum);
+    if (rc == 0) rc = catalog_write_section(fp, snap->index, snap->index_size * sizeof(uint32_t), true, &checksum);
+    if (rc == 0) rc = catalog_write_section(fp, snap->strings, snap->strings_size, false, &checksum);
+
+    hdr.checksum = checksum;
+    if (rc == 0) rc = fseek(fp, 0, SEEK_SET);
+    if (rc == 0 && fwrite(&hdr, sizeof(hdr), 1, fp) != 1) rc = -1;
+    if (rc == 0) rc = fflush(fp);
+    if (rc == 0) rc = fsync(fileno(fp));
+
+    if (fclose(fp) != 0 || rc != 0) {
+        log_error("카탈로그 스냅샷 파일 기록 실패: %s", tmp_path);
+        unlink(tmp_path);
+        return -1;
+    }
+
+    if (rename(tmp_path, path) != 0) {
+        log_error("카탈로그 스냅샷 파일 교체 실패: %s", path);
+        unlink(tmp_path);
+        return -1;
+    }
+
+    return 0;
+}
+
+static bool catalog_str_valid(const catalog_file_header_t *hdr, catalog_str_t str) {
+    return (uint64_t)str.offset + str.length < hdr->strings_size;
+}
+
+// 매핑된 파일의 구조 검증 (체크섬 통과 후 범위만 확인)
+static bool catalog_file_valid(const catalog_file_header_t *hdr, const catalog_snapshot_t *snap) {
+    if (hdr->strings_size > 0 && snap->strings[hdr->strings_size - 1] != '\0') {
+        return false;
+    }
+    if (hdr->index_size == 0 || (hdr->index_size & (hdr->index_size - 1)) != 0 ||
+        hdr->index_size <= hdr->video_count) {
+        return false;
+    }
+    // 채워진 슬롯이 동영상 수를 넘지 않아야 빈 슬롯이 남아 탐사가 끝난다 (catalog_build는 2배 이상)
+    uint32_t used = 0;
+    for (uint32_t i = 0; i < hdr->index_size; i++) {
+        if (snap->index[i] > hdr->video_count) {
+            return false;
+        }
+        used += (snap->index[i] != 0);
+    }
+    if (used > hdr->video_count) {
+        return false;
+    }
+    for (uint32_t i = 0; i < hdr->video_count; i++) {
+        const catalog_video_t *cv = &snap->videos[i];
+        if (!catalog_str_valid(hdr, cv->id) || !catalog_str_valid(hdr, cv->title) ||
+            !catalog_str_valid(hdr, cv->description) ||
+            (uint64_t)cv->first_file + cv->file_count > hdr->file_count ||
+            (uint64_t)cv->first_thumbnail + cv->thumbnail_count > hdr->thumbnail_count) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < hdr->file_count; i++) {
+        const catalog_file_t *cf = &snap->files[i];
+        if (!catalog_str_valid(hdr, cf->id) || !catalog_str_valid(hdr, cf->file_path) ||
+            !catalog_str_valid(hdr, cf->resolution) || !catalog_str_valid(hdr, cf->content_hash)) {
+            return false;
+        }
+    }
+    for (uint32_t i = 0; i < hdr->thumbnail_count; i++) {
+        const catalog_thumbnail_t *ct = &snap->thumbnails[i];
+        if (!catalog_str_valid(hdr, ct->id) || !catalog_str_valid(hdr, ct->file_path)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static catalog_snapshot_t* catalog_map_file(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(catalog_file_header_t)) {
+        close(fd);
+        return NULL;
+    }
+
+    // MAP_PRIVATE + 쓰기 허용: MIME ID를 재매핑해야 할 때만 해당 페이지가 복사된다
+    size_t size = (size_t)st.st_size;
+    char *base = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        log_warn("카탈로그 스냅샷 파일 매핑 실패: %s", path);
+        return NULL;
+    }
+
+    const catalog_file_header_t *hdr = (const catalog_file_header_t*)base;
+    const char *reason = NULL;
+    if (memcmp(hdr->magic, CATALOG_FILE_MAGIC, sizeof(hdr->magic)) != 0) {
+        reason = "형식이 다름";
+    } else if (hdr->version != CATALOG_FILE_VERSION || hdr->header_size != sizeof(catalog_file_header_t) ||
+               hdr->video_size != sizeof(catalog_video_t) || hdr->file_size != sizeof(catalog_file_t) ||
+               hdr->thumbnail_size != sizeof(catalog_thumbnail_t) || hdr->mime_count != MIME_MAX_TYPES) {
+        reason = "버전 불일치";
+    } else {
+        catalog_file_header_t expect;
+        catalog_snapshot_t shape = {
+            .video_count = hdr->video_count, .file_count = hdr->file_count,
+            .thumbnail_count = hdr->thumbnail_count, .index_size = hdr->index_size,
+            .strings_size = hdr->strings_size
+        };
+        catalog_file_layout(&shape, &expect);
+        if (hdr->total_size != size || hdr->videos_off != expect.videos_off ||
+            hdr->files_off != expect.files_off || hdr->thumbnails_off != expect.thumbnails_off ||
+            hdr->index_off != expect.index_off || hdr->strings_off != expect.strings_off ||
+            hdr->total_size != expect.total_size) {
+            reason = "크기 불일치";
+        } else if (catalog_checksum_update(14695981039346656037ull, base + hdr->videos_off,
+                                           size - hdr->videos_off) != hdr->checksum) {
+            reason = "체크섬 불일치";
+        }
+    }
+
+    catalog_snapshot_t *snap = NULL;
+    if (reason == NULL) {
+        snap = calloc(1, sizeof(catalog_snapshot_t));
+        if (snap == NULL) {
+            munmap(base, size);
+            return NULL;
+        }
+        snap->generation = hdr->generation;
+        snap->instance = hdr->instance;
+        snap->video_count = hdr->video_count;
+        snap->file_count = hdr->file_count;
+        snap->thumbnail_count = hdr->thumbnail_count;
+        snap->index_size = hdr->index_size;
+        snap->strings_size = hdr->strings_size;
+        snap->videos = (const catalog_video_t*)(base + hdr->videos_off);
+        snap->files = (const catalog_file_t*)(base + hdr->files_off);
+        snap->thumbnails = (const catalog_thumbnail_t*)(base + hdr->thumbnails_off);
+        snap->index = (const uint32_t*)(base + hdr->index_off);
+        snap->strings = base + hdr->strings_off;
+        snap->mapping = base;
+        snap->mapping_size = size;
+
+        if (!catalog_file_valid(hdr, snap)) {
+            reason = "구조 오류";
+        }
+    }
+
+    if (reason != NULL) {
+        log_warn("카탈로그 스냅샷 파일을 사용하지 않습니다 (%s): %s", reason, path);
+        free(snap);
+        munmap(base, size);
+        return NULL;
+    }
+
+    // 기록 당시와 현재 프로세스의 MIME ID가 다르면 제자리에서 고친다
+    mime_id_t remap[MIME_MAX_TYPES];
+    bool identity = true;
+    for (int i = 0; i < MIME_MAX_TYPES; i++) {
+        char name[CATALOG_FILE_MIME_LEN];
+        snprintf(name, sizeof(name), "%.*s", CATALOG_FILE_MIME_LEN - 1, hdr->mime_names[i]);
+        remap[i] = mime_intern(name);
+        identity = identity && remap[i] == i;
+    }
+    if (!identity) {
+        catalog_video_t *videos = (catalog_video_t*)(base + hdr->videos_off);
+        for (uint32_t i = 0; i < snap->video_count; i++) {
+            videos[i].mime = (videos[i].mime < MIME_MAX_TYPES) ? remap[videos[i].mime] : 0;
+        }
+        catalog_thumbnail_t *thumbnails = (catalog_thumbnail_t*)(base + hdr->thumbnails_off);
+        for (uint32_t i = 0; i < snap->thumbnail_count; i++) {
+            thumbnails[i].mime = (thumbnails[i].mime < MIME_MAX_TYPES) ? remap[thumbnails[i].mime] : 0;
+        }
+    }
+
+    return snap;
+}
+
+// 이전 epoch 슬롯의 읽기가 모두 끝날 때까지 대기
+// 호출자는 publish_mutex를 잡고 있어야 한다
+static void catalog_synchronize(void) {
+    unsigned int old_slot = atomic_fetch_add(&reader_epoch, 1) & 1;
+    while (atomic_load(&reader_counts[old_slot]) != 0) {
+        sched_yield();
+    }
+}
+
+static void catalog_publish(catalog_snapshot_t *snap) {
+    catalog_snapshot_t *old = atomic_exchange(&current_snapshot, snap);
+    if (old != NULL) {
+        catalog_synchronize();
+        catalog_free_snapshot(old);
+    }
+}
+
+// 시작 시 검증 스레드 (DB를 쓰므로 catalog_shutdown이 db_close 전에 기다린다)
+static pthread_t validate_thread;
+static bool validate_started = false;
+
+// 매핑한 스냅샷이 현재 DB와 같은지 확인하고 다르면 DB에서 다시 적재
+static void* catalog_validate_thread(void *arg) {
+    (void)arg;
+    int64_t generation, instance;
+
+    if (db_get_catalog_generation(&generation) < 0 || db_get_catalog_instance(&instance) < 0) {
+        log_error("카탈로그 스냅샷 검증 실패: DB를 읽을 수 없습니다");
+        return NULL;
+    }
+
+    pthread_mutex_lock(&publish_mutex);
+    catalog_snapshot_t *snap = atomic_load(&current_snapshot);
+    bool stale = (snap == NULL || snap->generation != generation || snap->instance != instance);
+    pthread_mutex_unlock(&publish_mutex);
+
+    if (stale) {
+        log_info("카탈로그 스냅샷 파일이 DB와 다릅니다 (세대 %lld), 다시 적재합니다", (long long)generation);
+        catalog_refresh();
+    } else {
+        log_info("카탈로그 스냅샷 파일 검증 완료 (세대 %lld)", (long long)generation);
+    }
+    return NULL;
+}
+
+int catalog_init(void) {
+    atomic_store(&reader_counts[0], 0);
+    atomic_store(&reader_counts[1], 0);
+
+    catalog_snapshot_t *mapped = catalog_map_file(CATALOG_SNAPSHOT_PATH);
+    if (mapped != NULL) {
+        pthread_mutex_lock(&publish_mutex);
+        catalog_publish(mapped);
+        catalog_saved_generation = mapped->generation;
+        catalog_saved_instance = mapped->instance;
+        pthread_mutex_unlock(&publish_mutex);
+
+        if (pthread_create(&validate_thread, NULL, catalog_validate_thread, NULL) == 0) {
+            validate_started = true;
+        } else {
+            catalog_validate_thread(NULL);
+        }
+    } else if (catalog_refresh() < 0) {
+        return -1;
+    }
+
+    catalog_ref_t ref = catalog_acquire();
+    log_info("카탈로그 적재 완료 (동영상 %u개, 파일 %u개, 썸네일 %u개, 세대 %lld, %s)",
+             ref.snapshot->video_count, ref.snapshot->file_count,
+             ref.snapshot->thumbnail_count, (long long)ref.snapshot->generation,
+             ref.snapshot->mapping != NULL ? "스냅샷 파일" : "DB");
+    catalog_release(&ref);
+    return 0;
+}
+
+void catalog_shutdown(void) {
+    if (validate_started) {
+        pthread_join(validate_thread, NULL);
+        validate_started = false;
+    }
+
+    pthread_mutex_lock(&publish_mutex);
+    catalog_snapshot_t *old = atomic_exchange(&current_snapshot, NULL);
+    if (old != NULL) {
+        catalog_synchronize();
+        catalog_free_snapshot(old);
+    }
+    pthread_mutex_unlock(&publish_mutex);
+}
+
+int catalog_save(const char *path) {
+    // 게시를 막아 두고 현재 스냅샷을 기록한다 (읽기 스레드는 영향 없음)
+    pthread_mutex_lock(&publish_mutex);
+    catalog_snapshot_t *snap = atomic_load(&current_snapshot);
+    int rc = -1;
+    if (snap != NULL) {
+        rc = catalog_write_file(snap, path);
+        if (rc == 0) {
+            catalog_saved_generation = snap->generation;
+            catalog_saved_instance = snap->instance;
+            log_info("카탈로그 스냅샷 저장 완료: %s (세대 %lld)", path, (long long)snap->generation);
+        }
+    }
+    pthread_mutex_unlock(&publish_mutex);
+    return rc;
+}
+
+int catalog_save_if_changed(const char *path) {
+    pthread_mutex_lock(&publish_mutex);
+    catalog_snapshot_t *snap = atomic_load(&current_snapshot);
+    bool changed = (snap != NULL && (snap->generation != catalog_saved_generation ||
+                                     snap->instance != catalog_saved_instance));
+    pthread_mutex_unlock(&publish_mutex);
+
+    if (!changed) {
+        return 0;
+    }
+    return (catalog_save(path) == 0) ? 1 : -1;
+}
+
+int catalog_refresh(void) {
+    pthread_mutex_lock(&publish_mutex);
+
+    catalog_snapshot_t *snap = catalog_load();
+    if (snap == NULL) {
+        pthread_mutex_unlock(&publish_mutex);
+        return -1;
+    }
+    catalog_publish(snap);
+
+    pthread_mutex_unlock(&publish_mutex);
+    return 0;
+}
+
+int catalog_refresh_if_changed(void) {
+    // DB 파일이 바뀌면 세대 번호가 우연히 같아도 instance가 다르다
+    int64_t generation, instance;
+    if (db_get_catalog_generation(&generation) < 0 || db_get_catalog_instance(&instance) < 0) {
+        return -1;
+    }
+
+    // 게시는 publish_mutex 아래에서만 일어나므로 여기서는 직접 읽어도 된다
+    pthread_mutex_lock(&publish_mutex);
+    catalog_snapshot_t *snap = atomic_load(&current_snapshot);
+    bool stale = (snap == NULL || snap->generation != generation || snap->instance != instance);
+    pthread_mutex_unlock(&publish_mutex);
+
+    if (!stale) {
+        return 0;
+    }
+
+    if (catalog_refresh() < 0) {
+        return -1;
+    }
+    log_info("카탈로그 스냅샷 교체 (세대 %lld)", (long long)generation);
+    return 1;
+}
+
+catalog_ref_t catalog_acquire(void) {
+    catalog_ref_t ref;
+
+    // 카운터를 올린 뒤 epoch가 그대로인지 다시 확인한다.
+    // 그 사이 게시자가 epoch를 뒤집었다면 이 슬롯은 이미 대기 대상에서 빠졌을 수 있으므로 재시도한다.
+    for (;;) {
+        ref.slot = atomic_load(&reader_epoch) & 1;
+        atomic_fetch_add(&reader_counts[ref.slot], 1);
+        if ((atomic_load(&reader_epoch) & 1) == ref.slot) {
+            break;
+        }
+        atomic_fetch_sub(&reader_counts[ref.slot], 1);
+    }
+
+    ref.snapshot = atomic_load(&current_snapshot);
+    return ref;
+}
+
+void catalog_release(catalog_ref_t *ref) {
+    if (ref->slot > 1) {
+        return;     // 이미 반환됨
+    }
+    atomic_fetch_sub(&reader_counts[ref->slot], 1);
+    ref->snapshot = NULL;
+    ref->slot = 2;
+}
+
+const catalog_video_t* catalog_find_video(const catalog_snapshot_t *snap, const char *video_id) {
+    if (snap == NULL) {
+        return NULL;
+    }
+    uint32_t idx = catalog_lookup(snap, video_id);
+    return (idx == CATALOG_NOT_FOUND) ? NULL : &snap->videos[idx];
+}
+
+void catalog_copy_file(const catalog_snapshot_t *snap, const catalog_video_t *cv,
+                       const catalog_file_t *cf, video_file_t *file) {
+    snprintf(file->id, sizeof(file->id), "%s", catalog_str(snap, cf->id));
+    snprintf(file->video_id, sizeof(file->video_id), "%s", catalog_str(snap, cv->id));
+    snprintf(file->file_path, sizeof(file->file_path), "%s", catalog_str(snap, cf->file_path));
+    snprintf(file->resolution, sizeof(file->resolution), "%s", catalog_str(snap, cf->resolution));
+    snprintf(file->content_hash, sizeof(file->content_hash), "%s", catalog_str(snap, cf->content_hash));
+    file->file_size = cf->file_size;
+    file->bitrate_kbps = cf->bitrate_kbps;
+    file->created_at = 0;
+}
+
+// 목록 순서(created_at DESC, id DESC)에서 커서 키보다 뒤에 있는지
+static bool catalog_is_after(const catalog_snapshot_t *snap, const catalog_video_t *cv,
+                             int64_t created_at, const char *id) {
+    if (cv->created_at != created_at) {
+        return cv->created_at < created_at;
+    }
+    return strcmp(catalog_str(snap, cv->id), id) < 0;
+}
+
+int catalog_list_videos(const catalog_snapshot_t *snap, const char *cursor, int page_size,
+                        video_page_t *page, int *total, char next_cursor[DB_CURSOR_LEN]) {
+    char after_created_at[32];
+    ott_uuid_t after_id;
+    uint32_t start = 0;
+
+    memset(page, 0, sizeof(*page));
+    *total = (int)snap->video_count;
+    next_cursor[0] = '\0';
+
+    if (cursor != NULL && cursor[0] != '\0') {
+        char *end;
+        if (db_decode_cursor(cursor, after_created_at, sizeof(after_created_at),
+                             after_id, sizeof(after_id)) < 0) {
+            return -2;
+        }
+        int64_t created_at = strtoll(after_created_at, &end, 10);
+        if (*end != '\0') {
+            return -2;
+        }
+
+        // 배열이 이미 목록 순서이므로 커서 위치를 이진 탐색
+        uint32_t lo = 0, hi = snap->video_count;
+        while (lo < hi) {
+            uint32_t mid = lo + (hi - lo) / 2;
+            if (catalog_is_after(snap, &snap->videos[mid], created_at, after_id)) {
+                hi = mid;
+            } else {
+                lo = mid + 1;
+            }
+        }
+        start = lo;
+    }
+
+    if (video_page_init(page, page_size) < 0) {
+        return -1;
+    }
+
+    uint32_t end_idx = start + (uint32_t)page_size;
+    if (end_idx > snap->video_count) {
+        end_idx = snap->video_count;
+    }
+    for (uint32_t i = start; i < end_idx; i++) {
+        const catalog_video_t *cv = &snap->videos[i];
+        if (video_page_add(page, catalog_str(snap, cv->id),
+                           catalog_str(snap, cv->title), cv->title.length,
+                           catalog_str(snap, cv->description), cv->description.length,
+                           cv->mime, cv->duration_sec, cv->created_at) < 0) {
+            return -1;
+        }
+    }
+
+    if (end_idx < snap->video_count && page->count > 0) {
+        const video_record_t *last = &page->items[page->count - 1];
+        char key1[32];
+        snprintf(key1, sizeof(key1), "%lld", (long long)last->created_at);
+        db_encode_cursor(key1, last->id, next_cursor);
+    }
+
+    return 0;
+}
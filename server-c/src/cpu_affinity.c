@@ -0,0 +1,258 @@
+#ifdef __linux__
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "cpu_affinity.h"
+#include "config.h"
+#include "logger.h"
+
+static const char *const class_names[CPU_CLASS_COUNT] = { "HTTP", "풀", "I/O" };
+static const char *const class_settings[CPU_CLASS_COUNT] = { CPU_PIN_HTTP, CPU_PIN_POOL, CPU_PIN_IO };
+
+#ifdef __linux__
+
+#include <sched.h>
+
+#define CPU_AFFINITY_MAX_NODES 64
+
+typedef enum {
+    CPU_PIN_NONE = 0,
+    CPU_PIN_NUMA,                   // 노드의 CPU 전체에 고정 (노드 안에서는 커널이 스케줄)
+    CPU_PIN_LIST                    // CPU 하나씩 고정
+} cpu_pin_mode_t;
+
+typedef struct {
+    cpu_pin_mode_t mode;
+    int cpus[CPU_SETSIZE];          // CPU_PIN_LIST: 배정 순서
+    int cpu_count;
+    atomic_uint next;               // 다음에 배정할 순번
+} cpu_class_config_t;
+
+static struct {
+    bool initialized;
+    int node_count;
+    cpu_set_t node_cpus[CPU_AFFINITY_MAX_NODES];
+    cpu_class_config_t classes[CPU_CLASS_COUNT];
+} affinity;
+
+static _Thread_local int tl_node = -1;
+
+// "0-3,8,10-11" 형식의 CPU 목록 (-1: 형식 오류)
+static int cpu_parse_list(const char *text, cpu_set_t *set) {
+    CPU_ZERO(set);
+    const char *p = text;
+    while (*p != '\0' && *p != '\n') {
+        char *end;
+        long first = strtol(p, &end, 10);
+        if (end == p || first < 0 || first >= CPU_SETSIZE) {
+            return -1;
+        }
+        long last = first;
+        p = end;
+        if (*p == '-') {
+            p++;
+            last = strtol(p, &end, 10);
+            if (end == p || last < first || last >= CPU_SETSIZE) {
+                return -1;
+            }
+            p = end;
+        }
+        for (long cpu = first; cpu <= last; cpu++) {
+            CPU_SET((int)cpu, set);
+        }
+        if (*p == ',') {
+            p++;
+        } else if (*p != '\0' && *p != '\n') {
+            return -1;
+        }
+    }
+    return CPU_COUNT(set);
+}
+
+// sysfs의 노드별 CPU 목록을 읽어 프로세스가 쓸 수 있는 CPU로 좁힌다 (cgroup/taskset 반영)
+static void cpu_load_topology(const cpu_set_t *allowed) {
+    affinity.node_count = 0;
+    for (int node = 0; node < CPU_AFFINITY_MAX_NODES; node++) {
+        char path[128];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+        FILE *fp = fopen(path, "r");
+        if (fp == NULL) {
+            continue;
+        }
+
+        char line[1024];
+        cpu_set_t cpus;
+        bool ok = fgets(line, sizeof(line), fp) != NULL && cpu_parse_list(line, &cpus) > 0;
+        fclose(fp);
+        if (!ok) {
+            continue;
+        }
+
+        CPU_AND(&cpus, &cpus, allowed);
+        if (CPU_COUNT(&cpus) > 0) {
+            affinity.node_cpus[affinity.node_count++] = cpus;
+        }
+    }
+
+    // sysfs가 없으면 (컨테이너 등) 단일 노드로 취급
+    if (affinity.node_count == 0) {
+        affinity.node_cpus[0] = *allowed;
+        affinity.node_count = 1;
+    }
+}
+
+static int cpu_node_of(int cpu) {
+    for (int node = 0; node < affinity.node_count; node++) {
+        if (CPU_ISSET(cpu, &affinity.node_cpus[node])) {
+            return node;
+        }
+    }
+    return 0;
+}
+
+// 설정 해석: CPU 목록은 노드를 번갈아 가며 배정하도록 순서를 섞는다
+static void cpu_load_class(cpu_class_t cls, const cpu_set_t *allowed) {
+    cpu_class_config_t *config = &affinity.classes[cls];
+    const char *setting = class_settings[cls];
+    atomic_init(&config->next, 0);
+    config->mode = CPU_PIN_NONE;
+    config->cpu_count = 0;
+
+    if (setting[0] == '\0') {
+        return;
+    }
+    if (strcmp(setting, "numa") == 0) {
+        config->mode = CPU_PIN_NUMA;
+        return;
+    }
+
+    cpu_set_t cpus;
+    if (cpu_parse_list(setting, &cpus) < 0) {
+        log_warn("CPU 고정 설정 형식 오류 (%s 스레드): %s", class_names[cls], setting);
+        return;
+    }
+    CPU_AND(&cpus, &cpus, allowed);
+    if (CPU_COUNT(&cpus) == 0) {
+        log_warn("사용 가능한 CPU가 없어 고정하지 않습니다 (%s 스레드): %s", class_names[cls], setting);
+        return;
+    }
+
+    int total = CPU_COUNT(&cpus);
+    for (int round = 0; config->cpu_count < total; round++) {
+        int before = config->cpu_count;
+        for (int node = 0; node < affinity.node_count; node++) {
+            int seen = 0;
+            for (int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                if (CPU_ISSET(cpu, &cpus) && CPU_ISSET(cpu, &affinity.node_cpus[node])) {
+                    if (seen++ == round) {
+                        config->cpus[config->cpu_count++] = cpu;
+                        break;
+                    }
+                }
+            }
+        }
+        if (config->cpu_count == before) {
+            break;
+        }
+    }
+    config->mode = config->cpu_count > 0 ? CPU_PIN_LIST : CPU_PIN_NONE;
+}
+
+int cpu_affinity_init(void) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        log_warn("프로세스 CPU 목록을 가져올 수 없어 CPU 고정을 사용하지 않습니다");
+        return -1;
+    }
+
+    cpu_load_topology(&allowed);
+    for (int cls = 0; cls < CPU_CLASS_COUNT; cls++) {
+        cpu_load_class((cpu_class_t)cls, &allowed);
+    }
+    affinity.initialized = true;
+
+    log_info("CPU 배치: NUMA 노드 %d개, CPU %d개 (HTTP \"%s\", 풀 \"%s\", I/O \"%s\")",
+             affinity.node_count, CPU_COUNT(&allowed), CPU_PIN_HTTP, CPU_PIN_POOL, CPU_PIN_IO);
+    return 0;
+}
+
+int cpu_affinity_pin_current(cpu_class_t cls) {
+    if (!affinity.initialized || cls < 0 || cls >= CPU_CLASS_COUNT) {
+        return -1;
+    }
+
+    cpu_class_config_t *config = &affinity.classes[cls];
+    if (config->mode == CPU_PIN_NONE) {
+        return -1;
+    }
+
+    unsigned int slot = atomic_fetch_add_explicit(&config->next, 1, memory_order_relaxed);
+    cpu_set_t cpus;
+    int node;
+    if (config->mode == CPU_PIN_NUMA) {
+        node = (int)(slot % (unsigned int)affinity.node_count);
+        cpus = affinity.node_cpus[node];
+    } else {
+        int cpu = config->cpus[slot % (unsigned int)config->cpu_count];
+        CPU_ZERO(&cpus);
+        CPU_SET(cpu, &cpus);
+        node = cpu_node_of(cpu);
+    }
+
+    int rc = pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+    if (rc != 0) {
+        log_warn("CPU 고정 실패 (%s 스레드): %s", class_names[cls], strerror(rc));
+        return -1;
+    }
+
+    tl_node = node;
+    log_debug("%s 스레드를 노드 %d에 고정", class_names[cls], node);
+    return node;
+}
+
+int cpu_affinity_current_node(void) {
+    if (tl_node >= 0) {
+        return tl_node;
+    }
+    if (!affinity.initialized) {
+        return 0;
+    }
+    int cpu = sched_getcpu();
+    return cpu >= 0 ? cpu_node_of(cpu) : 0;
+}
+
+int cpu_affinity_node_count(void) {
+    return affinity.initialized ? affinity.node_count : 1;
+}
+
+#else
+
+int cpu_affinity_init(void) {
+    for (int cls = 0; cls < CPU_CLASS_COUNT; cls++) {
+        if (class_settings[cls][0] != '\0') {
+            log_info("이 플랫폼에서는 CPU 고정을 지원하지 않아 %s 스레드 설정을 무시합니다", class_names[cls]);
+        }
+    }
+    return 0;
+}
+
+int cpu_affinity_pin_current(cpu_class_t cls) {
+    (void)cls;
+    return -1;
+}
+
+int cpu_affinity_current_node(void) {
+    return 0;
+}
+
+int cpu_affinity_node_count(void) {
+    return 1;
+}
+
+#endif
@@ -2,57 +2,253 @@
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
+#include <unistd.h>
 #include "db.h"
+#include "config.h"
 #include "logger.h"
+#include "migrate.h"
+#include "db_trace.h"
 #include "uuid.h"
+#include "cpu_affinity.h"
 
 static db_pool_t db_pool;
 
-int db_init(const char *db_path) {
-    int rc = sqlite3_open(db_path, &db_pool.db);
+// 스레드별 기본 읽기 슬롯 (-1: 아직 할당되지 않음)
+static _Thread_local int reader_home_slot = -1;
+
+// 연결마다 적용하는 PRAGMA (마이그레이션은 트랜잭션 안에서 실행되므로 여기서 설정)
+static int db_apply_pragmas(sqlite3 *db, bool readonly) {
+    char sql[256];
+    snprintf(sql, sizeof(sql),
+             "PRAGMA foreign_keys = ON;"
+             "PRAGMA synchronous = NORMAL;"
+             "PRAGMA temp_store = MEMORY;"
+             "PRAGMA mmap_size = %lld;"
+             "PRAGMA cache_size = -%d;"
+             "PRAGMA analysis_limit = 400;",
+             DB_MMAP_SIZE, DB_CACHE_SIZE_KB);
+
+    char *err_msg = NULL;
+    int rc = sqlite3_exec(db, sql, NULL, NULL, &err_msg);
     if (rc != SQLITE_OK) {
-        log_error("데이터베이스 열기 실패: %s", sqlite3_errmsg(db_pool.db));
+        log_error("PRAGMA 적용 실패: %s", err_msg);
+        sqlite3_free(err_msg);
         return -1;
     }
 
-    pthread_mutex_init(&db_pool.mutex, NULL);
+    // journal_mode는 데이터베이스 파일에 저장되므로 쓰기 연결에서 한 번만 설정
+    // auto_vacuum은 테이블이 만들어지기 전(새 DB)에만 적용된다
+    if (!readonly) {
+        rc = sqlite3_exec(db, "PRAGMA auto_vacuum = INCREMENTAL;"
+                              "PRAGMA journal_mode = WAL;"
+                              "PRAGMA journal_size_limit = 67108864;", NULL, NULL, &err_msg);
+        if (rc != SQLITE_OK) {
+            log_error("WAL 모드 설정 실패: %s", err_msg);
+            sqlite3_free(err_msg);
+            return -1;
+        }
+    }
 
-    // 외래 키 활성화
-    char *err_msg = NULL;
-    rc = sqlite3_exec(db_pool.db, "PRAGMA foreign_keys = ON;", NULL, NULL, &err_msg);
+    sqlite3_busy_timeout(db, DB_BUSY_TIMEOUT_MS);
+    return 0;
+}
+
+static int db_open_connection(const char *db_path, bool readonly, db_conn_t *conn) {
+    int flags = SQLITE_OPEN_NOMUTEX;
+    flags |= readonly ? SQLITE_OPEN_READONLY : (SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+
+    int rc = sqlite3_open_v2(db_path, &conn->db, flags, NULL);
     if (rc != SQLITE_OK) {
-        log_error("외래 키 활성화 실패: %s", err_msg);
-        sqlite3_free(err_msg);
+        log_error("데이터베이스 열기 실패: %s", sqlite3_errmsg(conn->db));
+        sqlite3_close(conn->db);
+        conn->db = NULL;
+        return -1;
+    }
+
+    if (db_apply_pragmas(conn->db, readonly) < 0) {
+        sqlite3_close(conn->db);
+        conn->db = NULL;
+        return -1;
+    }
+
+    // 쓰기 연결은 마이그레이션이 끝난 뒤 db_init에서 등록한다
+    if (readonly) {
+        db_trace_attach(conn->db);
+    }
+
+    pthread_mutex_init(&conn->mutex, NULL);
+    return 0;
+}
+
+static void db_close_connection(db_conn_t *conn) {
+    if (conn->db != NULL) {
+        sqlite3_close(conn->db);
+        conn->db = NULL;
+        pthread_mutex_destroy(&conn->mutex);
+    }
+}
+
+int db_init(const char *db_path) {
+    // 쓰기 연결을 먼저 열어 WAL 모드를 활성화한 뒤 읽기 연결을 연다
+    if (db_open_connection(db_path, false, &db_pool.writer) < 0) {
+        return -1;
+    }
+
+    // 읽기 연결이 열리기 전에 스키마를 최신 버전으로 올린다
+    if (migrate_run(db_pool.writer.db, MIGRATIONS_DIR) < 0) {
+        log_error("스키마 마이그레이션 실패");
+        db_close_connection(&db_pool.writer);
+        return -1;
+    }
+
+    int schema_version = migrate_get_version(db_pool.writer.db);
+    if (schema_version < DB_SCHEMA_VERSION) {
+        log_error("스키마 버전 %d이(가) 필요하지만 현재 %d입니다", DB_SCHEMA_VERSION, schema_version);
+        db_close_connection(&db_pool.writer);
+        return -1;
+    }
+    db_trace_attach(db_pool.writer.db);
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    int reader_count = (cpus > 0) ? (int)cpus : 1;
+    if (reader_count > DB_MAX_READ_CONNECTIONS) {
+        reader_count = DB_MAX_READ_CONNECTIONS;
+    }
+
+    db_pool.readers = calloc(reader_count, sizeof(db_conn_t));
+    if (db_pool.readers == NULL) {
+        log_error("읽기 연결 메모리 할당 실패");
+        db_close_connection(&db_pool.writer);
         return -1;
     }
 
-    log_info("데이터베이스 초기화 완료: %s", db_path);
+    for (int i = 0; i < reader_count; i++) {
+        if (db_open_connection(db_path, true, &db_pool.readers[i]) < 0) {
+            db_pool.reader_count = i;
+            db_close();
+            return -1;
+        }
+    }
+    db_pool.reader_count = reader_count;
+    atomic_init(&db_pool.next_reader, 0);
+
+    log_info("데이터베이스 초기화 완료: %s (읽기 연결 %d개)", db_path, reader_count);
     return 0;
 }
 
 void db_close(void) {
-    if (db_pool.db != NULL) {
-        sqlite3_close(db_pool.db);
-        pthread_mutex_destroy(&db_pool.mutex);
-        log_info("데이터베이스 종료");
+    if (db_pool.writer.db == NULL) {
+        return;
+    }
+
+    for (int i = 0; i < db_pool.reader_count; i++) {
+        db_close_connection(&db_pool.readers[i]);
     }
+    free(db_pool.readers);
+    db_pool.readers = NULL;
+    db_pool.reader_count = 0;
+
+    db_close_connection(&db_pool.writer);
+    log_info("데이터베이스 종료");
 }
 
 sqlite3* db_get_connection(void) {
-    pthread_mutex_lock(&db_pool.mutex);
-    return db_pool.db;
+    if (pthread_mutex_trylock(&db_pool.writer.mutex) == 0) {
+        db_trace_record_wait(true, false, 0);
+        return db_pool.writer.db;
+    }
+
+    uint64_t start = db_trace_now_ns();
+    pthread_mutex_lock(&db_pool.writer.mutex);
+    db_trace_record_wait(true, true, db_trace_now_ns() - start);
+    return db_pool.writer.db;
 }
 
 void db_release_connection(sqlite3 *db) {
-    (void)db; // Unused in single connection model
-    pthread_mutex_unlock(&db_pool.mutex);
+    (void)db; // Only one writer connection
+    pthread_mutex_unlock(&db_pool.writer.mutex);
+}
+
+sqlite3* db_get_read_connection(void) {
+    int n = db_pool.reader_count;
+
+    // 스레드마다 기본 슬롯을 배정하여 경합과 캐시 이동을 줄인다
+    // NUMA 노드마다 연속된 슬롯 구간을 나눠 주어, 연결의 페이지 캐시가 같은 노드의 스레드끼리만 공유되게 한다
+    if (reader_home_slot < 0) {
+        unsigned int ticket = atomic_fetch_add(&db_pool.next_reader, 1);
+        int nodes = cpu_affinity_node_count();
+        int per_node = n / nodes;
+        if (nodes > 1 && per_node > 0) {
+            int node = cpu_affinity_current_node() % nodes;
+            reader_home_slot = node * per_node + (int)(ticket % (unsigned)per_node);
+        } else {
+            reader_home_slot = (int)(ticket % (unsigned)n);
+        }
+    }
+
+    for (int i = 0; i < n; i++) {
+        db_conn_t *conn = &db_pool.readers[(reader_home_slot + i) % n];
+        if (pthread_mutex_trylock(&conn->mutex) == 0) {
+            db_trace_record_wait(false, false, 0);
+            return conn->db;
+        }
+    }
+
+    // 모든 슬롯이 사용 중이면 기본 슬롯에서 대기
+    db_conn_t *conn = &db_pool.readers[reader_home_slot];
+    uint64_t start = db_trace_now_ns();
+    pthread_mutex_lock(&conn->mutex);
+    db_trace_record_wait(false, true, db_trace_now_ns() - start);
+    return conn->db;
+}
+
+void db_release_read_connection(sqlite3 *db) {
+    for (int i = 0; i < db_pool.reader_count; i++) {
+        if (db_pool.readers[i].db == db) {
+            pthread_mutex_unlock(&db_pool.readers[i].mutex);
+            return;
+        }
+    }
+    log_error("알 수 없는 읽기 연결 반환");
+}
+
+// 쓰기 연결에서 PRAGMA optimize 실행
+// 읽기 전용 연결에서는 ANALYZE 결과를 쓸 수 없어 일만 늘고 실패하므로 쓰기 연결에서만 돌린다.
+int db_optimize(void) {
+    sqlite3 *db = db_get_connection();
+    int rc = sqlite3_exec(db, "PRAGMA optimize;", NULL, NULL, NULL);
+    if (rc != SQLITE_OK) {
+        log_error("PRAGMA optimize 실패: %s", sqlite3_errmsg(db));
+    }
+    db_release_connection(db);
+
+    return (rc == SQLITE_OK) ? 0 : -1;
+}
+
+// ID는 16바이트 BLOB으로 저장하고 API에는 문자열 UUID로 노출한다.
+// 형식이 잘못된 ID는 NULL로 바인딩되어 어떤 행과도 일치하지 않는다.
+static void db_bind_uuid(sqlite3_stmt *stmt, int index, const char *uuid) {
+    uint8_t bytes[OTT_UUID_BYTES];
+    if (uuid_parse(uuid, bytes) == 0) {
+        sqlite3_bind_blob(stmt, index, bytes, sizeof(bytes), SQLITE_TRANSIENT);
+    } else {
+        sqlite3_bind_null(stmt, index);
+    }
+}
+
+static void db_column_uuid(sqlite3_stmt *stmt, int col, ott_uuid_t out) {
+    if (sqlite3_column_bytes(stmt, col) == OTT_UUID_BYTES) {
+        uuid_format(sqlite3_column_blob(stmt, col), out);
+    } else {
+        out[0] = '\0';
+    }
 }
 
 // User operations
 int db_create_user(const char *login_id, const char *password_hash, const char *display_name, ott_uuid_t out_id) {
     sqlite3 *db = db_get_connection();
     
-    uuid_generate(out_id);
+    uuid_generate_v7(out_id);
     
     const char *sql = "INSERT INTO users (id, login_id, password_hash, display_name) VALUES (?, ?, ?, ?)";
     sqlite3_stmt *stmt;
@@ -64,26 +260,27 @@ int db_create_user(const char *login_id, const char *password_hash, const char *
         return -1;
     }
     
-    sqlite3_bind_text(stmt, 1, out_id, -1, SQLITE_STATIC);
+    db_bind_uuid(stmt, 1, out_id);
     sqlite3_bind_text(stmt, 2, login_id, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 3, password_hash, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 4, display_name, -1, SQLITE_STATIC);
     
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
-    db_release_connection(db);
     
     if (rc != SQLITE_DONE) {
         log_error("사용자 생성 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
         return -1;
     }
+    db_release_connection(db);
     
     log_info("사용자 생성 완료: %s (ID: %s)", login_id, out_id);
     return 0;
 }
 
 int db_get_user_by_login(const char *login_id, user_t *user) {
-    sqlite3 *db = db_get_connection();
+    sqlite3 *db = db_get_read_connection();
     
     const char *sql = "SELECT id, login_id, password_hash, display_name, created_at, updated_at FROM users WHERE login_id = ?";
     sqlite3_stmt *stmt;
@@ -91,7 +288,7 @@ int db_get_user_by_login(const char *login_id, user_t *user) {
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
         log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
-        db_release_connection(db);
+        db_release_read_connection(db);
         return -1;
     }
     
@@ -99,59 +296,65 @@ int db_get_user_by_login(const char *login_id, user_t *user) {
     
     rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
-        strncpy(user->id, (const char*)sqlite3_column_text(stmt, 0), sizeof(user->id) - 1);
+        db_column_uuid(stmt, 0, user->id);
         strncpy(user->login_id, (const char*)sqlite3_column_text(stmt, 1), sizeof(user->login_id) - 1);
         strncpy(user->password_hash, (const char*)sqlite3_column_text(stmt, 2), sizeof(user->password_hash) - 1);
         strncpy(user->display_name, (const char*)sqlite3_column_text(stmt, 3), sizeof(user->display_name) - 1);
+        user->created_at = (time_t)sqlite3_column_int64(stmt, 4);
+        user->updated_at = (time_t)sqlite3_column_int64(stmt, 5);
         
         sqlite3_finalize(stmt);
-        db_release_connection(db);
+        db_release_read_connection(db);
         return 0;
     }
     
     sqlite3_finalize(stmt);
-    db_release_connection(db);
+    db_release_read_connection(db);
     return -1;
 }
 
 int db_get_user_by_id(const char *user_id, user_t *user) {
-    sqlite3 *db = db_get_connection();
+    sqlite3 *db = db_get_read_connection();
     
     const char *sql = "SELECT id, login_id, password_hash, display_name, created_at, updated_at FROM users WHERE id = ?";
     sqlite3_stmt *stmt;
     
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
-        db_release_connection(db);
+        db_release_read_connection(db);
         return -1;
     }
     
-    sqlite3_bind_text(stmt, 1, user_id, -1, SQLITE_STATIC);
+    db_bind_uuid(stmt, 1, user_id);
     
     rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
-        strncpy(user->id, (const char*)sqlite3_column_text(stmt, 0), sizeof(user->id) - 1);
+        db_column_uuid(stmt, 0, user->id);
         strncpy(user->login_id, (const char*)sqlite3_column_text(stmt, 1), sizeof(user->login_id) - 1);
         strncpy(user->password_hash, (const char*)sqlite3_column_text(stmt, 2), sizeof(user->password_hash) - 1);
         strncpy(user->display_name, (const char*)sqlite3_column_text(stmt, 3), sizeof(user->display_name) - 1);
+        user->created_at = (time_t)sqlite3_column_int64(stmt, 4);
+        user->updated_at = (time_t)sqlite3_column_int64(stmt, 5);
         
         sqlite3_finalize(stmt);
-        db_release_connection(db);
+        db_release_read_connection(db);
         return 0;
     }
     
     sqlite3_finalize(stmt);
-    db_release_connection(db);
+    db_release_read_connection(db);
     return -1;
 }
 
 // Video operations
-int db_create_video(const char *title, const char *description, int duration_sec, ott_uuid_t out_id) {
+int db_create_video(const char *title, const char *description, int duration_sec,
+                    const char *mime_type, ott_uuid_t out_id) {
     sqlite3 *db = db_get_connection();
     
-    uuid_generate(out_id);
+    uuid_generate_v7(out_id);
     
-    const char *sql = "INSERT INTO videos (id, title, description, duration_sec) VALUES (?, ?, ?, ?)";
+    const char *sql = "INSERT INTO videos (id, title, description, duration_sec, mime_type) "
+                      "VALUES (?, ?, ?, ?, coalesce(?, 'video/mp4'))";
     sqlite3_stmt *stmt;
     
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
@@ -160,41 +363,43 @@ int db_create_video(const char *title, const char *description, int duration_sec
         return -1;
     }
     
-    sqlite3_bind_text(stmt, 1, out_id, -1, SQLITE_STATIC);
+    db_bind_uuid(stmt, 1, out_id);
     sqlite3_bind_text(stmt, 2, title, -1, SQLITE_STATIC);
     sqlite3_bind_text(stmt, 3, description, -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 4, duration_sec);
+    sqlite3_bind_text(stmt, 5, mime_type, -1, SQLITE_STATIC);
     
     rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
-    db_release_connection(db);
     
     if (rc != SQLITE_DONE) {
         log_error("동영상 생성 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
         return -1;
     }
+    db_release_connection(db);
     
     log_info("동영상 생성 완료: %s (ID: %s)", title, out_id);
     return 0;
 }
 
 int db_get_video(const char *video_id, video_t *video) {
-    sqlite3 *db = db_get_connection();
+    sqlite3 *db = db_get_read_connection();
     
     const char *sql = "SELECT id, title, description, duration_sec, mime_type FROM videos WHERE id = ?";
     sqlite3_stmt *stmt;
     
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
-        db_release_connection(db);
+        db_release_read_connection(db);
         return -1;
     }
     
-    sqlite3_bind_text(stmt, 1, video_id, -1, SQLITE_STATIC);
+    db_bind_uuid(stmt, 1, video_id);
     
     rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
-        strncpy(video->id, (const char*)sqlite3_column_text(stmt, 0), sizeof(video->id) - 1);
+        db_column_uuid(stmt, 0, video->id);
         strncpy(video->title, (const char*)sqlite3_column_text(stmt, 1), sizeof(video->title) - 1);
         
         const char *desc = (const char*)sqlite3_column_text(stmt, 2);
@@ -208,237 +413,446 @@ int db_get_video(const char *video_id, video_t *video) {
         strncpy(video->mime_type, (const char*)sqlite3_column_text(stmt, 4), sizeof(video->mime_type) - 1);
         
         sqlite3_finalize(stmt);
-        db_release_connection(db);
+        db_release_read_connection(db);
         return 0;
     }
     
     sqlite3_finalize(stmt);
-    db_release_connection(db);
+    db_release_read_connection(db);
     return -1;
 }
 
-int db_list_videos(int page, int page_size, video_t **videos, int *count, int *total) {
-    sqlite3 *db = db_get_connection();
+// Catalog page helpers
+// 커서는 페이지 마지막 항목의 정렬 키 두 개를 16진수로 인코딩한 값
+// (목록: created_at, id / 검색: BM25 점수, rowid)
+void db_encode_cursor(const char *key1, const char *key2, char out[DB_CURSOR_LEN]) {
+    char raw[DB_CURSOR_LEN / 2];
+    int n = snprintf(raw, sizeof(raw), "%s\t%s", key1, key2);
+    if (n < 0 || n >= (int)sizeof(raw)) {
+        out[0] = '\0';
+        return;
+    }
+
+    for (int i = 0; i < n; i++) {
+        snprintf(out + i * 2, 3, "%02x", (unsigned char)raw[i]);
+    }
+    out[n * 2] = '\0';
+}
+
+int db_decode_cursor(const char *cursor, char *key1, size_t key1_len,
+                            char *key2, size_t key2_len) {
+    size_t hex_len = strlen(cursor);
+    if (hex_len == 0 || hex_len % 2 != 0 || hex_len >= DB_CURSOR_LEN) {
+        return -1;
+    }
+
+    char raw[DB_CURSOR_LEN / 2];
+    size_t raw_len = hex_len / 2;
+    for (size_t i = 0; i < raw_len; i++) {
+        unsigned int byte;
+        if (sscanf(cursor + i * 2, "%2x", &byte) != 1) {
+            return -1;
+        }
+        raw[i] = (char)byte;
+    }
+    raw[raw_len] = '\0';
+
+    char *tab = strchr(raw, '\t');
+    if (tab == NULL || (size_t)(tab - raw) >= key1_len || strlen(tab + 1) >= key2_len) {
+        return -1;
+    }
+
+    *tab = '\0';
+    strcpy(key1, raw);
+    strcpy(key2, tab + 1);
+    return 0;
+}
+
+// LIMIT page_size + 1로 조회한 결과를 한 번만 순회하며 페이지 아레나에 채운다.
+// 컬럼 순서: id, title, description, duration_sec, mime_type, 정렬 키 1, 정렬 키 2
+// 여분의 행이 있으면 마지막으로 반환한 항목의 키로 다음 커서를 만든다.
+static int db_collect_video_page(sqlite3_stmt *stmt, int page_size, video_page_t *page,
+                                 char next_cursor[DB_CURSOR_LEN]) {
+    next_cursor[0] = '\0';
+
+    if (video_page_init(page, page_size) < 0) {
+        return -1;
+    }
+
+    char last_key1[32] = "";
+    char last_key2[40] = "";
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (page->count == page_size) {
+            db_encode_cursor(last_key1, last_key2, next_cursor);
+            break;
+        }
+
+        ott_uuid_t id;
+        db_column_uuid(stmt, 0, id);
+        const char *title = (const char*)sqlite3_column_text(stmt, 1);
+        int title_len = sqlite3_column_bytes(stmt, 1);
+        const char *desc = (const char*)sqlite3_column_text(stmt, 2);
+        int desc_len = sqlite3_column_bytes(stmt, 2);
+        const char *mime = (const char*)sqlite3_column_text(stmt, 4);
+
+        if (video_page_add(page, id, title ? title : "", (size_t)title_len,
+                           desc ? desc : "", (size_t)desc_len, mime_intern(mime),
+                           sqlite3_column_int(stmt, 3), 0) < 0) {
+            return -1;
+        }
+
+        snprintf(last_key1, sizeof(last_key1), "%s", (const char*)sqlite3_column_text(stmt, 5));
+        if (sqlite3_column_type(stmt, 6) == SQLITE_BLOB) {
+            db_column_uuid(stmt, 6, last_key2);
+        } else {
+            snprintf(last_key2, sizeof(last_key2), "%s", (const char*)sqlite3_column_text(stmt, 6));
+        }
+    }
+
+    return (rc == SQLITE_ROW || rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_list_videos(const char *cursor, int page_size, video_page_t *page, int *total,
+                   char next_cursor[DB_CURSOR_LEN]) {
+    char after_created_at[32];
+    ott_uuid_t after_id;
+    bool has_cursor = (cursor != NULL && cursor[0] != '\0');
+
+    memset(page, 0, sizeof(*page));
+    next_cursor[0] = '\0';
+
+    if (has_cursor && db_decode_cursor(cursor, after_created_at, sizeof(after_created_at),
+                                       after_id, sizeof(after_id)) < 0) {
+        return -2;
+    }
+
+    sqlite3 *db = db_get_read_connection();
     
-    // Get total count
-    const char *count_sql = "SELECT COUNT(*) FROM videos";
+    // 전체 개수는 트리거로 유지되는 카운터에서 읽는다
+    const char *count_sql = "SELECT value FROM catalog_stats WHERE name = 'video_count'";
     sqlite3_stmt *count_stmt;
-    sqlite3_prepare_v2(db, count_sql, -1, &count_stmt, NULL);
-    if (sqlite3_step(count_stmt) == SQLITE_ROW) {
-        *total = sqlite3_column_int(count_stmt, 0);
+    *total = 0;
+    if (sqlite3_prepare_v2(db, count_sql, -1, &count_stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(count_stmt) == SQLITE_ROW) {
+            *total = sqlite3_column_int(count_stmt, 0);
+        }
+        sqlite3_finalize(count_stmt);
     }
-    sqlite3_finalize(count_stmt);
     
-    // Get paginated results
-    const char *sql = "SELECT id, title, description, duration_sec, mime_type FROM videos ORDER BY created_at DESC LIMIT ? OFFSET ?";
+    // idx_videos_created_id를 따라 커서 이후 항목만 읽는다
+    const char *sql = has_cursor
+        ? "SELECT id, title, description, duration_sec, mime_type, created_at, id FROM videos "
+          "WHERE (created_at, id) < (?, ?) ORDER BY created_at DESC, id DESC LIMIT ?"
+        : "SELECT id, title, description, duration_sec, mime_type, created_at, id FROM videos "
+          "ORDER BY created_at DESC, id DESC LIMIT ?";
     sqlite3_stmt *stmt;
     
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
-        db_release_connection(db);
+        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
+        db_release_read_connection(db);
         return -1;
     }
     
-    int offset = (page - 1) * page_size;
-    sqlite3_bind_int(stmt, 1, page_size);
-    sqlite3_bind_int(stmt, 2, offset);
-    
-    // Count results
-    *count = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        (*count)++;
+    int param = 1;
+    if (has_cursor) {
+        sqlite3_bind_int64(stmt, param++, strtoll(after_created_at, NULL, 10));
+        db_bind_uuid(stmt, param++, after_id);
     }
-    sqlite3_reset(stmt);
+    sqlite3_bind_int(stmt, param, page_size + 1);
     
-    // Allocate array
-    *videos = malloc(sizeof(video_t) * (*count));
+    rc = db_collect_video_page(stmt, page_size, page, next_cursor);
     
-    // Fill results
-    int i = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW && i < *count) {
-        video_t *v = &(*videos)[i];
-        strncpy(v->id, (const char*)sqlite3_column_text(stmt, 0), sizeof(v->id) - 1);
-        v->id[sizeof(v->id) - 1] = '\0';
-        
-        strncpy(v->title, (const char*)sqlite3_column_text(stmt, 1), sizeof(v->title) - 1);
-        v->title[sizeof(v->title) - 1] = '\0';
-        
-        const char *desc = (const char*)sqlite3_column_text(stmt, 2);
-        if (desc) {
-            strncpy(v->description, desc, sizeof(v->description) - 1);
-            v->description[sizeof(v->description) - 1] = '\0';
-        } else {
-            v->description[0] = '\0';
+    sqlite3_finalize(stmt);
+    db_release_read_connection(db);
+    return rc;
+}
+
+// FTS5 MATCH 식: 검색어 전체를 하나의 구문으로 인용 (큰따옴표는 두 번 써서 이스케이프)
+static void db_build_match_phrase(const char *query, char *out, size_t out_len) {
+    size_t pos = 0;
+    out[pos++] = '"';
+    for (const char *p = query; *p != '\0' && pos + 3 < out_len; p++) {
+        if (*p == '"') {
+            out[pos++] = '"';
         }
-        
-        v->duration_sec = sqlite3_column_int(stmt, 3);
-        strncpy(v->mime_type, (const char*)sqlite3_column_text(stmt, 4), sizeof(v->mime_type) - 1);
-        v->mime_type[sizeof(v->mime_type) - 1] = '\0';
-        i++;
+        out[pos++] = *p;
     }
-    
-    sqlite3_finalize(stmt);
-    db_release_connection(db);
-    return 0;
+    out[pos++] = '"';
+    out[pos] = '\0';
 }
 
-int db_search_videos(const char *query, int page, int page_size, video_t **videos, int *count, int *total) {
-    // For now, simple LIKE search on title
-    // Can be enhanced with full-text search later
-    sqlite3 *db = db_get_connection();
-    
-    char search_pattern[512];
-    snprintf(search_pattern, sizeof(search_pattern), "%%%s%%", query);
-    
-    // Get total count
-    const char *count_sql = "SELECT COUNT(*) FROM videos WHERE title LIKE ?";
-    sqlite3_stmt *count_stmt;
-    sqlite3_prepare_v2(db, count_sql, -1, &count_stmt, NULL);
-    sqlite3_bind_text(count_stmt, 1, search_pattern, -1, SQLITE_STATIC);
-    if (sqlite3_step(count_stmt) == SQLITE_ROW) {
-        *total = sqlite3_column_int(count_stmt, 0);
+// LIKE 패턴 %<query>% (입력의 \ % _ 는 ESCAPE '\'로 글자 그대로 찾는다)
+static void db_build_like_pattern(const char *query, char *out, size_t out_len) {
+    size_t pos = 0;
+    out[pos++] = '%';
+    for (const char *p = query; *p != '\0' && pos + 4 < out_len; p++) {
+        if (*p == '\\' || *p == '%' || *p == '_') {
+            out[pos++] = '\\';
+        }
+        out[pos++] = *p;
+    }
+    out[pos++] = '%';
+    out[pos] = '\0';
+}
+
+// UTF-8 문자 수 (trigram 토크나이저는 3글자 이상이어야 MATCH 가능)
+static size_t db_utf8_length(const char *s) {
+    size_t n = 0;
+    for (; *s != '\0'; s++) {
+        if (((unsigned char)*s & 0xC0) != 0x80) {
+            n++;
+        }
+    }
+    return n;
+}
+
+int db_search_videos(const char *query, const char *cursor, int page_size, video_page_t *page,
+                     int *total, char next_cursor[DB_CURSOR_LEN]) {
+    // 제목/설명 FTS5 검색, BM25 점수순 (제목 가중치 10, 설명 1)
+    char after_score[32];
+    char after_rowid[40];
+    bool has_cursor = (cursor != NULL && cursor[0] != '\0');
+
+    memset(page, 0, sizeof(*page));
+    *total = -1;
+    next_cursor[0] = '\0';
+
+    if (has_cursor && db_decode_cursor(cursor, after_score, sizeof(after_score),
+                                       after_rowid, sizeof(after_rowid)) < 0) {
+        return -2;
+    }
+
+    // 3글자 미만은 trigram 색인을 쓸 수 없으므로 FTS 테이블에서 LIKE로 찾는다
+    bool use_match = db_utf8_length(query) >= 3;
+    char pattern[MAX_QUERY_LEN];
+    if (use_match) {
+        db_build_match_phrase(query, pattern, sizeof(pattern));
+    } else {
+        db_build_like_pattern(query, pattern, sizeof(pattern));
+    }
+    const char *filter = use_match
+        ? "videos_fts MATCH ?1"
+        : "(title LIKE ?1 ESCAPE '\\' OR description LIKE ?1 ESCAPE '\\')";
+
+    sqlite3 *db = db_get_read_connection();
+    char sql[768];
+    
+    // Total count (first page only)
+    if (!has_cursor) {
+        snprintf(sql, sizeof(sql), "SELECT COUNT(*) FROM videos_fts WHERE %s", filter);
+        sqlite3_stmt *count_stmt;
+        if (sqlite3_prepare_v2(db, sql, -1, &count_stmt, NULL) == SQLITE_OK) {
+            sqlite3_bind_text(count_stmt, 1, pattern, -1, SQLITE_STATIC);
+            if (sqlite3_step(count_stmt) == SQLITE_ROW) {
+                *total = sqlite3_column_int(count_stmt, 0);
+            }
+            sqlite3_finalize(count_stmt);
+        }
     }
-    sqlite3_finalize(count_stmt);
     
-    // Get paginated search results
-    const char *sql = "SELECT id, title, description, duration_sec, mime_type FROM videos WHERE title LIKE ? ORDER BY created_at DESC LIMIT ? OFFSET ?";
+    // 커서 키는 (점수, rowid); 점수는 왕복 가능한 정밀도의 텍스트로 내보낸다
+    snprintf(sql, sizeof(sql),
+             "SELECT v.id, v.title, v.description, v.duration_sec, v.mime_type, "
+             "printf('%%!.17g', f.score), f.rowid "
+             "FROM (SELECT rowid, %s AS score FROM videos_fts WHERE %s) AS f "
+             "JOIN videos AS v ON v.seq = f.rowid "
+             "%s ORDER BY f.score, f.rowid LIMIT ?4",
+             use_match ? "bm25(videos_fts, 10.0, 1.0)" : "0.0",
+             filter,
+             has_cursor ? "WHERE (f.score, f.rowid) > (?2, ?3)" : "");
     sqlite3_stmt *stmt;
     
     int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
     if (rc != SQLITE_OK) {
-        db_release_connection(db);
+        log_error("Failed to prepare statement: %s", sqlite3_errmsg(db));
+        db_release_read_connection(db);
         return -1;
     }
     
-    int offset = (page - 1) * page_size;
-    sqlite3_bind_text(stmt, 1, search_pattern, -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 2, page_size);
-    sqlite3_bind_int(stmt, 3, offset);
-    
-    // Count results
-    *count = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        (*count)++;
+    sqlite3_bind_text(stmt, 1, pattern, -1, SQLITE_STATIC);
+    if (has_cursor) {
+        sqlite3_bind_double(stmt, 2, strtod(after_score, NULL));
+        sqlite3_bind_int64(stmt, 3, strtoll(after_rowid, NULL, 10));
     }
-    sqlite3_reset(stmt);
-    
-    // Allocate array
-    *videos = malloc(sizeof(video_t) * (*count));
+    sqlite3_bind_int(stmt, 4, page_size + 1);
     
-    // Fill results
-    int i = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW && i < *count) {
-        video_t *v = &(*videos)[i];
-        strncpy(v->id, (const char*)sqlite3_column_text(stmt, 0), sizeof(v->id) - 1);
-        v->id[sizeof(v->id) - 1] = '\0';
-        
-        strncpy(v->title, (const char*)sqlite3_column_text(stmt, 1), sizeof(v->title) - 1);
-        v->title[sizeof(v->title) - 1] = '\0';
-        
-        const char *desc = (const char*)sqlite3_column_text(stmt, 2);
-        if (desc) {
-            strncpy(v->description, desc, sizeof(v->description) - 1);
-            v->description[sizeof(v->description) - 1] = '\0';
-        } else {
-            v->description[0] = '\0';
-        }
-        
-        v->duration_sec = sqlite3_column_int(stmt, 3);
-        strncpy(v->mime_type, (const char*)sqlite3_column_text(stmt, 4), sizeof(v->mime_type) - 1);
-        v->mime_type[sizeof(v->mime_type) - 1] = '\0';
-        i++;
+    rc = db_collect_video_page(stmt, page_size, page, next_cursor);
+    if (rc < 0) {
+        log_error("동영상 검색 실패: %s", sqlite3_errmsg(db));
     }
     
     sqlite3_finalize(stmt);
-    db_release_connection(db);
-    return 0;
+    db_release_read_connection(db);
+    return rc;
 }
 
-// Video file operations
-int db_create_video_file(const char *video_id, const char *file_path, int64_t file_size, 
-                         int bitrate_kbps, const char *resolution, ott_uuid_t out_id) {
-    sqlite3 *db = db_get_connection();
-    
-    uuid_generate(out_id);
-    
-    const char *sql = "INSERT INTO video_files (id, video_id, file_path, file_size, bitrate_kbps, resolution) VALUES (?, ?, ?, ?, ?, ?)";
+// 내용 주소 저장소 행 (같은 해시가 이미 있으면 그대로 두고, 참조 횟수는 video_files 트리거가 올린다)
+#define DB_INSERT_BLOB_SQL \
+    "INSERT INTO media_blobs (hash, file_path, file_size) VALUES (unhex(?), ?, ?) ON CONFLICT (hash) DO NOTHING"
+
+// 파일 행 추가 (호출자가 연 트랜잭션 안에서, 저장소 행과 함께)
+// 참조 횟수는 video_files 트리거가 올리므로 저장소 행을 먼저 넣는다
+static int db_insert_video_file(sqlite3 *db, const char *video_id, const char *file_path, int64_t file_size,
+                                int bitrate_kbps, const char *resolution, const char *video_codec,
+                                const char *audio_codec, const char *content_hash, const char *file_id) {
     sqlite3_stmt *stmt;
+    if (content_hash != NULL) {
+        if (sqlite3_prepare_v2(db, DB_INSERT_BLOB_SQL, -1, &stmt, NULL) != SQLITE_OK) {
+            log_error("저장소 행 추가 준비 실패: %s", sqlite3_errmsg(db));
+            return -1;
+        }
+        sqlite3_bind_text(stmt, 1, content_hash, -1, SQLITE_STATIC);
+        sqlite3_bind_text(stmt, 2, file_path, -1, SQLITE_STATIC);
+        sqlite3_bind_int64(stmt, 3, file_size);
+        int rc = sqlite3_step(stmt);
+        sqlite3_finalize(stmt);
+        if (rc != SQLITE_DONE) {
+            log_error("저장소 행 추가 실패: %s", sqlite3_errmsg(db));
+            return -1;
+        }
+    }
     
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_text(stmt, 1, out_id, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, video_id, -1, SQLITE_STATIC);
+    const char *sql = "INSERT INTO video_files (id, video_id, file_path, file_size, bitrate_kbps, resolution, "
+                      "video_codec, audio_codec, content_hash) VALUES (?, ?, ?, ?, ?, ?, ?, ?, unhex(?))";
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("동영상 파일 행 추가 준비 실패: %s", sqlite3_errmsg(db));
+        return -1;
+    }
+    db_bind_uuid(stmt, 1, file_id);
+    db_bind_uuid(stmt, 2, video_id);
     sqlite3_bind_text(stmt, 3, file_path, -1, SQLITE_STATIC);
     sqlite3_bind_int64(stmt, 4, file_size);
     sqlite3_bind_int(stmt, 5, bitrate_kbps);
     sqlite3_bind_text(stmt, 6, resolution, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 7, video_codec, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 8, audio_codec, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 9, content_hash, -1, SQLITE_STATIC);
     
     int rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        log_error("동영상 파일 행 추가 실패: %s", sqlite3_errmsg(db));
+        return -1;
+    }
+    return 0;
+}
+
+// Video file operations
+int db_create_video_file(const char *video_id, const char *file_path, int64_t file_size, 
+                         int bitrate_kbps, const char *resolution, const char *video_codec,
+                         const char *audio_codec, const char *content_hash, ott_uuid_t out_id) {
+    sqlite3 *db = db_get_connection();
+    
+    uuid_generate_v7(out_id);
+    
+    sqlite3_exec(db, "BEGIN IMMEDIATE", NULL, NULL, NULL);
+    int rc = db_insert_video_file(db, video_id, file_path, file_size, bitrate_kbps, resolution,
+                                  video_codec, audio_codec, content_hash, out_id);
+    sqlite3_exec(db, rc == 0 ? "COMMIT" : "ROLLBACK", NULL, NULL, NULL);
     db_release_connection(db);
     
-    return (rc == SQLITE_DONE) ? 0 : -1;
+    return rc;
 }
 
 int db_get_video_files(const char *video_id, video_file_t **files, int *count) {
-    sqlite3 *db = db_get_connection();
+    sqlite3 *db = db_get_read_connection();
     
-    const char *sql = "SELECT id, video_id, file_path, file_size, bitrate_kbps, resolution FROM video_files WHERE video_id = ?";
+    const char *sql = "SELECT id, video_id, file_path, file_size, bitrate_kbps, resolution, "
+                      "lower(hex(content_hash)) FROM video_files WHERE video_id = ? ORDER BY rowid";
     sqlite3_stmt *stmt;
     
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_text(stmt, 1, video_id, -1, SQLITE_STATIC);
-    
-    // Count results
+    *files = NULL;
     *count = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW) {
-        (*count)++;
-    }
-    sqlite3_reset(stmt);
-    
-    if (*count == 0) {
-        sqlite3_finalize(stmt);
-        db_release_connection(db);
-        return 0;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("동영상 파일 조회 실패: %s", sqlite3_errmsg(db));
+        db_release_read_connection(db);
+        return -1;
     }
-    
-    *files = malloc(sizeof(video_file_t) * (*count));
-    
-    int i = 0;
-    while (sqlite3_step(stmt) == SQLITE_ROW && i < *count) {
-        video_file_t *f = &(*files)[i];
-        strncpy(f->id, (const char*)sqlite3_column_text(stmt, 0), sizeof(f->id) - 1);
-        strncpy(f->video_id, (const char*)sqlite3_column_text(stmt, 1), sizeof(f->video_id) - 1);
-        strncpy(f->file_path, (const char*)sqlite3_column_text(stmt, 2), sizeof(f->file_path) - 1);
-        f->file_size = sqlite3_column_int64(stmt, 3);
-        f->bitrate_kbps = sqlite3_column_int(stmt, 4);
+    db_bind_uuid(stmt, 1, video_id);
+    
+    // 한 번만 순회하며 배열을 늘려 채운다 (개수를 세려고 다시 실행하지 않음)
+    int capacity = 0;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (*count == capacity) {
+            int new_capacity = capacity > 0 ? capacity * 2 : 4;
+            video_file_t *grown = realloc(*files, sizeof(video_file_t) * (size_t)new_capacity);
+            if (grown == NULL) {
+                rc = SQLITE_NOMEM;
+                break;
+            }
+            *files = grown;
+            capacity = new_capacity;
+        }
         
+        video_file_t *f = &(*files)[*count];
+        memset(f, 0, sizeof(*f));
         const char *res = (const char*)sqlite3_column_text(stmt, 5);
-        if (res) {
-            strncpy(f->resolution, res, sizeof(f->resolution) - 1);
-        }
-        i++;
+        db_column_uuid(stmt, 0, f->id);
+        db_column_uuid(stmt, 1, f->video_id);
+        snprintf(f->file_path, sizeof(f->file_path), "%s", (const char*)sqlite3_column_text(stmt, 2));
+        f->file_size = sqlite3_column_int64(stmt, 3);
+        f->bitrate_kbps = sqlite3_column_int(stmt, 4);
+        snprintf(f->resolution, sizeof(f->resolution), "%s", res ? res : "");
+        snprintf(f->content_hash, sizeof(f->content_hash), "%s", (const char*)sqlite3_column_text(stmt, 6));
+        (*count)++;
+    }
+    
+    if (rc != SQLITE_DONE) {
+        log_error("동영상 파일 조회 실패: %s", sqlite3_errmsg(db));
+        free(*files);
+        *files = NULL;
+        *count = 0;
     }
     
     sqlite3_finalize(stmt);
-    db_release_connection(db);
-    return 0;
+    db_release_read_connection(db);
+    return (rc == SQLITE_DONE) ? 0 : -1;
 }
 
 // Thumbnail operations
-int db_create_thumbnail(const char *video_id, const char *file_path, int width, int height, ott_uuid_t out_id) {
+// (pack_id, pack_offset, pack_length) 세 열을 읽는다 (개별 파일이면 모두 0)
+static void db_read_pack_ref(sqlite3_stmt *stmt, int col, thumb_pack_ref_t *ref) {
+    ref->pack_id = sqlite3_column_int(stmt, col);
+    ref->offset = sqlite3_column_int64(stmt, col + 1);
+    ref->length = sqlite3_column_int(stmt, col + 2);
+}
+
+static void db_bind_pack_ref(sqlite3_stmt *stmt, int idx, const thumb_pack_ref_t *ref) {
+    if (ref != NULL && ref->pack_id > 0) {
+        sqlite3_bind_int(stmt, idx, ref->pack_id);
+        sqlite3_bind_int64(stmt, idx + 1, ref->offset);
+        sqlite3_bind_int(stmt, idx + 2, ref->length);
+    } else {
+        sqlite3_bind_null(stmt, idx);
+        sqlite3_bind_null(stmt, idx + 1);
+        sqlite3_bind_null(stmt, idx + 2);
+    }
+}
+
+int db_create_thumbnail(const char *video_id, const char *file_path, int width, int height,
+                        const char *mime_type, ott_uuid_t out_id) {
     sqlite3 *db = db_get_connection();
     
-    uuid_generate(out_id);
+    uuid_generate_v7(out_id);
     
-    const char *sql = "INSERT INTO thumbnails (id, video_id, file_path, width, height) VALUES (?, ?, ?, ?, ?)";
+    const char *sql = "INSERT INTO thumbnails (id, video_id, file_path, width, height, mime_type) "
+                      "VALUES (?, ?, ?, ?, ?, coalesce(?, 'image/jpeg'))";
     sqlite3_stmt *stmt;
     
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_text(stmt, 1, out_id, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, video_id, -1, SQLITE_STATIC);
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("썸네일 추가 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
+        return -1;
+    }
+    db_bind_uuid(stmt, 1, out_id);
+    db_bind_uuid(stmt, 2, video_id);
     sqlite3_bind_text(stmt, 3, file_path, -1, SQLITE_STATIC);
     sqlite3_bind_int(stmt, 4, width);
     sqlite3_bind_int(stmt, 5, height);
+    sqlite3_bind_text(stmt, 6, mime_type, -1, SQLITE_STATIC);
     
     int rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
@@ -448,53 +862,128 @@ int db_create_thumbnail(const char *video_id, const char *file_path, int width,
 }
 
 int db_get_thumbnail(const char *video_id, thumbnail_t *thumbnail) {
-    sqlite3 *db = db_get_connection();
+    sqlite3 *db = db_get_read_connection();
     
-    const char *sql = "SELECT id, video_id, file_path, width, height FROM thumbnails WHERE video_id = ? LIMIT 1";
+    const char *sql = "SELECT id, video_id, file_path, width, height, mime_type, "
+                      "coalesce(pack_id, 0), coalesce(pack_offset, 0), coalesce(pack_length, 0) "
+                      "FROM thumbnails WHERE video_id = ? LIMIT 1";
     sqlite3_stmt *stmt;
     
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_text(stmt, 1, video_id, -1, SQLITE_STATIC);
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("썸네일 조회 실패: %s", sqlite3_errmsg(db));
+        db_release_read_connection(db);
+        return -1;
+    }
+    db_bind_uuid(stmt, 1, video_id);
     
     int rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
-        strncpy(thumbnail->id, (const char*)sqlite3_column_text(stmt, 0), sizeof(thumbnail->id) - 1);
-        strncpy(thumbnail->video_id, (const char*)sqlite3_column_text(stmt, 1), sizeof(thumbnail->video_id) - 1);
+        db_column_uuid(stmt, 0, thumbnail->id);
+        db_column_uuid(stmt, 1, thumbnail->video_id);
         strncpy(thumbnail->file_path, (const char*)sqlite3_column_text(stmt, 2), sizeof(thumbnail->file_path) - 1);
         thumbnail->width = sqlite3_column_int(stmt, 3);
         thumbnail->height = sqlite3_column_int(stmt, 4);
+        snprintf(thumbnail->mime_type, sizeof(thumbnail->mime_type), "%s", (const char*)sqlite3_column_text(stmt, 5));
+        db_read_pack_ref(stmt, 6, &thumbnail->pack);
         
         sqlite3_finalize(stmt);
-        db_release_connection(db);
+        db_release_read_connection(db);
         return 0;
     }
     
     sqlite3_finalize(stmt);
-    db_release_connection(db);
+    db_release_read_connection(db);
     return -1;
 }
 
-// Watch history operations
-int db_upsert_watch_history(const char *user_id, const char *video_id, int position_sec, bool completed) {
-    sqlite3 *db = db_get_connection();
-    
-    const char *sql = "INSERT INTO watch_history (id, user_id, video_id, last_position_sec, completed) "
-                      "VALUES (?, ?, ?, ?, ?) "
-                      "ON CONFLICT(user_id, video_id) DO UPDATE SET "
-                      "last_position_sec = excluded.last_position_sec, "
-                      "completed = excluded.completed, "
-                      "updated_at = datetime('now')";
-    
-    ott_uuid_t id;
-    uuid_generate(id);
-    
+int db_scan_pack_thumbnails(int32_t pack_id, int (*visit)(void *ctx, const thumbnail_t *thumbnail), void *ctx) {
+    sqlite3 *db = db_get_read_connection();
+    
+    const char *sql = (pack_id > 0)
+        ? "SELECT id, video_id, file_path, width, height, mime_type, pack_id, pack_offset, pack_length "
+          "FROM thumbnails WHERE pack_id = ? ORDER BY pack_offset"
+        : "SELECT id, video_id, file_path, width, height, mime_type, 0, 0, 0 "
+          "FROM thumbnails WHERE pack_id IS NULL";
     sqlite3_stmt *stmt;
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_text(stmt, 1, id, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, user_id, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 3, video_id, -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 4, position_sec);
-    sqlite3_bind_int(stmt, 5, completed ? 1 : 0);
+    
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("팩 썸네일 조회 실패: %s", sqlite3_errmsg(db));
+        db_release_read_connection(db);
+        return -1;
+    }
+    if (pack_id > 0) {
+        sqlite3_bind_int(stmt, 1, pack_id);
+    }
+    
+    int rc;
+    thumbnail_t thumb;
+    memset(&thumb, 0, sizeof(thumb));
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        db_column_uuid(stmt, 0, thumb.id);
+        db_column_uuid(stmt, 1, thumb.video_id);
+        snprintf(thumb.file_path, sizeof(thumb.file_path), "%s", (const char*)sqlite3_column_text(stmt, 2));
+        thumb.width = sqlite3_column_int(stmt, 3);
+        thumb.height = sqlite3_column_int(stmt, 4);
+        snprintf(thumb.mime_type, sizeof(thumb.mime_type), "%s", (const char*)sqlite3_column_text(stmt, 5));
+        db_read_pack_ref(stmt, 6, &thumb.pack);
+        if (visit(ctx, &thumb) < 0) {
+            rc = SQLITE_DONE;
+            break;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    db_release_read_connection(db);
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_scan_pack_usage(int (*visit)(void *ctx, int32_t pack_id, int64_t live_bytes), void *ctx) {
+    sqlite3 *db = db_get_read_connection();
+    
+    const char *sql = "SELECT pack_id, sum(pack_length) FROM thumbnails WHERE pack_id IS NOT NULL GROUP BY pack_id";
+    sqlite3_stmt *stmt;
+    
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("팩 사용량 조회 실패: %s", sqlite3_errmsg(db));
+        db_release_read_connection(db);
+        return -1;
+    }
+    
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (visit(ctx, sqlite3_column_int(stmt, 0), sqlite3_column_int64(stmt, 1)) < 0) {
+            rc = SQLITE_DONE;
+            break;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    db_release_read_connection(db);
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+// Trickplay operations
+int db_save_trickplay(const trickplay_t *trickplay) {
+    sqlite3 *db = db_get_connection();
+    
+    const char *sql = "INSERT OR REPLACE INTO trickplay (video_id, path_prefix, mime_type, interval_ms, "
+                      "tile_width, tile_height, columns, rows, tile_count) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)";
+    sqlite3_stmt *stmt;
+    
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("트릭플레이 저장 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
+        return -1;
+    }
+    db_bind_uuid(stmt, 1, trickplay->video_id);
+    sqlite3_bind_text(stmt, 2, trickplay->path_prefix, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, trickplay->mime_type, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, trickplay->interval_ms);
+    sqlite3_bind_int(stmt, 5, trickplay->tile_width);
+    sqlite3_bind_int(stmt, 6, trickplay->tile_height);
+    sqlite3_bind_int(stmt, 7, trickplay->columns);
+    sqlite3_bind_int(stmt, 8, trickplay->rows);
+    sqlite3_bind_int(stmt, 9, trickplay->tile_count);
     
     int rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
@@ -503,30 +992,758 @@ int db_upsert_watch_history(const char *user_id, const char *video_id, int posit
     return (rc == SQLITE_DONE) ? 0 : -1;
 }
 
-int db_get_watch_history(const char *user_id, const char *video_id, watch_history_t *history) {
+int db_get_trickplay(const char *video_id, trickplay_t *trickplay) {
+    sqlite3 *db = db_get_read_connection();
+    
+    const char *sql = "SELECT path_prefix, mime_type, interval_ms, tile_width, tile_height, columns, rows, "
+                      "tile_count FROM trickplay WHERE video_id = ?";
+    sqlite3_stmt *stmt;
+    
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("트릭플레이 조회 실패: %s", sqlite3_errmsg(db));
+        db_release_read_connection(db);
+        return -1;
+    }
+    db_bind_uuid(stmt, 1, video_id);
+    
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        snprintf(trickplay->video_id, sizeof(trickplay->video_id), "%s", video_id);
+        snprintf(trickplay->path_prefix, sizeof(trickplay->path_prefix), "%s", (const char*)sqlite3_column_text(stmt, 0));
+        snprintf(trickplay->mime_type, sizeof(trickplay->mime_type), "%s", (const char*)sqlite3_column_text(stmt, 1));
+        trickplay->interval_ms = sqlite3_column_int(stmt, 2);
+        trickplay->tile_width = sqlite3_column_int(stmt, 3);
+        trickplay->tile_height = sqlite3_column_int(stmt, 4);
+        trickplay->columns = sqlite3_column_int(stmt, 5);
+        trickplay->rows = sqlite3_column_int(stmt, 6);
+        trickplay->tile_count = sqlite3_column_int(stmt, 7);
+    }
+    
+    sqlite3_finalize(stmt);
+    db_release_read_connection(db);
+    return (rc == SQLITE_ROW) ? 0 : -1;
+}
+
+// Transcode job operations
+int db_enqueue_transcode(const char *video_id, const char *rung, int height, int bitrate_kbps) {
     sqlite3 *db = db_get_connection();
     
-    const char *sql = "SELECT id, user_id, video_id, last_position_sec, completed FROM watch_history WHERE user_id = ? AND video_id = ?";
+    const char *sql = "INSERT OR IGNORE INTO transcode_jobs (video_id, rung, height, bitrate_kbps) VALUES (?, ?, ?, ?)";
     sqlite3_stmt *stmt;
     
-    sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
-    sqlite3_bind_text(stmt, 1, user_id, -1, SQLITE_STATIC);
-    sqlite3_bind_text(stmt, 2, video_id, -1, SQLITE_STATIC);
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("트랜스코딩 작업 등록 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
+        return -1;
+    }
+    db_bind_uuid(stmt, 1, video_id);
+    sqlite3_bind_text(stmt, 2, rung, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, height);
+    sqlite3_bind_int(stmt, 4, bitrate_kbps);
+    
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    db_release_connection(db);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_transcode_requeue_running(void) {
+    sqlite3 *db = db_get_connection();
+    
+    int rc = sqlite3_exec(db, "UPDATE transcode_jobs SET state = 'queued', attempts = attempts - 1, progress = 0, "
+                              "updated_at = unixepoch() WHERE state = 'running'", NULL, NULL, NULL);
+    int changed = (rc == SQLITE_OK) ? sqlite3_changes(db) : -1;
+    db_release_connection(db);
+    
+    return changed;
+}
+
+int db_transcode_claim(transcode_job_t *job) {
+    sqlite3 *db = db_get_connection();
+    
+    // 조회와 상태 변경을 한 문장으로 (작업을 가져가는 쪽이 여럿이어도 같은 작업을 두 번 가져가지 않는다)
+    const char *claim_sql =
+        "UPDATE transcode_jobs SET state = 'running', attempts = attempts + 1, progress = 0, error = NULL, "
+        "updated_at = unixepoch() "
+        "WHERE id = (SELECT id FROM transcode_jobs WHERE state = 'queued' AND not_before <= unixepoch() "
+        "            ORDER BY not_before, id LIMIT 1) "
+        "RETURNING id, video_id, rung, height, bitrate_kbps, attempts";
+    const char *source_sql =
+        "SELECT f.file_path, v.duration_sec FROM video_files f JOIN videos v ON v.id = f.video_id "
+        "WHERE f.video_id = ? ORDER BY f.rowid LIMIT 1";
+    sqlite3_stmt *stmt;
     
+    memset(job, 0, sizeof(*job));
+    if (sqlite3_prepare_v2(db, claim_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("트랜스코딩 작업 조회 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
+        return -1;
+    }
     int rc = sqlite3_step(stmt);
     if (rc == SQLITE_ROW) {
-        strncpy(history->id, (const char*)sqlite3_column_text(stmt, 0), sizeof(history->id) - 1);
-        strncpy(history->user_id, (const char*)sqlite3_column_text(stmt, 1), sizeof(history->user_id) - 1);
-        strncpy(history->video_id, (const char*)sqlite3_column_text(stmt, 2), sizeof(history->video_id) - 1);
-        history->last_position_sec = sqlite3_column_int(stmt, 3);
-        history->completed = sqlite3_column_int(stmt, 4) == 1;
-        
-        sqlite3_finalize(stmt);
+        job->id = sqlite3_column_int64(stmt, 0);
+        db_column_uuid(stmt, 1, job->video_id);
+        snprintf(job->rung, sizeof(job->rung), "%s", (const char*)sqlite3_column_text(stmt, 2));
+        job->height = sqlite3_column_int(stmt, 3);
+        job->bitrate_kbps = sqlite3_column_int(stmt, 4);
+        job->attempts = sqlite3_column_int(stmt, 5);
+        snprintf(job->state, sizeof(job->state), "running");
+        // RETURNING 문장은 끝까지 실행해야 변경이 확정된다
+        rc = sqlite3_step(stmt);
+    }
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        log_error("트랜스코딩 작업 조회 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
+        return -1;
+    }
+    if (job->id == 0) {
         db_release_connection(db);
         return 0;
     }
     
+    if (sqlite3_prepare_v2(db, source_sql, -1, &stmt, NULL) != SQLITE_OK) {
+        // 원본 경로 없이 넘기면 작업이 바로 failed가 되므로 가져간 작업을 대기열로 돌려놓는다
+        log_error("트랜스코딩 원본 조회 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
+        db_transcode_release(job->id);
+        return -1;
+    }
+    db_bind_uuid(stmt, 1, job->video_id);
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        snprintf(job->source_path, sizeof(job->source_path), "%s", (const char*)sqlite3_column_text(stmt, 0));
+        job->duration_sec = sqlite3_column_double(stmt, 1);
+    }
+    sqlite3_finalize(stmt);
+    db_release_connection(db);
+    
+    return 1;
+}
+
+int db_transcode_set_progress(int64_t job_id, double progress) {
+    sqlite3 *db = db_get_connection();
+    
+    const char *sql = "UPDATE transcode_jobs SET progress = ?, updated_at = unixepoch() WHERE id = ?";
+    sqlite3_stmt *stmt;
+    
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("트랜스코딩 진행률 갱신 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
+        return -1;
+    }
+    sqlite3_bind_double(stmt, 1, progress);
+    sqlite3_bind_int64(stmt, 2, job_id);
+    
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    db_release_connection(db);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_transcode_complete(const transcode_job_t *job, const char *file_path, int64_t file_size,
+                          int bitrate_kbps, const char *resolution, const char *video_codec,
+                          const char *audio_codec, const char *content_hash) {
+    sqlite3 *db = db_get_connection();
+    
+    ott_uuid_t file_id;
+    uuid_generate_v7(file_id);
+    
+    sqlite3_exec(db, "BEGIN IMMEDIATE", NULL, NULL, NULL);
+    int rc = db_insert_video_file(db, job->video_id, file_path, file_size, bitrate_kbps, resolution,
+                                  video_codec, audio_codec, content_hash, file_id);
+    if (rc == 0) {
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(db, "UPDATE transcode_jobs SET state = 'done', progress = 1, error = NULL, "
+                                   "updated_at = unixepoch() WHERE id = ?", -1, &stmt, NULL) != SQLITE_OK) {
+            log_error("트랜스코딩 완료 기록 실패: %s", sqlite3_errmsg(db));
+            rc = -1;
+        } else {
+            sqlite3_bind_int64(stmt, 1, job->id);
+            rc = (sqlite3_step(stmt) == SQLITE_DONE) ? 0 : -1;
+            sqlite3_finalize(stmt);
+        }
+    }
+    sqlite3_exec(db, rc == 0 ? "COMMIT" : "ROLLBACK", NULL, NULL, NULL);
+    db_release_connection(db);
+    
+    return rc;
+}
+
+int db_transcode_fail(int64_t job_id, const char *error, int max_attempts, int retry_delay_sec) {
+    sqlite3 *db = db_get_connection();
+    
+    // 재시도 간격은 시도할 때마다 두 배 (attempts는 이미 이번 시도를 포함)
+    const char *sql =
+        "UPDATE transcode_jobs SET state = CASE WHEN attempts >= ?1 THEN 'failed' ELSE 'queued' END, "
+        "error = ?2, progress = 0, not_before = unixepoch() + ?3 * (1 << min(attempts - 1, 10)), "
+        "updated_at = unixepoch() WHERE id = ?4";
+    sqlite3_stmt *stmt;
+    
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("트랜스코딩 실패 기록 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
+        return -1;
+    }
+    sqlite3_bind_int(stmt, 1, max_attempts);
+    sqlite3_bind_text(stmt, 2, error, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, retry_delay_sec);
+    sqlite3_bind_int64(stmt, 4, job_id);
+    
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    db_release_connection(db);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_transcode_release(int64_t job_id) {
+    sqlite3 *db = db_get_connection();
+    
+    const char *sql = "UPDATE transcode_jobs SET state = 'queued', attempts = attempts - 1, progress = 0, "
+                      "updated_at = unixepoch() WHERE id = ? AND state = 'running'";
+    sqlite3_stmt *stmt;
+    
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("트랜스코딩 작업 반환 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
+        return -1;
+    }
+    sqlite3_bind_int64(stmt, 1, job_id);
+    
+    int rc = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+    db_release_connection(db);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_scan_transcode_jobs(const char *video_id, int (*visit)(void *ctx, const transcode_job_t *job), void *ctx) {
+    sqlite3 *db = db_get_read_connection();
+    
+    const char *sql = "SELECT id, rung, height, bitrate_kbps, state, attempts, progress, coalesce(error, '') "
+                      "FROM transcode_jobs WHERE video_id = ? ORDER BY height DESC";
+    sqlite3_stmt *stmt;
+    
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("트랜스코딩 작업 목록 조회 실패: %s", sqlite3_errmsg(db));
+        db_release_read_connection(db);
+        return -1;
+    }
+    db_bind_uuid(stmt, 1, video_id);
+    
+    int rc;
+    transcode_job_t job;
+    memset(&job, 0, sizeof(job));
+    snprintf(job.video_id, sizeof(job.video_id), "%s", video_id);
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        job.id = sqlite3_column_int64(stmt, 0);
+        snprintf(job.rung, sizeof(job.rung), "%s", (const char*)sqlite3_column_text(stmt, 1));
+        job.height = sqlite3_column_int(stmt, 2);
+        job.bitrate_kbps = sqlite3_column_int(stmt, 3);
+        snprintf(job.state, sizeof(job.state), "%s", (const char*)sqlite3_column_text(stmt, 4));
+        job.attempts = sqlite3_column_int(stmt, 5);
+        job.progress = sqlite3_column_double(stmt, 6);
+        snprintf(job.error, sizeof(job.error), "%s", (const char*)sqlite3_column_text(stmt, 7));
+        if (visit(ctx, &job) < 0) {
+            rc = SQLITE_DONE;
+            break;
+        }
+    }
+    
+    sqlite3_finalize(stmt);
+    db_release_read_connection(db);
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+// Batch ingest operations
+static void db_batch_finish(db_batch_t *batch, const char *sql) {
+    sqlite3_finalize(batch->insert_video);
+    sqlite3_finalize(batch->insert_file);
+    sqlite3_finalize(batch->insert_blob);
+    sqlite3_finalize(batch->insert_thumbnail);
+    sqlite3_finalize(batch->insert_trickplay);
+    sqlite3_finalize(batch->insert_source);
+    sqlite3_finalize(batch->insert_transcode);
+    sqlite3_finalize(batch->move_thumbnail);
+    
+    if (sqlite3_exec(batch->db, sql, NULL, NULL, NULL) != SQLITE_OK) {
+        log_error("배치 종료 실패 (%s): %s", sql, sqlite3_errmsg(batch->db));
+        batch->failed = true;
+        // COMMIT이 실패해 트랜잭션이 열려 있으면 쓰기 연결을 놓기 전에 같은 핸들에서 롤백한다.
+        // 놓은 뒤에 하면 그 사이 다른 쓰기 스레드가 열린 트랜잭션 안에서 실행되고 함께 버려진다
+        if (!sqlite3_get_autocommit(batch->db)) {
+            sqlite3_exec(batch->db, "ROLLBACK", NULL, NULL, NULL);
+        }
+    }
+    
+    db_release_connection(batch->db);
+    batch->db = NULL;
+}
+
+int db_batch_begin(db_batch_t *batch) {
+    memset(batch, 0, sizeof(*batch));
+    batch->db = db_get_connection();
+    
+    // IMMEDIATE: 배치 시작 시점에 쓰기 잠금을 잡아 중간에 SQLITE_BUSY로 실패하지 않도록 한다
+    int rc = sqlite3_exec(batch->db, "BEGIN IMMEDIATE", NULL, NULL, NULL);
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v3(batch->db,
+            "INSERT INTO videos (id, title, description, duration_sec, mime_type) "
+            "VALUES (?, ?, ?, ?, coalesce(?, 'video/mp4'))",
+            -1, SQLITE_PREPARE_PERSISTENT, &batch->insert_video, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v3(batch->db,
+            "INSERT INTO video_files (id, video_id, file_path, file_size, bitrate_kbps, resolution, "
+            "video_codec, audio_codec, content_hash) VALUES (?, ?, ?, ?, ?, ?, ?, ?, unhex(?))",
+            -1, SQLITE_PREPARE_PERSISTENT, &batch->insert_file, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v3(batch->db, DB_INSERT_BLOB_SQL, -1, SQLITE_PREPARE_PERSISTENT,
+                                &batch->insert_blob, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v3(batch->db,
+            "INSERT INTO thumbnails (id, video_id, file_path, width, height, mime_type, "
+            "pack_id, pack_offset, pack_length) VALUES (?, ?, ?, ?, ?, coalesce(?, 'image/jpeg'), ?, ?, ?)",
+            -1, SQLITE_PREPARE_PERSISTENT, &batch->insert_thumbnail, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v3(batch->db,
+            "INSERT OR REPLACE INTO trickplay (video_id, path_prefix, mime_type, interval_ms, "
+            "tile_width, tile_height, columns, rows, tile_count) VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?)",
+            -1, SQLITE_PREPARE_PERSISTENT, &batch->insert_trickplay, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v3(batch->db,
+            "INSERT OR IGNORE INTO ingest_sources (source_path, video_id) VALUES (?, ?)",
+            -1, SQLITE_PREPARE_PERSISTENT, &batch->insert_source, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v3(batch->db,
+            "INSERT OR IGNORE INTO transcode_jobs (video_id, rung, height, bitrate_kbps) VALUES (?, ?, ?, ?)",
+            -1, SQLITE_PREPARE_PERSISTENT, &batch->insert_transcode, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        // 옮기는 동안 행이 바뀌었으면(다시 생성, 삭제) 건드리지 않는다
+        rc = sqlite3_prepare_v3(batch->db,
+            "UPDATE thumbnails SET file_path = '', pack_id = ?, pack_offset = ?, pack_length = ? "
+            "WHERE id = ? AND pack_id IS ? AND pack_offset IS ?",
+            -1, SQLITE_PREPARE_PERSISTENT, &batch->move_thumbnail, NULL);
+    }
+    
+    if (rc != SQLITE_OK) {
+        log_error("배치 시작 실패: %s", sqlite3_errmsg(batch->db));
+        db_batch_finish(batch, "ROLLBACK");
+        return -1;
+    }
+    
+    return 0;
+}
+
+static int db_batch_step(db_batch_t *batch, sqlite3_stmt *stmt) {
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    
+    if (rc != SQLITE_DONE) {
+        log_error("배치 행 삽입 실패: %s", sqlite3_errmsg(batch->db));
+        batch->failed = true;
+        return -1;
+    }
+    
+    batch->row_count++;
+    return 0;
+}
+
+int db_batch_add_video(db_batch_t *batch, const char *title, const char *description,
+                       int duration_sec, const char *mime_type, ott_uuid_t out_id) {
+    uuid_generate_v7(out_id);
+    return db_batch_add_video_id(batch, out_id, title, description, duration_sec, mime_type);
+}
+
+int db_batch_add_video_id(db_batch_t *batch, const char *video_id, const char *title,
+                          const char *description, int duration_sec, const char *mime_type) {
+    if (batch->db == NULL || batch->failed) {
+        return -1;
+    }
+    
+    sqlite3_stmt *stmt = batch->insert_video;
+    db_bind_uuid(stmt, 1, video_id);
+    sqlite3_bind_text(stmt, 2, title, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, description, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, duration_sec);
+    sqlite3_bind_text(stmt, 5, mime_type, -1, SQLITE_STATIC);
+    
+    return db_batch_step(batch, stmt);
+}
+
+int db_batch_add_video_file(db_batch_t *batch, const char *video_id, const char *file_path,
+                            int64_t file_size, int bitrate_kbps, const char *resolution,
+                            const char *video_codec, const char *audio_codec, const char *content_hash,
+                            ott_uuid_t out_id) {
+    if (batch->db == NULL || batch->failed) {
+        return -1;
+    }
+    
+    uuid_generate_v7(out_id);
+    
+    // 참조 횟수는 video_files 트리거가 올리므로 저장소 행이 먼저 있어야 한다
+    if (content_hash != NULL) {
+        sqlite3_stmt *blob = batch->insert_blob;
+        sqlite3_bind_text(blob, 1, content_hash, -1, SQLITE_STATIC);
+        sqlite3_bind_text(blob, 2, file_path, -1, SQLITE_STATIC);
+        sqlite3_bind_int64(blob, 3, file_size);
+        if (db_batch_step(batch, blob) < 0) {
+            return -1;
+        }
+    }
+    
+    sqlite3_stmt *stmt = batch->insert_file;
+    db_bind_uuid(stmt, 1, out_id);
+    db_bind_uuid(stmt, 2, video_id);
+    sqlite3_bind_text(stmt, 3, file_path, -1, SQLITE_STATIC);
+    sqlite3_bind_int64(stmt, 4, file_size);
+    sqlite3_bind_int(stmt, 5, bitrate_kbps);
+    sqlite3_bind_text(stmt, 6, resolution, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 7, video_codec, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 8, audio_codec, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 9, content_hash, -1, SQLITE_STATIC);
+    
+    return db_batch_step(batch, stmt);
+}
+
+int db_batch_add_thumbnail(db_batch_t *batch, const char *video_id, const char *file_path,
+                           int width, int height, const char *mime_type, const thumb_pack_ref_t *pack,
+                           ott_uuid_t out_id) {
+    if (batch->db == NULL || batch->failed) {
+        return -1;
+    }
+    
+    uuid_generate_v7(out_id);
+    
+    sqlite3_stmt *stmt = batch->insert_thumbnail;
+    db_bind_uuid(stmt, 1, out_id);
+    db_bind_uuid(stmt, 2, video_id);
+    sqlite3_bind_text(stmt, 3, file_path, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, width);
+    sqlite3_bind_int(stmt, 5, height);
+    sqlite3_bind_text(stmt, 6, mime_type, -1, SQLITE_STATIC);
+    db_bind_pack_ref(stmt, 7, pack);
+    
+    return db_batch_step(batch, stmt);
+}
+
+int db_batch_move_thumbnail(db_batch_t *batch, const char *thumbnail_id, const thumb_pack_ref_t *from,
+                            const thumb_pack_ref_t *to) {
+    if (batch->db == NULL || batch->failed) {
+        return -1;
+    }
+    
+    sqlite3_stmt *stmt = batch->move_thumbnail;
+    db_bind_pack_ref(stmt, 1, to);
+    db_bind_uuid(stmt, 4, thumbnail_id);
+    if (from->pack_id > 0) {
+        sqlite3_bind_int(stmt, 5, from->pack_id);
+        sqlite3_bind_int64(stmt, 6, from->offset);
+    }
+    
+    return db_batch_step(batch, stmt);
+}
+
+int db_batch_add_trickplay(db_batch_t *batch, const trickplay_t *trickplay) {
+    if (batch->db == NULL || batch->failed) {
+        return -1;
+    }
+    
+    sqlite3_stmt *stmt = batch->insert_trickplay;
+    db_bind_uuid(stmt, 1, trickplay->video_id);
+    sqlite3_bind_text(stmt, 2, trickplay->path_prefix, -1, SQLITE_STATIC);
+    sqlite3_bind_text(stmt, 3, trickplay->mime_type, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 4, trickplay->interval_ms);
+    sqlite3_bind_int(stmt, 5, trickplay->tile_width);
+    sqlite3_bind_int(stmt, 6, trickplay->tile_height);
+    sqlite3_bind_int(stmt, 7, trickplay->columns);
+    sqlite3_bind_int(stmt, 8, trickplay->rows);
+    sqlite3_bind_int(stmt, 9, trickplay->tile_count);
+    
+    return db_batch_step(batch, stmt);
+}
+
+int db_batch_add_ingest_source(db_batch_t *batch, const char *source_path, const char *video_id) {
+    if (batch->db == NULL || batch->failed) {
+        return -1;
+    }
+    
+    sqlite3_stmt *stmt = batch->insert_source;
+    sqlite3_bind_text(stmt, 1, source_path, -1, SQLITE_STATIC);
+    db_bind_uuid(stmt, 2, video_id);
+    
+    return db_batch_step(batch, stmt);
+}
+
+int db_batch_add_transcode(db_batch_t *batch, const char *video_id, const char *rung, int height,
+                           int bitrate_kbps) {
+    if (batch->db == NULL || batch->failed) {
+        return -1;
+    }
+    
+    sqlite3_stmt *stmt = batch->insert_transcode;
+    db_bind_uuid(stmt, 1, video_id);
+    sqlite3_bind_text(stmt, 2, rung, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, height);
+    sqlite3_bind_int(stmt, 4, bitrate_kbps);
+    
+    return db_batch_step(batch, stmt);
+}
+
+int db_batch_commit(db_batch_t *batch) {
+    if (batch->db == NULL) {
+        return -1;
+    }
+    
+    if (batch->failed) {
+        log_error("배치에 실패한 행이 있어 %d개 행을 롤백합니다", batch->row_count);
+        db_batch_finish(batch, "ROLLBACK");
+        return -1;
+    }
+    
+    db_batch_finish(batch, "COMMIT");
+    return batch->failed ? -1 : 0;
+}
+
+void db_batch_rollback(db_batch_t *batch) {
+    if (batch->db != NULL) {
+        db_batch_finish(batch, "ROLLBACK");
+    }
+}
+
+// Ingest progress
+int db_scan_ingest_sources(int (*visit)(void *ctx, const char *source_path), void *ctx) {
+    sqlite3 *db = db_get_read_connection();
+    
+    sqlite3_stmt *stmt;
+    int rc = sqlite3_prepare_v2(db, "SELECT source_path FROM ingest_sources", -1, &stmt, NULL);
+    if (rc == SQLITE_OK) {
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            if (visit(ctx, (const char*)sqlite3_column_text(stmt, 0)) < 0) {
+                break;
+            }
+        }
+        rc = (rc == SQLITE_DONE) ? SQLITE_OK : SQLITE_ABORT;
+    }
+    if (rc != SQLITE_OK) {
+        log_error("등록 진행 상황 읽기 실패: %s", sqlite3_errmsg(db));
+    }
+    
+    sqlite3_finalize(stmt);
+    db_release_read_connection(db);
+    return (rc == SQLITE_OK) ? 0 : -1;
+}
+
+// Catalog snapshot operations
+int db_get_catalog_generation(int64_t *generation) {
+    sqlite3 *db = db_get_read_connection();
+    
+    const char *sql = "SELECT value FROM catalog_stats WHERE name = 'generation'";
+    sqlite3_stmt *stmt;
+    
+    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        db_release_read_connection(db);
+        return -1;
+    }
+    
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        *generation = sqlite3_column_int64(stmt, 0);
+    }
+    
+    sqlite3_finalize(stmt);
+    db_release_read_connection(db);
+    return (rc == SQLITE_ROW) ? 0 : -1;
+}
+
+int db_get_catalog_instance(int64_t *instance) {
+    sqlite3 *db = db_get_read_connection();
+    
+    const char *sql = "SELECT value FROM catalog_stats WHERE name = 'instance'";
+    sqlite3_stmt *stmt;
+    
+    int rc = sqlite3_prepare_v2(db, sql, -1, &stmt, NULL);
+    if (rc != SQLITE_OK) {
+        db_release_read_connection(db);
+        return -1;
+    }
+    
+    rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        *instance = sqlite3_column_int64(stmt, 0);
+    }
+    
+    sqlite3_finalize(stmt);
+    db_release_read_connection(db);
+    return (rc == SQLITE_ROW) ? 0 : -1;
+}
+
+int db_scan_catalog(const db_catalog_visitor_t *visitor, int64_t *generation) {
+    sqlite3 *db = db_get_read_connection();
+    
+    // 하나의 읽기 트랜잭션 안에서 세대 번호와 모든 행을 읽어 일관된 스냅샷을 만든다
+    const char *video_sql = "SELECT id, title, description, duration_sec, mime_type, created_at "
+                            "FROM videos ORDER BY created_at DESC, id DESC";
+    const char *file_sql = "SELECT id, video_id, file_path, file_size, bitrate_kbps, resolution, lower(hex(content_hash)) "
+                           "FROM video_files ORDER BY rowid";
+    const char *thumb_sql = "SELECT id, video_id, file_path, width, height, mime_type, "
+                            "coalesce(pack_id, 0), coalesce(pack_offset, 0), coalesce(pack_length, 0) "
+                            "FROM thumbnails ORDER BY rowid";
+    sqlite3_stmt *stmt = NULL;
+    int rc = sqlite3_exec(db, "BEGIN", NULL, NULL, NULL);
+    
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v2(db, "SELECT value FROM catalog_stats WHERE name = 'generation'", -1, &stmt, NULL);
+        if (rc == SQLITE_OK && sqlite3_step(stmt) == SQLITE_ROW) {
+            *generation = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v2(db, video_sql, -1, &stmt, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        db_catalog_video_t video;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            const char *title = (const char*)sqlite3_column_text(stmt, 1);
+            const char *desc = (const char*)sqlite3_column_text(stmt, 2);
+            const char *mime = (const char*)sqlite3_column_text(stmt, 4);
+            db_column_uuid(stmt, 0, video.id);
+            video.title = title ? title : "";
+            video.title_len = (size_t)sqlite3_column_bytes(stmt, 1);
+            video.description = desc ? desc : "";
+            video.description_len = (size_t)sqlite3_column_bytes(stmt, 2);
+            video.mime_type = mime ? mime : "video/mp4";
+            video.duration_sec = sqlite3_column_int(stmt, 3);
+            video.created_at = sqlite3_column_int64(stmt, 5);
+            if (visitor->video(visitor->ctx, &video) < 0) {
+                break;
+            }
+        }
+        sqlite3_finalize(stmt);
+        rc = (rc == SQLITE_DONE) ? SQLITE_OK : SQLITE_ABORT;
+    }
+    
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v2(db, file_sql, -1, &stmt, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        video_file_t file;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            const char *res = (const char*)sqlite3_column_text(stmt, 5);
+            db_column_uuid(stmt, 0, file.id);
+            db_column_uuid(stmt, 1, file.video_id);
+            snprintf(file.file_path, sizeof(file.file_path), "%s", (const char*)sqlite3_column_text(stmt, 2));
+            file.file_size = sqlite3_column_int64(stmt, 3);
+            file.bitrate_kbps = sqlite3_column_int(stmt, 4);
+            snprintf(file.resolution, sizeof(file.resolution), "%s", res ? res : "");
+            snprintf(file.content_hash, sizeof(file.content_hash), "%s", (const char*)sqlite3_column_text(stmt, 6));
+            if (visitor->file(visitor->ctx, &file) < 0) {
+                break;
+            }
+        }
+        sqlite3_finalize(stmt);
+        rc = (rc == SQLITE_DONE) ? SQLITE_OK : SQLITE_ABORT;
+    }
+    
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_prepare_v2(db, thumb_sql, -1, &stmt, NULL);
+    }
+    if (rc == SQLITE_OK) {
+        thumbnail_t thumb;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            db_column_uuid(stmt, 0, thumb.id);
+            db_column_uuid(stmt, 1, thumb.video_id);
+            snprintf(thumb.file_path, sizeof(thumb.file_path), "%s", (const char*)sqlite3_column_text(stmt, 2));
+            thumb.width = sqlite3_column_int(stmt, 3);
+            thumb.height = sqlite3_column_int(stmt, 4);
+            snprintf(thumb.mime_type, sizeof(thumb.mime_type), "%s", (const char*)sqlite3_column_text(stmt, 5));
+            db_read_pack_ref(stmt, 6, &thumb.pack);
+            if (visitor->thumbnail(visitor->ctx, &thumb) < 0) {
+                break;
+            }
+        }
+        sqlite3_finalize(stmt);
+        rc = (rc == SQLITE_DONE) ? SQLITE_OK : SQLITE_ABORT;
+    }
+    
+    if (rc != SQLITE_OK) {
+        log_error("카탈로그 스캔 실패: %s", sqlite3_errmsg(db));
+    }
+    
+    sqlite3_exec(db, "COMMIT", NULL, NULL, NULL);
+    db_release_read_connection(db);
+    return (rc == SQLITE_OK) ? 0 : -1;
+}
+
+// Watch history operations
+int db_upsert_watch_history(const char *user_id, const char *video_id, int position_sec, bool completed) {
+    sqlite3 *db = db_get_connection();
+    
+    const char *sql = "INSERT INTO watch_history (user_id, video_id, last_position_sec, completed) "
+                      "VALUES (?, ?, ?, ?) "
+                      "ON CONFLICT(user_id, video_id) DO UPDATE SET "
+                      "last_position_sec = excluded.last_position_sec, "
+                      "completed = excluded.completed, "
+                      "updated_at = unixepoch()";
+    
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("시청 이력 저장 실패: %s", sqlite3_errmsg(db));
+        db_release_connection(db);
+        return -1;
+    }
+    db_bind_uuid(stmt, 1, user_id);
+    db_bind_uuid(stmt, 2, video_id);
+    sqlite3_bind_int(stmt, 3, position_sec);
+    sqlite3_bind_int(stmt, 4, completed ? 1 : 0);
+    
+    int rc = sqlite3_step(stmt);
     sqlite3_finalize(stmt);
     db_release_connection(db);
+    
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+int db_get_watch_history(const char *user_id, const char *video_id, watch_history_t *history) {
+    sqlite3 *db = db_get_read_connection();
+    
+    const char *sql = "SELECT user_id, video_id, last_position_sec, completed, updated_at FROM watch_history WHERE user_id = ? AND video_id = ?";
+    sqlite3_stmt *stmt;
+    
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) {
+        log_error("시청 이력 조회 실패: %s", sqlite3_errmsg(db));
+        db_release_read_connection(db);
+        return -1;
+    }
+    db_bind_uuid(stmt, 1, user_id);
+    db_bind_uuid(stmt, 2, video_id);
+    
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        db_column_uuid(stmt, 0, history->user_id);
+        db_column_uuid(stmt, 1, history->video_id);
+        history->last_position_sec = sqlite3_column_int(stmt, 2);
+        history->completed = sqlite3_column_int(stmt, 3) == 1;
+        history->updated_at = (time_t)sqlite3_column_int64(stmt, 4);
+        
+        sqlite3_finalize(stmt);
+        db_release_read_connection(db);
+        return 0;
+    }
+    
+    sqlite3_finalize(stmt);
+    db_release_read_connection(db);
     return -1;
 }
@@ -0,0 +1,238 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sqlite3.h>
+#include "db_maint.h"
+#include "db.h"
+#include "config.h"
+#include "logger.h"
+
+typedef struct {
+    pthread_mutex_t mutex;
+    thread_pool_timer_t *timer;     // 백그라운드 풀의 주기 작업 (NULL이면 정지 상태)
+    time_t next_optimize;           // 주기 작업 안에서만 접근 (회차는 겹치지 않음)
+    sqlite3 *db;                    // 체크포인트/VACUUM 전용 연결
+    char wal_path[MAX_PATH_LEN];
+    db_maint_status_t status;       // mutex로 보호
+} db_maint_t;
+
+static db_maint_t maint = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER
+};
+
+static int64_t db_maint_wal_size(void) {
+    struct stat st;
+    return (stat(maint.wal_path, &st) == 0) ? (int64_t)st.st_size : 0;
+}
+
+static int64_t db_maint_pragma_int(const char *sql) {
+    sqlite3_stmt *stmt;
+    int64_t value = -1;
+
+    if (sqlite3_prepare_v2(maint.db, sql, -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            value = sqlite3_column_int64(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return value;
+}
+
+// PASSIVE는 읽기/쓰기를 막지 않고 가능한 만큼만 옮긴다.
+// WAL이 커졌으면 TRUNCATE로 파일을 0으로 줄인다 (짧은 busy timeout으로 요청을 오래 막지 않음).
+static void db_maint_checkpoint(bool force_truncate) {
+    int64_t wal_size = db_maint_wal_size();
+    bool truncate = force_truncate || wal_size > DB_WAL_TRUNCATE_BYTES;
+    int mode = truncate ? SQLITE_CHECKPOINT_TRUNCATE : SQLITE_CHECKPOINT_PASSIVE;
+    int wal_frames = 0, checkpointed = 0;
+
+    int rc = sqlite3_wal_checkpoint_v2(maint.db, NULL, mode, &wal_frames, &checkpointed);
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&maint.mutex);
+    maint.status.checkpoints++;
+    maint.status.last_checkpoint = now;
+    maint.status.last_wal_frames = wal_frames;
+    maint.status.last_checkpointed_frames = checkpointed;
+    if (rc == SQLITE_OK && truncate) {
+        maint.status.last_truncate = now;
+    }
+    if (rc == SQLITE_BUSY || (rc == SQLITE_OK && checkpointed < wal_frames)) {
+        maint.status.busy_checkpoints++;
+    }
+    maint.status.wal_size_bytes = db_maint_wal_size();
+    pthread_mutex_unlock(&maint.mutex);
+
+    if (rc != SQLITE_OK && rc != SQLITE_BUSY) {
+        log_error("WAL 체크포인트 실패: %s", sqlite3_errmsg(maint.db));
+    } else if (truncate) {
+        log_info("WAL TRUNCATE 체크포인트 (%lld bytes → %lld bytes)",
+                 (long long)wal_size, (long long)maint.status.wal_size_bytes);
+    }
+}
+
+static void db_maint_optimize(void) {
+    db_optimize();
+
+    int64_t freelist = db_maint_pragma_int("PRAGMA freelist_count");
+    int64_t vacuumed = 0;
+    bool incremental = db_maint_pragma_int("PRAGMA auto_vacuum") == 2;
+
+    if (incremental && freelist > 0) {
+        char sql[64];
+        snprintf(sql, sizeof(sql), "PRAGMA incremental_vacuum(%d)", DB_VACUUM_PAGES);
+        if (sqlite3_exec(maint.db, sql, NULL, NULL, NULL) == SQLITE_OK) {
+            int64_t after = db_maint_pragma_int("PRAGMA freelist_count");
+            vacuumed = (after >= 0) ? freelist - after : 0;
+            freelist = after;
+        } else {
+            log_error("증분 VACUUM 실패: %s", sqlite3_errmsg(maint.db));
+        }
+    }
+
+    time_t now = time(NULL);
+    pthread_mutex_lock(&maint.mutex);
+    maint.status.last_optimize = now;
+    maint.status.incremental_vacuum = incremental;
+    maint.status.freelist_pages = freelist;
+    if (incremental) {
+        maint.status.last_vacuum = now;
+        maint.status.vacuumed_pages += vacuumed;
+    }
+    pthread_mutex_unlock(&maint.mutex);
+
+    log_debug("DB 최적화 완료 (반환 페이지 %lld, 남은 빈 페이지 %lld)",
+              (long long)vacuumed, (long long)freelist);
+}
+
+// 참조가 0인 채로 유예 시간이 지난 내용 주소 저장 파일 회수
+// 행은 쓰기 잠금 안에서 지우고 (그 뒤에는 같은 해시를 새로 등록하면 행부터 다시 생긴다) 파일은 커밋 후에 지운다
+static void db_maint_reclaim_blobs(void) {
+    const char *sql = "DELETE FROM media_blobs WHERE refcount = 0 AND released_at <= unixepoch() - ? "
+                      "AND NOT EXISTS (SELECT 1 FROM video_files WHERE content_hash = media_blobs.hash) "
+                      "RETURNING file_path";
+    char (*paths)[MAX_PATH_LEN] = NULL;
+    int count = 0, cap = 0;
+    sqlite3_stmt *stmt;
+
+    if (sqlite3_exec(maint.db, "BEGIN IMMEDIATE", NULL, NULL, NULL) != SQLITE_OK) {
+        // 쓰기가 바쁘면 다음 회차에 다시 시도한다
+        return;
+    }
+    int rc = sqlite3_prepare_v2(maint.db, sql, -1, &stmt, NULL);
+    if (rc == SQLITE_OK) {
+        sqlite3_bind_int(stmt, 1, MEDIA_BLOB_RECLAIM_GRACE_SEC);
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            if (count == cap) {
+                int new_cap = cap > 0 ? cap * 2 : 16;
+                void *grown = realloc(paths, (size_t)new_cap * sizeof(*paths));
+                if (grown == NULL) {
+                    rc = SQLITE_NOMEM;
+                    break;
+                }
+                paths = grown;
+                cap = new_cap;
+            }
+            snprintf(paths[count++], MAX_PATH_LEN, "%s", (const char*)sqlite3_column_text(stmt, 0));
+        }
+        sqlite3_finalize(stmt);
+    }
+    if (rc != SQLITE_DONE || sqlite3_exec(maint.db, "COMMIT", NULL, NULL, NULL) != SQLITE_OK) {
+        log_error("저장 파일 회수 실패: %s", sqlite3_errmsg(maint.db));
+        sqlite3_exec(maint.db, "ROLLBACK", NULL, NULL, NULL);
+        free(paths);
+        return;
+    }
+
+    int64_t reclaimed = 0;
+    for (int i = 0; i < count; i++) {
+        if (unlink(paths[i]) == 0 || errno == ENOENT) {
+            reclaimed++;
+        } else {
+            log_warn("저장 파일을 지우지 못했습니다: %s (%s)", paths[i], strerror(errno));
+        }
+    }
+    free(paths);
+
+    if (count > 0) {
+        pthread_mutex_lock(&maint.mutex);
+        maint.status.reclaimed_blobs += reclaimed;
+        pthread_mutex_unlock(&maint.mutex);
+        log_info("참조 없는 저장 파일 %lld개 회수", (long long)reclaimed);
+    }
+}
+
+// 주기 작업 한 회차: 체크포인트, 주기가 되었으면 optimize/증분 VACUUM/저장 파일 회수
+static void db_maint_tick(void *arg) {
+    (void)arg;
+    db_maint_checkpoint(false);
+    if (time(NULL) >= maint.next_optimize) {
+        db_maint_optimize();
+        db_maint_reclaim_blobs();
+        maint.next_optimize = time(NULL) + DB_OPTIMIZE_INTERVAL_SEC;
+    }
+}
+
+int db_maint_start(const char *db_path, thread_pool_t *pool) {
+    snprintf(maint.wal_path, sizeof(maint.wal_path), "%s-wal", db_path);
+
+    int rc = sqlite3_open_v2(db_path, &maint.db, SQLITE_OPEN_READWRITE | SQLITE_OPEN_NOMUTEX, NULL);
+    if (rc != SQLITE_OK) {
+        log_error("유지보수 연결 열기 실패: %s", sqlite3_errmsg(maint.db));
+        sqlite3_close(maint.db);
+        maint.db = NULL;
+        return -1;
+    }
+    sqlite3_busy_timeout(maint.db, 100);
+
+    memset(&maint.status, 0, sizeof(maint.status));
+    maint.status.incremental_vacuum = db_maint_pragma_int("PRAGMA auto_vacuum") == 2;
+    maint.status.wal_size_bytes = db_maint_wal_size();
+    maint.next_optimize = time(NULL) + DB_OPTIMIZE_INTERVAL_SEC;
+
+    if (thread_pool_schedule_every(pool, DB_MAINT_INTERVAL_SEC * 1000, db_maint_tick, NULL,
+                                   TP_PRIORITY_BATCH, &maint.timer) < 0) {
+        log_error("유지보수 작업 예약 실패");
+        sqlite3_close(maint.db);
+        maint.db = NULL;
+        return -1;
+    }
+
+    // 체크포인트는 유지보수 작업이 전담한다 (예약에 성공한 뒤에만 꺼야 실패해도 WAL이 무한히 커지지 않는다)
+    sqlite3 *writer = db_get_connection();
+    sqlite3_exec(writer, "PRAGMA wal_autocheckpoint = 0;", NULL, NULL, NULL);
+    db_release_connection(writer);
+
+    log_info("DB 유지보수 시작 (체크포인트 %d초, 최적화 %d초 주기)",
+             DB_MAINT_INTERVAL_SEC, DB_OPTIMIZE_INTERVAL_SEC);
+    return 0;
+}
+
+void db_maint_stop(void) {
+    if (maint.timer == NULL) {
+        return;
+    }
+
+    // 실행 중인 회차가 있으면 끝날 때까지 기다린다
+    thread_pool_timer_cancel(maint.timer, true);
+    thread_pool_timer_release(maint.timer);
+    maint.timer = NULL;
+
+    // 종료 시 WAL을 비워 다음 시작이 빠르도록 한다
+    db_maint_checkpoint(true);
+    sqlite3_close(maint.db);
+    maint.db = NULL;
+
+    log_info("DB 유지보수 종료");
+}
+
+void db_maint_get_status(db_maint_status_t *status) {
+    pthread_mutex_lock(&maint.mutex);
+    *status = maint.status;
+    pthread_mutex_unlock(&maint.mutex);
+}
@@ -0,0 +1,252 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include "db_trace.h"
+#include "config.h"
+#include "logger.h"
+
+typedef struct {
+    _Atomic(char *) sql;
+    atomic_uint_fast64_t calls;
+    atomic_uint_fast64_t total_ns;
+    atomic_uint_fast64_t max_ns;
+    atomic_uint_fast64_t rows;
+    atomic_uint_fast64_t fullscan_steps;
+    atomic_uint_fast64_t sorts;
+    atomic_uint_fast64_t autoindexes;
+    atomic_uint_fast64_t wait_ns;
+    atomic_uint_fast64_t latency_hist[DB_TRACE_BUCKETS];
+    atomic_uint_fast64_t wait_hist[DB_TRACE_BUCKETS];
+} trace_entry_t;
+
+typedef struct {
+    atomic_uint_fast64_t acquires;
+    atomic_uint_fast64_t contended;
+    atomic_uint_fast64_t total_wait_ns;
+    atomic_uint_fast64_t max_wait_ns;
+    atomic_uint_fast64_t wait_hist[DB_TRACE_BUCKETS];
+} trace_pool_t;
+
+// 정적 테이블: 슬롯은 SQL 포인터를 CAS로 선점하며, 한 번 선점되면 바뀌지 않는다
+static trace_entry_t trace_entries[DB_TRACE_MAX_STATEMENTS];
+static trace_entry_t trace_overflow;
+static trace_pool_t trace_writer_pool;
+static trace_pool_t trace_reader_pool;
+
+// 현재 스레드에서 실행 중인 문장의 반환 행 수와 귀속 대기 시간
+// (연결은 한 번에 한 스레드만 사용하고 문장은 순차 실행되므로 스레드 로컬로 충분하다)
+static _Thread_local uint64_t tl_rows = 0;
+static _Thread_local uint64_t tl_pending_wait_ns = 0;
+
+uint64_t db_trace_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int db_trace_bucket(uint64_t ns) {
+    uint64_t us = ns / 1000;
+    if (us == 0) {
+        return 0;
+    }
+    int b = 64 - __builtin_clzll(us);
+    return (b < DB_TRACE_BUCKETS) ? b : DB_TRACE_BUCKETS - 1;
+}
+
+static void db_trace_update_max(atomic_uint_fast64_t *max, uint64_t value) {
+    uint64_t cur = atomic_load_explicit(max, memory_order_relaxed);
+    while (value > cur &&
+           !atomic_compare_exchange_weak_explicit(max, &cur, value,
+                                                  memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static uint32_t db_trace_hash(const char *s) {
+    uint32_t h = 2166136261u;
+    for (size_t i = 0; s[i] && i < DB_TRACE_SQL_LEN - 1; i++) {
+        h ^= (unsigned char)s[i];
+        h *= 16777619u;
+    }
+    return h;
+}
+
+static trace_entry_t* db_trace_find_entry(const char *sql) {
+    uint32_t start = db_trace_hash(sql) % DB_TRACE_MAX_STATEMENTS;
+
+    for (uint32_t i = 0; i < DB_TRACE_MAX_STATEMENTS; i++) {
+        trace_entry_t *e = &trace_entries[(start + i) % DB_TRACE_MAX_STATEMENTS];
+        char *cur = atomic_load_explicit(&e->sql, memory_order_acquire);
+
+        if (cur == NULL) {
+            size_t len = 0;
+            while (len < DB_TRACE_SQL_LEN - 1 && sql[len] != '\0') {
+                len++;
+            }
+            char *copy = malloc(len + 1);
+            if (copy == NULL) {
+                return &trace_overflow;
+            }
+            memcpy(copy, sql, len);
+            copy[len] = '\0';
+
+            if (atomic_compare_exchange_strong_explicit(&e->sql, &cur, copy,
+                                                        memory_order_acq_rel, memory_order_acquire)) {
+                return e;
+            }
+            free(copy);     // 다른 스레드가 먼저 선점함, cur에 그 SQL이 들어 있다
+        }
+
+        if (strncmp(cur, sql, DB_TRACE_SQL_LEN - 1) == 0) {
+            return e;
+        }
+    }
+
+    return &trace_overflow;
+}
+
+static void db_trace_profile(sqlite3_stmt *stmt, uint64_t elapsed_ns) {
+    const char *sql = sqlite3_sql(stmt);
+    if (sql == NULL) {
+        return;
+    }
+
+    uint64_t rows = tl_rows;
+    uint64_t wait_ns = tl_pending_wait_ns;
+    tl_rows = 0;
+    tl_pending_wait_ns = 0;
+
+    // 재사용되는 문장은 실행마다 카운터를 초기화해서 읽는다
+    int fullscan = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    int sorts = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1);
+    int autoindex = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+
+    trace_entry_t *e = db_trace_find_entry(sql);
+    atomic_fetch_add_explicit(&e->calls, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->total_ns, elapsed_ns, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->rows, rows, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->fullscan_steps, (uint64_t)fullscan, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->sorts, (uint64_t)sorts, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->autoindexes, (uint64_t)autoindex, memory_order_relaxed);
+    atomic_fetch_add_explicit(&e->latency_hist[db_trace_bucket(elapsed_ns)], 1, memory_order_relaxed);
+    db_trace_update_max(&e->max_ns, elapsed_ns);
+
+    if (wait_ns > 0) {
+        atomic_fetch_add_explicit(&e->wait_ns, wait_ns, memory_order_relaxed);
+        atomic_fetch_add_explicit(&e->wait_hist[db_trace_bucket(wait_ns)], 1, memory_order_relaxed);
+    }
+
+    if (elapsed_ns >= (uint64_t)DB_SLOW_QUERY_MS * 1000000ull) {
+        log_warn("느린 쿼리 %.1fms (rows=%llu, fullscan=%d, sort=%d, autoindex=%d, wait=%.1fms): %s",
+                 elapsed_ns / 1e6, (unsigned long long)rows, fullscan, sorts, autoindex,
+                 wait_ns / 1e6, sql);
+    }
+}
+
+static int db_trace_callback(unsigned int type, void *ctx, void *p, void *x) {
+    (void)ctx;
+
+    if (type == SQLITE_TRACE_ROW) {
+        tl_rows++;
+    } else if (type == SQLITE_TRACE_PROFILE) {
+        db_trace_profile((sqlite3_stmt*)p, (uint64_t)*(sqlite3_int64*)x);
+    }
+    return 0;
+}
+
+void db_trace_attach(sqlite3 *db) {
+    sqlite3_trace_v2(db, SQLITE_TRACE_PROFILE | SQLITE_TRACE_ROW, db_trace_callback, NULL);
+}
+
+void db_trace_record_wait(bool writer, bool contended, uint64_t wait_ns) {
+    trace_pool_t *pool = writer ? &trace_writer_pool : &trace_reader_pool;
+
+    atomic_fetch_add_explicit(&pool->acquires, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&pool->wait_hist[db_trace_bucket(wait_ns)], 1, memory_order_relaxed);
+    if (contended) {
+        atomic_fetch_add_explicit(&pool->contended, 1, memory_order_relaxed);
+        atomic_fetch_add_explicit(&pool->total_wait_ns, wait_ns, memory_order_relaxed);
+        db_trace_update_max(&pool->max_wait_ns, wait_ns);
+    }
+
+    tl_pending_wait_ns += wait_ns;
+}
+
+static void db_trace_copy_entry(const trace_entry_t *e, const char *sql, db_trace_stat_t *out) {
+    snprintf(out->sql, sizeof(out->sql), "%s", sql);
+    out->calls = atomic_load_explicit(&e->calls, memory_order_relaxed);
+    out->total_ns = atomic_load_explicit(&e->total_ns, memory_order_relaxed);
+    out->max_ns = atomic_load_explicit(&e->max_ns, memory_order_relaxed);
+    out->rows = atomic_load_explicit(&e->rows, memory_order_relaxed);
+    out->fullscan_steps = atomic_load_explicit(&e->fullscan_steps, memory_order_relaxed);
+    out->sorts = atomic_load_explicit(&e->sorts, memory_order_relaxed);
+    out->autoindexes = atomic_load_explicit(&e->autoindexes, memory_order_relaxed);
+    out->wait_ns = atomic_load_explicit(&e->wait_ns, memory_order_relaxed);
+    for (int i = 0; i < DB_TRACE_BUCKETS; i++) {
+        out->latency_hist[i] = atomic_load_explicit(&e->latency_hist[i], memory_order_relaxed);
+        out->wait_hist[i] = atomic_load_explicit(&e->wait_hist[i], memory_order_relaxed);
+    }
+}
+
+static int db_trace_compare_total(const void *a, const void *b) {
+    uint64_t ta = ((const db_trace_stat_t*)a)->total_ns;
+    uint64_t tb = ((const db_trace_stat_t*)b)->total_ns;
+    return (ta < tb) - (ta > tb);
+}
+
+int db_trace_collect(db_trace_stat_t *out, int max) {
+    int n = 0;
+
+    for (int i = 0; i < DB_TRACE_MAX_STATEMENTS && n < max; i++) {
+        const char *sql = atomic_load_explicit(&trace_entries[i].sql, memory_order_acquire);
+        if (sql != NULL) {
+            db_trace_copy_entry(&trace_entries[i], sql, &out[n++]);
+        }
+    }
+    if (n < max && atomic_load_explicit(&trace_overflow.calls, memory_order_relaxed) > 0) {
+        db_trace_copy_entry(&trace_overflow, "<other>", &out[n++]);
+    }
+
+    qsort(out, n, sizeof(db_trace_stat_t), db_trace_compare_total);
+    return n;
+}
+
+static void db_trace_copy_pool(const trace_pool_t *pool, db_trace_pool_stat_t *out) {
+    out->acquires = atomic_load_explicit(&pool->acquires, memory_order_relaxed);
+    out->contended = atomic_load_explicit(&pool->contended, memory_order_relaxed);
+    out->total_wait_ns = atomic_load_explicit(&pool->total_wait_ns, memory_order_relaxed);
+    out->max_wait_ns = atomic_load_explicit(&pool->max_wait_ns, memory_order_relaxed);
+    for (int i = 0; i < DB_TRACE_BUCKETS; i++) {
+        out->wait_hist[i] = atomic_load_explicit(&pool->wait_hist[i], memory_order_relaxed);
+    }
+}
+
+void db_trace_collect_pool(db_trace_pool_stat_t *writer, db_trace_pool_stat_t *readers) {
+    db_trace_copy_pool(&trace_writer_pool, writer);
+    db_trace_copy_pool(&trace_reader_pool, readers);
+}
+
+uint64_t db_trace_percentile_us(const uint64_t hist[DB_TRACE_BUCKETS], double pct) {
+    uint64_t total = 0;
+    for (int i = 0; i < DB_TRACE_BUCKETS; i++) {
+        total += hist[i];
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t target = (uint64_t)(total * pct / 100.0);
+    if (target == 0) {
+        target = 1;
+    }
+
+    uint64_t seen = 0;
+    for (int i = 0; i < DB_TRACE_BUCKETS; i++) {
+        seen += hist[i];
+        if (seen >= target) {
+            return (i == 0) ? 1 : (1ull << i);
+        }
+    }
+    return 1ull << (DB_TRACE_BUCKETS - 1);
+}
@@ -1,6 +1,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <strings.h>
+#include <stdbool.h>
 #include <sys/stat.h>
 #include <unistd.h>
 #include "civetweb.h"
@@ -8,8 +10,16 @@
 #include "http_handler.h"
 #include "auth.h"
 #include "db.h"
+#include "catalog.h"
+#include "db_trace.h"
+#include "db_maint.h"
+#include "journal.h"
 #include "streaming.h"
 #include "json_helper.h"
+#include "thumbnail.h"
+#include "thumbnail_queue.h"
+#include "thumb_pack.h"
+#include "cpu_affinity.h"
 #include "logger.h"
 #include "config.h"
 
@@ -39,6 +49,21 @@ static int authenticate_request(struct mg_connection *conn, user_t *user) {
     return 0;
 }
 
+// 관리용 API: 사용자 역할이 없으므로 인증에 더해 같은 호스트(루프백)에서 온 요청만 받는다
+// 리버스 프록시를 거친 요청은 프록시 주소가 루프백이어도 외부 요청이므로 거부한다
+static int authenticate_admin_request(struct mg_connection *conn, user_t *user) {
+    const struct mg_request_info *ri = mg_get_request_info(conn);
+    bool loopback = (strncmp(ri->remote_addr, "127.", 4) == 0 || strcmp(ri->remote_addr, "::1") == 0 ||
+                     strncmp(ri->remote_addr, "::ffff:127.", 11) == 0);
+    if (!loopback || mg_get_header(conn, "X-Forwarded-For") != NULL ||
+        mg_get_header(conn, "Forwarded") != NULL) {
+        cJSON *error = json_create_error("FORBIDDEN", "Admin API is only available from localhost");
+        json_send_response(conn, 403, error);
+        return -1;
+    }
+    return authenticate_request(conn, user);
+}
+
 int handle_auth_check(struct mg_connection *conn, void *cbdata) {
     (void)cbdata;
     
@@ -69,36 +94,42 @@ int handle_videos_list(struct mg_connection *conn, void *cbdata) {
     size_t query_string_len = strlen(query_string);
     
     char query_buf[256] = "";
-    char page_buf[16] = "1";
+    char cursor_buf[DB_CURSOR_LEN] = "";
     char page_size_buf[16] = "20";
     
     mg_get_var(query_string, query_string_len, "query", query_buf, sizeof(query_buf));
-    mg_get_var(query_string, query_string_len, "page", page_buf, sizeof(page_buf));
+    mg_get_var(query_string, query_string_len, "cursor", cursor_buf, sizeof(cursor_buf));
     mg_get_var(query_string, query_string_len, "pageSize", page_size_buf, sizeof(page_size_buf));
     
-    int page = atoi(page_buf);
     int page_size = atoi(page_size_buf);
-    
-    if (page < 1) page = 1;
     if (page_size < 1 || page_size > 100) page_size = 20;
     
-    video_t *videos = NULL;
-    int count = 0;
+    video_page_t page;
     int total = 0;
+    char next_cursor[DB_CURSOR_LEN] = "";
+    int rc;
     
     if (strlen(query_buf) > 0) {
-        db_search_videos(query_buf, page, page_size, &videos, &count, &total);
+        rc = db_search_videos(query_buf, cursor_buf, page_size, &page, &total, next_cursor);
     } else {
-        db_list_videos(page, page_size, &videos, &count, &total);
+        // 최신순 목록은 카탈로그 스냅샷에서 바로 잘라낸다
+        catalog_ref_t ref = catalog_acquire();
+        rc = catalog_list_videos(ref.snapshot, cursor_buf, page_size, &page, &total, next_cursor);
+        catalog_release(&ref);
     }
     
-    cJSON *response = json_create_video_list(videos, count, page, page_size, total);
-    json_send_response(conn, 200, response);
-    
-    if (videos != NULL) {
-        free(videos);
+    if (rc == -2) {
+        video_page_free(&page);
+        cJSON *error = json_create_error("BAD_REQUEST", "Invalid cursor");
+        json_send_response(conn, 400, error);
+        return 1;
     }
     
+    // JSON은 페이지 아레나의 문자열을 참조하므로 전송이 끝난 뒤 해제한다
+    cJSON *response = json_create_video_page(&page, page_size, total, next_cursor);
+    json_send_response(conn, 200, response);
+    video_page_free(&page);
+    
     return 1;
 }
 
@@ -133,8 +164,10 @@ int handle_video_detail(struct mg_connection *conn, void *cbdata) {
         *slash = '\0';
     }
     
-    video_t video;
-    if (db_get_video(video_id, &video) < 0) {
+    catalog_ref_t ref = catalog_acquire();
+    const catalog_video_t *cv = catalog_find_video(ref.snapshot, video_id);
+    if (cv == NULL) {
+        catalog_release(&ref);
         cJSON *error = json_create_error("NOT_FOUND", "Video not found");
         json_send_response(conn, 404, error);
         return 1;
@@ -143,94 +176,370 @@ int handle_video_detail(struct mg_connection *conn, void *cbdata) {
     char thumbnail_url[256];
     snprintf(thumbnail_url, sizeof(thumbnail_url), "/api/videos/%s/thumbnail", video_id);
     
-    cJSON *response = json_create_video(&video, thumbnail_url);
+    cJSON *response = json_create_video(ref.snapshot, cv, thumbnail_url);
     
     // Add files array
-    video_file_t *files = NULL;
-    int file_count = 0;
-    db_get_video_files(video_id, &files, &file_count);
-    
     cJSON *files_array = cJSON_CreateArray();
-    for (int i = 0; i < file_count; i++) {
+    for (uint32_t i = 0; i < cv->file_count; i++) {
+        const catalog_file_t *cf = &ref.snapshot->files[cv->first_file + i];
         cJSON *file_obj = cJSON_CreateObject();
-        cJSON_AddStringToObject(file_obj, "path", files[i].file_path);
-        cJSON_AddNumberToObject(file_obj, "size", files[i].file_size);
-        cJSON_AddNumberToObject(file_obj, "bitrate", files[i].bitrate_kbps);
+        cJSON_AddStringToObject(file_obj, "path", catalog_str(ref.snapshot, cf->file_path));
+        cJSON_AddNumberToObject(file_obj, "size", cf->file_size);
+        cJSON_AddNumberToObject(file_obj, "bitrate", cf->bitrate_kbps);
+        cJSON_AddStringToObject(file_obj, "resolution", catalog_str(ref.snapshot, cf->resolution));
         cJSON_AddItemToArray(files_array, file_obj);
     }
     cJSON_AddItemToObject(response, "files", files_array);
     
-    if (files != NULL) {
-        free(files);
-    }
+    // 응답 전송 전에 스냅샷 반환
+    catalog_release(&ref);
     
     json_send_response(conn, 200, response);
     return 1;
 }
 
+// Accept 헤더가 이미지 형식을 이름으로 허용하는지 (q=0은 거부)
+// image/* 나 */* 만으로는 허용으로 보지 않는다 (WebP/AVIF를 해석한다는 보장이 없음)
+static bool accept_allows(const char *accept, const char *mime) {
+    size_t mime_len = strlen(mime);
+    const char *p = accept;
+    while (*p != '\0') {
+        p += strspn(p, " \t,");
+        const char *end = p + strcspn(p, ",");
+        size_t len = strcspn(p, ",;");
+        while (len > 0 && (p[len - 1] == ' ' || p[len - 1] == '\t')) {
+            len--;
+        }
+        if (len == mime_len && strncasecmp(p, mime, mime_len) == 0) {
+            double q = 1.0;
+            for (const char *param = p + len; param < end; param++) {
+                if (*param == ';') {
+                    const char *v = param + 1 + strspn(param + 1, " \t");
+                    if ((v[0] == 'q' || v[0] == 'Q') && v[1] == '=') {
+                        q = strtod(v + 2, NULL);
+                    }
+                }
+            }
+            return q > 0;
+        }
+        p = end;
+    }
+    return false;
+}
+
+// 변형 선택: 클라이언트가 받는 형식 중 가장 작은 형식 (AVIF > WebP > JPEG)
+// 그 형식 안에서는 요청 너비 이상인 가장 작은 변형, 없으면 가장 큰 변형
+static const catalog_thumbnail_t* thumbnail_pick(const catalog_snapshot_t *snap, const catalog_video_t *cv,
+                                                 const char *accept, int want_width) {
+    static const char *const preference[] = { "image/avif", "image/webp", "image/jpeg" };
+    const size_t format_count = sizeof(preference) / sizeof(preference[0]);
+    const catalog_thumbnail_t *thumbs = &snap->thumbnails[cv->first_thumbnail];
+
+    for (size_t f = 0; f < format_count; f++) {
+        // JPEG는 Accept와 상관없이 항상 허용
+        if (f + 1 < format_count && (accept == NULL || !accept_allows(accept, preference[f]))) {
+            continue;
+        }
+        mime_id_t mime = mime_intern(preference[f]);
+        const catalog_thumbnail_t *best = NULL;
+        for (uint32_t i = 0; i < cv->thumbnail_count; i++) {
+            const catalog_thumbnail_t *t = &thumbs[i];
+            if (t->mime != mime) {
+                continue;
+            }
+            if (best == NULL || (best->width < want_width && t->width > best->width) ||
+                (t->width >= want_width && t->width < best->width)) {
+                best = t;
+            }
+        }
+        if (best != NULL) {
+            return best;
+        }
+    }
+
+    // 알 수 없는 형식만 있으면 첫 번째
+    return &thumbs[0];
+}
+
+// URI에서 동영상 ID 추출 (/api/videos/<id>/...)
+static int uri_video_id(const char *uri, char *video_id, size_t video_id_len) {
+    const char *id_start = strstr(uri, "/api/videos/");
+    if (id_start == NULL) {
+        return -1;
+    }
+    
+    id_start += strlen("/api/videos/");
+    snprintf(video_id, video_id_len, "%.*s", (int)strcspn(id_start, "/"), id_start);
+    return 0;
+}
+
+// 미디어 디렉터리의 이미지 파일 전송 (상대 경로는 작업 디렉터리 기준)
+static void send_image_file(struct mg_connection *conn, const char *file_path, const char *mime_type,
+                            const char *extra_headers) {
+    // Convert relative path to absolute path
+    char abs_path[512];
+    if (file_path[0] == '/') {
+        // Already absolute
+        snprintf(abs_path, sizeof(abs_path), "%s", file_path);
+    } else {
+        // Relative path - resolve it
+        char cwd[256];
+        if (getcwd(cwd, sizeof(cwd)) == NULL) {
+            log_error("getcwd 실패");
+            mg_send_http_error(conn, 500, "Internal server error");
+            return;
+        }
+        snprintf(abs_path, sizeof(abs_path), "%s/%s", cwd, file_path);
+    }
+    
+    log_debug("이미지 파일 전송: %s", abs_path);
+    
+    // Check if file exists
+    FILE *fp = fopen(abs_path, "rb");
+    if (fp == NULL) {
+        log_error("이미지 파일을 열 수 없음: %s", abs_path);
+        mg_send_http_error(conn, 404, "Image file not found");
+        return;
+    }
+    fclose(fp);
+    
+    mg_send_mime_file2(conn, abs_path, mime_type, extra_headers);
+}
+
+// 썸네일 팩 안의 이미지 전송
+// 팩은 추가 전용이고 번호를 다시 쓰지 않으므로 (팩, 위치)가 곧 내용의 ETag다.
+// 캐시 재검증은 팩을 읽지 않고 304로 끝내고, 본문은 열어 둔 팩에서 pread 한 번으로 읽는다.
+static void send_packed_image(struct mg_connection *conn, const thumb_pack_ref_t *pack, const char *mime_type,
+                              const char *extra_headers) {
+    char etag[48];
+    snprintf(etag, sizeof(etag), "p%d-%lld", (int)pack->pack_id, (long long)pack->offset);
+    if (streaming_etag_matches(mg_get_header(conn, "If-None-Match"), etag, true)) {
+        mg_printf(conn, "HTTP/1.1 304 Not Modified\r\nETag: \"%s\"\r\n%s\r\n", etag, extra_headers);
+        return;
+    }
+
+    const struct mg_request_info *ri = mg_get_request_info(conn);
+    bool head = (strcmp(ri->request_method, "HEAD") == 0);
+    void *data = NULL;
+    if (!head) {
+        data = malloc((size_t)pack->length);
+        if (data == NULL) {
+            mg_send_http_error(conn, 500, "Internal server error");
+            return;
+        }
+        if (thumb_pack_read(pack, data) < 0) {
+            free(data);
+            mg_send_http_error(conn, 404, "Image file not found");
+            return;
+        }
+    }
+
+    mg_printf(conn, "HTTP/1.1 200 OK\r\n"
+                    "Content-Type: %s\r\n"
+                    "Content-Length: %d\r\n"
+                    "ETag: \"%s\"\r\n%s\r\n",
+              mime_type, (int)pack->length, etag, extra_headers);
+    if (data != NULL) {
+        mg_write(conn, data, (size_t)pack->length);
+        free(data);
+    }
+}
+
+// 썸네일을 만드는 동안 보내는 자리 표시 이미지 (16:9 회색 바탕에 재생 표시)
+static const char thumbnail_placeholder_svg[] =
+    "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"320\" height=\"180\" viewBox=\"0 0 320 180\">"
+    "<rect width=\"320\" height=\"180\" fill=\"#2a2a2a\"/>"
+    "<path d=\"M144 66v48l40-24z\" fill=\"#555\"/></svg>";
+
+// 202와 Retry-After로 아직 준비 중임을 알리고, 캐시에 남지 않도록 한다
+static void send_thumbnail_placeholder(struct mg_connection *conn) {
+    mg_printf(conn, "HTTP/1.1 202 Accepted\r\n"
+                    "Content-Type: image/svg+xml\r\n"
+                    "Content-Length: %zu\r\n"
+                    "Cache-Control: no-store\r\n"
+                    "Retry-After: %d\r\n\r\n",
+              sizeof(thumbnail_placeholder_svg) - 1, THUMBNAIL_PLACEHOLDER_RETRY_SEC);
+    mg_write(conn, thumbnail_placeholder_svg, sizeof(thumbnail_placeholder_svg) - 1);
+}
+
 int handle_video_thumbnail(struct mg_connection *conn, void *cbdata) {
     (void)cbdata;
     
     // Extract video ID
     const struct mg_request_info *ri = mg_get_request_info(conn);
-    const char *uri = ri->local_uri;
-    
-    const char *id_start = strstr(uri, "/api/videos/");
-    if (id_start == NULL) {
+    char video_id[64];
+    if (uri_video_id(ri->local_uri, video_id, sizeof(video_id)) < 0) {
         mg_send_http_error(conn, 400, "Invalid URI");
         return 1;
     }
     
-    id_start += strlen("/api/videos/");
-    char video_id[64];
-    strncpy(video_id, id_start, sizeof(video_id) - 1);
-    video_id[sizeof(video_id) - 1] = '\0';
-    
-    char *slash = strchr(video_id, '/');
-    if (slash != NULL) {
-        *slash = '\0';
+    // ?w=: 표시할 CSS 너비 × 기기 픽셀 비율 (srcset이 고른 값)
+    int want_width = THUMBNAIL_DEFAULT_WIDTH;
+    if (ri->query_string != NULL) {
+        char width_buf[16];
+        if (mg_get_var(ri->query_string, strlen(ri->query_string), "w", width_buf, sizeof(width_buf)) > 0) {
+            int w = atoi(width_buf);
+            if (w > 0 && w <= 4096) {
+                want_width = w;
+            }
+        }
     }
     
     thumbnail_t thumbnail;
-    if (db_get_thumbnail(video_id, &thumbnail) < 0) {
+    catalog_ref_t ref = catalog_acquire();
+    const catalog_video_t *cv = catalog_find_video(ref.snapshot, video_id);
+    if (cv == NULL || (cv->thumbnail_count == 0 && cv->file_count == 0)) {
+        catalog_release(&ref);
         mg_send_http_error(conn, 404, "Thumbnail not found");
         return 1;
     }
+    if (cv->thumbnail_count == 0) {
+        // 등록 때 만들지 못한 썸네일은 원본에서 백그라운드로 만들고, 그동안 자리 표시 이미지를 보낸다
+        // (원본 파일이 없으면 위에서 404, 저장된 썸네일은 파일 행 없이도 제공한다)
+        char video_path[MAX_PATH_LEN];
+        snprintf(video_path, sizeof(video_path), "%s",
+                 catalog_str(ref.snapshot, ref.snapshot->files[cv->first_file].file_path));
+        catalog_release(&ref);
+        if (thumbnail_queue_request(video_id, video_path) == THUMBNAIL_QUEUE_FAILED) {
+            mg_send_http_error(conn, 404, "Thumbnail not found");
+        } else {
+            send_thumbnail_placeholder(conn);
+        }
+        return 1;
+    }
+    const catalog_thumbnail_t *ct = thumbnail_pick(ref.snapshot, cv, mg_get_header(conn, "Accept"), want_width);
+    snprintf(thumbnail.file_path, sizeof(thumbnail.file_path), "%s", catalog_str(ref.snapshot, ct->file_path));
+    snprintf(thumbnail.mime_type, sizeof(thumbnail.mime_type), "%s", mime_name(ct->mime));
+    thumbnail.pack = ct->pack;
+    catalog_release(&ref);
     
-    // Convert relative path to absolute path
-    char abs_path[512];
-    if (thumbnail.file_path[0] == '/') {
-        // Already absolute
-        strncpy(abs_path, thumbnail.file_path, sizeof(abs_path) - 1);
+    // Send thumbnail (Accept에 따라 형식이 달라지므로 캐시에 Vary를 알린다)
+    if (thumbnail.pack.pack_id > 0) {
+        send_packed_image(conn, &thumbnail.pack, thumbnail.mime_type, "Vary: Accept\r\n");
     } else {
-        // Relative path - resolve it
-        char cwd[256];
-        if (getcwd(cwd, sizeof(cwd)) != NULL) {
-            snprintf(abs_path, sizeof(abs_path), "%s/%s", cwd, thumbnail.file_path);
-        } else {
-            log_error("getcwd 실패");
-            mg_send_http_error(conn, 500, "Internal server error");
-            return 1;
+        send_image_file(conn, thumbnail.file_path, thumbnail.mime_type, "Vary: Accept\r\n");
+    }
+    return 1;
+}
+
+// WebVTT 시각 (HH:MM:SS.mmm)
+static int vtt_time(char *buf, size_t len, int64_t ms) {
+    return snprintf(buf, len, "%02lld:%02lld:%02lld.%03lld", (long long)(ms / 3600000),
+                    (long long)(ms / 60000 % 60), (long long)(ms / 1000 % 60), (long long)(ms % 1000));
+}
+
+int handle_video_trickplay_vtt(struct mg_connection *conn, void *cbdata) {
+    (void)cbdata;
+    
+    const struct mg_request_info *ri = mg_get_request_info(conn);
+    char video_id[64];
+    trickplay_t tp;
+    if (uri_video_id(ri->local_uri, video_id, sizeof(video_id)) < 0 ||
+        db_get_trickplay(video_id, &tp) < 0 || tp.tile_count <= 0) {
+        mg_send_http_error(conn, 404, "Trickplay not found");
+        return 1;
+    }
+    
+    // 큐 하나: 시각 2개 + 시트 URL + 좌표 (시트 URL은 이 VTT 위치 기준 상대 경로)
+    const char *extension = thumbnail_mime_extension(tp.mime_type);
+    size_t cap = 16 + (size_t)tp.tile_count * 96;
+    char *body = malloc(cap);
+    if (body == NULL) {
+        mg_send_http_error(conn, 500, "Internal server error");
+        return 1;
+    }
+    
+    size_t len = (size_t)snprintf(body, cap, "WEBVTT\n\n");
+    int per_sheet = tp.columns * tp.rows;
+    for (int i = 0; i < tp.tile_count; i++) {
+        char start[16], end[16];
+        vtt_time(start, sizeof(start), (int64_t)i * tp.interval_ms);
+        vtt_time(end, sizeof(end), (int64_t)(i + 1) * tp.interval_ms);
+        int slot = i % per_sheet;
+        int n = snprintf(body + len, cap - len, "%s --> %s\ntrickplay/%d.%s#xywh=%d,%d,%d,%d\n\n",
+                         start, end, i / per_sheet, extension,
+                         (slot % tp.columns) * tp.tile_width, (slot / tp.columns) * tp.tile_height,
+                         tp.tile_width, tp.tile_height);
+        if (n < 0 || (size_t)n >= cap - len) {
+            break;
         }
+        len += (size_t)n;
     }
-    abs_path[sizeof(abs_path) - 1] = '\0';
     
-    log_debug("썸네일 파일 전송: %s", abs_path);
+    mg_printf(conn, "HTTP/1.1 200 OK\r\n");
+    mg_printf(conn, "Content-Type: text/vtt; charset=utf-8\r\n");
+    mg_printf(conn, "Content-Length: %zu\r\n", len);
+    mg_printf(conn, "Cache-Control: public, max-age=%d\r\n", TRICKPLAY_CACHE_MAX_AGE_SEC);
+    mg_printf(conn, "\r\n");
+    mg_write(conn, body, len);
+    free(body);
+    return 1;
+}
+
+int handle_video_trickplay_sheet(struct mg_connection *conn, void *cbdata) {
+    (void)cbdata;
     
-    // Check if file exists
-    FILE *fp = fopen(abs_path, "rb");
-    if (fp == NULL) {
-        log_error("썸네일 파일을 열 수 없음: %s", abs_path);
-        mg_send_http_error(conn, 404, "Thumbnail file not found");
+    // /api/videos/<id>/thumbnail/trickplay/<n>.<확장자>
+    const struct mg_request_info *ri = mg_get_request_info(conn);
+    const char *sheet_start = strstr(ri->local_uri, "/thumbnail/trickplay/");
+    char video_id[64];
+    if (sheet_start == NULL || uri_video_id(ri->local_uri, video_id, sizeof(video_id)) < 0) {
+        mg_send_http_error(conn, 400, "Invalid URI");
         return 1;
     }
-    fclose(fp);
     
-    // Send thumbnail file
-    mg_send_file(conn, abs_path);
+    char *end;
+    long sheet = strtol(sheet_start + strlen("/thumbnail/trickplay/"), &end, 10);
+    trickplay_t tp;
+    if (end == sheet_start + strlen("/thumbnail/trickplay/") || sheet < 0 ||
+        db_get_trickplay(video_id, &tp) < 0 || sheet >= trickplay_sheet_count(&tp)) {
+        mg_send_http_error(conn, 404, "Trickplay sheet not found");
+        return 1;
+    }
+    
+    char file_path[sizeof(tp.path_prefix) + 32];
+    snprintf(file_path, sizeof(file_path), "%s_%ld.%s", tp.path_prefix, sheet, thumbnail_mime_extension(tp.mime_type));
+    
+    // 시트는 다시 만들지 않는 한 바뀌지 않으므로 브라우저/프록시 캐시에 오래 둔다
+    char headers[64];
+    snprintf(headers, sizeof(headers), "Cache-Control: public, max-age=%d\r\n", TRICKPLAY_CACHE_MAX_AGE_SEC);
+    send_image_file(conn, file_path, tp.mime_type, headers);
     return 1;
 }
 
+// 해상도 문자열 "1280x720"의 높이 (모르면 0)
+static int resolution_height(const char *resolution) {
+    const char *x = strchr(resolution, 'x');
+    return x != NULL ? atoi(x + 1) : 0;
+}
+
+// 스트림 파일 선택: 제한(max_kbps, max_height, 0은 제한 없음) 안에서 비트레이트가 가장 높은 파일,
+// 맞는 파일이 없으면 가장 낮은 파일. 제한이 없으면 원본(첫 파일, 이후는 트랜스코딩 결과)
+static const catalog_file_t* select_stream_file(const catalog_snapshot_t *snap, const catalog_video_t *cv,
+                                                int max_kbps, int max_height) {
+    const catalog_file_t *files = &snap->files[cv->first_file];
+    if (max_kbps <= 0 && max_height <= 0) {
+        return &files[0];
+    }
+    
+    const catalog_file_t *best = NULL;
+    const catalog_file_t *lowest = &files[0];
+    for (uint32_t i = 0; i < cv->file_count; i++) {
+        const catalog_file_t *cf = &files[i];
+        if (cf->bitrate_kbps < lowest->bitrate_kbps) {
+            lowest = cf;
+        }
+        int height = resolution_height(catalog_str(snap, cf->resolution));
+        if ((max_kbps > 0 && cf->bitrate_kbps > max_kbps) || (max_height > 0 && height > max_height)) {
+            continue;
+        }
+        if (best == NULL || cf->bitrate_kbps > best->bitrate_kbps) {
+            best = cf;
+        }
+    }
+    return best != NULL ? best : lowest;
+}
+
 int handle_video_stream(struct mg_connection *conn, void *cbdata) {
     (void)cbdata;
     
@@ -259,42 +568,71 @@ int handle_video_stream(struct mg_connection *conn, void *cbdata) {
         *slash = '\0';
     }
     
-    // Get video files
-    video_file_t *files = NULL;
-    int file_count = 0;
-    db_get_video_files(video_id, &files, &file_count);
-    
-    if (file_count == 0) {
+    // Get video file from catalog snapshot (파일 I/O 전에 스냅샷 반환)
+    catalog_ref_t ref = catalog_acquire();
+    const catalog_video_t *cv = catalog_find_video(ref.snapshot, video_id);
+    if (cv == NULL || cv->file_count == 0) {
+        catalog_release(&ref);
         mg_send_http_error(conn, 404, "Video file not found");
-        if (files != NULL) free(files);
         return 1;
     }
     
-    // Use first file (can be enhanced for multi-bitrate selection)
-    const char *file_path = files[0].file_path;
-    int bitrate = files[0].bitrate_kbps;
+    // 대역폭이 좁은 클라이언트는 max_kbps/max_height로 낮은 비트레이트 파일을 받는다
+    const char *query_string = ri->query_string ? ri->query_string : "";
+    size_t query_string_len = strlen(query_string);
+    char limit_param[16];
+    int max_kbps = 0;
+    int max_height = 0;
+    if (mg_get_var(query_string, query_string_len, "max_kbps", limit_param, sizeof(limit_param)) > 0) {
+        max_kbps = atoi(limit_param);
+    }
+    if (mg_get_var(query_string, query_string_len, "max_height", limit_param, sizeof(limit_param)) > 0) {
+        max_height = atoi(limit_param);
+    }
+    
+    video_file_t file;
+    char mime_type[64];
+    const catalog_file_t *cf = select_stream_file(ref.snapshot, cv, max_kbps, max_height);
+    catalog_copy_file(ref.snapshot, cv, cf, &file);
+    // 동영상의 MIME 타입은 원본 기준이고, 트랜스코딩 결과는 항상 MP4
+    snprintf(mime_type, sizeof(mime_type), "%s",
+             cf == &ref.snapshot->files[cv->first_file] ? mime_name(cv->mime) : "video/mp4");
+    catalog_release(&ref);
+    
+    const char *file_path = file.file_path;
+    int bitrate = file.bitrate_kbps;
     
     // Get file size
     struct stat st;
     if (stat(file_path, &st) != 0) {
         mg_send_http_error(conn, 404, "File not found");
-        free(files);
         return 1;
     }
     
-    // Parse Range header
+    // 내용 해시가 강한 ETag (같은 마스터를 공유하는 동영상끼리도 같은 값)
+    const char *etag = file.content_hash;
+    if (streaming_etag_matches(mg_get_header(conn, "If-None-Match"), etag, true)) {
+        mg_printf(conn, "HTTP/1.1 304 Not Modified\r\n"
+                        "ETag: \"%s\"\r\n"
+                        "Accept-Ranges: bytes\r\n"
+                        "Connection: keep-alive\r\n\r\n", etag);
+        return 1;
+    }
+    
+    // Parse Range header (If-Range가 현재 ETag와 다르면 범위를 무시하고 전체를 보낸다)
     const char *range_header = mg_get_header(conn, "Range");
+    const char *if_range = mg_get_header(conn, "If-Range");
+    if (if_range != NULL && !streaming_etag_matches(if_range, etag, false)) {
+        range_header = NULL;
+    }
     http_range_t range;
     
     if (streaming_parse_range(range_header, st.st_size, &range) < 0) {
         mg_send_http_error(conn, 416, "Range not satisfiable");
-        free(files);
         return 1;
     }
     
     // 시작 위치 파라미터 확인
-    const char *query_string = ri->query_string ? ri->query_string : "";
-    size_t query_string_len = strlen(query_string);
     char start_param[16];
     if (mg_get_var(query_string, query_string_len, "start", start_param, sizeof(start_param)) > 0) {
         int64_t offset;
@@ -306,11 +644,43 @@ int handle_video_stream(struct mg_connection *conn, void *cbdata) {
     }
     
     // 파일 스트리밍
-    video_t video;
-    db_get_video(video_id, &video);
-    streaming_send_video(conn, file_path, &range, video.mime_type);
+    streaming_send_video(conn, file_path, &range, mime_type, etag);
     
-    free(files);
+    return 1;
+}
+
+static int add_transcode_job(void *ctx, const transcode_job_t *job) {
+    cJSON_AddItemToArray((cJSON*)ctx, json_create_transcode_job(job));
+    return 0;
+}
+
+// 트랜스코딩 래더 진행 상황 (단계별 상태, 시도 횟수, 진행률)
+int handle_video_transcode(struct mg_connection *conn, void *cbdata) {
+    (void)cbdata;
+    
+    user_t user;
+    if (authenticate_request(conn, &user) < 0) {
+        return 1;
+    }
+    
+    const struct mg_request_info *ri = mg_get_request_info(conn);
+    char video_id[64];
+    if (uri_video_id(ri->local_uri, video_id, sizeof(video_id)) < 0) {
+        mg_send_http_error(conn, 400, "Invalid URI");
+        return 1;
+    }
+    
+    cJSON *jobs = cJSON_CreateArray();
+    if (db_scan_transcode_jobs(video_id, add_transcode_job, jobs) < 0) {
+        cJSON_Delete(jobs);
+        mg_send_http_error(conn, 500, "Internal server error");
+        return 1;
+    }
+    
+    cJSON *response = cJSON_CreateObject();
+    cJSON_AddStringToObject(response, "videoId", video_id);
+    cJSON_AddItemToObject(response, "jobs", jobs);
+    json_send_response(conn, 200, response);
     return 1;
 }
 
@@ -408,10 +778,27 @@ int handle_watch_progress_post(struct mg_connection *conn, void *cbdata) {
         completed = cJSON_IsTrue(completed_json);
     }
     
+    // 분석용 이벤트 종류 (선택): start / progress / seek, completed면 complete
+    journal_event_type_t event_type = completed ? JOURNAL_EVENT_COMPLETE : JOURNAL_EVENT_PROGRESS;
+    const char *event = cJSON_GetStringValue(cJSON_GetObjectItem(json, "event"));
+    if (!completed && event != NULL) {
+        if (strcmp(event, "start") == 0) {
+            event_type = JOURNAL_EVENT_START;
+        } else if (strcmp(event, "seek") == 0) {
+            event_type = JOURNAL_EVENT_SEEK;
+        }
+    }
+    cJSON *from_json = cJSON_GetObjectItem(json, "fromSec");
+    int from_sec = cJSON_IsNumber(from_json) ? (int)cJSON_GetNumberValue(from_json) : 0;
+    
     cJSON_Delete(json);
     
-    // Update watch history
-    if (db_upsert_watch_history(user.id, video_id, position_sec, completed) < 0) {
+    // 저널은 메모리 버퍼에만 복사 (파일 쓰기는 저널 스레드가 담당)
+    journal_record(event_type, user.id, video_id, position_sec, from_sec);
+    
+    // 재생 시작은 위치가 바뀌지 않으므로 DB에 쓰지 않는다
+    if (event_type != JOURNAL_EVENT_START &&
+        db_upsert_watch_history(user.id, video_id, position_sec, completed) < 0) {
         mg_send_http_error(conn, 500, "Failed to update watch history");
         return 1;
     }
@@ -424,6 +811,48 @@ int handle_watch_progress_post(struct mg_connection *conn, void *cbdata) {
     return 1;
 }
 
+int handle_db_stats(struct mg_connection *conn, void *cbdata) {
+    (void)cbdata;
+    
+    // SQL 원문과 내부 상태를 그대로 돌려주므로 관리용 요청만 받는다
+    user_t user;
+    if (authenticate_admin_request(conn, &user) < 0) {
+        return 1;
+    }
+    
+    db_trace_stat_t *stats = malloc(sizeof(db_trace_stat_t) * (DB_TRACE_MAX_STATEMENTS + 1));
+    if (stats == NULL) {
+        mg_send_http_error(conn, 500, "Internal server error");
+        return 1;
+    }
+    
+    int count = db_trace_collect(stats, DB_TRACE_MAX_STATEMENTS + 1);
+    db_trace_pool_stat_t writer, readers;
+    db_trace_collect_pool(&writer, &readers);
+    
+    db_maint_status_t maint_status;
+    db_maint_get_status(&maint_status);
+    
+    journal_stats_t journal_stats;
+    journal_get_stats(&journal_stats);
+    
+    cJSON *response = json_create_db_stats(stats, count, &writer, &readers);
+    cJSON_AddItemToObject(response, "maintenance", json_create_db_maint_status(&maint_status));
+    cJSON_AddItemToObject(response, "journal", json_create_journal_stats(&journal_stats));
+    free(stats);
+    
+    json_send_response(conn, 200, response);
+    return 1;
+}
+
+// CivetWeb 스레드 시작 시 호출 (0: 수신 스레드, 1: 요청 워커, 2: 내부 타이머)
+// 요청 워커의 스트리밍 버퍼는 스택에 있으므로 고정 후에는 노드 로컬 메모리를 쓴다
+static void* http_init_thread(const struct mg_context *ctx, int thread_type) {
+    (void)ctx;
+    cpu_affinity_pin_current(thread_type == 1 ? CPU_CLASS_HTTP : CPU_CLASS_IO);
+    return NULL;
+}
+
 int http_server_init(void) {
     mg_init_library(0);
     return 0;
@@ -449,7 +878,11 @@ int http_server_start(void) {
         NULL
     };
     
-    ctx = mg_start(NULL, NULL, options);
+    struct mg_callbacks callbacks;
+    memset(&callbacks, 0, sizeof(callbacks));
+    callbacks.init_thread = http_init_thread;
+    
+    ctx = mg_start(&callbacks, NULL, options);
     if (ctx == NULL) {
         log_error("HTTP 서버 시작 실패");
         return -1;
@@ -459,10 +892,14 @@ int http_server_start(void) {
     mg_set_request_handler(ctx, "/api/auth/check", handle_auth_check, NULL);
     mg_set_request_handler(ctx, "/api/videos$", handle_videos_list, NULL);
     mg_set_request_handler(ctx, "/api/videos/*/stream", handle_video_stream, NULL);
+    mg_set_request_handler(ctx, "/api/videos/*/thumbnail/trickplay.vtt$", handle_video_trickplay_vtt, NULL);
+    mg_set_request_handler(ctx, "/api/videos/*/thumbnail/trickplay/", handle_video_trickplay_sheet, NULL);
     mg_set_request_handler(ctx, "/api/videos/*/thumbnail", handle_video_thumbnail, NULL);
     mg_set_request_handler(ctx, "/api/videos/*/progress", handle_watch_progress_post, NULL);
+    mg_set_request_handler(ctx, "/api/videos/*/transcode$", handle_video_transcode, NULL);
     mg_set_request_handler(ctx, "/api/videos/*", handle_video_detail, NULL);
     mg_set_request_handler(ctx, "/api/users/me/history", handle_watch_history_get, NULL);
+    mg_set_request_handler(ctx, "/api/admin/db-stats", handle_db_stats, NULL);
     
     log_info("HTTP 서버가 포트 %s에서 시작되었습니다", SERVER_PORT);
     return 0;
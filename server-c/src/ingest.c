@@ -0,0 +1,564 @@
+#ifdef __linux__
+#define _DEFAULT_SOURCE                 // realpath
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "ingest.h"
+#include "thread_pool.h"
+#include "media_probe.h"
+#include "thumbnail.h"
+#include "thumb_pack.h"
+#include "media_place.h"
+#include "media_blob.h"
+#include "transcode.h"
+#include "db.h"
+#include "uuid.h"
+#include "logger.h"
+#include "config.h"
+
+typedef struct ingest_item {
+    struct ingest *ingest;
+    char *source_path;              // realpath로 정규화 (ingest_sources 키)
+    char *title;
+    char *description;
+    char *thumbnail_path;           // 매니페스트가 지정한 썸네일 (NULL: 생성)
+    int duration_hint;
+    int64_t file_size;
+    ott_uuid_t video_id;            // 프로브 단계에서 발급 (복사본/썸네일 파일 이름)
+    char dest_path[1024];           // 등록할 경로 (복사하지 않으면 원본)
+    char content_hash[MEDIA_HASH_HEX_LEN];  // 저장소에 넣었으면 내용 해시 (아니면 빈 문자열)
+    bool moved;                     // 원본을 저장소로 옮김 (실패하면 원래 자리에 다시 링크)
+    media_info_t info;
+    thumbnail_variant_t variants[THUMBNAIL_MAX_VARIANTS];
+    int variant_count;
+    trickplay_t trickplay;
+    bool has_trickplay;
+    struct ingest_item *next;       // 커밋 대기 목록
+} ingest_item_t;
+
+// 이미 등록된 원본 경로 집합 (열린 주소법, 시작할 때 한 번 채우고 이후 읽기만 함)
+typedef struct {
+    char **slots;
+    size_t capacity;                // 2의 거듭제곱
+    size_t count;
+} ingest_seen_t;
+
+struct ingest {
+    ingest_options_t options;
+    thread_pool_t *pools[INGEST_STAGE_COUNT];
+    thread_pool_timer_t *commit_timer;
+    ingest_seen_t seen;
+    struct timespec started;
+
+    // DB 단계 전용 (DB 풀의 워커 하나와 커밋 타이머 작업만 접근, finish에서는 풀이 멈춘 뒤 접근)
+    db_batch_t batch;
+    bool in_batch;
+    ingest_item_t *pending;
+    long pending_count;
+
+    atomic_long submitted;
+    atomic_long skipped;
+    atomic_long completed;
+    atomic_long failed;
+    atomic_llong bytes;
+    atomic_llong copied_bytes;
+    atomic_long deduped;
+    atomic_llong deduped_bytes;
+    atomic_long placed[MEDIA_PLACE_METHOD_COUNT];
+    atomic_llong busy_ns[INGEST_STAGE_COUNT];
+};
+
+static const char *const stage_names[INGEST_STAGE_COUNT] = { "프로브", "복사", "썸네일", "DB" };
+
+static void ingest_stage_probe(void *arg);
+static void ingest_stage_copy(void *arg);
+static void ingest_stage_thumbnail(void *arg);
+static void ingest_stage_db(void *arg);
+
+static const task_func_t stage_tasks[INGEST_STAGE_COUNT] = {
+    ingest_stage_probe, ingest_stage_copy, ingest_stage_thumbnail, ingest_stage_db
+};
+
+static int64_t ingest_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static uint64_t ingest_hash(const char *s) {
+    uint64_t h = 1469598103934665603ull;
+    for (; *s != '\0'; s++) {
+        h = (h ^ (unsigned char)*s) * 1099511628211ull;
+    }
+    return h;
+}
+
+static bool ingest_seen_contains(const ingest_seen_t *seen, const char *path) {
+    if (seen->capacity == 0) {
+        return false;
+    }
+    size_t mask = seen->capacity - 1;
+    for (size_t i = ingest_hash(path) & mask; seen->slots[i] != NULL; i = (i + 1) & mask) {
+        if (strcmp(seen->slots[i], path) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static int ingest_seen_add(void *ctx, const char *path) {
+    ingest_seen_t *seen = ctx;
+    // 적재율 1/2 이하 유지
+    if ((seen->count + 1) * 2 > seen->capacity) {
+        size_t capacity = seen->capacity ? seen->capacity * 2 : 1024;
+        char **slots = calloc(capacity, sizeof(char*));
+        if (slots == NULL) {
+            return -1;
+        }
+        for (size_t i = 0; i < seen->capacity; i++) {
+            if (seen->slots[i] != NULL) {
+                size_t j = ingest_hash(seen->slots[i]) & (capacity - 1);
+                while (slots[j] != NULL) {
+                    j = (j + 1) & (capacity - 1);
+                }
+                slots[j] = seen->slots[i];
+            }
+        }
+        free(seen->slots);
+        seen->slots = slots;
+        seen->capacity = capacity;
+    }
+
+    if (ingest_seen_contains(seen, path)) {
+        return 0;
+    }
+    char *copy = strdup(path);
+    if (copy == NULL) {
+        return -1;
+    }
+    size_t mask = seen->capacity - 1;
+    size_t i = ingest_hash(path) & mask;
+    while (seen->slots[i] != NULL) {
+        i = (i + 1) & mask;
+    }
+    seen->slots[i] = copy;
+    seen->count++;
+    return 0;
+}
+
+static void ingest_seen_free(ingest_seen_t *seen) {
+    for (size_t i = 0; i < seen->capacity; i++) {
+        free(seen->slots[i]);
+    }
+    free(seen->slots);
+    memset(seen, 0, sizeof(*seen));
+}
+
+static void ingest_item_free(ingest_item_t *item) {
+    free(item->source_path);
+    free(item->title);
+    free(item->description);
+    free(item->thumbnail_path);
+    free(item);
+}
+
+// 등록하지 못한 파일: 만든 탐색 미리보기를 지운다
+// 팩에 추가한 썸네일은 아무 행도 가리키지 않으므로 팩 압축 때 회수된다.
+// 저장소 파일은 같은 내용을 가리키는 다른 등록이 있을 수 있으므로 남겨 두고, 다음에 같은 내용을
+// 등록할 때 그대로 재사용한다.
+static void ingest_item_discard(ingest_item_t *item) {
+    if (item->moved) {
+        link(item->dest_path, item->source_path);
+    }
+    if (item->has_trickplay) {
+        thumbnail_remove_trickplay(&item->trickplay, trickplay_sheet_count(&item->trickplay));
+    }
+}
+
+static void ingest_item_fail(ingest_item_t *item, const char *reason) {
+    log_warn("등록 실패 (%s): %s", reason, item->source_path);
+    atomic_fetch_add(&item->ingest->failed, 1);
+    ingest_item_discard(item);
+    ingest_item_free(item);
+}
+
+// 다음으로 켜진 단계에 넣는다 (큐가 가득 차면 대기)
+static void ingest_forward(ingest_item_t *item, ingest_stage_t from) {
+    struct ingest *ing = item->ingest;
+    int stage = from + 1;
+    while (ing->pools[stage] == NULL) {
+        stage++;
+    }
+    if (thread_pool_submit(ing->pools[stage], stage_tasks[stage], item) < 0) {
+        ingest_item_fail(item, "큐 제출");
+    }
+}
+
+static void ingest_add_busy(struct ingest *ing, ingest_stage_t stage, int64_t start_ns) {
+    atomic_fetch_add_explicit(&ing->busy_ns[stage], ingest_now_ns() - start_ns, memory_order_relaxed);
+}
+
+// 컨테이너를 읽지 못하면 알 수 없는 값으로 두고 계속한다 (파일이 없을 때만 실패)
+static void ingest_stage_probe(void *arg) {
+    ingest_item_t *item = arg;
+    int64_t start = ingest_now_ns();
+
+    struct stat st;
+    bool ok = stat(item->source_path, &st) == 0 && S_ISREG(st.st_mode);
+    if (ok) {
+        item->file_size = st.st_size;
+        if (media_probe(item->source_path, &item->info) < 0) {
+            memset(&item->info, 0, sizeof(item->info));
+        }
+        if (item->duration_hint > 0) {
+            item->info.duration_sec = item->duration_hint;
+        }
+        if (item->info.bitrate_kbps <= 0 && item->info.duration_sec > 0) {
+            item->info.bitrate_kbps = (int)(item->file_size * 8 / item->info.duration_sec / 1000);
+        }
+        uuid_generate_v7(item->video_id);
+        snprintf(item->dest_path, sizeof(item->dest_path), "%s", item->source_path);
+    }
+
+    ingest_add_busy(item->ingest, INGEST_STAGE_PROBE, start);
+    if (!ok) {
+        ingest_item_fail(item, "일반 파일이 아님");
+        return;
+    }
+    ingest_forward(item, INGEST_STAGE_PROBE);
+}
+
+// 원본을 해시해 내용 주소 저장소에 놓는다
+// 같은 내용이 이미 있으면 그 파일을 가리키고, 없으면 링크/리플링크/커널 복사 순으로 놓는다.
+static void ingest_stage_copy(void *arg) {
+    ingest_item_t *item = arg;
+    struct ingest *ing = item->ingest;
+    int64_t start = ingest_now_ns();
+
+    char hash[MEDIA_HASH_HEX_LEN];
+    char blob_path[sizeof(item->dest_path)];
+    media_place_method_t method = MEDIA_PLACE_COPY;
+    int64_t copied = 0;
+    bool deduped = false;
+    int rc = media_hash_file(item->source_path, hash, NULL);
+    if (rc == 0) {
+        rc = media_blob_store(item->source_path, hash, item->file_size, ing->options.move,
+                              blob_path, sizeof(blob_path), &deduped, &method, &copied);
+    }
+    if (rc == 0) {
+        snprintf(item->dest_path, sizeof(item->dest_path), "%s", blob_path);
+        snprintf(item->content_hash, sizeof(item->content_hash), "%s", hash);
+        atomic_fetch_add_explicit(&ing->bytes, item->file_size, memory_order_relaxed);
+        if (deduped) {
+            atomic_fetch_add_explicit(&ing->deduped, 1, memory_order_relaxed);
+            atomic_fetch_add_explicit(&ing->deduped_bytes, item->file_size, memory_order_relaxed);
+        } else {
+            item->moved = (method == MEDIA_PLACE_RENAME);
+            atomic_fetch_add_explicit(&ing->copied_bytes, copied, memory_order_relaxed);
+            atomic_fetch_add_explicit(&ing->placed[method], 1, memory_order_relaxed);
+        }
+    }
+
+    ingest_add_busy(ing, INGEST_STAGE_COPY, start);
+    if (rc < 0) {
+        ingest_item_fail(item, "저장");
+        return;
+    }
+    ingest_forward(item, INGEST_STAGE_COPY);
+}
+
+// 썸네일과 탐색 미리보기는 실패해도 동영상은 등록한다 (단일 등록과 같은 정책)
+static void ingest_stage_thumbnail(void *arg) {
+    ingest_item_t *item = arg;
+    int64_t start = ingest_now_ns();
+
+    if (item->thumbnail_path == NULL) {
+        int count = thumbnail_generate_variants(item->dest_path,
+                                                thumbnail_default_offset(item->info.duration_sec),
+                                                item->variants, THUMBNAIL_MAX_VARIANTS);
+        item->variant_count = (count > 0) ? count : 0;
+    }
+
+    char prefix[512];
+    snprintf(prefix, sizeof(prefix), "%s/%s_trickplay", THUMBNAIL_DIR, item->video_id);
+    if (thumbnail_generate_trickplay(item->dest_path, prefix, &item->trickplay) == 0) {
+        snprintf(item->trickplay.video_id, sizeof(item->trickplay.video_id), "%s", item->video_id);
+        item->has_trickplay = true;
+    }
+
+    ingest_add_busy(item->ingest, INGEST_STAGE_THUMBNAIL, start);
+    ingest_forward(item, INGEST_STAGE_THUMBNAIL);
+}
+
+static void ingest_report_fill(struct ingest *ing, ingest_report_t *report) {
+    report->submitted = atomic_load(&ing->submitted);
+    report->skipped = atomic_load(&ing->skipped);
+    report->completed = atomic_load(&ing->completed);
+    report->failed = atomic_load(&ing->failed);
+    report->bytes = atomic_load(&ing->bytes);
+    report->copied_bytes = atomic_load(&ing->copied_bytes);
+    report->deduped = atomic_load(&ing->deduped);
+    report->deduped_bytes = atomic_load(&ing->deduped_bytes);
+    for (int i = 0; i < MEDIA_PLACE_METHOD_COUNT; i++) {
+        report->placed[i] = atomic_load(&ing->placed[i]);
+    }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    report->elapsed_sec = (now.tv_sec - ing->started.tv_sec) + (now.tv_nsec - ing->started.tv_nsec) / 1e9;
+    for (int i = 0; i < INGEST_STAGE_COUNT; i++) {
+        report->busy_sec[i] = atomic_load(&ing->busy_ns[i]) / 1e9;
+    }
+}
+
+// 현재 배치 커밋 (DB 스레드 전용)
+static void ingest_commit(struct ingest *ing) {
+    if (!ing->in_batch) {
+        return;
+    }
+    ing->in_batch = false;
+
+    // 썸네일 팩을 먼저 디스크에 내린다 (커밋된 행이 가리키는 레코드가 사라지지 않도록)
+    int rc = -1;
+    if (thumb_pack_sync() == 0) {
+        rc = db_batch_commit(&ing->batch);
+    } else {
+        db_batch_rollback(&ing->batch);
+    }
+    ingest_item_t *item = ing->pending;
+    while (item != NULL) {
+        ingest_item_t *next = item->next;
+        if (rc < 0) {
+            ingest_item_discard(item);
+        }
+        ingest_item_free(item);
+        item = next;
+    }
+
+    if (rc < 0) {
+        log_error("등록 배치 커밋 실패, 파일 %ld개를 건너뜁니다", ing->pending_count);
+        atomic_fetch_add(&ing->failed, ing->pending_count);
+    } else {
+        atomic_fetch_add(&ing->completed, ing->pending_count);
+    }
+    ing->pending = NULL;
+    ing->pending_count = 0;
+
+    if (rc == 0 && ing->options.progress != NULL) {
+        ingest_report_t report;
+        ingest_report_fill(ing, &report);
+        ing->options.progress(&report, ing->options.progress_ctx);
+    }
+}
+
+static void ingest_commit_task(void *arg) {
+    ingest_commit(arg);
+}
+
+static void ingest_stage_db(void *arg) {
+    ingest_item_t *item = arg;
+    struct ingest *ing = item->ingest;
+    int64_t start = ingest_now_ns();
+
+    if (!ing->in_batch) {
+        if (db_batch_begin(&ing->batch) < 0) {
+            ingest_add_busy(ing, INGEST_STAGE_DB, start);
+            ingest_item_fail(item, "DB 트랜잭션 시작");
+            return;
+        }
+        ing->in_batch = true;
+    }
+
+    db_batch_t *batch = &ing->batch;
+    const media_info_t *info = &item->info;
+    ott_uuid_t row_id;
+    db_batch_add_video_id(batch, item->video_id, item->title, item->description, (int)info->duration_sec,
+                          info->mime_type[0] != '\0' ? info->mime_type : NULL);
+    db_batch_add_video_file(batch, item->video_id, item->dest_path, item->file_size, info->bitrate_kbps,
+                            info->resolution[0] != '\0' ? info->resolution : NULL,
+                            info->video_codec[0] != '\0' ? info->video_codec : NULL,
+                            info->audio_codec[0] != '\0' ? info->audio_codec : NULL,
+                            item->content_hash[0] != '\0' ? item->content_hash : NULL, row_id);
+    if (item->thumbnail_path != NULL) {
+        db_batch_add_thumbnail(batch, item->video_id, item->thumbnail_path, 320, 180, NULL, NULL, row_id);
+    }
+    for (int i = 0; i < item->variant_count; i++) {
+        const thumbnail_variant_t *v = &item->variants[i];
+        db_batch_add_thumbnail(batch, item->video_id, v->file_path, v->width, v->height, v->mime_type,
+                               &v->pack, row_id);
+    }
+    if (item->has_trickplay) {
+        db_batch_add_trickplay(batch, &item->trickplay);
+    }
+    db_batch_add_ingest_source(batch, item->source_path, item->video_id);
+
+    // 원본보다 낮은 단계는 서버가 백그라운드에서 인코딩한다
+    const transcode_rung_t *rungs[TRANSCODE_MAX_RUNGS];
+    int rung_count = transcode_ladder_for(info->height, rungs, TRANSCODE_MAX_RUNGS);
+    for (int i = 0; i < rung_count; i++) {
+        db_batch_add_transcode(batch, item->video_id, rungs[i]->name, rungs[i]->height, rungs[i]->bitrate_kbps);
+    }
+
+    item->next = ing->pending;
+    ing->pending = item;
+    // 한 행이라도 실패하면 트랜잭션 전체가 롤백되므로 더 모으지 않고 바로 정리한다
+    if (++ing->pending_count >= DB_BATCH_ROWS || batch->failed) {
+        ingest_commit(ing);
+    }
+    ingest_add_busy(ing, INGEST_STAGE_DB, start);
+}
+
+const char* ingest_stage_name(ingest_stage_t stage) {
+    return (stage >= 0 && stage < INGEST_STAGE_COUNT) ? stage_names[stage] : "?";
+}
+
+void ingest_options_default(ingest_options_t *options) {
+    memset(options, 0, sizeof(*options));
+    options->workers[INGEST_STAGE_PROBE] = INGEST_PROBE_WORKERS;
+    options->workers[INGEST_STAGE_COPY] = INGEST_COPY_WORKERS;
+    options->workers[INGEST_STAGE_THUMBNAIL] = INGEST_THUMBNAIL_WORKERS;
+    options->workers[INGEST_STAGE_DB] = 1;
+    options->copy = true;
+    options->thumbnails = true;
+}
+
+ingest_t* ingest_start(const ingest_options_t *options) {
+    struct ingest *ing = calloc(1, sizeof(*ing));
+    if (ing == NULL) {
+        return NULL;
+    }
+    ing->options = *options;
+    clock_gettime(CLOCK_MONOTONIC, &ing->started);
+
+    if (db_scan_ingest_sources(ingest_seen_add, &ing->seen) < 0) {
+        ingest_seen_free(&ing->seen);
+        free(ing);
+        return NULL;
+    }
+    if (ing->seen.count > 0) {
+        log_info("이전 실행에서 등록된 원본 %zu개는 건너뜁니다", ing->seen.count);
+    }
+
+    if (options->thumbnails) {
+        mkdir(THUMBNAIL_DIR, 0755);
+    }
+
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    bool enabled[INGEST_STAGE_COUNT] = { true, options->copy, options->thumbnails, true };
+    bool ok = true;
+    for (int stage = 0; stage < INGEST_STAGE_COUNT && ok; stage++) {
+        if (!enabled[stage]) {
+            continue;
+        }
+        int workers = (stage == INGEST_STAGE_DB) ? 1 : options->workers[stage];
+        if (workers <= 0) {
+            workers = cpus > 0 ? (int)cpus : 1;
+        }
+        ing->pools[stage] = thread_pool_create_bounded(workers, INGEST_QUEUE_CAPACITY);
+        ok = ing->pools[stage] != NULL;
+        if (ok) {
+            log_info("등록 %s 단계: 워커 %d개", stage_names[stage], workers);
+        }
+    }
+    // 파일이 드문드문 들어와도 커밋이 밀리지 않도록 DB 스레드에서 주기적으로 커밋
+    if (ok) {
+        ok = thread_pool_schedule_every(ing->pools[INGEST_STAGE_DB], INGEST_COMMIT_INTERVAL_MS,
+                                        ingest_commit_task, ing, TP_PRIORITY_NORMAL, &ing->commit_timer) == 0;
+    }
+
+    if (!ok) {
+        log_error("등록 파이프라인을 시작하지 못했습니다");
+        for (int stage = 0; stage < INGEST_STAGE_COUNT; stage++) {
+            if (ing->pools[stage] != NULL) {
+                thread_pool_destroy(ing->pools[stage]);
+            }
+        }
+        ingest_seen_free(&ing->seen);
+        free(ing);
+        return NULL;
+    }
+    return ing;
+}
+
+static char* ingest_strdup(const char *s) {
+    return (s != NULL && s[0] != '\0') ? strdup(s) : NULL;
+}
+
+int ingest_add(ingest_t *ing, const char *source_path, const char *title, const char *description,
+               int duration_hint, const char *thumbnail_path) {
+    char resolved[PATH_MAX];
+    if (realpath(source_path, resolved) == NULL) {
+        log_warn("등록 실패 (파일을 찾을 수 없음): %s", source_path);
+        atomic_fetch_add(&ing->failed, 1);
+        return -1;
+    }
+    if (ingest_seen_contains(&ing->seen, resolved)) {
+        atomic_fetch_add(&ing->skipped, 1);
+        return 1;
+    }
+    // 같은 실행에서 두 번 나온 원본도 건너뛴다 (메인 스레드에서만 호출되므로 잠금이 필요 없다)
+    if (ingest_seen_add(&ing->seen, resolved) < 0) {
+        log_warn("등록한 원본 목록에 추가하지 못했습니다: %s", resolved);
+    }
+
+    ingest_item_t *item = calloc(1, sizeof(*item));
+    if (item == NULL) {
+        atomic_fetch_add(&ing->failed, 1);
+        return -1;
+    }
+    item->ingest = ing;
+    item->source_path = strdup(resolved);
+    item->title = strdup(title);
+    item->description = strdup(description != NULL ? description : "");
+    item->thumbnail_path = ingest_strdup(thumbnail_path);
+    item->duration_hint = duration_hint;
+    if (item->source_path == NULL || item->title == NULL || item->description == NULL ||
+        (thumbnail_path != NULL && thumbnail_path[0] != '\0' && item->thumbnail_path == NULL)) {
+        ingest_item_free(item);
+        atomic_fetch_add(&ing->failed, 1);
+        return -1;
+    }
+
+    atomic_fetch_add(&ing->submitted, 1);
+    if (thread_pool_submit(ing->pools[INGEST_STAGE_PROBE], ingest_stage_probe, item) < 0) {
+        ingest_item_fail(item, "큐 제출");
+        return -1;
+    }
+    return 0;
+}
+
+int ingest_finish(ingest_t *ing, ingest_report_t *report) {
+    // 앞 단계부터 차례로 비운다 (앞 단계가 끝나면 다음 단계에 더 들어올 작업이 없다)
+    for (int stage = 0; stage < INGEST_STAGE_COUNT; stage++) {
+        if (ing->pools[stage] != NULL) {
+            thread_pool_wait(ing->pools[stage]);
+        }
+    }
+    thread_pool_timer_cancel(ing->commit_timer, true);
+    thread_pool_timer_release(ing->commit_timer);
+
+    // DB 풀이 멈췄으므로 이 스레드에서 마지막 배치를 커밋한다
+    ingest_commit(ing);
+
+    for (int stage = 0; stage < INGEST_STAGE_COUNT; stage++) {
+        if (ing->pools[stage] != NULL) {
+            thread_pool_destroy(ing->pools[stage]);
+        }
+    }
+
+    ingest_report_t local;
+    ingest_report_t *r = (report != NULL) ? report : &local;
+    ingest_report_fill(ing, r);
+    log_info("일괄 등록 종료: 완료 %ld, 건너뜀 %ld, 실패 %ld (%.1f초)",
+             r->completed, r->skipped, r->failed, r->elapsed_sec);
+
+    ingest_seen_free(&ing->seen);
+    free(ing);
+    return r->failed == 0 ? 0 : -1;
+}
@@ -0,0 +1,319 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stddef.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+#include "journal.h"
+#include "uuid.h"
+#include "config.h"
+#include "cpu_affinity.h"
+#include "logger.h"
+
+// 이중 버퍼: 요청 스레드는 active 버퍼에 추가만 하고,
+// 쓰기 스레드는 버퍼를 교체한 뒤 잠금 밖에서 파일에 쓴다.
+// 비활성 버퍼는 쓰기 스레드만 만지므로 교체 시 항상 비어 있다.
+typedef struct {
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    bool running;
+    bool stop;
+
+    journal_event_t *buffers[2];
+    int active;
+    int count;                      // active 버퍼의 이벤트 수
+
+    char dir[MAX_PATH_LEN];
+    int fd;                         // 쓰기 스레드 전용
+    uint64_t sequence;
+    int64_t segment_bytes;
+
+    journal_stats_t stats;          // mutex로 보호
+} journal_t;
+
+static journal_t journal = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+    .fd = -1
+};
+
+static int64_t journal_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+uint32_t journal_event_checksum(const journal_event_t *event) {
+    const uint8_t *p = (const uint8_t *)event;
+    uint32_t hash = 2166136261u;
+
+    for (size_t i = 0; i < offsetof(journal_event_t, checksum); i++) {
+        hash ^= p[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+void journal_segment_path(const char *dir, uint64_t sequence, char *out, size_t out_len) {
+    snprintf(out, out_len, "%s/events-%08llu.log", dir, (unsigned long long)sequence);
+}
+
+// 디렉터리에서 가장 큰 세그먼트 번호 (없으면 0)
+static uint64_t journal_last_sequence(const char *dir) {
+    uint64_t last = 0;
+    DIR *d = opendir(dir);
+    if (d == NULL) {
+        return 0;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(d)) != NULL) {
+        unsigned long long seq;
+        char tail[8];
+        if (sscanf(entry->d_name, "events-%llu.%7s", &seq, tail) == 2 &&
+            strcmp(tail, "log") == 0 && seq > last) {
+            last = seq;
+        }
+    }
+    closedir(d);
+    return last;
+}
+
+static int journal_write_all(int fd, const void *data, size_t len) {
+    const char *p = data;
+    while (len > 0) {
+        ssize_t n = write(fd, p, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+static void journal_close_segment(void) {
+    if (journal.fd >= 0) {
+        fsync(journal.fd);
+        close(journal.fd);
+        journal.fd = -1;
+    }
+}
+
+// 새 세그먼트 시작 (기존 세그먼트 끝에 이어 쓰지 않는다: 잘린 레코드 뒤에 붙는 것을 방지)
+static int journal_open_segment(uint64_t sequence) {
+    char path[MAX_PATH_LEN];
+    journal_segment_path(journal.dir, sequence, path, sizeof(path));
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_EXCL | O_APPEND, 0644);
+    if (fd < 0) {
+        log_error("저널 세그먼트 생성 실패: %s (%s)", path, strerror(errno));
+        return -1;
+    }
+
+    journal_segment_header_t header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, JOURNAL_MAGIC, sizeof(header.magic));
+    header.version = JOURNAL_VERSION;
+    header.event_size = sizeof(journal_event_t);
+    header.sequence = sequence;
+    header.created_ms = journal_now_ms();
+
+    if (journal_write_all(fd, &header, sizeof(header)) < 0) {
+        log_error("저널 세그먼트 헤더 쓰기 실패: %s", path);
+        close(fd);
+        unlink(path);
+        return -1;
+    }
+
+    journal.fd = fd;
+    journal.sequence = sequence;
+    journal.segment_bytes = sizeof(header);
+    return 0;
+}
+
+static void journal_flush(const journal_event_t *events, int count) {
+    size_t len = sizeof(journal_event_t) * (size_t)count;
+
+    if (journal.fd >= 0 && journal.segment_bytes + (int64_t)len > JOURNAL_SEGMENT_BYTES) {
+        journal_close_segment();
+        journal_open_segment(journal.sequence + 1);
+    } else if (journal.fd < 0) {
+        journal_open_segment(journal.sequence + 1);
+    }
+
+    bool ok = journal.fd >= 0 && journal_write_all(journal.fd, events, len) == 0;
+    if (ok) {
+        journal.segment_bytes += (int64_t)len;
+    } else if (journal.fd >= 0) {
+        // 부분 쓰기가 남았을 수 있으므로 다음 쓰기는 새 세그먼트에서 시작한다
+        log_error("저널 쓰기 실패: %s", strerror(errno));
+        close(journal.fd);
+        journal.fd = -1;
+    }
+
+    pthread_mutex_lock(&journal.mutex);
+    if (ok) {
+        journal.stats.written += (uint64_t)count;
+    } else {
+        journal.stats.dropped += (uint64_t)count;
+    }
+    journal.stats.segment_sequence = journal.sequence;
+    journal.stats.segment_bytes = (uint64_t)journal.segment_bytes;
+    pthread_mutex_unlock(&journal.mutex);
+}
+
+static void* journal_thread(void *arg) {
+    (void)arg;
+    cpu_affinity_pin_current(CPU_CLASS_IO);
+
+    pthread_mutex_lock(&journal.mutex);
+    for (;;) {
+        if (!journal.stop && journal.count < JOURNAL_BUFFER_EVENTS / 2) {
+            struct timespec deadline;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += JOURNAL_FLUSH_INTERVAL_MS / 1000;
+            deadline.tv_nsec += (long)(JOURNAL_FLUSH_INTERVAL_MS % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            pthread_cond_timedwait(&journal.cond, &journal.mutex, &deadline);
+        }
+
+        bool stop = journal.stop;
+        int count = journal.count;
+        const journal_event_t *events = journal.buffers[journal.active];
+        if (count > 0) {
+            journal.active ^= 1;
+            journal.count = 0;
+        }
+        pthread_mutex_unlock(&journal.mutex);
+
+        if (count > 0) {
+            journal_flush(events, count);
+        }
+        if (stop) {
+            break;
+        }
+
+        pthread_mutex_lock(&journal.mutex);
+    }
+
+    journal_close_segment();
+    return NULL;
+}
+
+int journal_init(const char *dir) {
+    snprintf(journal.dir, sizeof(journal.dir), "%s", dir);
+
+    if (mkdir(dir, 0755) < 0 && errno != EEXIST) {
+        log_error("저널 디렉터리 생성 실패: %s (%s)", dir, strerror(errno));
+        return -1;
+    }
+
+    journal.buffers[0] = malloc(sizeof(journal_event_t) * JOURNAL_BUFFER_EVENTS);
+    journal.buffers[1] = malloc(sizeof(journal_event_t) * JOURNAL_BUFFER_EVENTS);
+    if (journal.buffers[0] == NULL || journal.buffers[1] == NULL) {
+        log_error("저널 버퍼 할당 실패");
+        free(journal.buffers[0]);
+        free(journal.buffers[1]);
+        journal.buffers[0] = journal.buffers[1] = NULL;
+        return -1;
+    }
+
+    memset(&journal.stats, 0, sizeof(journal.stats));
+    journal.active = 0;
+    journal.count = 0;
+    journal.stop = false;
+
+    if (journal_open_segment(journal_last_sequence(dir) + 1) < 0) {
+        free(journal.buffers[0]);
+        free(journal.buffers[1]);
+        journal.buffers[0] = journal.buffers[1] = NULL;
+        return -1;
+    }
+    journal.stats.segment_sequence = journal.sequence;
+    journal.stats.segment_bytes = (uint64_t)journal.segment_bytes;
+
+    journal.running = true;
+    if (pthread_create(&journal.thread, NULL, journal_thread, NULL) != 0) {
+        journal.running = false;
+        log_error("저널 스레드 생성 실패");
+        journal_close_segment();
+        free(journal.buffers[0]);
+        free(journal.buffers[1]);
+        journal.buffers[0] = journal.buffers[1] = NULL;
+        return -1;
+    }
+
+    log_info("시청 이벤트 저널 시작: %s (세그먼트 %llu)", dir, (unsigned long long)journal.sequence);
+    return 0;
+}
+
+void journal_shutdown(void) {
+    if (!journal.running) {
+        return;
+    }
+
+    // running을 먼저 내려 이후 기록은 버퍼에 들어가지 않게 한다
+    pthread_mutex_lock(&journal.mutex);
+    journal.running = false;
+    journal.stop = true;
+    pthread_cond_signal(&journal.cond);
+    pthread_mutex_unlock(&journal.mutex);
+
+    pthread_join(journal.thread, NULL);
+
+    free(journal.buffers[0]);
+    free(journal.buffers[1]);
+    journal.buffers[0] = journal.buffers[1] = NULL;
+
+    log_info("시청 이벤트 저널 종료 (기록 %llu, 버림 %llu)",
+             (unsigned long long)journal.stats.written, (unsigned long long)journal.stats.dropped);
+}
+
+int journal_record(journal_event_type_t type, const char *user_id, const char *video_id,
+                   int position_sec, int from_sec) {
+    journal_event_t event;
+    memset(&event, 0, sizeof(event));
+
+    if (uuid_parse(user_id, event.user_id) < 0 || uuid_parse(video_id, event.video_id) < 0) {
+        return -1;
+    }
+    event.timestamp_ms = journal_now_ms();
+    event.position_sec = position_sec > 0 ? (uint32_t)position_sec : 0;
+    event.from_sec = from_sec > 0 ? (uint32_t)from_sec : 0;
+    event.type = (uint16_t)type;
+    event.checksum = journal_event_checksum(&event);
+
+    pthread_mutex_lock(&journal.mutex);
+    if (!journal.running || journal.count >= JOURNAL_BUFFER_EVENTS) {
+        journal.stats.dropped++;
+        pthread_mutex_unlock(&journal.mutex);
+        return -1;
+    }
+    journal.buffers[journal.active][journal.count++] = event;
+    journal.stats.recorded++;
+    if (journal.count == JOURNAL_BUFFER_EVENTS / 2) {
+        pthread_cond_signal(&journal.cond);
+    }
+    pthread_mutex_unlock(&journal.mutex);
+
+    return 0;
+}
+
+void journal_get_stats(journal_stats_t *stats) {
+    pthread_mutex_lock(&journal.mutex);
+    *stats = journal.stats;
+    pthread_mutex_unlock(&journal.mutex);
+}
@@ -0,0 +1,429 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <dirent.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <sqlite3.h>
+#include "journal.h"
+#include "uuid.h"
+#include "config.h"
+
+// 시청 이벤트 저널 집계 도구
+// 저널 세그먼트를 순서대로 읽어 analytics DB(서비스 DB와 별도 파일)에 증분 집계한다.
+// 마지막으로 처리한 위치(세그먼트, 오프셋)를 저장하므로 주기적으로 다시 실행하면 새 이벤트만 처리한다.
+
+#define RETENTION_BUCKET_SEC 10             // 잔존율 히스토그램 구간 크기
+#define RETENTION_MAX_SEC (24 * 3600)       // 이보다 큰 위치는 잘라낸다
+
+static const char *AGG_SCHEMA =
+    "PRAGMA journal_mode = WAL;"
+    "PRAGMA synchronous = NORMAL;"
+    "CREATE TABLE IF NOT EXISTS journal_cursor ("
+    "  id INTEGER PRIMARY KEY CHECK (id = 1),"
+    "  segment INTEGER NOT NULL,"
+    "  offset INTEGER NOT NULL);"
+    // 시청자별 최대 시청 위치 (잔존율 증분 계산용)
+    "CREATE TABLE IF NOT EXISTS viewer_progress ("
+    "  user_id BLOB NOT NULL,"
+    "  video_id BLOB NOT NULL,"
+    "  max_position INTEGER NOT NULL,"
+    "  completed INTEGER NOT NULL DEFAULT 0,"
+    "  starts INTEGER NOT NULL DEFAULT 0,"
+    "  PRIMARY KEY (user_id, video_id)) WITHOUT ROWID;"
+    // bucket b: 시청 위치가 b * RETENTION_BUCKET_SEC초 이상에 도달한 시청자 수
+    "CREATE TABLE IF NOT EXISTS video_retention ("
+    "  video_id BLOB NOT NULL,"
+    "  bucket INTEGER NOT NULL,"
+    "  viewers INTEGER NOT NULL,"
+    "  PRIMARY KEY (video_id, bucket)) WITHOUT ROWID;"
+    "CREATE TABLE IF NOT EXISTS video_summary ("
+    "  video_id BLOB PRIMARY KEY,"
+    "  viewers INTEGER NOT NULL DEFAULT 0,"
+    "  starts INTEGER NOT NULL DEFAULT 0,"
+    "  completions INTEGER NOT NULL DEFAULT 0,"
+    "  seeks INTEGER NOT NULL DEFAULT 0,"
+    "  last_event_ms INTEGER NOT NULL DEFAULT 0) WITHOUT ROWID;";
+
+typedef struct {
+    sqlite3 *db;
+    sqlite3_stmt *get_viewer;
+    sqlite3_stmt *put_viewer;
+    sqlite3_stmt *add_bucket;
+    sqlite3_stmt *add_summary;
+    long long events;
+    long long corrupt;
+} agg_t;
+
+static int agg_prepare(agg_t *agg) {
+    static const char *sql[] = {
+        "SELECT max_position, completed FROM viewer_progress WHERE user_id = ? AND video_id = ?",
+        "INSERT INTO viewer_progress (user_id, video_id, max_position, completed, starts) "
+        "VALUES (?1, ?2, ?3, ?4, ?5) "
+        "ON CONFLICT (user_id, video_id) DO UPDATE SET "
+        "max_position = ?3, completed = ?4, starts = starts + ?5",
+        "INSERT INTO video_retention (video_id, bucket, viewers) VALUES (?, ?, 1) "
+        "ON CONFLICT (video_id, bucket) DO UPDATE SET viewers = viewers + 1",
+        "INSERT INTO video_summary (video_id, viewers, starts, completions, seeks, last_event_ms) "
+        "VALUES (?1, ?2, ?3, ?4, ?5, ?6) "
+        "ON CONFLICT (video_id) DO UPDATE SET "
+        "viewers = viewers + ?2, starts = starts + ?3, completions = completions + ?4, "
+        "seeks = seeks + ?5, last_event_ms = max(last_event_ms, ?6)"
+    };
+    sqlite3_stmt **stmts[] = { &agg->get_viewer, &agg->put_viewer, &agg->add_bucket, &agg->add_summary };
+
+    for (size_t i = 0; i < sizeof(sql) / sizeof(sql[0]); i++) {
+        if (sqlite3_prepare_v2(agg->db, sql[i], -1, stmts[i], NULL) != SQLITE_OK) {
+            fprintf(stderr, "❌ SQL 준비 실패: %s\n", sqlite3_errmsg(agg->db));
+            return -1;
+        }
+    }
+    return 0;
+}
+
+static void agg_finalize(agg_t *agg) {
+    sqlite3_finalize(agg->get_viewer);
+    sqlite3_finalize(agg->put_viewer);
+    sqlite3_finalize(agg->add_bucket);
+    sqlite3_finalize(agg->add_summary);
+}
+
+static int step_done(agg_t *agg, sqlite3_stmt *stmt) {
+    int rc = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (rc != SQLITE_DONE) {
+        fprintf(stderr, "❌ 집계 쓰기 실패: %s\n", sqlite3_errmsg(agg->db));
+        return -1;
+    }
+    return 0;
+}
+
+// 이벤트 하나를 반영
+// SEEK은 이동 전 위치까지를 본 것으로 보고, 이동한 위치는 이후 PROGRESS로 반영된다.
+static int agg_apply(agg_t *agg, const journal_event_t *ev) {
+    int64_t watched = (ev->type == JOURNAL_EVENT_SEEK) ? ev->from_sec : ev->position_sec;
+    if (watched > RETENTION_MAX_SEC) {
+        watched = RETENTION_MAX_SEC;
+    }
+
+    sqlite3_bind_blob(agg->get_viewer, 1, ev->user_id, OTT_UUID_BYTES, SQLITE_STATIC);
+    sqlite3_bind_blob(agg->get_viewer, 2, ev->video_id, OTT_UUID_BYTES, SQLITE_STATIC);
+
+    bool known = false;
+    int64_t max_position = 0;
+    bool completed = false;
+    if (sqlite3_step(agg->get_viewer) == SQLITE_ROW) {
+        known = true;
+        max_position = sqlite3_column_int64(agg->get_viewer, 0);
+        completed = sqlite3_column_int(agg->get_viewer, 1) != 0;
+    }
+    sqlite3_reset(agg->get_viewer);
+
+    // 새로 도달한 구간만 증가시킨다
+    int64_t old_bucket = known ? max_position / RETENTION_BUCKET_SEC : -1;
+    int64_t new_bucket = watched / RETENTION_BUCKET_SEC;
+    for (int64_t b = old_bucket + 1; b <= new_bucket; b++) {
+        sqlite3_bind_blob(agg->add_bucket, 1, ev->video_id, OTT_UUID_BYTES, SQLITE_STATIC);
+        sqlite3_bind_int64(agg->add_bucket, 2, b);
+        if (step_done(agg, agg->add_bucket) < 0) {
+            return -1;
+        }
+    }
+
+    bool newly_completed = ev->type == JOURNAL_EVENT_COMPLETE && !completed;
+    bool is_start = ev->type == JOURNAL_EVENT_START;
+
+    sqlite3_bind_blob(agg->put_viewer, 1, ev->user_id, OTT_UUID_BYTES, SQLITE_STATIC);
+    sqlite3_bind_blob(agg->put_viewer, 2, ev->video_id, OTT_UUID_BYTES, SQLITE_STATIC);
+    sqlite3_bind_int64(agg->put_viewer, 3, watched > max_position ? watched : max_position);
+    sqlite3_bind_int(agg->put_viewer, 4, completed || newly_completed);
+    sqlite3_bind_int(agg->put_viewer, 5, is_start);
+    if (step_done(agg, agg->put_viewer) < 0) {
+        return -1;
+    }
+
+    sqlite3_bind_blob(agg->add_summary, 1, ev->video_id, OTT_UUID_BYTES, SQLITE_STATIC);
+    sqlite3_bind_int(agg->add_summary, 2, !known);
+    sqlite3_bind_int(agg->add_summary, 3, is_start);
+    sqlite3_bind_int(agg->add_summary, 4, newly_completed);
+    sqlite3_bind_int(agg->add_summary, 5, ev->type == JOURNAL_EVENT_SEEK);
+    sqlite3_bind_int64(agg->add_summary, 6, ev->timestamp_ms);
+    return step_done(agg, agg->add_summary);
+}
+
+static int agg_save_cursor(agg_t *agg, uint64_t segment, long offset) {
+    char sql[160];
+    snprintf(sql, sizeof(sql),
+             "INSERT OR REPLACE INTO journal_cursor (id, segment, offset) VALUES (1, %llu, %ld)",
+             (unsigned long long)segment, offset);
+    return sqlite3_exec(agg->db, sql, NULL, NULL, NULL) == SQLITE_OK ? 0 : -1;
+}
+
+// 세그먼트 하나를 offset부터 끝까지 처리하고 커서와 함께 한 트랜잭션으로 커밋한다.
+// 끝의 잘린 레코드(기록 중인 세그먼트)는 남겨두었다가 다음 실행에서 다시 읽는다.
+// active: 서버가 아직 쓰고 있을 수 있는 마지막 세그먼트
+// 끝에 걸친 레코드(길이가 모자라거나 체크섬이 틀린 마지막 레코드)는 쓰는 중일 수 있으므로 건너뛰지 않고
+// 커서를 그 앞에 두어 다음 실행에서 다시 읽는다. 지난 세그먼트의 끝은 더 쓰일 일이 없으므로 손상으로 센다.
+static int agg_segment(agg_t *agg, const char *dir, uint64_t sequence, long offset, bool active) {
+    char path[MAX_PATH_LEN];
+    journal_segment_path(dir, sequence, path, sizeof(path));
+
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        fprintf(stderr, "❌ 세그먼트를 열 수 없습니다: %s\n", path);
+        return -1;
+    }
+
+    journal_segment_header_t header;
+    if (fread(&header, sizeof(header), 1, fp) != 1 ||
+        memcmp(header.magic, JOURNAL_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != JOURNAL_VERSION || header.event_size != sizeof(journal_event_t)) {
+        fprintf(stderr, "⚠️  세그먼트 헤더가 올바르지 않아 건너뜁니다: %s\n", path);
+        fclose(fp);
+        return agg_save_cursor(agg, sequence, 0);
+    }
+
+    if (offset < (long)sizeof(header)) {
+        offset = (long)sizeof(header);
+    }
+    if (fseek(fp, offset, SEEK_SET) != 0) {
+        fclose(fp);
+        return -1;
+    }
+
+    sqlite3_exec(agg->db, "BEGIN", NULL, NULL, NULL);
+
+    journal_event_t ev;
+    int result = 0;
+    size_t n;
+    while ((n = fread(&ev, 1, sizeof(ev), fp)) == sizeof(ev)) {
+        if (ev.checksum != journal_event_checksum(&ev) ||
+            ev.type < JOURNAL_EVENT_START || ev.type > JOURNAL_EVENT_COMPLETE) {
+            // 뒤에 완전한 레코드가 하나도 없으면 아직 쓰는 중인 레코드
+            struct stat st;
+            if (active && fstat(fileno(fp), &st) == 0 && st.st_size < offset + 2 * (long)sizeof(ev)) {
+                n = 0;
+                break;
+            }
+            offset += (long)sizeof(ev);
+            agg->corrupt++;
+            continue;
+        }
+        offset += (long)sizeof(ev);
+        if (agg_apply(agg, &ev) < 0) {
+            result = -1;
+            break;
+        }
+        agg->events++;
+    }
+    if (result == 0 && n > 0 && n < sizeof(ev) && !active) {
+        agg->corrupt++;             // 지난 세그먼트 끝의 잘린 레코드
+    }
+    fclose(fp);
+
+    if (result == 0) {
+        result = agg_save_cursor(agg, sequence, offset);
+    }
+    if (result == 0 && sqlite3_exec(agg->db, "COMMIT", NULL, NULL, NULL) == SQLITE_OK) {
+        return 0;
+    }
+    sqlite3_exec(agg->db, "ROLLBACK", NULL, NULL, NULL);
+    return -1;
+}
+
+static int compare_u64(const void *a, const void *b) {
+    uint64_t x = *(const uint64_t *)a, y = *(const uint64_t *)b;
+    return (x > y) - (x < y);
+}
+
+// 세그먼트 번호 목록 (오름차순, 호출자가 free)
+static int list_segments(const char *dir, uint64_t **out) {
+    DIR *d = opendir(dir);
+    if (d == NULL) {
+        return -1;
+    }
+
+    int count = 0, cap = 16;
+    uint64_t *seqs = malloc(sizeof(uint64_t) * cap);
+    struct dirent *entry;
+    while (seqs != NULL && (entry = readdir(d)) != NULL) {
+        unsigned long long seq;
+        char tail[8];
+        if (sscanf(entry->d_name, "events-%llu.%7s", &seq, tail) != 2 || strcmp(tail, "log") != 0) {
+            continue;
+        }
+        if (count == cap) {
+            cap *= 2;
+            uint64_t *grown = realloc(seqs, sizeof(uint64_t) * cap);
+            if (grown == NULL) {
+                free(seqs);
+                seqs = NULL;
+                break;
+            }
+            seqs = grown;
+        }
+        seqs[count++] = seq;
+    }
+    closedir(d);
+
+    if (seqs == NULL) {
+        return -1;
+    }
+    qsort(seqs, count, sizeof(uint64_t), compare_u64);
+    *out = seqs;
+    return count;
+}
+
+static int aggregate(const char *journal_dir, sqlite3 *db) {
+    agg_t agg = { .db = db };
+    if (agg_prepare(&agg) < 0) {
+        agg_finalize(&agg);
+        return 1;
+    }
+
+    uint64_t cursor_segment = 0;
+    long cursor_offset = 0;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT segment, offset FROM journal_cursor WHERE id = 1",
+                           -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            cursor_segment = (uint64_t)sqlite3_column_int64(stmt, 0);
+            cursor_offset = (long)sqlite3_column_int64(stmt, 1);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    uint64_t *segments = NULL;
+    int count = list_segments(journal_dir, &segments);
+    if (count < 0) {
+        fprintf(stderr, "❌ 저널 디렉터리를 읽을 수 없습니다: %s\n", journal_dir);
+        agg_finalize(&agg);
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    int result = 0;
+    int processed = 0;
+    for (int i = 0; i < count; i++) {
+        if (segments[i] < cursor_segment) {
+            continue;
+        }
+        long offset = (segments[i] == cursor_segment) ? cursor_offset : 0;
+        if (agg_segment(&agg, journal_dir, segments[i], offset, i == count - 1) < 0) {
+            fprintf(stderr, "❌ 세그먼트 %llu 집계 실패\n", (unsigned long long)segments[i]);
+            result = 1;
+            break;
+        }
+        processed++;
+    }
+    free(segments);
+
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double elapsed = (end.tv_sec - start.tv_sec) + (end.tv_nsec - start.tv_nsec) / 1e9;
+    printf("✅ 세그먼트 %d개, 이벤트 %lld건 집계 (손상 %lld건, %.2f초)\n",
+           processed, agg.events, agg.corrupt, elapsed);
+
+    agg_finalize(&agg);
+    return result;
+}
+
+// 동영상 하나의 요약과 잔존율 곡선 출력
+static int report(sqlite3 *db, const char *video_id) {
+    uint8_t key[OTT_UUID_BYTES];
+    if (uuid_parse(video_id, key) < 0) {
+        fprintf(stderr, "❌ 잘못된 동영상 ID: %s\n", video_id);
+        return 1;
+    }
+
+    sqlite3_stmt *stmt;
+    long long viewers = 0;
+    if (sqlite3_prepare_v2(db, "SELECT viewers, starts, completions, seeks FROM video_summary "
+                           "WHERE video_id = ?", -1, &stmt, NULL) != SQLITE_OK) {
+        fprintf(stderr, "❌ 집계 DB 조회 실패: %s\n", sqlite3_errmsg(db));
+        return 1;
+    }
+    sqlite3_bind_blob(stmt, 1, key, OTT_UUID_BYTES, SQLITE_STATIC);
+    if (sqlite3_step(stmt) != SQLITE_ROW) {
+        sqlite3_finalize(stmt);
+        printf("집계된 이벤트가 없습니다: %s\n", video_id);
+        return 0;
+    }
+    viewers = sqlite3_column_int64(stmt, 0);
+    long long completions = sqlite3_column_int64(stmt, 2);
+    printf("시청자 %lld명, 재생 시작 %lld회, 완료 %lld명 (%.1f%%), 탐색 %lld회\n",
+           viewers, sqlite3_column_int64(stmt, 1), completions,
+           viewers > 0 ? 100.0 * completions / viewers : 0.0, sqlite3_column_int64(stmt, 3));
+    sqlite3_finalize(stmt);
+
+    if (sqlite3_prepare_v2(db, "SELECT bucket, viewers FROM video_retention "
+                           "WHERE video_id = ? ORDER BY bucket", -1, &stmt, NULL) != SQLITE_OK) {
+        return 1;
+    }
+    sqlite3_bind_blob(stmt, 1, key, OTT_UUID_BYTES, SQLITE_STATIC);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        long long bucket = sqlite3_column_int64(stmt, 0);
+        long long count = sqlite3_column_int64(stmt, 1);
+        printf("  %6llds  %6lld  %5.1f%%\n", bucket * RETENTION_BUCKET_SEC, count,
+               viewers > 0 ? 100.0 * count / viewers : 0.0);
+    }
+    sqlite3_finalize(stmt);
+    return 0;
+}
+
+static void print_usage(const char *prog) {
+    printf("Usage: %s [journal_dir] [analytics_db]\n", prog);
+    printf("       %s --report <video_id> [analytics_db]\n", prog);
+    printf("\n");
+    printf("  저널 세그먼트를 읽어 동영상별 잔존율/완료율을 집계합니다 (기본: %s → %s).\n",
+           JOURNAL_DIR, ANALYTICS_DB_PATH);
+    printf("  마지막 처리 위치를 기억하므로 주기적으로 실행하면 새 이벤트만 반영합니다.\n");
+}
+
+int main(int argc, char *argv[]) {
+    const char *journal_dir = JOURNAL_DIR;
+    const char *db_path = ANALYTICS_DB_PATH;
+    const char *report_video = NULL;
+
+    if (argc > 1 && (strcmp(argv[1], "-h") == 0 || strcmp(argv[1], "--help") == 0)) {
+        print_usage(argv[0]);
+        return 0;
+    }
+    if (argc > 1 && strcmp(argv[1], "--report") == 0) {
+        if (argc < 3) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        report_video = argv[2];
+        if (argc > 3) {
+            db_path = argv[3];
+        }
+    } else {
+        if (argc > 1) {
+            journal_dir = argv[1];
+        }
+        if (argc > 2) {
+            db_path = argv[2];
+        }
+    }
+
+    sqlite3 *db;
+    if (sqlite3_open(db_path, &db) != SQLITE_OK) {
+        fprintf(stderr, "❌ 집계 DB를 열 수 없습니다: %s\n", db_path);
+        sqlite3_close(db);
+        return 1;
+    }
+    char *err = NULL;
+    if (sqlite3_exec(db, AGG_SCHEMA, NULL, NULL, &err) != SQLITE_OK) {
+        fprintf(stderr, "❌ 집계 DB 스키마 생성 실패: %s\n", err ? err : "");
+        sqlite3_free(err);
+        sqlite3_close(db);
+        return 1;
+    }
+
+    int rc = report_video ? report(db, report_video) : aggregate(journal_dir, db);
+    sqlite3_close(db);
+    return rc;
+}
@@ -5,14 +5,15 @@
 #include "json_helper.h"
 #include "logger.h"
 
-cJSON* json_create_video(const video_t *video, const char *thumbnail_url) {
+cJSON* json_create_video(const catalog_snapshot_t *snap, const catalog_video_t *cv,
+                         const char *thumbnail_url) {
     cJSON *json = cJSON_CreateObject();
     
-    cJSON_AddStringToObject(json, "id", video->id);
-    cJSON_AddStringToObject(json, "title", video->title);
-    cJSON_AddStringToObject(json, "description", video->description);
-    cJSON_AddNumberToObject(json, "durationSec", video->duration_sec);
-    cJSON_AddStringToObject(json, "mimeType", video->mime_type);
+    cJSON_AddStringToObject(json, "id", catalog_str(snap, cv->id));
+    cJSON_AddStringToObject(json, "title", catalog_str(snap, cv->title));
+    cJSON_AddStringToObject(json, "description", catalog_str(snap, cv->description));
+    cJSON_AddNumberToObject(json, "durationSec", cv->duration_sec);
+    cJSON_AddItemToObjectCS(json, "mimeType", cJSON_CreateStringReference(mime_name(cv->mime)));
     
     if (thumbnail_url != NULL) {
         cJSON_AddStringToObject(json, "thumbnailUrl", thumbnail_url);
@@ -21,22 +22,39 @@ cJSON* json_create_video(const video_t *video, const char *thumbnail_url) {
     return json;
 }
 
-cJSON* json_create_video_list(video_t *videos, int count, int page, int page_size, int total) {
+cJSON* json_create_video_page(const video_page_t *page, int page_size, int total,
+                              const char *next_cursor) {
     cJSON *json = cJSON_CreateObject();
     cJSON *items = cJSON_CreateArray();
     
-    for (int i = 0; i < count; i++) {
-        char thumbnail_url[256];
-        snprintf(thumbnail_url, sizeof(thumbnail_url), "/api/videos/%s/thumbnail", videos[i].id);
+    // 키는 상수(CS), 값은 페이지 아레나/MIME 테이블 참조로 추가해 문자열 복사를 없앤다
+    for (int i = 0; i < page->count; i++) {
+        const video_record_t *rec = &page->items[i];
+        cJSON *video_json = cJSON_CreateObject();
+        
+        cJSON_AddItemToObjectCS(video_json, "id", cJSON_CreateStringReference(rec->id));
+        cJSON_AddItemToObjectCS(video_json, "title",
+                                cJSON_CreateStringReference(video_page_str(page, rec->title)));
+        cJSON_AddItemToObjectCS(video_json, "description",
+                                cJSON_CreateStringReference(video_page_str(page, rec->description)));
+        cJSON_AddItemToObjectCS(video_json, "durationSec", cJSON_CreateNumber(rec->duration_sec));
+        cJSON_AddItemToObjectCS(video_json, "mimeType", cJSON_CreateStringReference(mime_name(rec->mime)));
+        cJSON_AddItemToObjectCS(video_json, "thumbnailUrl",
+                                cJSON_CreateStringReference(video_page_str(page, rec->thumbnail_url)));
         
-        cJSON *video_json = json_create_video(&videos[i], thumbnail_url);
         cJSON_AddItemToArray(items, video_json);
     }
     
     cJSON_AddItemToObject(json, "items", items);
-    cJSON_AddNumberToObject(json, "page", page);
     cJSON_AddNumberToObject(json, "pageSize", page_size);
-    cJSON_AddNumberToObject(json, "total", total);
+    if (total >= 0) {
+        cJSON_AddNumberToObject(json, "total", total);
+    }
+    if (next_cursor != NULL && next_cursor[0] != '\0') {
+        cJSON_AddStringToObject(json, "nextCursor", next_cursor);
+    } else {
+        cJSON_AddNullToObject(json, "nextCursor");
+    }
     
     return json;
 }
@@ -61,6 +79,111 @@ cJSON* json_create_watch_history(const watch_history_t *history) {
     return json;
 }
 
+cJSON* json_create_transcode_job(const transcode_job_t *job) {
+    cJSON *json = cJSON_CreateObject();
+    
+    cJSON_AddStringToObject(json, "rung", job->rung);
+    cJSON_AddNumberToObject(json, "height", job->height);
+    cJSON_AddNumberToObject(json, "bitrate", job->bitrate_kbps);
+    cJSON_AddStringToObject(json, "state", job->state);
+    cJSON_AddNumberToObject(json, "attempts", job->attempts);
+    cJSON_AddNumberToObject(json, "progress", job->progress);
+    if (job->error[0] != '\0') {
+        cJSON_AddStringToObject(json, "error", job->error);
+    }
+    
+    return json;
+}
+
+static cJSON* json_create_pool_stats(const db_trace_pool_stat_t *pool) {
+    cJSON *json = cJSON_CreateObject();
+    
+    cJSON_AddNumberToObject(json, "acquires", (double)pool->acquires);
+    cJSON_AddNumberToObject(json, "contended", (double)pool->contended);
+    cJSON_AddNumberToObject(json, "totalWaitMs", pool->total_wait_ns / 1e6);
+    cJSON_AddNumberToObject(json, "maxWaitMs", pool->max_wait_ns / 1e6);
+    cJSON_AddNumberToObject(json, "p99WaitUs", (double)db_trace_percentile_us(pool->wait_hist, 99.0));
+    
+    return json;
+}
+
+cJSON* json_create_db_stats(const db_trace_stat_t *stats, int count,
+                            const db_trace_pool_stat_t *writer, const db_trace_pool_stat_t *readers) {
+    cJSON *json = cJSON_CreateObject();
+    cJSON *items = cJSON_CreateArray();
+    
+    for (int i = 0; i < count; i++) {
+        const db_trace_stat_t *st = &stats[i];
+        cJSON *item = cJSON_CreateObject();
+        
+        cJSON_AddStringToObject(item, "sql", st->sql);
+        cJSON_AddNumberToObject(item, "calls", (double)st->calls);
+        cJSON_AddNumberToObject(item, "totalMs", st->total_ns / 1e6);
+        cJSON_AddNumberToObject(item, "avgUs", st->calls ? st->total_ns / 1e3 / st->calls : 0);
+        cJSON_AddNumberToObject(item, "maxUs", st->max_ns / 1e3);
+        cJSON_AddNumberToObject(item, "p50Us", (double)db_trace_percentile_us(st->latency_hist, 50.0));
+        cJSON_AddNumberToObject(item, "p95Us", (double)db_trace_percentile_us(st->latency_hist, 95.0));
+        cJSON_AddNumberToObject(item, "p99Us", (double)db_trace_percentile_us(st->latency_hist, 99.0));
+        cJSON_AddNumberToObject(item, "rows", (double)st->rows);
+        cJSON_AddNumberToObject(item, "fullScanSteps", (double)st->fullscan_steps);
+        cJSON_AddNumberToObject(item, "sorts", (double)st->sorts);
+        cJSON_AddNumberToObject(item, "autoIndexes", (double)st->autoindexes);
+        cJSON_AddNumberToObject(item, "lockWaitMs", st->wait_ns / 1e6);
+        cJSON_AddNumberToObject(item, "lockWaitP99Us", (double)db_trace_percentile_us(st->wait_hist, 99.0));
+        
+        cJSON_AddItemToArray(items, item);
+    }
+    
+    cJSON *pool = cJSON_CreateObject();
+    cJSON_AddItemToObject(pool, "writer", json_create_pool_stats(writer));
+    cJSON_AddItemToObject(pool, "readers", json_create_pool_stats(readers));
+    
+    cJSON_AddItemToObject(json, "statements", items);
+    cJSON_AddItemToObject(json, "pool", pool);
+    
+    return json;
+}
+
+static void json_add_time(cJSON *json, const char *name, time_t t) {
+    if (t > 0) {
+        cJSON_AddNumberToObject(json, name, (double)t);
+    } else {
+        cJSON_AddNullToObject(json, name);
+    }
+}
+
+cJSON* json_create_db_maint_status(const db_maint_status_t *status) {
+    cJSON *json = cJSON_CreateObject();
+    
+    json_add_time(json, "lastCheckpoint", status->last_checkpoint);
+    json_add_time(json, "lastTruncate", status->last_truncate);
+    json_add_time(json, "lastOptimize", status->last_optimize);
+    json_add_time(json, "lastVacuum", status->last_vacuum);
+    cJSON_AddNumberToObject(json, "walSizeBytes", (double)status->wal_size_bytes);
+    cJSON_AddNumberToObject(json, "walFrames", status->last_wal_frames);
+    cJSON_AddNumberToObject(json, "checkpointedFrames", status->last_checkpointed_frames);
+    cJSON_AddNumberToObject(json, "checkpoints", (double)status->checkpoints);
+    cJSON_AddNumberToObject(json, "busyCheckpoints", (double)status->busy_checkpoints);
+    cJSON_AddNumberToObject(json, "freelistPages", (double)status->freelist_pages);
+    cJSON_AddNumberToObject(json, "vacuumedPages", (double)status->vacuumed_pages);
+    cJSON_AddNumberToObject(json, "reclaimedBlobs", (double)status->reclaimed_blobs);
+    cJSON_AddBoolToObject(json, "incrementalVacuum", status->incremental_vacuum);
+    
+    return json;
+}
+
+cJSON* json_create_journal_stats(const journal_stats_t *stats) {
+    cJSON *json = cJSON_CreateObject();
+    
+    cJSON_AddNumberToObject(json, "recorded", (double)stats->recorded);
+    cJSON_AddNumberToObject(json, "written", (double)stats->written);
+    cJSON_AddNumberToObject(json, "dropped", (double)stats->dropped);
+    cJSON_AddNumberToObject(json, "segment", (double)stats->segment_sequence);
+    cJSON_AddNumberToObject(json, "segmentBytes", (double)stats->segment_bytes);
+    
+    return json;
+}
+
 cJSON* json_create_error(const char *code, const char *message) {
     cJSON *json = cJSON_CreateObject();
     cJSON *error = cJSON_CreateObject();
@@ -1,15 +1,24 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <pthread.h>
 #include <unistd.h>
+#include <time.h>
 #include <sodium.h>
 #include "config.h"
 #include "logger.h"
 #include "db.h"
+#include "catalog.h"
+#include "db_maint.h"
+#include "transcode.h"
+#include "thumb_pack.h"
+#include "thumbnail_queue.h"
+#include "journal.h"
 #include "http_handler.h"
 #include "thread_pool.h"
+#include "cpu_affinity.h"
 
-static volatile int keep_running = 1;
+static volatile sig_atomic_t keep_running = 1;
 
 void signal_handler(int signum) {
     (void)signum;
@@ -26,6 +35,18 @@ void print_banner(void) {
     printf("\n");
 }
 
+// 카탈로그 변경은 세대 번호로 감지해 새 스냅샷 게시
+static void catalog_refresh_task(void *arg) {
+    (void)arg;
+    catalog_refresh_if_changed();
+}
+
+// 변경된 스냅샷을 주기적으로 파일에 저장
+static void catalog_save_task(void *arg) {
+    (void)arg;
+    catalog_save_if_changed(CATALOG_SNAPSHOT_PATH);
+}
+
 int main(int argc, char *argv[]) {
     (void)argc;
     (void)argv;
@@ -36,6 +57,16 @@ int main(int argc, char *argv[]) {
     logger_init(LOG_INFO);
     log_info("OTT 스트리밍 서버를 시작합니다...");
     
+    // 종료 시그널은 메인 스레드만 받도록 스레드를 만들기 전에 막아 둔다 (이후 스레드가 마스크를 물려받음)
+    sigset_t stop_signals, old_mask;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGINT);
+    sigaddset(&stop_signals, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, &old_mask);
+    
+    // 스레드 종류별 CPU/NUMA 배치 (이후 만드는 스레드가 시작할 때 고정)
+    cpu_affinity_init();
+    
     // libsodium 초기화
     if (sodium_init() < 0) {
         log_error("libsodium 초기화 실패");
@@ -49,9 +80,68 @@ int main(int argc, char *argv[]) {
         return 1;
     }
     
+    // 카탈로그 스냅샷 적재
+    if (catalog_init() < 0) {
+        log_error("카탈로그 초기화 실패");
+        db_close();
+        return 1;
+    }
+    
+    // 주기 작업용 백그라운드 풀 (기능마다 스레드를 두지 않고 타이머 휠 하나로 예약)
+    thread_pool_t *background = thread_pool_create_bounded(BACKGROUND_THREADS, BACKGROUND_QUEUE_CAPACITY);
+    if (background == NULL) {
+        log_error("백그라운드 스레드 풀 생성 실패");
+        catalog_shutdown();
+        db_close();
+        return 1;
+    }
+    
+    // 백그라운드 유지보수 (체크포인트, optimize, 증분 VACUUM)
+    if (db_maint_start(DB_PATH, background) < 0) {
+        log_warn("DB 유지보수 없이 계속합니다");
+    }
+    
+    // 낮은 비트레이트 단계 트랜스코딩 (ffmpeg가 없으면 작업이 실패로 남을 뿐 서비스는 계속)
+    if (transcode_start(background) < 0) {
+        log_warn("트랜스코딩 없이 계속합니다");
+    }
+    
+    // 썸네일 팩 압축 (지운 썸네일이 많은 지난 팩을 주기적으로 정리)
+    if (thumb_pack_start(background) < 0) {
+        log_warn("썸네일 팩 압축 없이 계속합니다");
+    }
+    
+    thread_pool_timer_t *refresh_timer = NULL;
+    thread_pool_timer_t *save_timer = NULL;
+    thread_pool_schedule_every(background, CATALOG_REFRESH_INTERVAL_MS, catalog_refresh_task, NULL,
+                               TP_PRIORITY_NORMAL, &refresh_timer);
+    thread_pool_schedule_every(background, CATALOG_SAVE_INTERVAL_SEC * 1000, catalog_save_task, NULL,
+                               TP_PRIORITY_BATCH, &save_timer);
+    
+    // 시청 이벤트 저널 (분석용, 실패해도 서비스는 계속)
+    if (journal_init(JOURNAL_DIR) < 0) {
+        log_warn("시청 이벤트 저널 없이 계속합니다");
+    }
+    
+    // 썸네일이 없는 동영상은 첫 요청 때 만든다 (실패하면 404를 그대로 보낸다)
+    if (thumbnail_queue_start() < 0) {
+        log_warn("요청 시 썸네일 생성 없이 계속합니다");
+    }
+    
     // HTTP 서버 초기화
     if (http_server_init() < 0) {
         log_error("HTTP 서버 초기화 실패");
+        journal_shutdown();
+        thumbnail_queue_stop();
+        thread_pool_timer_cancel(refresh_timer, true);
+        thread_pool_timer_cancel(save_timer, true);
+        thread_pool_timer_release(refresh_timer);
+        thread_pool_timer_release(save_timer);
+        transcode_stop();
+        thumb_pack_stop();
+        db_maint_stop();
+        thread_pool_destroy(background);
+        catalog_shutdown();
         db_close();
         return 1;
     }
@@ -59,6 +149,17 @@ int main(int argc, char *argv[]) {
     // HTTP 서버 시작
     if (http_server_start() < 0) {
         log_error("HTTP 서버 시작 실패");
+        journal_shutdown();
+        thumbnail_queue_stop();
+        thread_pool_timer_cancel(refresh_timer, true);
+        thread_pool_timer_cancel(save_timer, true);
+        thread_pool_timer_release(refresh_timer);
+        thread_pool_timer_release(save_timer);
+        transcode_stop();
+        thumb_pack_stop();
+        db_maint_stop();
+        thread_pool_destroy(background);
+        catalog_shutdown();
         db_close();
         return 1;
     }
@@ -71,14 +172,26 @@ int main(int argc, char *argv[]) {
     log_info("서버 주소: http://localhost:%s", SERVER_PORT);
     log_info("종료하려면 Ctrl+C를 누르세요");
     
-    // 메인 루프
+    // 메인 스레드는 종료 시그널까지 잠든다 (주기 작업은 백그라운드 풀의 타이머가 실행)
     while (keep_running) {
-        sleep(1);
+        sigsuspend(&old_mask);
     }
     
     // 정리
     log_info("서버를 종료합니다...");
     http_server_stop();
+    journal_shutdown();
+    thumbnail_queue_stop();
+    thread_pool_timer_cancel(refresh_timer, true);
+    thread_pool_timer_cancel(save_timer, true);
+    thread_pool_timer_release(refresh_timer);
+    thread_pool_timer_release(save_timer);
+    transcode_stop();
+    thumb_pack_stop();
+    db_maint_stop();
+    thread_pool_destroy(background);
+    catalog_save_if_changed(CATALOG_SNAPSHOT_PATH);
+    catalog_shutdown();
     db_close();
     
     log_info("서버가 정상적으로 종료되었습니다");
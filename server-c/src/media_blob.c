@@ -0,0 +1,124 @@
+#ifdef __linux__
+#define _DEFAULT_SOURCE                 // posix_fadvise
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sodium.h>
+#include "media_blob.h"
+#include "logger.h"
+#include "config.h"
+
+#define MEDIA_HASH_BUFFER (1024 * 1024)
+
+int media_hash_file(const char *path, char hash_hex[MEDIA_HASH_HEX_LEN], int64_t *size) {
+    if (sodium_init() < 0) {
+        log_error("libsodium 초기화 실패");
+        return -1;
+    }
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        log_error("해시할 파일을 열 수 없습니다: %s (%s)", path, strerror(errno));
+        return -1;
+    }
+    unsigned char *buffer = malloc(MEDIA_HASH_BUFFER);
+    if (buffer == NULL) {
+        close(fd);
+        return -1;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    crypto_generichash_state state;
+    crypto_generichash_init(&state, NULL, 0, MEDIA_HASH_BYTES);
+
+    int64_t total = 0;
+    ssize_t n;
+    while ((n = read(fd, buffer, MEDIA_HASH_BUFFER)) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        crypto_generichash_update(&state, buffer, (unsigned long long)n);
+        total += n;
+    }
+    int err = errno;
+    free(buffer);
+    close(fd);
+    if (n < 0) {
+        log_error("해시 중 읽기 실패: %s (%s)", path, strerror(err));
+        return -1;
+    }
+
+    unsigned char digest[MEDIA_HASH_BYTES];
+    crypto_generichash_final(&state, digest, sizeof(digest));
+    sodium_bin2hex(hash_hex, MEDIA_HASH_HEX_LEN, digest, sizeof(digest));
+    if (size != NULL) {
+        *size = total;
+    }
+    return 0;
+}
+
+void media_blob_path(const char *hash_hex, char *out, size_t out_len) {
+    snprintf(out, out_len, "%s/%.2s/%s", MEDIA_BLOB_DIR, hash_hex, hash_hex);
+}
+
+// 같은 해시의 파일이 이미 있는지 (크기가 다르면 해시 충돌이 아니라 손상이므로 오류)
+static int media_blob_exists(const char *path, int64_t size) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        return 0;
+    }
+    if (st.st_size != size) {
+        log_error("저장된 파일 크기가 해시와 맞지 않습니다: %s (%lld != %lld)", path,
+                  (long long)st.st_size, (long long)size);
+        return -1;
+    }
+    return 1;
+}
+
+int media_blob_store(const char *src, const char *hash_hex, int64_t size, bool move,
+                     char *out_path, size_t out_len, bool *deduped,
+                     media_place_method_t *method, int64_t *copied) {
+    media_blob_path(hash_hex, out_path, out_len);
+    *deduped = false;
+    if (copied != NULL) {
+        *copied = 0;
+    }
+
+    int exists = media_blob_exists(out_path, size);
+    if (exists != 0) {
+        *deduped = (exists > 0);
+        return exists > 0 ? 0 : -1;
+    }
+
+    char dir[MAX_PATH_LEN];
+    snprintf(dir, sizeof(dir), "%s/%.2s", MEDIA_BLOB_DIR, hash_hex);
+    mkdir(MEDIA_BLOB_DIR, 0755);
+    if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+        log_error("저장소 디렉토리를 만들 수 없습니다: %s (%s)", dir, strerror(errno));
+        return -1;
+    }
+
+    // 하드 링크는 원본을 고치면 저장된 내용도 바뀌므로 쓰지 않고 (리플링크는 쓰기 시 복사),
+    // 저장한 파일은 읽기 전용으로 둔다
+    if (media_place(src, out_path, move, false, method, copied) == 0) {
+        chmod(out_path, 0444);
+        return 0;
+    }
+    // 같은 내용을 동시에 등록하던 다른 작업이 먼저 놓은 경우
+    if (media_blob_exists(out_path, size) > 0) {
+        *deduped = true;
+        return 0;
+    }
+    return -1;
+}
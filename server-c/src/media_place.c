@@ -0,0 +1,255 @@
+#ifdef __linux__
+#define _GNU_SOURCE                     // copy_file_range
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <libgen.h>
+#include <sys/stat.h>
+#include "media_place.h"
+#include "logger.h"
+#include "config.h"
+
+#ifdef __linux__
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#endif
+#ifdef __APPLE__
+#include <sys/clonefile.h>
+#endif
+
+static const char *const method_names[MEDIA_PLACE_METHOD_COUNT] = { "이동", "하드 링크", "리플링크", "copy_file_range", "복사" };
+
+const char* media_place_method_name(media_place_method_t method) {
+    return (method >= MEDIA_PLACE_RENAME && method < MEDIA_PLACE_METHOD_COUNT) ? method_names[method] : "?";
+}
+
+// 다음 방법으로 넘어가도 되는 오류 (파일 시스템이 지원하지 않거나 볼륨이 다름)
+static bool place_unsupported(int err) {
+    return err == EXDEV || err == EPERM || err == ENOTSUP || err == EOPNOTSUPP ||
+           err == ENOSYS || err == EINVAL || err == EMLINK || err == ENOTTY;
+}
+
+// 이름 변경/링크가 디스크에 남도록 디렉토리 항목을 fsync
+static void place_sync_dir(const char *path) {
+    char buf[MAX_PATH_LEN];
+    snprintf(buf, sizeof(buf), "%s", path);
+    int fd = open(dirname(buf), O_RDONLY);
+    if (fd >= 0) {
+        fsync(fd);
+        close(fd);
+    }
+}
+
+#ifdef __linux__
+// 커널 안에서 복사 (같은 파일 시스템이면 파일 시스템이 블록을 공유하거나 서버 쪽 복사를 할 수 있다)
+// 반환: 0 성공, 1 지원하지 않음 (아무것도 복사하지 않음), -1 실패
+static int place_copy_range(int in, int out, int64_t size, int64_t *copied) {
+    int64_t done = 0;
+    while (done < size) {
+        size_t chunk = (size - done) > (1LL << 30) ? (size_t)(1LL << 30) : (size_t)(size - done);
+        ssize_t n = copy_file_range(in, NULL, out, NULL, chunk, 0);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return (done == 0 && place_unsupported(errno)) ? 1 : -1;
+        }
+        if (n == 0) {
+            break;                  // 복사 중 원본이 줄어듦
+        }
+        done += n;
+    }
+    *copied = done;
+    if (done != size) {
+        log_error("복사 중 원본 크기가 바뀌었습니다 (%lld / %lld바이트)", (long long)done, (long long)size);
+        errno = EIO;
+        return -1;
+    }
+    return 0;
+}
+#endif
+
+static int place_copy_buffer(int in, int out, int64_t *copied) {
+    char *buffer = malloc(MEDIA_PLACE_BUFFER_SIZE);
+    if (buffer == NULL) {
+        return -1;
+    }
+#ifdef POSIX_FADV_SEQUENTIAL
+    posix_fadvise(in, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    int64_t done = 0;
+    int rc = 0;
+    ssize_t n;
+    while ((n = read(in, buffer, MEDIA_PLACE_BUFFER_SIZE)) != 0) {
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            rc = -1;
+            break;
+        }
+        for (ssize_t off = 0; off < n && rc == 0; ) {
+            ssize_t w = write(out, buffer + off, (size_t)(n - off));
+            if (w < 0) {
+                if (errno != EINTR) {
+                    rc = -1;
+                }
+                continue;
+            }
+            off += w;
+        }
+        if (rc < 0) {
+            break;
+        }
+        done += n;
+    }
+    free(buffer);
+    *copied = done;
+    return rc;
+}
+
+// 임시 파일에 리플링크 또는 복사한 뒤 fsync하고 dest로 이름 변경
+// 임시 파일 이름은 작업마다 달라서 같은 dest를 동시에 놓는 작업끼리 서로의 파일을 덮어쓰지 않는다
+static int place_copy(const char *src, const char *dest, media_place_method_t *method, int64_t *bytes) {
+    char tmp_path[MAX_PATH_LEN + 16];
+    snprintf(tmp_path, sizeof(tmp_path), "%s.XXXXXX", dest);
+
+    int in = open(src, O_RDONLY);
+    if (in < 0) {
+        log_error("원본을 열 수 없습니다: %s (%s)", src, strerror(errno));
+        return -1;
+    }
+    struct stat st;
+    if (fstat(in, &st) != 0) {
+        close(in);
+        return -1;
+    }
+
+    int out = mkstemp(tmp_path);
+    if (out < 0) {
+        log_error("임시 파일을 만들 수 없습니다: %s (%s)", tmp_path, strerror(errno));
+        close(in);
+        return -1;
+    }
+    fchmod(out, 0644);
+    int rc = 1;                     // 1: 아직 옮기지 못함
+    int64_t copied = 0;
+#ifdef __APPLE__
+    // clonefile은 대상 파일을 직접 만들므로 방금 만든 빈 임시 파일 자리에 복제한다
+    close(out);
+    unlink(tmp_path);
+    if (clonefile(src, tmp_path, 0) == 0) {
+        *method = MEDIA_PLACE_CLONE;
+        rc = 0;
+        out = open(tmp_path, O_WRONLY);
+    } else {
+        out = open(tmp_path, O_WRONLY | O_CREAT | O_EXCL, 0644);
+    }
+    if (out < 0) {
+        log_error("파일을 만들 수 없습니다: %s (%s)", tmp_path, strerror(errno));
+        if (rc == 0) {
+            unlink(tmp_path);
+        }
+        close(in);
+        return -1;
+    }
+#endif
+#ifdef __linux__
+    if (rc == 1 && ioctl(out, FICLONE, in) == 0) {
+        *method = MEDIA_PLACE_CLONE;
+        rc = 0;
+    }
+    if (rc == 1) {
+        rc = place_copy_range(in, out, st.st_size, &copied);
+        if (rc == 0) {
+            *method = MEDIA_PLACE_COPY_RANGE;
+        }
+    }
+#endif
+    if (rc == 1) {
+        *method = MEDIA_PLACE_COPY;
+        rc = place_copy_buffer(in, out, &copied);
+        // 복사 중 원본이 줄거나 늘었으면 잘린 파일을 등록하지 않는다
+        if (rc == 0 && copied != (int64_t)st.st_size) {
+            log_error("복사 중 원본 크기가 바뀌었습니다 (%lld / %lld바이트)", (long long)copied,
+                      (long long)st.st_size);
+            errno = EIO;
+            rc = -1;
+        }
+    }
+
+    if (rc == 0 && fsync(out) != 0) {
+        rc = -1;
+    }
+#ifdef POSIX_FADV_DONTNEED
+    // 방금 복사한 대용량 파일이 스트리밍 중인 파일의 페이지 캐시를 밀어내지 않도록
+    if (rc == 0 && *method != MEDIA_PLACE_CLONE) {
+        posix_fadvise(in, 0, 0, POSIX_FADV_DONTNEED);
+        posix_fadvise(out, 0, 0, POSIX_FADV_DONTNEED);
+    }
+#endif
+    int err = errno;
+    close(in);
+    if (out >= 0 && close(out) != 0 && rc == 0) {
+        err = errno;
+        rc = -1;
+    }
+    if (rc == 0 && rename(tmp_path, dest) != 0) {
+        err = errno;
+        rc = -1;
+    }
+    if (rc < 0) {
+        log_error("파일 복사 실패: %s → %s (%s)", src, dest, strerror(err));
+        unlink(tmp_path);
+        return -1;
+    }
+
+    place_sync_dir(dest);
+    *bytes = copied;
+    return 0;
+}
+
+int media_place(const char *src, const char *dest, bool move, bool allow_link, media_place_method_t *method,
+                int64_t *bytes) {
+    media_place_method_t used = MEDIA_PLACE_COPY;
+    int64_t copied = 0;
+
+    // rename은 dest를 덮어쓰므로 먼저 확인 (링크는 스스로 EEXIST로 실패)
+    if (access(dest, F_OK) == 0) {
+        log_error("대상 파일이 이미 있습니다: %s", dest);
+        return -1;
+    }
+
+    int rc = -1;
+    if (move && rename(src, dest) == 0) {
+        used = MEDIA_PLACE_RENAME;
+        rc = 0;
+    } else if (allow_link && link(src, dest) == 0) {
+        used = MEDIA_PLACE_LINK;
+        rc = 0;
+    } else if (allow_link && (errno == EEXIST || !place_unsupported(errno))) {
+        log_error("파일을 놓을 수 없습니다: %s → %s (%s)", src, dest, strerror(errno));
+        return -1;
+    }
+
+    if (rc == 0) {
+        place_sync_dir(dest);
+    } else if (place_copy(src, dest, &used, &copied) < 0) {
+        return -1;
+    }
+
+    log_debug("미디어 배치 (%s): %s → %s", media_place_method_name(used), src, dest);
+    if (method != NULL) {
+        *method = used;
+    }
+    if (bytes != NULL) {
+        *bytes = copied;
+    }
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <string.h>
+#include <strings.h>
+#include <stdbool.h>
+#include <pthread.h>
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/avutil.h>
+#include "media_probe.h"
+#include "logger.h"
+
+// 스트림 정보를 찾을 때 읽는 최대 바이트/시간 (MP4는 moov만으로 충분, TS 등은 앞부분 일부만 읽음)
+#define MEDIA_PROBE_SIZE "5000000"
+#define MEDIA_ANALYZE_DURATION "2000000"
+
+static pthread_once_t probe_once = PTHREAD_ONCE_INIT;
+
+static void media_probe_init(void) {
+    // 라이브러리 자체 로그는 끄고 실패는 logger로 남긴다
+    av_log_set_level(AV_LOG_ERROR);
+}
+
+static bool has_extension(const char *path, const char *ext) {
+    const char *dot = strrchr(path, '.');
+    return dot != NULL && strcasecmp(dot + 1, ext) == 0;
+}
+
+// 데먹서 이름(쉼표로 구분된 별칭 목록)과 코덱으로 MIME 타입 결정
+static void media_probe_mime(const AVFormatContext *fmt, const char *path, enum AVCodecID video_codec,
+                             char *out, size_t out_len) {
+    const char *name = fmt->iformat->name;
+    const char *mime = NULL;
+
+    if (strstr(name, "mp4") != NULL || strstr(name, "mov") != NULL) {
+        mime = has_extension(path, "mov") ? "video/quicktime" : "video/mp4";
+    } else if (strstr(name, "matroska") != NULL || strstr(name, "webm") != NULL) {
+        bool webm = video_codec == AV_CODEC_ID_NONE || video_codec == AV_CODEC_ID_VP8 ||
+                    video_codec == AV_CODEC_ID_VP9 || video_codec == AV_CODEC_ID_AV1;
+        mime = webm ? "video/webm" : "video/x-matroska";
+    } else if (strcmp(name, "mpegts") == 0) {
+        mime = "video/mp2t";
+    } else if (strcmp(name, "avi") == 0) {
+        mime = "video/x-msvideo";
+    } else if (strcmp(name, "flv") == 0) {
+        mime = "video/x-flv";
+    } else if (strcmp(name, "ogg") == 0) {
+        mime = "video/ogg";
+    }
+
+    if (mime != NULL) {
+        snprintf(out, out_len, "%s", mime);
+    } else if (fmt->iformat->mime_type != NULL && fmt->iformat->mime_type[0] != '\0') {
+        // 데먹서가 알려 주는 목록의 첫 항목
+        snprintf(out, out_len, "%.*s", (int)strcspn(fmt->iformat->mime_type, ","), fmt->iformat->mime_type);
+    } else {
+        snprintf(out, out_len, "application/octet-stream");
+    }
+}
+
+int media_probe(const char *path, media_info_t *info) {
+    if (path == NULL || info == NULL) {
+        return -1;
+    }
+    memset(info, 0, sizeof(*info));
+    pthread_once(&probe_once, media_probe_init);
+
+    AVDictionary *options = NULL;
+    av_dict_set(&options, "probesize", MEDIA_PROBE_SIZE, 0);
+    av_dict_set(&options, "analyzeduration", MEDIA_ANALYZE_DURATION, 0);
+
+    AVFormatContext *fmt = NULL;
+    int rc = avformat_open_input(&fmt, path, NULL, &options);
+    av_dict_free(&options);
+    if (rc < 0) {
+        char err[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(rc, err, sizeof(err));
+        log_error("미디어 파일 열기 실패: %s (%s)", path, err);
+        return -1;
+    }
+
+    rc = avformat_find_stream_info(fmt, NULL);
+    if (rc < 0) {
+        char err[AV_ERROR_MAX_STRING_SIZE];
+        av_strerror(rc, err, sizeof(err));
+        log_error("미디어 스트림 정보 읽기 실패: %s (%s)", path, err);
+        avformat_close_input(&fmt);
+        return -1;
+    }
+
+    if (fmt->duration != AV_NOPTS_VALUE && fmt->duration > 0) {
+        info->duration_sec = (double)fmt->duration / AV_TIME_BASE;
+    }
+
+    if (fmt->bit_rate > 0) {
+        info->bitrate_kbps = (int)(fmt->bit_rate / 1000);
+    } else if (info->duration_sec > 0 && fmt->pb != NULL) {
+        int64_t size = avio_size(fmt->pb);
+        if (size > 0) {
+            info->bitrate_kbps = (int)(size * 8 / info->duration_sec / 1000);
+        }
+    }
+
+    enum AVCodecID video_codec = AV_CODEC_ID_NONE;
+    int video = av_find_best_stream(fmt, AVMEDIA_TYPE_VIDEO, -1, -1, NULL, 0);
+    if (video >= 0) {
+        const AVCodecParameters *par = fmt->streams[video]->codecpar;
+        video_codec = par->codec_id;
+        info->width = par->width;
+        info->height = par->height;
+        if (par->width > 0 && par->height > 0) {
+            snprintf(info->resolution, sizeof(info->resolution), "%dx%d", par->width, par->height);
+        }
+        snprintf(info->video_codec, sizeof(info->video_codec), "%s", avcodec_get_name(par->codec_id));
+    }
+
+    int audio = av_find_best_stream(fmt, AVMEDIA_TYPE_AUDIO, -1, video, NULL, 0);
+    if (audio >= 0) {
+        snprintf(info->audio_codec, sizeof(info->audio_codec), "%s",
+                 avcodec_get_name(fmt->streams[audio]->codecpar->codec_id));
+    }
+
+    media_probe_mime(fmt, path, video_codec, info->mime_type, sizeof(info->mime_type));
+    avformat_close_input(&fmt);
+
+    log_debug("미디어 정보: %s (%.2f초, %d kbps, %s, %s/%s, %s)", path, info->duration_sec,
+              info->bitrate_kbps, info->resolution, info->video_codec, info->audio_codec, info->mime_type);
+    return 0;
+}
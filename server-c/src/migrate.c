@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include "migrate.h"
+#include "logger.h"
+#include "config.h"
+
+typedef struct {
+    int version;
+    char path[MAX_PATH_LEN];
+} migration_t;
+
+static int migration_compare(const void *a, const void *b) {
+    return ((const migration_t*)a)->version - ((const migration_t*)b)->version;
+}
+
+static char* migrate_read_file(const char *path) {
+    FILE *fp = fopen(path, "rb");
+    if (fp == NULL) {
+        log_error("마이그레이션 파일을 열 수 없음: %s", path);
+        return NULL;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    long size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    char *sql = malloc(size + 1);
+    if (sql == NULL || fread(sql, 1, size, fp) != (size_t)size) {
+        log_error("마이그레이션 파일 읽기 실패: %s", path);
+        free(sql);
+        fclose(fp);
+        return NULL;
+    }
+    sql[size] = '\0';
+
+    fclose(fp);
+    return sql;
+}
+
+// 버전 순으로 정렬된 마이그레이션 목록 (호출자가 free)
+static int migrate_list(const char *migrations_dir, migration_t **out, int *count) {
+    DIR *dir = opendir(migrations_dir);
+    if (dir == NULL) {
+        log_error("마이그레이션 디렉터리를 열 수 없음: %s", migrations_dir);
+        return -1;
+    }
+
+    int capacity = 16;
+    *count = 0;
+    *out = malloc(sizeof(migration_t) * capacity);
+    if (*out == NULL) {
+        closedir(dir);
+        return -1;
+    }
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        int version;
+        int name_end = 0;
+        size_t len = strlen(entry->d_name);
+        if (sscanf(entry->d_name, "V%d__%n", &version, &name_end) != 1 || name_end == 0 ||
+            len < 4 || strcmp(entry->d_name + len - 4, ".sql") != 0) {
+            continue;
+        }
+
+        if (*count == capacity) {
+            capacity *= 2;
+            migration_t *grown = realloc(*out, sizeof(migration_t) * capacity);
+            if (grown == NULL) {
+                free(*out);
+                closedir(dir);
+                return -1;
+            }
+            *out = grown;
+        }
+
+        migration_t *m = &(*out)[(*count)++];
+        m->version = version;
+        snprintf(m->path, sizeof(m->path), "%s/%s", migrations_dir, entry->d_name);
+    }
+    closedir(dir);
+
+    qsort(*out, *count, sizeof(migration_t), migration_compare);
+    return 0;
+}
+
+static int migrate_hex_digit(unsigned char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+// unhex(X): SQLite 3.41 미만 라이브러리를 위한 대체 구현 (잘못된 입력이면 NULL)
+static void migrate_unhex(sqlite3_context *ctx, int argc, sqlite3_value **argv) {
+    (void)argc;
+    if (sqlite3_value_type(argv[0]) == SQLITE_NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+
+    const unsigned char *hex = sqlite3_value_text(argv[0]);
+    int len = sqlite3_value_bytes(argv[0]);
+    if (hex == NULL || len % 2 != 0) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+
+    unsigned char *out = sqlite3_malloc(len / 2 + 1);
+    if (out == NULL) {
+        sqlite3_result_error_nomem(ctx);
+        return;
+    }
+
+    for (int i = 0; i < len / 2; i++) {
+        int hi = migrate_hex_digit(hex[i * 2]);
+        int lo = migrate_hex_digit(hex[i * 2 + 1]);
+        if (hi < 0 || lo < 0) {
+            sqlite3_free(out);
+            sqlite3_result_null(ctx);
+            return;
+        }
+        out[i] = (unsigned char)((hi << 4) | lo);
+    }
+
+    sqlite3_result_blob(ctx, out, len / 2, sqlite3_free);
+}
+
+int migrate_get_version(sqlite3 *db) {
+    sqlite3_stmt *stmt;
+    int version = -1;
+
+    if (sqlite3_prepare_v2(db, "PRAGMA user_version", -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            version = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    return version;
+}
+
+// 외래 키 위반이 하나라도 있으면 -1
+static int migrate_foreign_key_check(sqlite3 *db) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "PRAGMA foreign_key_check", -1, &stmt, NULL) != SQLITE_OK) {
+        return -1;
+    }
+
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        log_error("외래 키 위반: 테이블 %s (rowid %lld)",
+                  (const char*)sqlite3_column_text(stmt, 0), sqlite3_column_int64(stmt, 1));
+    }
+    sqlite3_finalize(stmt);
+
+    return (rc == SQLITE_DONE) ? 0 : -1;
+}
+
+static int migrate_apply(sqlite3 *db, const migration_t *m) {
+    char *sql = migrate_read_file(m->path);
+    if (sql == NULL) {
+        return -1;
+    }
+
+    // 테이블 재구성 중 CASCADE가 동작하지 않도록 외래 키를 끄고 (트랜잭션 밖에서만 변경 가능)
+    // 커밋 전에 foreign_key_check로 무결성을 확인한다
+    char *err_msg = NULL;
+    sqlite3_exec(db, "PRAGMA foreign_keys = OFF", NULL, NULL, NULL);
+
+    int rc = sqlite3_exec(db, "BEGIN IMMEDIATE", NULL, NULL, &err_msg);
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_exec(db, sql, NULL, NULL, &err_msg);
+    }
+    if (rc == SQLITE_OK) {
+        char version_sql[64];
+        snprintf(version_sql, sizeof(version_sql), "PRAGMA user_version = %d", m->version);
+        rc = sqlite3_exec(db, version_sql, NULL, NULL, &err_msg);
+    }
+    if (rc == SQLITE_OK && migrate_foreign_key_check(db) < 0) {
+        rc = SQLITE_CONSTRAINT;
+    }
+    if (rc == SQLITE_OK) {
+        rc = sqlite3_exec(db, "COMMIT", NULL, NULL, &err_msg);
+    }
+
+    if (rc != SQLITE_OK) {
+        log_error("마이그레이션 실패 %s: %s", m->path, err_msg ? err_msg : sqlite3_errstr(rc));
+        sqlite3_free(err_msg);
+        sqlite3_exec(db, "ROLLBACK", NULL, NULL, NULL);
+    }
+
+    sqlite3_exec(db, "PRAGMA foreign_keys = ON", NULL, NULL, NULL);
+    free(sql);
+    return (rc == SQLITE_OK) ? 0 : -1;
+}
+
+int migrate_run(sqlite3 *db, const char *migrations_dir) {
+    int current = migrate_get_version(db);
+    if (current < 0) {
+        log_error("스키마 버전 조회 실패: %s", sqlite3_errmsg(db));
+        return -1;
+    }
+
+    if (sqlite3_libversion_number() < 3041000) {
+        sqlite3_create_function(db, "unhex", 1, SQLITE_UTF8 | SQLITE_DETERMINISTIC, NULL,
+                                migrate_unhex, NULL, NULL);
+    }
+
+    migration_t *migrations = NULL;
+    int count = 0;
+    if (migrate_list(migrations_dir, &migrations, &count) < 0) {
+        return -1;
+    }
+
+    int applied = 0;
+    for (int i = 0; i < count; i++) {
+        if (migrations[i].version <= current) {
+            continue;
+        }
+
+        log_info("마이그레이션 적용 중: %s", migrations[i].path);
+        if (migrate_apply(db, &migrations[i]) < 0) {
+            free(migrations);
+            return -1;
+        }
+        current = migrations[i].version;
+        applied++;
+    }
+
+    free(migrations);
+
+    if (applied > 0) {
+        log_info("마이그레이션 %d개 적용 완료 (스키마 버전 %d)", applied, current);
+    }
+    return 0;
+}
@@ -69,8 +69,40 @@ int streaming_parse_range(const char *range_header, int64_t file_size, http_rang
     return 0;
 }
 
+bool streaming_etag_matches(const char *header, const char *etag, bool weak) {
+    if (header == NULL || etag == NULL || etag[0] == '\0') {
+        return false;
+    }
+    size_t etag_len = strlen(etag);
+    const char *p = header;
+    while (*p != '\0') {
+        while (*p == ' ' || *p == '\t' || *p == ',') {
+            p++;
+        }
+        if (*p == '*') {
+            return weak;
+        }
+        bool is_weak = strncmp(p, "W/", 2) == 0;
+        if (is_weak) {
+            p += 2;
+        }
+        if (*p != '"') {
+            break;
+        }
+        const char *end = strchr(p + 1, '"');
+        if (end == NULL) {
+            break;
+        }
+        if ((weak || !is_weak) && (size_t)(end - p - 1) == etag_len && strncmp(p + 1, etag, etag_len) == 0) {
+            return true;
+        }
+        p = end + 1;
+    }
+    return false;
+}
+
 int streaming_send_video(struct mg_connection *conn, const char *file_path, 
-                         const http_range_t *range, const char *mime_type) {
+                         const http_range_t *range, const char *mime_type, const char *etag) {
     FILE *fp = fopen(file_path, "rb");
     if (fp == NULL) {
         log_error("Failed to open file: %s", file_path);
@@ -98,6 +130,9 @@ int streaming_send_video(struct mg_connection *conn, const char *file_path,
         mg_printf(conn, "Content-Length: %lld\r\n", content_length);
         mg_printf(conn, "Content-Range: bytes %lld-%lld/%lld\r\n", start, end, file_size);
         mg_printf(conn, "Accept-Ranges: bytes\r\n");
+        if (etag != NULL && etag[0] != '\0') {
+            mg_printf(conn, "ETag: \"%s\"\r\n", etag);
+        }
         mg_printf(conn, "Connection: keep-alive\r\n");
         mg_printf(conn, "\r\n");
 
@@ -108,6 +143,9 @@ int streaming_send_video(struct mg_connection *conn, const char *file_path,
         mg_printf(conn, "Content-Type: %s\r\n", mime_type);
         mg_printf(conn, "Content-Length: %lld\r\n", content_length);
         mg_printf(conn, "Accept-Ranges: bytes\r\n");
+        if (etag != NULL && etag[0] != '\0') {
+            mg_printf(conn, "ETag: \"%s\"\r\n", etag);
+        }
         mg_printf(conn, "Connection: keep-alive\r\n");
         mg_printf(conn, "\r\n");
 
@@ -1,96 +1,1249 @@
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <time.h>
 #include <pthread.h>
 #include "thread_pool.h"
+#include "timer_wheel.h"
+#include "cpu_affinity.h"
 #include "logger.h"
 
+#define TP_DEQUE_CAPACITY 1024      // 워커 덱 크기 (2의 거듭제곱, 가득 차면 주입 큐 사용)
+#define TP_CHUNK_TASKS 256          // 노드를 한 번에 할당하는 단위
+#define TP_CACHE_BATCH 64           // 워커 캐시 ↔ 전역 프리 리스트 이동 단위
+#define TP_INJECT_BATCH 32          // 주입 큐에서 한 번에 가져오는 최대 작업 수
+#define TP_FAIRNESS_INTERVAL 16     // 이 횟수마다 한 번 낮은 우선순위 큐부터 확인 (굶주림 방지)
+#define TP_CACHE_LINE 64
+
+// Chase-Lev 덱 (Lê et al. 2013의 C11 메모리 순서)
+// 소유 워커만 bottom 쪽에서 push/pop하고, 다른 워커는 top 쪽에서 CAS로 훔친다.
+// 크기를 고정해 배열 교체와 그에 따른 메모리 회수 문제를 없앴다.
+typedef struct {
+    _Alignas(TP_CACHE_LINE) atomic_long top;
+    _Alignas(TP_CACHE_LINE) atomic_long bottom;
+    _Alignas(TP_CACHE_LINE) _Atomic(task_t *) buffer[TP_DEQUE_CAPACITY];
+} tp_deque_t;
+
+typedef struct tp_worker {
+    tp_deque_t deque;
+    thread_pool_t *pool;
+    pthread_t thread;
+    int index;
+    bool started;
+    unsigned int rng;               // 훔칠 대상 선택용
+    task_t *free_tasks;             // 워커 전용 노드 캐시 (잠금 없음)
+    int free_count;
+    unsigned int ticks;             // 꺼낸 작업 수 (굶주림 방지 주기)
+    atomic_int node;                // 워커가 고정된 NUMA 노드 (훔칠 때 같은 노드를 먼저 본다)
+} tp_worker_t;
+
+typedef struct tp_task_chunk {
+    struct tp_task_chunk *next;
+    task_t tasks[TP_CHUNK_TASKS];
+} tp_task_chunk_t;
+
+// Vyukov 방식 MPMC 링: 칸마다 순번을 두어 생산자/소비자가 CAS 한 번으로 자리를 잡는다
+typedef struct {
+    atomic_size_t sequence;
+    task_func_t function;
+    void *arg;
+    thread_pool_future_t *future;
+    thread_pool_group_t *group;
+} tp_cell_t;
+
+typedef struct tp_ring {
+    _Alignas(TP_CACHE_LINE) atomic_size_t enqueue_pos;
+    _Alignas(TP_CACHE_LINE) atomic_size_t dequeue_pos;
+    _Alignas(TP_CACHE_LINE) size_t mask;
+    tp_cell_t *cells;
+} tp_ring_t;
+
+// 실행할 작업 (노드나 링 칸에서 값으로 복사해 온다)
+typedef struct {
+    task_func_t function;
+    void *arg;
+    thread_pool_future_t *future;
+    thread_pool_group_t *group;
+} tp_job_t;
+
+// 완료 핸들: 제출자와 풀이 하나씩 참조를 가진다
+struct thread_pool_future {
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+    atomic_int state;               // tp_future_state_t
+    atomic_int refs;
+    thread_pool_t *pool;
+    thread_pool_group_t *group;
+};
+
+// 예약 작업: 휠, 핸들을 받은 호출자, 제출된 회차가 각각 참조를 가진다
+// node가 첫 멤버이므로 휠에서 꺼낸 노드를 그대로 변환해 쓴다.
+struct thread_pool_timer {
+    timer_node_t node;
+    struct thread_pool_timer *fire_next;  // 만료 처리 중 제출할 목록 (타이머 스레드 전용)
+    thread_pool_t *pool;
+    task_func_t function;
+    void *arg;
+    tp_priority_t priority;
+    uint64_t interval;              // 주기 (틱, 0이면 한 번 실행)
+    atomic_int refs;
+    bool in_flight;                 // 제출된 회차가 아직 끝나지 않음 (tp_timers.mutex로 보호)
+};
+
+typedef struct tp_timers {
+    pthread_mutex_t mutex;          // 휠과 아래 필드 보호
+    pthread_cond_t cond;            // 새 예약/종료 알림 (타이머 스레드가 대기)
+    pthread_cond_t idle_cond;       // 회차 종료 알림 (thread_pool_timer_cancel의 wait)
+    timer_wheel_t wheel;
+    pthread_t thread;
+    bool started;
+    bool stop;
+    unsigned long fires;
+    unsigned long overruns;
+} tp_timers_t;
+
+// 현재 스레드가 워커라면 그 워커 (다른 풀의 워커인지는 pool로 구분)
+static _Thread_local tp_worker_t *tl_worker = NULL;
+
+// 훔치기 경합에서 진 경우 (비어 있는 것과 구분)
+#define TP_STEAL_ABORT ((task_t *)(uintptr_t)1)
+
 static void* thread_pool_worker(void *arg);
 
-thread_pool_t* thread_pool_create(int num_threads) {
+static bool tp_deque_push(tp_deque_t *d, task_t *task) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed);
+    long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    if (b - t >= TP_DEQUE_CAPACITY) {
+        return false;
+    }
+    atomic_store_explicit(&d->buffer[b & (TP_DEQUE_CAPACITY - 1)], task, memory_order_relaxed);
+    atomic_store_explicit(&d->bottom, b + 1, memory_order_release);
+    return true;
+}
+
+static task_t* tp_deque_pop(tp_deque_t *d) {
+    long b = atomic_load_explicit(&d->bottom, memory_order_relaxed) - 1;
+    atomic_store_explicit(&d->bottom, b, memory_order_relaxed);
+    atomic_thread_fence(memory_order_seq_cst);
+    long t = atomic_load_explicit(&d->top, memory_order_relaxed);
+
+    if (t > b) {
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+        return NULL;
+    }
+
+    task_t *task = atomic_load_explicit(&d->buffer[b & (TP_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (t == b) {
+        // 마지막 하나: 훔치는 쪽과 top을 두고 경쟁
+        if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                     memory_order_seq_cst, memory_order_relaxed)) {
+            task = NULL;
+        }
+        atomic_store_explicit(&d->bottom, b + 1, memory_order_relaxed);
+    }
+    return task;
+}
+
+static task_t* tp_deque_steal(tp_deque_t *d) {
+    long t = atomic_load_explicit(&d->top, memory_order_acquire);
+    atomic_thread_fence(memory_order_seq_cst);
+    long b = atomic_load_explicit(&d->bottom, memory_order_acquire);
+
+    if (t >= b) {
+        return NULL;
+    }
+
+    task_t *task = atomic_load_explicit(&d->buffer[t & (TP_DEQUE_CAPACITY - 1)], memory_order_relaxed);
+    if (!atomic_compare_exchange_strong_explicit(&d->top, &t, t + 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return TP_STEAL_ABORT;
+    }
+    return task;
+}
+
+static bool tp_ring_push(tp_ring_t *ring, const tp_job_t *job) {
+    size_t pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+    tp_cell_t *cell;
+
+    for (;;) {
+        cell = &ring->cells[pos & ring->mask];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)pos;
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->enqueue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;           // 가득 참
+        } else {
+            pos = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+        }
+    }
+
+    cell->function = job->function;
+    cell->arg = job->arg;
+    cell->future = job->future;
+    cell->group = job->group;
+    atomic_store_explicit(&cell->sequence, pos + 1, memory_order_release);
+    return true;
+}
+
+static bool tp_ring_pop(tp_ring_t *ring, tp_job_t *job) {
+    size_t pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+    tp_cell_t *cell;
+
+    for (;;) {
+        cell = &ring->cells[pos & ring->mask];
+        size_t seq = atomic_load_explicit(&cell->sequence, memory_order_acquire);
+        intptr_t diff = (intptr_t)seq - (intptr_t)(pos + 1);
+        if (diff == 0) {
+            if (atomic_compare_exchange_weak_explicit(&ring->dequeue_pos, &pos, pos + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (diff < 0) {
+            return false;           // 비어 있음
+        } else {
+            pos = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+        }
+    }
+
+    job->function = cell->function;
+    job->arg = cell->arg;
+    job->future = cell->future;
+    job->group = cell->group;
+    atomic_store_explicit(&cell->sequence, pos + ring->mask + 1, memory_order_release);
+    return true;
+}
+
+static long tp_ring_depth(tp_ring_t *ring) {
+    size_t enq = atomic_load_explicit(&ring->enqueue_pos, memory_order_relaxed);
+    size_t deq = atomic_load_explicit(&ring->dequeue_pos, memory_order_relaxed);
+    return enq > deq ? (long)(enq - deq) : 0;
+}
+
+// 새 청크를 할당해 전역 프리 리스트에 연결 (queue_mutex 보유 상태)
+static int tp_grow_locked(thread_pool_t *pool) {
+    tp_task_chunk_t *chunk = malloc(sizeof(tp_task_chunk_t));
+    if (chunk == NULL) {
+        log_error("작업 메모리 할당 실패");
+        return -1;
+    }
+
+    chunk->next = pool->chunks;
+    pool->chunks = chunk;
+    for (int i = 0; i < TP_CHUNK_TASKS; i++) {
+        chunk->tasks[i].next = pool->free_tasks;
+        pool->free_tasks = &chunk->tasks[i];
+    }
+    return 0;
+}
+
+// queue_mutex 보유 상태에서 노드 하나 꺼내기
+static task_t* tp_take_free_locked(thread_pool_t *pool) {
+    if (pool->free_tasks == NULL && tp_grow_locked(pool) < 0) {
+        return NULL;
+    }
+    task_t *task = pool->free_tasks;
+    pool->free_tasks = task->next;
+    return task;
+}
+
+// 워커 캐시에서 노드 꺼내기 (비었으면 전역 리스트에서 한 묶음 가져옴)
+static task_t* tp_worker_alloc(tp_worker_t *worker) {
+    if (worker->free_tasks == NULL) {
+        thread_pool_t *pool = worker->pool;
+        pthread_mutex_lock(&pool->queue_mutex);
+        for (int i = 0; i < TP_CACHE_BATCH; i++) {
+            task_t *task = tp_take_free_locked(pool);
+            if (task == NULL) {
+                break;
+            }
+            task->next = worker->free_tasks;
+            worker->free_tasks = task;
+            worker->free_count++;
+        }
+        pthread_mutex_unlock(&pool->queue_mutex);
+        if (worker->free_tasks == NULL) {
+            return NULL;
+        }
+    }
+
+    task_t *task = worker->free_tasks;
+    worker->free_tasks = task->next;
+    worker->free_count--;
+    return task;
+}
+
+// 실행이 끝난 노드 반환 (캐시가 커지면 한 묶음을 전역 리스트로 돌려보냄)
+static void tp_worker_free(tp_worker_t *worker, task_t *task) {
+    task->next = worker->free_tasks;
+    worker->free_tasks = task;
+    worker->free_count++;
+
+    if (worker->free_count >= TP_CACHE_BATCH * 2) {
+        task_t *head = worker->free_tasks;
+        task_t *tail = head;
+        for (int i = 1; i < TP_CACHE_BATCH; i++) {
+            tail = tail->next;
+        }
+        worker->free_tasks = tail->next;
+        worker->free_count -= TP_CACHE_BATCH;
+
+        thread_pool_t *pool = worker->pool;
+        pthread_mutex_lock(&pool->queue_mutex);
+        tail->next = pool->free_tasks;
+        pool->free_tasks = head;
+        pthread_mutex_unlock(&pool->queue_mutex);
+    }
+}
+
+// 잠든 워커가 있고 작업을 찾는 중인 워커가 없으면 하나 깨운다
+// 작업을 넣은 뒤의 seq_cst 펜스와 워커의 sleepers 증가가 짝을 이뤄 깨우기 누락을 막는다.
+// 깨운 워커는 searching으로 계산되므로, 제출이 몰려도 한 번에 하나씩만 깨어난다.
+static void tp_notify(thread_pool_t *pool) {
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&pool->sleepers, memory_order_relaxed) == 0) {
+        return;
+    }
+    int expected = 0;
+    if (!atomic_compare_exchange_strong_explicit(&pool->searching, &expected, 1,
+                                                 memory_order_seq_cst, memory_order_relaxed)) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->park_mutex);
+    pool->wakeups++;
+    pthread_cond_signal(&pool->park_cond);
+    pthread_mutex_unlock(&pool->park_mutex);
+}
+
+static tp_ring_t* tp_ring_create(size_t size) {
+    tp_ring_t *ring = aligned_alloc(TP_CACHE_LINE, sizeof(tp_ring_t));
+    tp_cell_t *cells = ring ? malloc(sizeof(tp_cell_t) * size) : NULL;
+    if (cells == NULL) {
+        free(ring);
+        return NULL;
+    }
+    for (size_t i = 0; i < size; i++) {
+        atomic_init(&cells[i].sequence, i);
+    }
+    atomic_init(&ring->enqueue_pos, 0);
+    atomic_init(&ring->dequeue_pos, 0);
+    ring->mask = size - 1;
+    ring->cells = cells;
+    return ring;
+}
+
+static void tp_ring_free(tp_ring_t *ring) {
+    if (ring != NULL) {
+        free(ring->cells);
+        free(ring);
+    }
+}
+
+static thread_pool_t* tp_create(int num_threads, int capacity) {
     if (num_threads <= 0) {
         log_error("잘못된 스레드 개수: %d", num_threads);
         return NULL;
     }
 
-    thread_pool_t *pool = malloc(sizeof(thread_pool_t));
+    thread_pool_t *pool = calloc(1, sizeof(thread_pool_t));
     if (pool == NULL) {
         log_error("스레드 풀 메모리 할당 실패");
         return NULL;
     }
 
+    // 덱이 캐시 라인 정렬을 요구하므로 aligned_alloc 사용
+    size_t workers_size = sizeof(tp_worker_t) * num_threads;
+    workers_size = (workers_size + TP_CACHE_LINE - 1) / TP_CACHE_LINE * TP_CACHE_LINE;
+    pool->workers = aligned_alloc(TP_CACHE_LINE, workers_size);
+    if (pool->workers == NULL) {
+        log_error("스레드 풀 메모리 할당 실패");
+        free(pool);
+        return NULL;
+    }
+    memset(pool->workers, 0, workers_size);
+
+    if (capacity > 0) {
+        size_t size = 2;
+        while (size < (size_t)capacity) {
+            size <<= 1;
+        }
+        for (int p = 0; p < TP_PRIORITY_COUNT; p++) {
+            pool->rings[p] = tp_ring_create(size);
+            if (pool->rings[p] == NULL) {
+                log_error("스레드 풀 메모리 할당 실패");
+                for (int q = 0; q < p; q++) {
+                    tp_ring_free(pool->rings[q]);
+                }
+                free(pool->workers);
+                free(pool);
+                return NULL;
+            }
+        }
+    }
+
+    pool->timers = calloc(1, sizeof(tp_timers_t));
+    if (pool->timers == NULL) {
+        log_error("스레드 풀 메모리 할당 실패");
+        for (int p = 0; p < TP_PRIORITY_COUNT; p++) {
+            tp_ring_free(pool->rings[p]);
+        }
+        free(pool->workers);
+        free(pool);
+        return NULL;
+    }
+    pthread_mutex_init(&pool->timers->mutex, NULL);
+    pthread_cond_init(&pool->timers->cond, NULL);
+    pthread_cond_init(&pool->timers->idle_cond, NULL);
+    timer_wheel_init(&pool->timers->wheel, 0);
+
     pool->thread_count = num_threads;
-    pool->threads = malloc(sizeof(pthread_t) * num_threads);
-    pool->task_queue_head = NULL;
-    pool->task_queue_tail = NULL;
-    pool->shutdown = false;
-    pool->active_tasks = 0;
+    for (int p = 0; p < TP_PRIORITY_COUNT; p++) {
+        atomic_init(&pool->injected[p], 0);
+    }
+    atomic_init(&pool->space_waiters, 0);
+    atomic_init(&pool->sleepers, 0);
+    atomic_init(&pool->searching, 0);
+    atomic_init(&pool->active_tasks, 0);
+    atomic_init(&pool->submitted, 0);
+    atomic_init(&pool->rejected, 0);
+    atomic_init(&pool->blocked, 0);
+    atomic_init(&pool->cancelled, 0);
+    atomic_init(&pool->shutdown, false);
 
     pthread_mutex_init(&pool->queue_mutex, NULL);
-    pthread_cond_init(&pool->queue_cond, NULL);
+    pthread_mutex_init(&pool->space_mutex, NULL);
+    pthread_cond_init(&pool->space_cond, NULL);
+    pthread_mutex_init(&pool->park_mutex, NULL);
+    pthread_cond_init(&pool->park_cond, NULL);
+    pthread_mutex_init(&pool->wait_mutex, NULL);
     pthread_cond_init(&pool->queue_empty_cond, NULL);
 
+    for (int i = 0; i < num_threads; i++) {
+        tp_worker_t *worker = &pool->workers[i];
+        atomic_init(&worker->deque.top, 0);
+        atomic_init(&worker->deque.bottom, 0);
+        worker->pool = pool;
+        worker->index = i;
+        worker->rng = 2654435761u * (unsigned int)(i + 1);
+        atomic_init(&worker->node, 0);
+    }
+
     // Create worker threads
     for (int i = 0; i < num_threads; i++) {
-        if (pthread_create(&pool->threads[i], NULL, thread_pool_worker, pool) != 0) {
+        if (pthread_create(&pool->workers[i].thread, NULL, thread_pool_worker, &pool->workers[i]) != 0) {
             log_error("스레드 생성 실패 %d", i);
             thread_pool_destroy(pool);
             return NULL;
         }
+        pool->workers[i].started = true;
     }
 
-    log_info("%d개의 스레드로 스레드 풀 생성 완료", num_threads);
+    if (pool->rings[0] != NULL) {
+        log_info("%d개의 스레드로 스레드 풀 생성 완료 (큐 용량 %zu)", num_threads, pool->rings[0]->mask + 1);
+    } else {
+        log_info("%d개의 스레드로 스레드 풀 생성 완료", num_threads);
+    }
     return pool;
 }
 
-int thread_pool_submit(thread_pool_t *pool, task_func_t function, void *arg) {
-    if (pool == NULL || function == NULL) {
+thread_pool_t* thread_pool_create(int num_threads) {
+    return tp_create(num_threads, 0);
+}
+
+thread_pool_t* thread_pool_create_bounded(int num_threads, int capacity) {
+    if (capacity <= 0) {
+        log_error("잘못된 큐 용량: %d", capacity);
+        return NULL;
+    }
+    return tp_create(num_threads, capacity);
+}
+
+static tp_worker_t* tp_current_worker(thread_pool_t *pool) {
+    return (tl_worker != NULL && tl_worker->pool == pool) ? tl_worker : NULL;
+}
+
+static struct timespec tp_deadline(int timeout_ms) {
+    struct timespec deadline;
+    clock_gettime(CLOCK_REALTIME, &deadline);
+    deadline.tv_sec += timeout_ms / 1000;
+    deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        deadline.tv_sec++;
+        deadline.tv_nsec -= 1000000000L;
+    }
+    return deadline;
+}
+
+static void tp_future_release(thread_pool_future_t *future) {
+    if (atomic_fetch_sub_explicit(&future->refs, 1, memory_order_acq_rel) == 1) {
+        pthread_mutex_destroy(&future->mutex);
+        pthread_cond_destroy(&future->cond);
+        free(future);
+    }
+}
+
+static void tp_future_finish(thread_pool_future_t *future, tp_future_state_t state) {
+    pthread_mutex_lock(&future->mutex);
+    atomic_store_explicit(&future->state, state, memory_order_release);
+    pthread_cond_broadcast(&future->cond);
+    pthread_mutex_unlock(&future->mutex);
+}
+
+// 그룹 작업 하나 끝남 (대기자가 그룹을 바로 해제할 수 있으므로 감소도 잠금 안에서 한다)
+static void tp_group_done(thread_pool_group_t *group) {
+    pthread_mutex_lock(&group->mutex);
+    if (atomic_fetch_sub_explicit(&group->pending, 1, memory_order_acq_rel) == 1) {
+        pthread_cond_broadcast(&group->cond);
+    }
+    pthread_mutex_unlock(&group->mutex);
+}
+
+// 작업 실행 (취소된 작업은 건너뛴다, 그룹은 취소 시점에 이미 처리됨)
+static void tp_run_job(const tp_job_t *job) {
+    if (job->future != NULL) {
+        int expected = TP_FUTURE_PENDING;
+        if (!atomic_compare_exchange_strong_explicit(&job->future->state, &expected, TP_FUTURE_RUNNING,
+                                                     memory_order_acq_rel, memory_order_acquire)) {
+            tp_future_release(job->future);
+            return;
+        }
+    }
+
+    job->function(job->arg);
+
+    if (job->future != NULL) {
+        tp_future_finish(job->future, TP_FUTURE_DONE);
+        tp_future_release(job->future);
+    }
+    if (job->group != NULL) {
+        tp_group_done(job->group);
+    }
+}
+
+// 링에 넣기 (timeout_ms: 0이면 바로 실패, 음수면 무한 대기, 1: 호출자가 직접 실행해야 함)
+// 대기 쪽 space_waiters 증가와 워커의 꺼낸 뒤 펜스가 짝을 이뤄 깨우기 누락을 막는다.
+static int tp_ring_submit(thread_pool_t *pool, tp_ring_t *ring, const tp_job_t *job, int timeout_ms) {
+    if (tp_ring_push(ring, job)) {
+        return 0;
+    }
+    if (timeout_ms == 0) {
+        atomic_fetch_add_explicit(&pool->rejected, 1, memory_order_relaxed);
         return -1;
     }
 
-    task_t *task = malloc(sizeof(task_t));
-    if (task == NULL) {
-        log_error("작업 메모리 할당 실패");
+    // 워커가 무한 대기하면 모든 워커가 서로를 기다릴 수 있으므로 그 자리에서 실행한다
+    if (timeout_ms < 0 && tp_current_worker(pool) != NULL) {
+        atomic_fetch_add_explicit(&pool->blocked, 1, memory_order_relaxed);
+        return 1;
+    }
+
+    atomic_fetch_add_explicit(&pool->blocked, 1, memory_order_relaxed);
+    struct timespec deadline = tp_deadline(timeout_ms > 0 ? timeout_ms : 0);
+    int result = 0;
+
+    pthread_mutex_lock(&pool->space_mutex);
+    atomic_fetch_add_explicit(&pool->space_waiters, 1, memory_order_seq_cst);
+    while (!tp_ring_push(ring, job)) {
+        if (atomic_load_explicit(&pool->shutdown, memory_order_acquire)) {
+            result = -1;
+            break;
+        }
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&pool->space_cond, &pool->space_mutex);
+        } else if (pthread_cond_timedwait(&pool->space_cond, &pool->space_mutex, &deadline) == ETIMEDOUT) {
+            if (!tp_ring_push(ring, job)) {
+                atomic_fetch_add_explicit(&pool->rejected, 1, memory_order_relaxed);
+                result = -1;
+            }
+            break;
+        }
+    }
+    atomic_fetch_sub_explicit(&pool->space_waiters, 1, memory_order_relaxed);
+    pthread_mutex_unlock(&pool->space_mutex);
+
+    return result;
+}
+
+static int tp_submit(thread_pool_t *pool, const tp_job_t *job, tp_priority_t priority, int timeout_ms) {
+    if (atomic_load_explicit(&pool->shutdown, memory_order_acquire)) {
         return -1;
     }
 
-    task->function = function;
-    task->arg = arg;
-    task->next = NULL;
+    tp_worker_t *worker = tp_current_worker(pool);
+    atomic_fetch_add_explicit(&pool->active_tasks, 1, memory_order_relaxed);
 
-    pthread_mutex_lock(&pool->queue_mutex);
+    if (pool->rings[priority] != NULL) {
+        int rc = tp_ring_submit(pool, pool->rings[priority], job, timeout_ms);
+        if (rc < 0) {
+            atomic_fetch_sub_explicit(&pool->active_tasks, 1, memory_order_relaxed);
+            return -1;
+        }
+        atomic_fetch_add_explicit(&pool->submitted, 1, memory_order_relaxed);
+        if (rc > 0) {
+            // 가득 찬 링에 워커가 제출: 호출자 실행 (이 작업은 큐를 거치지 않음)
+            atomic_fetch_sub_explicit(&pool->active_tasks, 1, memory_order_relaxed);
+            tp_run_job(job);
+            return 0;
+        }
+        tp_notify(pool);
+        return 0;
+    }
 
-    if (pool->shutdown) {
+    // 워커 안에서의 NORMAL 제출: 자기 덱에 넣는다 (잠금 없음)
+    if (worker != NULL && priority == TP_PRIORITY_NORMAL) {
+        task_t *task = tp_worker_alloc(worker);
+        if (task == NULL) {
+            atomic_fetch_sub_explicit(&pool->active_tasks, 1, memory_order_relaxed);
+            return -1;
+        }
+        task->function = job->function;
+        task->arg = job->arg;
+        task->future = job->future;
+        task->group = job->group;
+        if (tp_deque_push(&worker->deque, task)) {
+            atomic_fetch_add_explicit(&pool->submitted, 1, memory_order_relaxed);
+            tp_notify(pool);
+            return 0;
+        }
+        tp_worker_free(worker, task);
+    }
+
+    // 외부 스레드, 다른 우선순위, 덱이 가득 찬 워커의 제출: 우선순위별 주입 큐
+    pthread_mutex_lock(&pool->queue_mutex);
+    task_t *task = tp_take_free_locked(pool);
+    if (task == NULL) {
         pthread_mutex_unlock(&pool->queue_mutex);
-        free(task);
+        atomic_fetch_sub_explicit(&pool->active_tasks, 1, memory_order_relaxed);
         return -1;
     }
-
-    // Add task to queue
-    if (pool->task_queue_tail == NULL) {
-        pool->task_queue_head = task;
-        pool->task_queue_tail = task;
+    task->function = job->function;
+    task->arg = job->arg;
+    task->future = job->future;
+    task->group = job->group;
+    task->next = NULL;
+    if (pool->task_queue_tail[priority] == NULL) {
+        pool->task_queue_head[priority] = task;
     } else {
-        pool->task_queue_tail->next = task;
-        pool->task_queue_tail = task;
+        pool->task_queue_tail[priority]->next = task;
     }
-
-    pool->active_tasks++;
-    pthread_cond_signal(&pool->queue_cond);
+    pool->task_queue_tail[priority] = task;
+    atomic_fetch_add_explicit(&pool->injected[priority], 1, memory_order_relaxed);
     pthread_mutex_unlock(&pool->queue_mutex);
 
+    atomic_fetch_add_explicit(&pool->submitted, 1, memory_order_relaxed);
+    tp_notify(pool);
     return 0;
 }
 
-void thread_pool_wait(thread_pool_t *pool) {
+static int tp_submit_plain(thread_pool_t *pool, task_func_t function, void *arg, int timeout_ms) {
+    if (pool == NULL || function == NULL) {
+        return -1;
+    }
+    tp_job_t job = { function, arg, NULL, NULL };
+    return tp_submit(pool, &job, TP_PRIORITY_NORMAL, timeout_ms);
+}
+
+int thread_pool_submit(thread_pool_t *pool, task_func_t function, void *arg) {
+    return tp_submit_plain(pool, function, arg, -1);
+}
+
+int thread_pool_try_submit(thread_pool_t *pool, task_func_t function, void *arg) {
+    return tp_submit_plain(pool, function, arg, 0);
+}
+
+int thread_pool_submit_timed(thread_pool_t *pool, task_func_t function, void *arg, int timeout_ms) {
+    return tp_submit_plain(pool, function, arg, timeout_ms > 0 ? timeout_ms : 0);
+}
+
+int thread_pool_submit_ex(thread_pool_t *pool, task_func_t function, void *arg,
+                          tp_priority_t priority, thread_pool_group_t *group,
+                          int timeout_ms, thread_pool_future_t **future) {
+    if (future != NULL) {
+        *future = NULL;
+    }
+    if (pool == NULL || function == NULL || priority < 0 || priority >= TP_PRIORITY_COUNT) {
+        return -1;
+    }
+
+    tp_job_t job = { function, arg, NULL, group };
+    if (future != NULL) {
+        job.future = malloc(sizeof(thread_pool_future_t));
+        if (job.future == NULL) {
+            log_error("작업 메모리 할당 실패");
+            return -1;
+        }
+        pthread_mutex_init(&job.future->mutex, NULL);
+        pthread_cond_init(&job.future->cond, NULL);
+        atomic_init(&job.future->state, TP_FUTURE_PENDING);
+        atomic_init(&job.future->refs, 2);
+        job.future->pool = pool;
+        job.future->group = group;
+    }
+    if (group != NULL) {
+        atomic_fetch_add_explicit(&group->pending, 1, memory_order_relaxed);
+    }
+
+    if (tp_submit(pool, &job, priority, timeout_ms) < 0) {
+        if (group != NULL) {
+            tp_group_done(group);
+        }
+        if (job.future != NULL) {
+            atomic_store_explicit(&job.future->refs, 1, memory_order_relaxed);
+            tp_future_release(job.future);
+        }
+        return -1;
+    }
+
+    if (future != NULL) {
+        *future = job.future;
+    }
+    return 0;
+}
+
+int thread_pool_future_wait(thread_pool_future_t *future, int timeout_ms) {
+    struct timespec deadline = tp_deadline(timeout_ms > 0 ? timeout_ms : 0);
+    int result = 0;
+
+    pthread_mutex_lock(&future->mutex);
+    for (;;) {
+        int state = atomic_load_explicit(&future->state, memory_order_acquire);
+        if (state == TP_FUTURE_DONE) {
+            break;
+        }
+        if (state == TP_FUTURE_CANCELLED) {
+            result = -2;
+            break;
+        }
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&future->cond, &future->mutex);
+        } else if (timeout_ms == 0 ||
+                   pthread_cond_timedwait(&future->cond, &future->mutex, &deadline) == ETIMEDOUT) {
+            state = atomic_load_explicit(&future->state, memory_order_acquire);
+            result = (state == TP_FUTURE_DONE) ? 0 : (state == TP_FUTURE_CANCELLED) ? -2 : -1;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&future->mutex);
+
+    return result;
+}
+
+bool thread_pool_future_cancel(thread_pool_future_t *future) {
+    int expected = TP_FUTURE_PENDING;
+    if (!atomic_compare_exchange_strong_explicit(&future->state, &expected, TP_FUTURE_CANCELLED,
+                                                 memory_order_acq_rel, memory_order_acquire)) {
+        return false;
+    }
+
+    // 큐에 남은 항목은 워커가 꺼낼 때 건너뛰고, 그룹과 대기자는 지금 풀어준다
+    tp_future_finish(future, TP_FUTURE_CANCELLED);
+    if (future->group != NULL) {
+        tp_group_done(future->group);
+    }
+    atomic_fetch_add_explicit(&future->pool->cancelled, 1, memory_order_relaxed);
+    return true;
+}
+
+tp_future_state_t thread_pool_future_state(thread_pool_future_t *future) {
+    return (tp_future_state_t)atomic_load_explicit(&future->state, memory_order_acquire);
+}
+
+void thread_pool_future_release(thread_pool_future_t *future) {
+    if (future != NULL) {
+        tp_future_release(future);
+    }
+}
+
+void thread_pool_group_init(thread_pool_group_t *group) {
+    pthread_mutex_init(&group->mutex, NULL);
+    pthread_cond_init(&group->cond, NULL);
+    atomic_init(&group->pending, 0);
+}
+
+int thread_pool_group_wait(thread_pool_group_t *group, int timeout_ms) {
+    struct timespec deadline = tp_deadline(timeout_ms > 0 ? timeout_ms : 0);
+    int result = 0;
+
+    pthread_mutex_lock(&group->mutex);
+    while (atomic_load_explicit(&group->pending, memory_order_acquire) > 0) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&group->cond, &group->mutex);
+        } else if (timeout_ms == 0 ||
+                   pthread_cond_timedwait(&group->cond, &group->mutex, &deadline) == ETIMEDOUT) {
+            result = atomic_load_explicit(&group->pending, memory_order_acquire) > 0 ? -1 : 0;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&group->mutex);
+
+    return result;
+}
+
+void thread_pool_group_destroy(thread_pool_group_t *group) {
+    pthread_mutex_destroy(&group->mutex);
+    pthread_cond_destroy(&group->cond);
+}
+
+static uint64_t tp_monotonic_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000 + (uint64_t)ts.tv_nsec / 1000000;
+}
+
+static void tp_timer_release(thread_pool_timer_t *timer) {
+    if (atomic_fetch_sub_explicit(&timer->refs, 1, memory_order_acq_rel) == 1) {
+        free(timer);
+    }
+}
+
+static void tp_timer_finish(thread_pool_timer_t *timer) {
+    tp_timers_t *timers = timer->pool->timers;
+    pthread_mutex_lock(&timers->mutex);
+    timer->in_flight = false;
+    pthread_cond_broadcast(&timers->idle_cond);
+    pthread_mutex_unlock(&timers->mutex);
+}
+
+// 만료된 회차 실행 (워커에서)
+static void tp_timer_run(void *arg) {
+    thread_pool_timer_t *timer = arg;
+    timer->function(timer->arg);
+    tp_timer_finish(timer);
+    tp_timer_release(timer);
+}
+
+// now 틱까지 휠을 진행하고 제출할 예약 목록을 돌려준다 (timers->mutex 보유)
+// 주기 작업은 같은 잠금 안에서 다시 넣으므로 취소와 엇갈리지 않는다.
+static thread_pool_timer_t* tp_timer_expire_locked(tp_timers_t *timers, uint64_t now) {
+    timer_node_t expired;
+    timer_node_init(&expired);
+    timer_wheel_advance(&timers->wheel, now, &expired);
+
+    thread_pool_timer_t *fire = NULL;
+    thread_pool_timer_t **tail = &fire;
+    timer_node_t *node;
+    while ((node = timer_list_pop(&expired)) != NULL) {
+        thread_pool_timer_t *timer = (thread_pool_timer_t *)node;
+        uint64_t scheduled = node->expires;
+
+        if (timer->in_flight) {
+            // 이전 회차가 아직 실행 중 (주기 작업만 해당)
+            timers->overruns++;
+        } else {
+            timer->in_flight = true;
+            if (timer->interval > 0) {
+                atomic_fetch_add_explicit(&timer->refs, 1, memory_order_relaxed);
+            }
+            // 한 번 실행 작업은 휠의 참조를 제출할 회차에 넘긴다
+            timer->fire_next = NULL;
+            *tail = timer;
+            tail = &timer->fire_next;
+            timers->fires++;
+        }
+
+        if (timer->interval > 0) {
+            // 늦어서 놓친 회차는 몰아서 실행하지 않고 건너뛴다 (주기의 위상은 유지)
+            uint64_t missed = (now - scheduled) / timer->interval;
+            timers->overruns += missed;
+            timer_wheel_add(&timers->wheel, node, scheduled + (missed + 1) * timer->interval);
+        }
+    }
+    return fire;
+}
+
+// 타이머 스레드: 다음 만료(또는 상위 단계 내림) 시각까지 잠들었다가 만료된 작업을 워커에 제출
+static void* tp_timer_thread(void *arg) {
+    thread_pool_t *pool = arg;
+    tp_timers_t *timers = pool->timers;
+    cpu_affinity_pin_current(CPU_CLASS_IO);
+
+    pthread_mutex_lock(&timers->mutex);
+    while (!timers->stop) {
+        uint64_t now_ms = tp_monotonic_ms();
+        thread_pool_timer_t *fire = tp_timer_expire_locked(timers, now_ms / TP_TIMER_TICK_MS);
+
+        if (fire != NULL) {
+            pthread_mutex_unlock(&timers->mutex);
+            // 용량 제한 풀이 가득 차면 자리가 날 때까지 기다린다 (만료가 늦어질 뿐 회차를 잃지 않음)
+            while (fire != NULL) {
+                thread_pool_timer_t *next = fire->fire_next;
+                if (thread_pool_submit_ex(pool, tp_timer_run, fire, fire->priority, NULL, -1, NULL) < 0) {
+                    tp_timer_finish(fire);
+                    tp_timer_release(fire);
+                }
+                fire = next;
+            }
+            pthread_mutex_lock(&timers->mutex);
+            continue;
+        }
+
+        uint64_t next_tick;
+        if (!timer_wheel_next(&timers->wheel, &next_tick)) {
+            pthread_cond_wait(&timers->cond, &timers->mutex);
+        } else {
+            uint64_t wake_ms = next_tick * TP_TIMER_TICK_MS;
+            int wait_ms = wake_ms > now_ms ? (int)(wake_ms - now_ms) : 0;
+            struct timespec deadline = tp_deadline(wait_ms);
+            pthread_cond_timedwait(&timers->cond, &timers->mutex, &deadline);
+        }
+    }
+    pthread_mutex_unlock(&timers->mutex);
+    return NULL;
+}
+
+static int tp_schedule(thread_pool_t *pool, int delay_ms, int interval_ms, task_func_t function, void *arg,
+                       tp_priority_t priority, thread_pool_timer_t **timer) {
+    if (timer != NULL) {
+        *timer = NULL;
+    }
+    if (pool == NULL || function == NULL || priority < 0 || priority >= TP_PRIORITY_COUNT) {
+        return -1;
+    }
+
+    thread_pool_timer_t *entry = malloc(sizeof(thread_pool_timer_t));
+    if (entry == NULL) {
+        log_error("타이머 메모리 할당 실패");
+        return -1;
+    }
+    timer_node_init(&entry->node);
+    entry->fire_next = NULL;
+    entry->pool = pool;
+    entry->function = function;
+    entry->arg = arg;
+    entry->priority = priority;
+    entry->interval = interval_ms > 0
+        ? ((uint64_t)interval_ms + TP_TIMER_TICK_MS - 1) / TP_TIMER_TICK_MS
+        : 0;
+    entry->in_flight = false;
+    atomic_init(&entry->refs, timer != NULL ? 2 : 1);
+
+    uint64_t delay = delay_ms > 0 ? ((uint64_t)delay_ms + TP_TIMER_TICK_MS - 1) / TP_TIMER_TICK_MS : 0;
+
+    tp_timers_t *timers = pool->timers;
+    pthread_mutex_lock(&timers->mutex);
+    if (timers->stop || atomic_load_explicit(&pool->shutdown, memory_order_acquire)) {
+        pthread_mutex_unlock(&timers->mutex);
+        free(entry);
+        return -1;
+    }
+    if (!timers->started) {
+        if (pthread_create(&timers->thread, NULL, tp_timer_thread, pool) != 0) {
+            pthread_mutex_unlock(&timers->mutex);
+            log_error("타이머 스레드 생성 실패");
+            free(entry);
+            return -1;
+        }
+        timers->started = true;
+    }
+
+    uint64_t now = tp_monotonic_ms() / TP_TIMER_TICK_MS;
+    if (timers->wheel.count == 0 && timers->wheel.now < now) {
+        // 비어 있는 동안 멈춰 있던 휠을 현재 시각으로 당긴다 (먼 예약이 최대값에 잘리지 않도록)
+        timers->wheel.now = now;
+    }
+    timer_wheel_add(&timers->wheel, &entry->node, now + delay);
+    pthread_cond_signal(&timers->cond);
+    pthread_mutex_unlock(&timers->mutex);
+
+    if (timer != NULL) {
+        *timer = entry;
+    }
+    return 0;
+}
+
+int thread_pool_schedule_after(thread_pool_t *pool, int delay_ms, task_func_t function, void *arg,
+                               tp_priority_t priority, thread_pool_timer_t **timer) {
+    return tp_schedule(pool, delay_ms, 0, function, arg, priority, timer);
+}
+
+int thread_pool_schedule_every(thread_pool_t *pool, int interval_ms, task_func_t function, void *arg,
+                               tp_priority_t priority, thread_pool_timer_t **timer) {
+    if (interval_ms <= 0) {
+        log_error("잘못된 주기: %d", interval_ms);
+        return -1;
+    }
+    return tp_schedule(pool, interval_ms, interval_ms, function, arg, priority, timer);
+}
+
+bool thread_pool_timer_cancel(thread_pool_timer_t *timer, bool wait) {
+    if (timer == NULL) {
+        return false;
+    }
+
+    tp_timers_t *timers = timer->pool->timers;
+    pthread_mutex_lock(&timers->mutex);
+    bool removed = timer_node_pending(&timer->node);
+    if (removed) {
+        timer_wheel_remove(&timers->wheel, &timer->node);
+    }
+    while (wait && timer->in_flight) {
+        pthread_cond_wait(&timers->idle_cond, &timers->mutex);
+    }
+    pthread_mutex_unlock(&timers->mutex);
+
+    if (removed) {
+        tp_timer_release(timer);
+    }
+    return removed;
+}
+
+void thread_pool_timer_release(thread_pool_timer_t *timer) {
+    if (timer != NULL) {
+        tp_timer_release(timer);
+    }
+}
+
+// 타이머 스레드 정지 (워커보다 먼저 멈춰 종료 중에 새 회차가 제출되지 않게 한다)
+static void tp_timers_stop(thread_pool_t *pool) {
+    tp_timers_t *timers = pool->timers;
+    if (timers == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&timers->mutex);
+    timers->stop = true;
+    pthread_cond_signal(&timers->cond);
+    pthread_mutex_unlock(&timers->mutex);
+
+    if (timers->started) {
+        pthread_join(timers->thread, NULL);
+    }
+}
+
+// 남은 예약을 버리고 해제 (워커 종료 후)
+static void tp_timers_free(thread_pool_t *pool) {
+    tp_timers_t *timers = pool->timers;
+    if (timers == NULL) {
+        return;
+    }
+
+    timer_node_t pending;
+    timer_node_init(&pending);
+    timer_wheel_drain(&timers->wheel, &pending);
+    timer_node_t *node;
+    while ((node = timer_list_pop(&pending)) != NULL) {
+        tp_timer_release((thread_pool_timer_t *)node);
+    }
+
+    pthread_mutex_destroy(&timers->mutex);
+    pthread_cond_destroy(&timers->cond);
+    pthread_cond_destroy(&timers->idle_cond);
+    free(timers);
+    pool->timers = NULL;
+}
+
+void thread_pool_get_stats(thread_pool_t *pool, thread_pool_stats_t *stats) {
+    memset(stats, 0, sizeof(*stats));
     if (pool == NULL) {
         return;
     }
 
+    stats->threads = pool->thread_count;
+    if (pool->rings[0] != NULL) {
+        stats->capacity = (long)(pool->rings[0]->mask + 1);
+    }
+    for (int p = 0; p < TP_PRIORITY_COUNT; p++) {
+        stats->class_depth[p] = pool->rings[p] != NULL
+            ? tp_ring_depth(pool->rings[p])
+            : atomic_load_explicit(&pool->injected[p], memory_order_relaxed);
+        stats->queue_depth += stats->class_depth[p];
+    }
+    for (int i = 0; i < pool->thread_count; i++) {
+        tp_deque_t *d = &pool->workers[i].deque;
+        long n = atomic_load_explicit(&d->bottom, memory_order_relaxed) -
+                 atomic_load_explicit(&d->top, memory_order_relaxed);
+        stats->queue_depth += n > 0 ? n : 0;
+    }
+    stats->active_tasks = atomic_load_explicit(&pool->active_tasks, memory_order_relaxed);
+    stats->submitted = atomic_load_explicit(&pool->submitted, memory_order_relaxed);
+    stats->rejected = atomic_load_explicit(&pool->rejected, memory_order_relaxed);
+    stats->blocked = atomic_load_explicit(&pool->blocked, memory_order_relaxed);
+    stats->cancelled = atomic_load_explicit(&pool->cancelled, memory_order_relaxed);
+
+    pthread_mutex_lock(&pool->timers->mutex);
+    stats->timers = (long)pool->timers->wheel.count;
+    stats->timer_fires = pool->timers->fires;
+    stats->timer_overruns = pool->timers->overruns;
+    pthread_mutex_unlock(&pool->timers->mutex);
+}
+
+// NORMAL 주입 큐에서 작업을 가져온다. 하나는 바로 실행하고 나머지는 자기 덱에 옮겨 다른 워커가 훔칠 수 있게 한다.
+static task_t* tp_take_injected(tp_worker_t *worker) {
+    thread_pool_t *pool = worker->pool;
+    if (atomic_load_explicit(&pool->injected[TP_PRIORITY_NORMAL], memory_order_relaxed) == 0) {
+        return NULL;
+    }
+
     pthread_mutex_lock(&pool->queue_mutex);
-    while (pool->active_tasks > 0 || pool->task_queue_head != NULL) {
-        pthread_cond_wait(&pool->queue_empty_cond, &pool->queue_mutex);
+    int available = atomic_load_explicit(&pool->injected[TP_PRIORITY_NORMAL], memory_order_relaxed);
+    int take = available / pool->thread_count + 1;
+    if (take > TP_INJECT_BATCH) {
+        take = TP_INJECT_BATCH;
+    }
+
+    task_t *first = pool->task_queue_head[TP_PRIORITY_NORMAL];
+    int moved = 0;
+    if (first != NULL) {
+        pool->task_queue_head[TP_PRIORITY_NORMAL] = first->next;
+        moved = 1;
+        while (moved < take && pool->task_queue_head[TP_PRIORITY_NORMAL] != NULL) {
+            task_t *task = pool->task_queue_head[TP_PRIORITY_NORMAL];
+            if (!tp_deque_push(&worker->deque, task)) {
+                break;
+            }
+            pool->task_queue_head[TP_PRIORITY_NORMAL] = task->next;
+            moved++;
+        }
+        if (pool->task_queue_head[TP_PRIORITY_NORMAL] == NULL) {
+            pool->task_queue_tail[TP_PRIORITY_NORMAL] = NULL;
+        }
+        atomic_fetch_sub_explicit(&pool->injected[TP_PRIORITY_NORMAL], moved, memory_order_relaxed);
     }
     pthread_mutex_unlock(&pool->queue_mutex);
+
+    if (moved > 1) {
+        tp_notify(pool);
+    }
+    return first;
+}
+
+// INTERACTIVE/BATCH 주입 큐에서 하나 꺼내기 (덱으로 옮기지 않는다)
+static task_t* tp_take_queued(thread_pool_t *pool, tp_priority_t priority) {
+    if (atomic_load_explicit(&pool->injected[priority], memory_order_relaxed) == 0) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&pool->queue_mutex);
+    task_t *task = pool->task_queue_head[priority];
+    if (task != NULL) {
+        pool->task_queue_head[priority] = task->next;
+        if (task->next == NULL) {
+            pool->task_queue_tail[priority] = NULL;
+        }
+        atomic_fetch_sub_explicit(&pool->injected[priority], 1, memory_order_relaxed);
+    }
+    pthread_mutex_unlock(&pool->queue_mutex);
+    return task;
+}
+
+static task_t* tp_steal(tp_worker_t *worker) {
+    thread_pool_t *pool = worker->pool;
+    int n = pool->thread_count;
+    if (n <= 1) {
+        return NULL;
+    }
+
+    // 같은 NUMA 노드의 워커를 먼저 훔쳐 작업 인자와 노드가 소켓을 건너지 않게 한다
+    int node = atomic_load_explicit(&worker->node, memory_order_relaxed);
+    int passes = cpu_affinity_node_count() > 1 ? 2 : 1;
+
+    bool retry;
+    do {
+        retry = false;
+        worker->rng = worker->rng * 1103515245u + 12345u;
+        int start = (int)((worker->rng >> 16) % (unsigned int)n);
+        for (int pass = 0; pass < passes; pass++) {
+            for (int i = 0; i < n; i++) {
+                int victim = (start + i) % n;
+                if (victim == worker->index) {
+                    continue;
+                }
+                if (passes > 1 &&
+                    (atomic_load_explicit(&pool->workers[victim].node, memory_order_relaxed) == node) != (pass == 0)) {
+                    continue;
+                }
+                task_t *task = tp_deque_steal(&pool->workers[victim].deque);
+                if (task == TP_STEAL_ABORT) {
+                    retry = true;
+                } else if (task != NULL) {
+                    return task;
+                }
+            }
+        }
+    } while (retry);
+
+    return NULL;
+}
+
+// 노드의 내용을 꺼내고 노드는 워커 캐시로 반환
+static bool tp_job_from_task(tp_worker_t *worker, task_t *task, tp_job_t *job) {
+    if (task == NULL) {
+        return false;
+    }
+    job->function = task->function;
+    job->arg = task->arg;
+    job->future = task->future;
+    job->group = task->group;
+    tp_worker_free(worker, task);
+    return true;
+}
+
+// 링에서 꺼낸 뒤 자리를 기다리는 제출자가 있으면 깨운다 (링마다 기다리는 제출자가 다를 수 있어 broadcast)
+static bool tp_ring_take(thread_pool_t *pool, tp_ring_t *ring, tp_job_t *job) {
+    if (!tp_ring_pop(ring, job)) {
+        return false;
+    }
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&pool->space_waiters, memory_order_relaxed) > 0) {
+        pthread_mutex_lock(&pool->space_mutex);
+        pthread_cond_broadcast(&pool->space_cond);
+        pthread_mutex_unlock(&pool->space_mutex);
+    }
+    return true;
+}
+
+// 우선순위 하나의 공유 큐(링 또는 주입 큐)에서 꺼내기
+static bool tp_take_shared(tp_worker_t *worker, tp_priority_t priority, tp_job_t *job) {
+    thread_pool_t *pool = worker->pool;
+    if (pool->rings[priority] != NULL) {
+        return tp_ring_take(pool, pool->rings[priority], job);
+    }
+    if (priority == TP_PRIORITY_NORMAL) {
+        return tp_job_from_task(worker, tp_take_injected(worker), job);
+    }
+    return tp_job_from_task(worker, tp_take_queued(pool, priority), job);
+}
+
+// 탐색 전 빠른 확인: INTERACTIVE 큐, 자기 덱
+// TP_FAIRNESS_INTERVAL번에 한 번은 BATCH, NORMAL 공유 큐를 먼저 봐서 굶주림을 막는다.
+static bool tp_take_local(tp_worker_t *worker, tp_job_t *job) {
+    if (++worker->ticks % TP_FAIRNESS_INTERVAL == 0) {
+        if (tp_take_shared(worker, TP_PRIORITY_BATCH, job) ||
+            tp_take_shared(worker, TP_PRIORITY_NORMAL, job)) {
+            return true;
+        }
+    }
+    return tp_take_shared(worker, TP_PRIORITY_INTERACTIVE, job) ||
+           tp_job_from_task(worker, tp_deque_pop(&worker->deque), job);
+}
+
+// 자기 덱 밖에서 작업 찾기: INTERACTIVE → NORMAL 주입 큐 → 훔치기 → BATCH
+static bool tp_search(tp_worker_t *worker, tp_job_t *job) {
+    return tp_take_shared(worker, TP_PRIORITY_INTERACTIVE, job) ||
+           tp_take_shared(worker, TP_PRIORITY_NORMAL, job) ||
+           (worker->pool->rings[0] == NULL && tp_job_from_task(worker, tp_steal(worker), job)) ||
+           tp_take_shared(worker, TP_PRIORITY_BATCH, job);
+}
+
+static bool tp_find_job(tp_worker_t *worker, tp_job_t *job) {
+    return tp_take_local(worker, job) || tp_search(worker, job);
+}
+
+void thread_pool_wait(thread_pool_t *pool) {
+    if (pool == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->wait_mutex);
+    while (atomic_load_explicit(&pool->active_tasks, memory_order_acquire) > 0) {
+        pthread_cond_wait(&pool->queue_empty_cond, &pool->wait_mutex);
+    }
+    pthread_mutex_unlock(&pool->wait_mutex);
 }
 
 void thread_pool_destroy(thread_pool_t *pool) {
@@ -98,75 +1251,136 @@ void thread_pool_destroy(thread_pool_t *pool) {
         return;
     }
 
-    pthread_mutex_lock(&pool->queue_mutex);
-    pool->shutdown = true;
-    pthread_cond_broadcast(&pool->queue_cond);
-    pthread_mutex_unlock(&pool->queue_mutex);
+    tp_timers_stop(pool);
+
+    pthread_mutex_lock(&pool->park_mutex);
+    atomic_store_explicit(&pool->shutdown, true, memory_order_release);
+    pthread_cond_broadcast(&pool->park_cond);
+    pthread_mutex_unlock(&pool->park_mutex);
+
+    pthread_mutex_lock(&pool->space_mutex);
+    pthread_cond_broadcast(&pool->space_cond);
+    pthread_mutex_unlock(&pool->space_mutex);
 
     // Wait for all threads to finish
     for (int i = 0; i < pool->thread_count; i++) {
-        pthread_join(pool->threads[i], NULL);
+        if (pool->workers[i].started) {
+            pthread_join(pool->workers[i].thread, NULL);
+        }
     }
 
-    // Clean up remaining tasks
-    pthread_mutex_lock(&pool->queue_mutex);
-    task_t *task = pool->task_queue_head;
-    while (task != NULL) {
-        task_t *next = task->next;
-        free(task);
-        task = next;
+    tp_timers_free(pool);
+
+    // 노드는 모두 청크에 속하므로 청크만 해제하면 된다
+    tp_task_chunk_t *chunk = pool->chunks;
+    while (chunk != NULL) {
+        tp_task_chunk_t *next = chunk->next;
+        free(chunk);
+        chunk = next;
+    }
+
+    for (int p = 0; p < TP_PRIORITY_COUNT; p++) {
+        tp_ring_free(pool->rings[p]);
     }
-    pthread_mutex_unlock(&pool->queue_mutex);
 
     pthread_mutex_destroy(&pool->queue_mutex);
-    pthread_cond_destroy(&pool->queue_cond);
+    pthread_mutex_destroy(&pool->space_mutex);
+    pthread_cond_destroy(&pool->space_cond);
+    pthread_mutex_destroy(&pool->park_mutex);
+    pthread_cond_destroy(&pool->park_cond);
+    pthread_mutex_destroy(&pool->wait_mutex);
     pthread_cond_destroy(&pool->queue_empty_cond);
-    free(pool->threads);
+    free(pool->workers);
     free(pool);
 
     log_info("스레드 풀 종료 완료");
 }
 
-static void* thread_pool_worker(void *arg) {
-    thread_pool_t *pool = (thread_pool_t*)arg;
+// 작업을 찾던 워커가 작업을 찾았을 때: 마지막 탐색자였다면 다른 워커를 깨워 탐색을 이어가게 한다
+static void tp_end_search(tp_worker_t *worker, bool *searching) {
+    if (*searching) {
+        *searching = false;
+        if (atomic_fetch_sub_explicit(&worker->pool->searching, 1, memory_order_seq_cst) == 1) {
+            tp_notify(worker->pool);
+        }
+    }
+}
 
-    while (1) {
-        pthread_mutex_lock(&pool->queue_mutex);
+// 잠들기: sleepers를 올리고 한 번 더 확인한 뒤 깨우기 토큰을 기다린다 (제출 쪽 tp_notify와 짝)
+// false를 반환하면 searching 상태 여부와 상관없이 다시 탐색한다
+static bool tp_park(tp_worker_t *worker, bool *searching, tp_job_t *job) {
+    thread_pool_t *pool = worker->pool;
 
-        // Wait for task or shutdown signal
-        while (pool->task_queue_head == NULL && !pool->shutdown) {
-            pthread_cond_wait(&pool->queue_cond, &pool->queue_mutex);
-        }
+    atomic_fetch_add_explicit(&pool->sleepers, 1, memory_order_seq_cst);
+    if (*searching) {
+        *searching = false;
+        atomic_fetch_sub_explicit(&pool->searching, 1, memory_order_seq_cst);
+    }
 
-        if (pool->shutdown && pool->task_queue_head == NULL) {
-            pthread_mutex_unlock(&pool->queue_mutex);
-            break;
-        }
+    if (tp_find_job(worker, job)) {
+        atomic_fetch_sub_explicit(&pool->sleepers, 1, memory_order_relaxed);
+        return true;
+    }
+
+    pthread_mutex_lock(&pool->park_mutex);
+    while (pool->wakeups == 0 && !atomic_load_explicit(&pool->shutdown, memory_order_relaxed)) {
+        pthread_cond_wait(&pool->park_cond, &pool->park_mutex);
+    }
+    if (pool->wakeups > 0) {
+        pool->wakeups--;
+        *searching = true;
+    }
+    pthread_mutex_unlock(&pool->park_mutex);
 
-        // Get task from queue
-        task_t *task = pool->task_queue_head;
-        if (task != NULL) {
-            pool->task_queue_head = task->next;
-            if (pool->task_queue_head == NULL) {
-                pool->task_queue_tail = NULL;
+    atomic_fetch_sub_explicit(&pool->sleepers, 1, memory_order_relaxed);
+    return false;
+}
+
+static void* thread_pool_worker(void *arg) {
+    tp_worker_t *worker = (tp_worker_t*)arg;
+    thread_pool_t *pool = worker->pool;
+    bool searching = false;
+    tl_worker = worker;
+
+    // 고정 이후 이 워커가 새로 할당하는 작업 노드 청크는 이 노드의 메모리에 놓인다 (first-touch)
+    cpu_affinity_pin_current(CPU_CLASS_POOL);
+    atomic_store_explicit(&worker->node, cpu_affinity_current_node(), memory_order_relaxed);
+
+    while (1) {
+        tp_job_t job;
+
+        if (!tp_take_local(worker, &job)) {
+            if (!searching) {
+                searching = true;
+                atomic_fetch_add_explicit(&pool->searching, 1, memory_order_seq_cst);
+            }
+            if (!tp_search(worker, &job)) {
+                // 종료 중이고 더 찾을 작업이 없으면 끝낸다 (남은 작업은 각 덱의 소유 워커가 처리)
+                if (atomic_load_explicit(&pool->shutdown, memory_order_acquire)) {
+                    tp_end_search(worker, &searching);
+                    break;
+                }
+                if (!tp_park(worker, &searching, &job)) {
+                    if (atomic_load_explicit(&pool->shutdown, memory_order_acquire) && !searching) {
+                        break;
+                    }
+                    continue;
+                }
             }
+            tp_end_search(worker, &searching);
         }
 
-        pthread_mutex_unlock(&pool->queue_mutex);
-
         // Execute task
-        if (task != NULL) {
-            task->function(task->arg);
-            free(task);
-
-            pthread_mutex_lock(&pool->queue_mutex);
-            pool->active_tasks--;
-            if (pool->active_tasks == 0) {
-                pthread_cond_broadcast(&pool->queue_empty_cond);
-            }
-            pthread_mutex_unlock(&pool->queue_mutex);
+        tp_run_job(&job);
+
+        // 마지막 작업이 끝났을 때만 대기 중인 thread_pool_wait를 깨운다
+        if (atomic_fetch_sub_explicit(&pool->active_tasks, 1, memory_order_acq_rel) == 1) {
+            pthread_mutex_lock(&pool->wait_mutex);
+            pthread_cond_broadcast(&pool->queue_empty_cond);
+            pthread_mutex_unlock(&pool->wait_mutex);
         }
     }
 
+    tl_worker = NULL;
     return NULL;
 }
@@ -0,0 +1,649 @@
+#ifdef __linux__
+#define _DEFAULT_SOURCE                 // flock
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include "thumb_pack.h"
+#include "db.h"
+#include "catalog.h"
+#include "logger.h"
+#include "config.h"
+
+#define THUMB_PACK_MAGIC 0x4b504854U    // "THPK" (리틀 엔디언)
+
+// 개별 파일을 팩으로 옮길 때 한 트랜잭션에 넣는 행 수
+#define THUMB_PACK_IMPORT_BATCH 1000
+
+typedef struct {
+    uint32_t magic;
+    uint32_t length;
+} thumb_pack_header_t;
+
+_Static_assert(sizeof(thumb_pack_header_t) == THUMB_PACK_RECORD_HEADER, "pack record header size");
+
+// 추가 (같은 프로세스 안은 mutex, 프로세스 사이는 flock)
+static struct {
+    pthread_mutex_t mutex;
+    int fd;
+    int32_t pack_id;
+    bool dirty;                     // 마지막 동기화 뒤에 추가한 레코드가 있음
+    bool sync_failed;               // 넘어가기 전 팩의 동기화 실패 (다음 thumb_pack_sync가 알린다)
+} writer = { PTHREAD_MUTEX_INITIALIZER, -1, 0, false, false };
+
+// 읽기용으로 열어 둔 팩 (pread 중에는 읽기 잠금, 열고 닫을 때만 쓰기 잠금)
+typedef struct {
+    int32_t pack_id;
+    int fd;
+} thumb_pack_fd_t;
+
+static struct {
+    pthread_rwlock_t lock;
+    thumb_pack_fd_t open[THUMBNAIL_PACK_MAX_OPEN];
+    int count;
+    int next_evict;
+} readers = {
+    .lock = PTHREAD_RWLOCK_INITIALIZER
+};
+
+static thread_pool_timer_t *compact_timer = NULL;
+
+// 압축을 마쳤지만 아직 지우지 않은 팩 (압축 스레드만 사용)
+// 이전 스냅샷으로 위치를 받은 요청이 팩을 열기 전에 지우지 않도록 다음 압축 때 지운다
+static struct {
+    int32_t *ids;
+    int count;
+    int cap;
+} retired = { NULL, 0, 0 };
+
+// 행 하나의 이동 (압축: 지난 팩 → 현재 팩, 가져오기: 개별 파일 → 현재 팩)
+typedef struct {
+    ott_uuid_t thumbnail_id;
+    thumb_pack_ref_t from;
+    thumb_pack_ref_t to;
+} thumb_pack_move_t;
+
+void thumb_pack_path(int32_t pack_id, char *out, size_t out_len) {
+    snprintf(out, out_len, "%s/pack-%06d.pack", THUMBNAIL_DIR, (int)pack_id);
+}
+
+// "pack-<번호>.pack"이면 번호, 아니면 0
+static int32_t thumb_pack_parse_name(const char *name) {
+    int id = 0;
+    int end = 0;
+    if (sscanf(name, "pack-%d%n", &id, &end) != 1 || strcmp(name + end, ".pack") != 0 || id <= 0) {
+        return 0;
+    }
+    return id;
+}
+
+// 디렉터리에서 가장 큰 팩 번호 (없으면 0)
+static int32_t thumb_pack_latest(void) {
+    DIR *dir = opendir(THUMBNAIL_DIR);
+    if (dir == NULL) {
+        return 0;
+    }
+    int32_t latest = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        int32_t id = thumb_pack_parse_name(entry->d_name);
+        if (id > latest) {
+            latest = id;
+        }
+    }
+    closedir(dir);
+    return latest;
+}
+
+static int thumb_pack_pwrite_all(int fd, const void *data, size_t length, off_t offset) {
+    const char *p = data;
+    while (length > 0) {
+        ssize_t n = pwrite(fd, p, length, offset);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return -1;
+        }
+        p += n;
+        length -= (size_t)n;
+        offset += n;
+    }
+    return 0;
+}
+
+static int thumb_pack_open_writer(int32_t pack_id) {
+    char path[MAX_PATH_LEN];
+    thumb_pack_path(pack_id, path, sizeof(path));
+    mkdir(THUMBNAIL_DIR, 0755);
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        log_error("썸네일 팩을 열 수 없습니다: %s (%s)", path, strerror(errno));
+        return -1;
+    }
+    writer.fd = fd;
+    writer.pack_id = pack_id;
+    return 0;
+}
+
+// 추가한 레코드를 디스크에 내린 뒤 닫는다 (writer.mutex를 잡은 상태에서 호출)
+static void thumb_pack_close_writer(void) {
+    if (writer.fd >= 0) {
+        if (writer.dirty && fdatasync(writer.fd) != 0) {
+            log_error("썸네일 팩 동기화 실패: pack %d (%s)", (int)writer.pack_id, strerror(errno));
+            writer.sync_failed = true;
+        }
+        writer.dirty = false;
+        close(writer.fd);
+        writer.fd = -1;
+    }
+}
+
+// flock을 잡은 상태에서 호출 (반환: 0 추가함, 1 다른 팩으로 넘어가야 함, -1 실패)
+static int thumb_pack_append_locked(const void *data, size_t length, thumb_pack_ref_t *ref) {
+    struct stat st;
+    if (fstat(writer.fd, &st) != 0) {
+        log_error("썸네일 팩 상태 확인 실패: pack %d (%s)", (int)writer.pack_id, strerror(errno));
+        return -1;
+    }
+    // 압축으로 지워진 팩이거나 (이 프로세스나 다른 프로세스가 채워) 가득 찬 팩
+    if (st.st_nlink == 0 || st.st_size >= THUMBNAIL_PACK_MAX_BYTES) {
+        return 1;
+    }
+
+    thumb_pack_header_t header = { THUMB_PACK_MAGIC, (uint32_t)length };
+    off_t offset = st.st_size;
+    if (thumb_pack_pwrite_all(writer.fd, &header, sizeof(header), offset) < 0 ||
+        thumb_pack_pwrite_all(writer.fd, data, length, offset + (off_t)sizeof(header)) < 0) {
+        log_error("썸네일 팩 쓰기 실패: pack %d (%s)", (int)writer.pack_id, strerror(errno));
+        // 반쯤 쓴 레코드를 잘라 다음 추가가 같은 자리에 쓰도록
+        if (ftruncate(writer.fd, offset) != 0) {
+            log_warn("썸네일 팩 되돌리기 실패: pack %d", (int)writer.pack_id);
+        }
+        return -1;
+    }
+
+    writer.dirty = true;
+    ref->pack_id = writer.pack_id;
+    ref->offset = (int64_t)offset + (int64_t)sizeof(header);
+    ref->length = (int32_t)length;
+    return 0;
+}
+
+int thumb_pack_append(const void *data, size_t length, thumb_pack_ref_t *ref) {
+    if (length == 0 || length > INT32_MAX) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&writer.mutex);
+    int rc = -1;
+    // 다른 프로세스가 팩을 넘겼으면 따라간다 (몇 번이면 충분하다)
+    for (int attempt = 0; attempt < 4; attempt++) {
+        if (writer.fd < 0) {
+            int32_t latest = thumb_pack_latest();
+            if (thumb_pack_open_writer(latest > 0 ? latest : 1) < 0) {
+                break;
+            }
+        }
+        if (flock(writer.fd, LOCK_EX) != 0) {
+            log_error("썸네일 팩 잠금 실패: pack %d (%s)", (int)writer.pack_id, strerror(errno));
+            break;
+        }
+        rc = thumb_pack_append_locked(data, length, ref);
+        flock(writer.fd, LOCK_UN);
+        if (rc <= 0) {
+            break;
+        }
+        rc = -1;
+
+        // 가득 찼으면 다음 번호, 지워졌으면 디렉터리에서 다시 찾는다
+        struct stat st;
+        int32_t next = (fstat(writer.fd, &st) == 0 && st.st_nlink > 0) ? writer.pack_id + 1 : 0;
+        thumb_pack_close_writer();
+        if (next > 0 && thumb_pack_open_writer(next) < 0) {
+            break;
+        }
+    }
+    pthread_mutex_unlock(&writer.mutex);
+    return rc;
+}
+
+int thumb_pack_sync(void) {
+    pthread_mutex_lock(&writer.mutex);
+    int rc = 0;
+    if (writer.fd >= 0 && writer.dirty) {
+        if (fdatasync(writer.fd) != 0) {
+            log_error("썸네일 팩 동기화 실패: pack %d (%s)", (int)writer.pack_id, strerror(errno));
+            rc = -1;
+        } else {
+            writer.dirty = false;
+        }
+    }
+    if (writer.sync_failed) {
+        writer.sync_failed = false;
+        rc = -1;
+    }
+    pthread_mutex_unlock(&writer.mutex);
+    return rc;
+}
+
+// 열어 둔 fd 찾기 (readers.lock을 잡은 상태에서 호출)
+static int thumb_pack_find_fd(int32_t pack_id) {
+    for (int i = 0; i < readers.count; i++) {
+        if (readers.open[i].pack_id == pack_id) {
+            return readers.open[i].fd;
+        }
+    }
+    return -1;
+}
+
+static int thumb_pack_open_reader(int32_t pack_id) {
+    char path[MAX_PATH_LEN];
+    thumb_pack_path(pack_id, path, sizeof(path));
+
+    pthread_rwlock_wrlock(&readers.lock);
+    int rc = 0;
+    if (thumb_pack_find_fd(pack_id) < 0) {
+        int fd = open(path, O_RDONLY | O_CLOEXEC);
+        if (fd < 0) {
+            log_error("썸네일 팩을 열 수 없습니다: %s (%s)", path, strerror(errno));
+            rc = -1;
+        } else {
+            // 가득 차면 돌아가며 하나를 닫는다
+            int slot = readers.count;
+            if (slot < THUMBNAIL_PACK_MAX_OPEN) {
+                readers.count++;
+            } else {
+                slot = readers.next_evict;
+                readers.next_evict = (slot + 1) % THUMBNAIL_PACK_MAX_OPEN;
+                close(readers.open[slot].fd);
+            }
+            readers.open[slot].pack_id = pack_id;
+            readers.open[slot].fd = fd;
+        }
+    }
+    pthread_rwlock_unlock(&readers.lock);
+    return rc;
+}
+
+int thumb_pack_read(const thumb_pack_ref_t *ref, void *buffer) {
+    for (int attempt = 0; attempt < 3; attempt++) {
+        pthread_rwlock_rdlock(&readers.lock);
+        int fd = thumb_pack_find_fd(ref->pack_id);
+        if (fd >= 0) {
+            ssize_t n = pread(fd, buffer, (size_t)ref->length, (off_t)ref->offset);
+            pthread_rwlock_unlock(&readers.lock);
+            if (n != ref->length) {
+                log_error("썸네일 팩 읽기 실패: pack %d @%lld (%d바이트)", (int)ref->pack_id,
+                          (long long)ref->offset, (int)ref->length);
+                return -1;
+            }
+            return 0;
+        }
+        pthread_rwlock_unlock(&readers.lock);
+
+        if (thumb_pack_open_reader(ref->pack_id) < 0) {
+            return -1;
+        }
+    }
+    return -1;
+}
+
+// 지난 압축에서 지운 팩 닫기 (그사이 카탈로그가 새 위치로 바뀌어 더 읽을 일이 없다)
+static void thumb_pack_close_unlinked(void) {
+    pthread_rwlock_wrlock(&readers.lock);
+    for (int i = 0; i < readers.count; ) {
+        struct stat st;
+        if (fstat(readers.open[i].fd, &st) == 0 && st.st_nlink == 0) {
+            close(readers.open[i].fd);
+            readers.open[i] = readers.open[--readers.count];
+            continue;
+        }
+        i++;
+    }
+    readers.next_evict = 0;
+    pthread_rwlock_unlock(&readers.lock);
+}
+
+// 이동 목록을 한 트랜잭션으로 반영 (옮긴 레코드를 디스크에 내린 뒤에 행을 바꾼다)
+static int thumb_pack_apply_moves(const thumb_pack_move_t *moves, int count) {
+    db_batch_t batch;
+    if (thumb_pack_sync() < 0 || db_batch_begin(&batch) < 0) {
+        return -1;
+    }
+    for (int i = 0; i < count; i++) {
+        if (db_batch_move_thumbnail(&batch, moves[i].thumbnail_id, &moves[i].from, &moves[i].to) < 0) {
+            db_batch_rollback(&batch);
+            return -1;
+        }
+    }
+    return db_batch_commit(&batch);
+}
+
+typedef struct {
+    int fd;                         // 옮기는 팩
+    unsigned char *buffer;
+    size_t buffer_size;
+    thumb_pack_move_t *moves;
+    int count;
+    int cap;
+    bool failed;
+} thumb_pack_copy_t;
+
+static bool thumb_pack_reserve(unsigned char **buffer, size_t *size, size_t need) {
+    if (need <= *size) {
+        return true;
+    }
+    unsigned char *grown = realloc(*buffer, need);
+    if (grown == NULL) {
+        return false;
+    }
+    *buffer = grown;
+    *size = need;
+    return true;
+}
+
+// 레코드를 헤더까지 읽어 확인한 뒤 현재 팩으로 복사
+static int thumb_pack_copy_record(void *arg, const thumbnail_t *thumb) {
+    thumb_pack_copy_t *copy = arg;
+    size_t length = (size_t)thumb->pack.length;
+    size_t total = length + THUMB_PACK_RECORD_HEADER;
+
+    if (copy->count == copy->cap) {
+        int cap = copy->cap > 0 ? copy->cap * 2 : 256;
+        thumb_pack_move_t *grown = realloc(copy->moves, (size_t)cap * sizeof(*grown));
+        if (grown == NULL) {
+            copy->failed = true;
+            return -1;
+        }
+        copy->moves = grown;
+        copy->cap = cap;
+    }
+    if (!thumb_pack_reserve(&copy->buffer, &copy->buffer_size, total)) {
+        copy->failed = true;
+        return -1;
+    }
+
+    thumb_pack_header_t header = { 0, 0 };
+    ssize_t n = pread(copy->fd, copy->buffer, total, (off_t)(thumb->pack.offset - THUMB_PACK_RECORD_HEADER));
+    if (n == (ssize_t)total) {
+        memcpy(&header, copy->buffer, sizeof(header));
+    }
+    if (header.magic != THUMB_PACK_MAGIC || header.length != (uint32_t)length) {
+        // 손상된 레코드를 가리키는 행이 있으면 팩을 지우지 않는다
+        log_error("썸네일 팩 레코드가 손상되었습니다: pack %d @%lld (썸네일 %s)", (int)thumb->pack.pack_id,
+                  (long long)thumb->pack.offset, thumb->id);
+        copy->failed = true;
+        return -1;
+    }
+
+    thumb_pack_move_t *move = &copy->moves[copy->count];
+    if (thumb_pack_append(copy->buffer + THUMB_PACK_RECORD_HEADER, length, &move->to) < 0) {
+        copy->failed = true;
+        return -1;
+    }
+    snprintf(move->thumbnail_id, sizeof(move->thumbnail_id), "%s", thumb->id);
+    move->from = thumb->pack;
+    copy->count++;
+    return 0;
+}
+
+// 팩 하나 압축: 살아 있는 이미지를 현재 팩으로 복사하고 행을 고친 뒤 팩을 지운다
+// 복사는 읽기 연결로 하고 쓰기 연결은 마지막 갱신에만 잡는다
+static int thumb_pack_compact_one(int32_t pack_id, int64_t live_bytes, int64_t pack_bytes) {
+    char path[MAX_PATH_LEN];
+    thumb_pack_path(pack_id, path, sizeof(path));
+
+    thumb_pack_copy_t copy = { .fd = open(path, O_RDONLY | O_CLOEXEC) };
+    if (copy.fd < 0) {
+        log_error("썸네일 팩을 열 수 없습니다: %s (%s)", path, strerror(errno));
+        return -1;
+    }
+
+    int rc = db_scan_pack_thumbnails(pack_id, thumb_pack_copy_record, &copy);
+    if (rc == 0 && !copy.failed && copy.count > 0) {
+        rc = thumb_pack_apply_moves(copy.moves, copy.count);
+    }
+    close(copy.fd);
+    free(copy.buffer);
+    free(copy.moves);
+
+    // 실패하면 이미 복사한 레코드는 현재 팩의 죽은 바이트로 남고 다음 압축에서 회수된다
+    if (rc < 0 || copy.failed) {
+        log_error("썸네일 팩 %d 압축 실패", (int)pack_id);
+        return -1;
+    }
+    // 새 위치를 게시하고 파일은 다음 압축 때 지운다 (그 전에 이전 스냅샷을 가진 요청이 모두 끝난다)
+    // 목록에 넣지 못하거나 그 전에 종료되면 행이 없는 팩으로 남아 다음 압축에서 다시 처리된다
+    if (copy.count > 0) {
+        catalog_refresh_if_changed();
+    }
+    if (retired.count == retired.cap) {
+        int cap = retired.cap > 0 ? retired.cap * 2 : 16;
+        int32_t *grown = realloc(retired.ids, (size_t)cap * sizeof(*grown));
+        if (grown != NULL) {
+            retired.ids = grown;
+            retired.cap = cap;
+        }
+    }
+    if (retired.count < retired.cap) {
+        retired.ids[retired.count++] = pack_id;
+    }
+    log_info("썸네일 팩 %d 압축: 이미지 %d개 이동, %.1f MB 회수", (int)pack_id, copy.count,
+             (pack_bytes - live_bytes) / (1024.0 * 1024.0));
+    return 0;
+}
+
+typedef struct {
+    int32_t pack_id;
+    int64_t live_bytes;
+} thumb_pack_usage_t;
+
+typedef struct {
+    thumb_pack_usage_t *items;
+    int count;
+    int cap;
+} thumb_pack_usage_list_t;
+
+static int thumb_pack_collect_usage(void *ctx, int32_t pack_id, int64_t live_bytes) {
+    thumb_pack_usage_list_t *list = ctx;
+    if (list->count == list->cap) {
+        int cap = list->cap > 0 ? list->cap * 2 : 64;
+        thumb_pack_usage_t *grown = realloc(list->items, (size_t)cap * sizeof(*grown));
+        if (grown == NULL) {
+            return -1;
+        }
+        list->items = grown;
+        list->cap = cap;
+    }
+    list->items[list->count++] = (thumb_pack_usage_t){ pack_id, live_bytes };
+    return 0;
+}
+
+// 지난 압축에서 비운 팩 지우기 (열어 둔 fd는 다음 압축의 thumb_pack_close_unlinked가 닫는다)
+static void thumb_pack_unlink_retired(void) {
+    for (int i = 0; i < retired.count; i++) {
+        char path[MAX_PATH_LEN];
+        thumb_pack_path(retired.ids[i], path, sizeof(path));
+        if (unlink(path) != 0 && errno != ENOENT) {
+            log_warn("압축한 썸네일 팩을 지우지 못했습니다: %s (%s)", path, strerror(errno));
+        }
+    }
+    retired.count = 0;
+}
+
+int thumb_pack_compact(void) {
+    thumb_pack_close_unlinked();
+    thumb_pack_unlink_retired();
+
+    int32_t latest = thumb_pack_latest();
+    if (latest <= 1) {
+        return 0;
+    }
+
+    thumb_pack_usage_list_t usage = { 0 };
+    if (db_scan_pack_usage(thumb_pack_collect_usage, &usage) < 0) {
+        free(usage.items);
+        return -1;
+    }
+
+    // 현재 팩은 추가 중이므로 건드리지 않는다
+    int compacted = 0;
+    time_t now = time(NULL);
+    for (int32_t pack_id = 1; pack_id < latest; pack_id++) {
+        char path[MAX_PATH_LEN];
+        struct stat st;
+        thumb_pack_path(pack_id, path, sizeof(path));
+        if (stat(path, &st) != 0 || now - st.st_mtime < THUMBNAIL_PACK_COMPACT_GRACE_SEC) {
+            continue;
+        }
+        int64_t live_bytes = 0;
+        for (int i = 0; i < usage.count; i++) {
+            if (usage.items[i].pack_id == pack_id) {
+                live_bytes = usage.items[i].live_bytes;
+                break;
+            }
+        }
+        if ((double)live_bytes >= (double)st.st_size * THUMBNAIL_PACK_COMPACT_RATIO) {
+            continue;
+        }
+        if (thumb_pack_compact_one(pack_id, live_bytes, (int64_t)st.st_size) == 0) {
+            compacted++;
+        }
+    }
+
+    free(usage.items);
+    return compacted;
+}
+
+typedef struct {
+    thumb_pack_move_t moves[THUMB_PACK_IMPORT_BATCH];
+    char paths[THUMB_PACK_IMPORT_BATCH][sizeof(((thumbnail_t*)0)->file_path)];
+    int count;
+    int imported;
+    int skipped;
+    unsigned char *buffer;
+    size_t buffer_size;
+    bool failed;
+} thumb_pack_import_t;
+
+// 한 트랜잭션을 반영한 뒤 미디어 디렉터리 안의 원래 파일을 지운다
+static int thumb_pack_import_flush(thumb_pack_import_t *import) {
+    if (import->count == 0) {
+        return 0;
+    }
+    if (thumb_pack_apply_moves(import->moves, import->count) < 0) {
+        import->failed = true;
+        return -1;
+    }
+    size_t dir_len = strlen(THUMBNAIL_DIR);
+    for (int i = 0; i < import->count; i++) {
+        if (strncmp(import->paths[i], THUMBNAIL_DIR "/", dir_len + 1) == 0) {
+            remove(import->paths[i]);
+        }
+    }
+    import->imported += import->count;
+    import->count = 0;
+    return 0;
+}
+
+static int thumb_pack_import_file(void *arg, const thumbnail_t *thumb) {
+    thumb_pack_import_t *import = arg;
+
+    FILE *fp = fopen(thumb->file_path, "rb");
+    struct stat st;
+    if (fp == NULL || fstat(fileno(fp), &st) != 0 || st.st_size <= 0 || st.st_size > INT32_MAX ||
+        !thumb_pack_reserve(&import->buffer, &import->buffer_size, (size_t)st.st_size) ||
+        fread(import->buffer, 1, (size_t)st.st_size, fp) != (size_t)st.st_size) {
+        log_warn("썸네일 파일을 읽을 수 없어 건너뜁니다: %s", thumb->file_path);
+        if (fp != NULL) {
+            fclose(fp);
+        }
+        import->skipped++;
+        return 0;
+    }
+    fclose(fp);
+
+    thumb_pack_move_t *move = &import->moves[import->count];
+    if (thumb_pack_append(import->buffer, (size_t)st.st_size, &move->to) < 0) {
+        import->failed = true;
+        return -1;
+    }
+    snprintf(move->thumbnail_id, sizeof(move->thumbnail_id), "%s", thumb->id);
+    memset(&move->from, 0, sizeof(move->from));
+    snprintf(import->paths[import->count], sizeof(import->paths[0]), "%s", thumb->file_path);
+
+    if (++import->count == THUMB_PACK_IMPORT_BATCH) {
+        return thumb_pack_import_flush(import);
+    }
+    return 0;
+}
+
+int thumb_pack_import_files(void) {
+    thumb_pack_import_t *import = calloc(1, sizeof(*import));
+    if (import == NULL) {
+        return -1;
+    }
+
+    int rc = db_scan_pack_thumbnails(0, thumb_pack_import_file, import);
+    if (rc == 0 && !import->failed) {
+        rc = thumb_pack_import_flush(import);
+    }
+    int imported = import->imported;
+    if (import->skipped > 0) {
+        log_warn("읽을 수 없는 썸네일 파일 %d개는 그대로 두었습니다", import->skipped);
+    }
+    bool failed = (rc < 0 || import->failed);
+    free(import->buffer);
+    free(import);
+    return failed ? -1 : imported;
+}
+
+static void thumb_pack_compact_task(void *arg) {
+    (void)arg;
+    thumb_pack_compact();
+}
+
+int thumb_pack_start(thread_pool_t *background) {
+    if (thread_pool_schedule_every(background, THUMBNAIL_PACK_COMPACT_INTERVAL_SEC * 1000, thumb_pack_compact_task,
+                                   NULL, TP_PRIORITY_BATCH, &compact_timer) < 0) {
+        log_error("썸네일 팩 압축 예약 실패");
+        return -1;
+    }
+    return 0;
+}
+
+void thumb_pack_stop(void) {
+    if (compact_timer != NULL) {
+        thread_pool_timer_cancel(compact_timer, true);
+        thread_pool_timer_release(compact_timer);
+        compact_timer = NULL;
+    }
+    // 지우지 못한 팩은 다음 실행의 압축이 행 없는 팩으로 다시 처리한다
+    free(retired.ids);
+    retired.ids = NULL;
+    retired.count = 0;
+    retired.cap = 0;
+
+    pthread_mutex_lock(&writer.mutex);
+    thumb_pack_close_writer();
+    pthread_mutex_unlock(&writer.mutex);
+
+    pthread_rwlock_wrlock(&readers.lock);
+    for (int i = 0; i < readers.count; i++) {
+        close(readers.open[i].fd);
+    }
+    readers.count = 0;
+    readers.next_evict = 0;
+    pthread_rwlock_unlock(&readers.lock);
+}
@@ -1,95 +1,413 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdbool.h>
+#include <errno.h>
 #include <sys/stat.h>
+#include <libavformat/avformat.h>
+#include <libavcodec/avcodec.h>
+#include <libavutil/avutil.h>
+#include <libswscale/swscale.h>
 #include "thumbnail.h"
+#include "thumb_pack.h"
+#include "media_probe.h"
 #include "logger.h"
 #include "db.h"
 #include "uuid.h"
 #include "config.h"
 
+// 출력 형식 (생성 순서)
+typedef struct {
+    const char *mime_type;
+    const char *extension;
+    const char *encoder;            // NULL: 내장 MJPEG 인코더
+    const char *muxer;              // NULL: 인코더 패킷이 그대로 완전한 이미지 파일
+    enum AVPixelFormat pix_fmt;
+    const char *options;            // 인코더 옵션 ("키=값:키=값")
+    bool enabled;
+} thumbnail_format_t;
+
+static const thumbnail_format_t thumbnail_formats[] = {
+    { "image/avif", "avif", "libaom-av1", "avif", AV_PIX_FMT_YUV420P,
+      "crf=32:cpu-used=6:still-picture=1", THUMBNAIL_AVIF },
+    { "image/webp", "webp", "libwebp", NULL, AV_PIX_FMT_YUV420P,
+      "quality=75:compression_level=4", true },
+    // JPEG는 전 범위(full range) YUV를 쓴다
+    { "image/jpeg", "jpg", NULL, NULL, AV_PIX_FMT_YUVJ420P, NULL, true },
+};
+
+#define THUMBNAIL_FORMAT_COUNT (sizeof(thumbnail_formats) / sizeof(thumbnail_formats[0]))
+#define THUMBNAIL_JPEG_QSCALE 4         // MJPEG qscale (2~31, 작을수록 고화질)
+
+static void thumbnail_av_error(const char *what, const char *path, int rc) {
+    char err[AV_ERROR_MAX_STRING_SIZE];
+    av_strerror(rc, err, sizeof(err));
+    log_error("%s 실패: %s (%s)", what, path, err);
+}
+
 int thumbnail_get_duration(const char *video_path, double *duration_sec) {
     if (video_path == NULL || duration_sec == NULL) {
         return -1;
     }
 
-    char command[2048];
-    snprintf(command, sizeof(command),
-             "ffprobe -v error -show_entries format=duration "
-             "-of default=noprint_wrappers=1:nokey=1 \"%s\"",
-             video_path);
+    media_info_t info;
+    if (media_probe(video_path, &info) < 0 || info.duration_sec <= 0) {
+        log_error("동영상 길이 읽기 실패: %s", video_path);
+        return -1;
+    }
+    *duration_sec = info.duration_sec;
+    
+    log_debug("동영상 길이: %.2f초", *duration_sec);
+    return 0;
+}
+
+// 디코딩할 동영상 스트림
+typedef struct {
+    AVFormatContext *fmt;
+    AVCodecContext *dec;
+    AVPacket *pkt;
+    int stream;
+} thumbnail_input_t;
 
-    FILE *fp = popen(command, "r");
-    if (fp == NULL) {
-        log_error("ffprobe 실행 실패");
+static void thumbnail_close_input(thumbnail_input_t *in) {
+    avcodec_free_context(&in->dec);
+    avformat_close_input(&in->fmt);
+    av_packet_free(&in->pkt);
+}
+
+// thread_count 1: 프레임 하나만 필요할 때 프레임 스레딩 지연을 피한다, 0: 자동
+static int thumbnail_open_input(const char *video_path, int thread_count, enum AVDiscard skip_frame,
+                                thumbnail_input_t *in) {
+    memset(in, 0, sizeof(*in));
+    const AVCodec *codec = NULL;
+    in->pkt = av_packet_alloc();
+
+    int rc = (in->pkt != NULL) ? avformat_open_input(&in->fmt, video_path, NULL, NULL) : AVERROR(ENOMEM);
+    if (rc >= 0) {
+        rc = avformat_find_stream_info(in->fmt, NULL);
+    }
+    if (rc >= 0) {
+        rc = in->stream = av_find_best_stream(in->fmt, AVMEDIA_TYPE_VIDEO, -1, -1, &codec, 0);
+    }
+    if (rc >= 0) {
+        in->dec = avcodec_alloc_context3(codec);
+        rc = (in->dec != NULL) ? avcodec_parameters_to_context(in->dec, in->fmt->streams[in->stream]->codecpar)
+                               : AVERROR(ENOMEM);
+    }
+    if (rc >= 0) {
+        in->dec->thread_count = thread_count;
+        in->dec->skip_frame = skip_frame;
+        rc = avcodec_open2(in->dec, codec, NULL);
+    }
+    if (rc < 0) {
+        thumbnail_av_error("썸네일용 동영상 열기", video_path, rc);
+        thumbnail_close_input(in);
         return -1;
     }
+    return 0;
+}
+
+// 다음 프레임 (0: frame에 담음, 1: 스트림 끝 또는 디코딩 중단)
+static int thumbnail_next_frame(thumbnail_input_t *in, AVFrame *frame) {
+    for (;;) {
+        int rc = avcodec_receive_frame(in->dec, frame);
+        if (rc >= 0) {
+            return 0;
+        }
+        if (rc != AVERROR(EAGAIN)) {
+            return 1;
+        }
 
-    char duration_str[64];
-    if (fgets(duration_str, sizeof(duration_str), fp) == NULL) {
-        pclose(fp);
-        log_error("ffprobe에서 길이 읽기 실패");
+        if (av_read_frame(in->fmt, in->pkt) < 0) {
+            // 파일 끝: 디코더에 남은 프레임을 꺼낸다
+            avcodec_send_packet(in->dec, NULL);
+            continue;
+        }
+        if (in->pkt->stream_index == in->stream) {
+            // 손상된 패킷은 건너뛰고 다음 패킷으로 계속한다
+            avcodec_send_packet(in->dec, in->pkt);
+        }
+        av_packet_unref(in->pkt);
+    }
+}
+
+// offset_sec 이후 첫 프레임을 디코딩한다 (그보다 짧은 파일은 마지막 프레임)
+static int thumbnail_decode_frame(const char *video_path, double offset_sec, AVFrame *frame, AVRational *sar) {
+    thumbnail_input_t in;
+    if (thumbnail_open_input(video_path, 1, AVDISCARD_DEFAULT, &in) < 0) {
         return -1;
     }
 
-    pclose(fp);
-    *duration_sec = atof(duration_str);
-    
-    log_debug("동영상 길이: %.2f초", *duration_sec);
+    AVStream *st = in.fmt->streams[in.stream];
+    int64_t target = (int64_t)(offset_sec / av_q2d(st->time_base));
+    if (st->start_time != AV_NOPTS_VALUE) {
+        target += st->start_time;
+    }
+    // 목표 직전 키프레임으로 이동 (실패하면 처음부터 디코딩)
+    if (av_seek_frame(in.fmt, in.stream, target, AVSEEK_FLAG_BACKWARD) < 0) {
+        log_debug("썸네일 위치로 이동 실패, 처음부터 디코딩: %s", video_path);
+    }
+
+    AVFrame *decoded = av_frame_alloc();
+    bool have_frame = false;
+    while (decoded != NULL && thumbnail_next_frame(&in, decoded) == 0) {
+        av_frame_unref(frame);
+        av_frame_move_ref(frame, decoded);
+        have_frame = true;
+        if (frame->best_effort_timestamp == AV_NOPTS_VALUE || frame->best_effort_timestamp >= target) {
+            break;
+        }
+    }
+
+    if (have_frame) {
+        *sar = av_guess_sample_aspect_ratio(in.fmt, st, frame);
+    } else {
+        log_error("썸네일 프레임을 디코딩하지 못했습니다: %s", video_path);
+    }
+
+    av_frame_free(&decoded);
+    thumbnail_close_input(&in);
+    return have_frame ? 0 : -1;
+}
+
+static AVFrame* thumbnail_scale(struct SwsContext **sws, const AVFrame *src, int width, int height,
+                                enum AVPixelFormat pix_fmt) {
+    AVFrame *dst = av_frame_alloc();
+    if (dst == NULL) {
+        return NULL;
+    }
+    dst->width = width;
+    dst->height = height;
+    dst->format = pix_fmt;
+
+    // 축소 전용이므로 영역 평균(SWS_AREA)이 앨리어싱 없이 가장 싸다
+    *sws = sws_getCachedContext(*sws, src->width, src->height, (enum AVPixelFormat)src->format,
+                                width, height, pix_fmt, SWS_AREA, NULL, NULL, NULL);
+    if (*sws == NULL || av_frame_get_buffer(dst, 0) < 0 ||
+        sws_scale(*sws, (const uint8_t *const *)src->data, src->linesize, 0, src->height,
+                  dst->data, dst->linesize) <= 0) {
+        av_frame_free(&dst);
+        return NULL;
+    }
+    return dst;
+}
+
+// pack이 있으면 팩에 추가하고, 없으면 path에 파일로 쓴다 (탐색 미리보기 시트)
+static int thumbnail_write_file(const char *path, const AVPacket *pkt, thumb_pack_ref_t *pack) {
+    if (pack != NULL) {
+        return thumb_pack_append(pkt->data, (size_t)pkt->size, pack);
+    }
+    FILE *fp = fopen(path, "wb");
+    if (fp == NULL) {
+        log_error("썸네일 파일을 만들 수 없음: %s (%s)", path, strerror(errno));
+        return -1;
+    }
+    size_t written = fwrite(pkt->data, 1, (size_t)pkt->size, fp);
+    if (fclose(fp) != 0 || written != (size_t)pkt->size) {
+        log_error("썸네일 파일 쓰기 실패: %s", path);
+        return -1;
+    }
     return 0;
 }
 
-int thumbnail_generate(const char *video_path, const char *output_path, 
-                      int width, double offset_sec) {
-    if (video_path == NULL || output_path == NULL) {
+// 컨테이너가 필요한 형식 (AVIF: AV1 키프레임을 HEIF 컨테이너에 담는다)
+// 팩에 넣을 때는 메모리 버퍼에 먹싱한 뒤 한 번에 추가한다
+static int thumbnail_write_muxed(const char *muxer, const AVCodecContext *ctx, AVPacket *pkt, const char *path,
+                                 thumb_pack_ref_t *pack) {
+    AVFormatContext *oc = NULL;
+    AVStream *st = NULL;
+    int rc = avformat_alloc_output_context2(&oc, NULL, muxer, path);
+    if (rc >= 0) {
+        st = avformat_new_stream(oc, NULL);
+        rc = (st != NULL) ? avcodec_parameters_from_context(st->codecpar, ctx) : AVERROR(ENOMEM);
+    }
+    if (rc >= 0) {
+        st->time_base = ctx->time_base;
+        rc = (pack != NULL) ? avio_open_dyn_buf(&oc->pb) : avio_open(&oc->pb, path, AVIO_FLAG_WRITE);
+    }
+    int stored = 0;
+    if (rc >= 0) {
+        rc = avformat_write_header(oc, NULL);
+        if (rc >= 0) {
+            pkt->stream_index = 0;
+            av_packet_rescale_ts(pkt, ctx->time_base, st->time_base);
+            rc = av_write_frame(oc, pkt);
+        }
+        if (rc >= 0) {
+            rc = av_write_trailer(oc);
+        }
+        if (pack != NULL) {
+            uint8_t *data = NULL;
+            int length = avio_close_dyn_buf(oc->pb, &data);
+            oc->pb = NULL;
+            if (rc >= 0) {
+                stored = thumb_pack_append(data, (size_t)length, pack);
+            }
+            av_free(data);
+        } else {
+            avio_closep(&oc->pb);
+        }
+    }
+    avformat_free_context(oc);
+
+    if (rc < 0) {
+        thumbnail_av_error("썸네일 컨테이너 기록", path, rc);
         return -1;
     }
+    return stored;
+}
+
+// path: 파일 경로 (pack이 있으면 로그용 이름)
+static int thumbnail_encode(const thumbnail_format_t *format, const AVCodec *codec, AVFrame *frame,
+                            const char *path, thumb_pack_ref_t *pack) {
+    AVCodecContext *ctx = avcodec_alloc_context3(codec);
+    AVPacket *pkt = av_packet_alloc();
+    AVDictionary *options = NULL;
+    int rc = (ctx != NULL && pkt != NULL) ? 0 : AVERROR(ENOMEM);
 
-    // Create output directory if it doesn't exist
-    char dir_path[512];
-    strncpy(dir_path, output_path, sizeof(dir_path) - 1);
-    char *last_slash = strrchr(dir_path, '/');
-    if (last_slash != NULL) {
-        *last_slash = '\0';
-        mkdir(dir_path, 0755);
+    if (rc >= 0) {
+        ctx->width = frame->width;
+        ctx->height = frame->height;
+        ctx->pix_fmt = frame->format;
+        ctx->time_base = (AVRational){ 1, 25 };
+        ctx->sample_aspect_ratio = (AVRational){ 1, 1 };   // 축소하면서 정사각 픽셀로 맞췄다
+        ctx->thread_count = 1;
+        if (format->encoder == NULL) {
+            ctx->flags |= AV_CODEC_FLAG_QSCALE;
+            ctx->global_quality = FF_QP2LAMBDA * THUMBNAIL_JPEG_QSCALE;
+            frame->quality = ctx->global_quality;
+        }
+        if (format->options != NULL) {
+            av_dict_parse_string(&options, format->options, "=", ":", 0);
+        }
+        rc = avcodec_open2(ctx, codec, &options);
+    }
+    if (rc >= 0) {
+        rc = avcodec_send_frame(ctx, frame);
+    }
+    if (rc >= 0) {
+        rc = avcodec_send_frame(ctx, NULL);
+    }
+    if (rc >= 0) {
+        rc = avcodec_receive_packet(ctx, pkt);
+    }
+    if (rc < 0) {
+        thumbnail_av_error("썸네일 인코딩", path, rc);
+    } else {
+        rc = (format->muxer != NULL) ? thumbnail_write_muxed(format->muxer, ctx, pkt, path, pack)
+                                     : thumbnail_write_file(path, pkt, pack);
     }
 
-    // Build ffmpeg command
-    char command[2048];
-    snprintf(command, sizeof(command),
-             "ffmpeg -ss %.2f -i \"%s\" -vframes 1 -vf scale=%d:-1 \"%s\" -y 2>&1",
-             offset_sec, video_path, width, output_path);
+    av_dict_free(&options);
+    av_packet_free(&pkt);
+    avcodec_free_context(&ctx);
+    return rc < 0 ? -1 : 0;
+}
 
-    log_debug("썸네일 생성: %s", command);
+// 이 빌드의 FFmpeg에 있는 인코더만 사용 (libwebp/libaom은 선택 의존성)
+static const AVCodec* thumbnail_find_encoder(const thumbnail_format_t *format) {
+    if (format->encoder == NULL) {
+        return avcodec_find_encoder(AV_CODEC_ID_MJPEG);
+    }
+    const AVCodec *codec = avcodec_find_encoder_by_name(format->encoder);
+    if (codec == NULL) {
+        log_warn("%s 인코더가 없어 %s 이미지를 만들지 않습니다", format->encoder, format->mime_type);
+    } else if (format->muxer != NULL && av_guess_format(format->muxer, NULL, NULL) == NULL) {
+        log_warn("%s 먹서가 없어 %s 이미지를 만들지 않습니다", format->muxer, format->mime_type);
+        codec = NULL;
+    }
+    return codec;
+}
 
-    FILE *fp = popen(command, "r");
-    if (fp == NULL) {
-        log_error("ffmpeg 실행 실패");
+int thumbnail_generate_variants(const char *video_path, double offset_sec,
+                                thumbnail_variant_t *variants, int max_variants) {
+    if (video_path == NULL || variants == NULL || max_variants <= 0) {
         return -1;
     }
 
-    // Read ffmpeg output (for debugging)
-    char line[256];
-    while (fgets(line, sizeof(line), fp) != NULL) {
-        // Optionally log ffmpeg output
-        // log_debug("ffmpeg: %s", line);
+    const AVCodec *encoders[THUMBNAIL_FORMAT_COUNT];
+    for (size_t f = 0; f < THUMBNAIL_FORMAT_COUNT; f++) {
+        encoders[f] = thumbnail_formats[f].enabled ? thumbnail_find_encoder(&thumbnail_formats[f]) : NULL;
     }
 
-    int status = pclose(fp);
-    if (status != 0) {
-        log_error("ffmpeg가 상태 코드 %d로 실패했습니다", status);
+    AVFrame *frame = av_frame_alloc();
+    AVRational sar = { 0, 1 };
+    if (frame == NULL || thumbnail_decode_frame(video_path, offset_sec, frame, &sar) < 0) {
+        av_frame_free(&frame);
         return -1;
     }
 
-    // Verify output file exists
-    struct stat st;
-    if (stat(output_path, &st) != 0) {
-        log_error("썸네일 파일이 생성되지 않았습니다: %s", output_path);
+    // 화면 비율은 SAR을 반영해서 계산하고, 4:2:0 크로마 때문에 크기는 짝수로 맞춘다
+    double display_width = (double)frame->width;
+    if (sar.num > 0 && sar.den > 0) {
+        display_width = display_width * sar.num / sar.den;
+    }
+    int max_width = (int)(display_width + 0.5) & ~1;
+
+    static const int widths[] = THUMBNAIL_WIDTHS;
+    struct SwsContext *sws = NULL;
+    int count = 0;
+    for (size_t w = 0; w < sizeof(widths) / sizeof(widths[0]) && count < max_variants; w++) {
+        int width = widths[w];
+        bool last = false;
+        if (width >= max_width) {
+            width = max_width;
+            last = true;
+        }
+        int height = ((int)((double)width * frame->height / display_width + 0.5) + 1) & ~1;
+        if (width < 2 || height < 2) {
+            break;
+        }
+
+        // 같은 픽셀 형식을 쓰는 형식끼리는 축소 결과를 공유한다
+        AVFrame *scaled = NULL;
+        for (size_t f = 0; f < THUMBNAIL_FORMAT_COUNT && count < max_variants; f++) {
+            const thumbnail_format_t *format = &thumbnail_formats[f];
+            if (encoders[f] == NULL) {
+                continue;
+            }
+            if (scaled == NULL || scaled->format != format->pix_fmt) {
+                av_frame_free(&scaled);
+                scaled = thumbnail_scale(&sws, frame, width, height, format->pix_fmt);
+                if (scaled == NULL) {
+                    log_error("썸네일 축소 실패: %dx%d", width, height);
+                    continue;
+                }
+            }
+
+            // 인코딩이 끝난 이미지만 팩에 추가된다 (DB에 기록되기 전까지는 아무도 가리키지 않는다)
+            thumbnail_variant_t *variant = &variants[count];
+            if (thumbnail_encode(format, encoders[f], scaled, video_path, &variant->pack) < 0) {
+                continue;
+            }
+            variant->file_path[0] = '\0';
+            variant->mime_type = format->mime_type;
+            variant->width = width;
+            variant->height = height;
+            count++;
+        }
+        av_frame_free(&scaled);
+
+        if (last) {
+            break;
+        }
+    }
+
+    sws_freeContext(sws);
+    av_frame_free(&frame);
+
+    if (count == 0) {
+        log_error("썸네일 변형을 하나도 만들지 못했습니다: %s", video_path);
         return -1;
     }
+    log_info("썸네일 변형 %d개 생성: %s", count, video_path);
+    return count;
+}
 
-    log_info("썸네일 생성 완료: %s (크기: %lld 바이트)", output_path, (long long)st.st_size);
-    return 0;
+double thumbnail_default_offset(double duration_sec) {
+    // 10% of duration or 5 seconds, whichever is smaller
+    double offset_sec = duration_sec * 0.1;
+    return offset_sec > 5.0 ? 5.0 : offset_sec;
 }
 
 int thumbnail_generate_and_save(const char *video_id, const char *video_path) {
@@ -104,28 +422,251 @@ int thumbnail_generate_and_save(const char *video_id, const char *video_path) {
         duration_sec = 100.0; // Fallback
     }
 
-    // Calculate offset (10% of duration or 5 seconds, whichever is smaller)
-    double offset_sec = duration_sec * 0.1;
-    if (offset_sec > 5.0) {
-        offset_sec = 5.0;
-    }
+    double offset_sec = thumbnail_default_offset(duration_sec);
 
-    // Generate output path
-    char output_path[1024];
-    snprintf(output_path, sizeof(output_path), "%s/%s.jpg", THUMBNAIL_DIR, video_id);
+    thumbnail_variant_t variants[THUMBNAIL_MAX_VARIANTS];
+    int count = thumbnail_generate_variants(video_path, offset_sec, variants, THUMBNAIL_MAX_VARIANTS);
+    if (count < 0) {
+        return -1;
+    }
 
-    // Generate thumbnail
-    if (thumbnail_generate(video_path, output_path, 320, offset_sec) < 0) {
+    // 팩을 먼저 디스크에 내려야 커밋된 행이 빈 자리를 가리키지 않는다
+    if (thumb_pack_sync() < 0) {
         return -1;
     }
 
-    // Save to database
-    ott_uuid_t thumb_id;
-    if (db_create_thumbnail(video_id, output_path, 320, 180, thumb_id) < 0) {
+    // 변형 전체를 한 트랜잭션으로 기록 (카탈로그에는 한꺼번에 나타난다)
+    db_batch_t batch;
+    int rc = db_batch_begin(&batch);
+    for (int i = 0; rc == 0 && i < count; i++) {
+        ott_uuid_t thumb_id;
+        rc = db_batch_add_thumbnail(&batch, video_id, variants[i].file_path, variants[i].width,
+                                    variants[i].height, variants[i].mime_type, &variants[i].pack, thumb_id);
+    }
+    if (rc == 0) {
+        rc = db_batch_commit(&batch);
+    } else {
+        db_batch_rollback(&batch);
+    }
+
+    // 실패하면 팩에 추가한 이미지는 아무 행도 가리키지 않으므로 압축 때 회수된다
+    if (rc < 0) {
         log_error("데이터베이스에 썸네일 저장 실패");
         return -1;
     }
 
-    log_info("동영상 %s의 썸네일 저장 완료: %s", video_id, output_path);
+    log_info("동영상 %s의 썸네일 변형 %d개 저장 완료", video_id, count);
+    return 0;
+}
+
+const char* thumbnail_mime_extension(const char *mime_type) {
+    for (size_t f = 0; f < THUMBNAIL_FORMAT_COUNT; f++) {
+        if (mime_type != NULL && strcmp(thumbnail_formats[f].mime_type, mime_type) == 0) {
+            return thumbnail_formats[f].extension;
+        }
+    }
+    return "jpg";
+}
+
+// 빈 시트를 검은색으로 채운다 (마지막 시트의 남는 칸)
+static void trickplay_clear_sheet(AVFrame *sheet) {
+    uint8_t black = (sheet->format == AV_PIX_FMT_YUVJ420P) ? 0 : 16;
+    for (int y = 0; y < sheet->height; y++) {
+        memset(sheet->data[0] + (size_t)y * sheet->linesize[0], black, (size_t)sheet->width);
+    }
+    for (int plane = 1; plane <= 2; plane++) {
+        for (int y = 0; y < sheet->height / 2; y++) {
+            memset(sheet->data[plane] + (size_t)y * sheet->linesize[plane], 128, (size_t)sheet->width / 2);
+        }
+    }
+}
+
+// 프레임을 축소해서 시트의 (x, y) 칸에 바로 그린다 (4:2:0, x/y는 짝수)
+static int trickplay_place_tile(struct SwsContext **sws, const AVFrame *src, AVFrame *sheet,
+                                int x, int y, int tile_width, int tile_height) {
+    *sws = sws_getCachedContext(*sws, src->width, src->height, (enum AVPixelFormat)src->format,
+                                tile_width, tile_height, (enum AVPixelFormat)sheet->format,
+                                SWS_AREA, NULL, NULL, NULL);
+    if (*sws == NULL) {
+        return -1;
+    }
+    uint8_t *const dst[4] = {
+        sheet->data[0] + (size_t)y * sheet->linesize[0] + x,
+        sheet->data[1] + (size_t)(y / 2) * sheet->linesize[1] + x / 2,
+        sheet->data[2] + (size_t)(y / 2) * sheet->linesize[2] + x / 2,
+        NULL
+    };
+    return sws_scale(*sws, (const uint8_t *const *)src->data, src->linesize, 0, src->height,
+                     dst, sheet->linesize) > 0 ? 0 : -1;
+}
+
+// 채운 타일까지만 잘라서 시트 n을 기록
+static int trickplay_write_sheet(const thumbnail_format_t *format, const AVCodec *codec, AVFrame *sheet,
+                                 const trickplay_t *tp, int sheet_index, int tiles_in_sheet) {
+    char path[sizeof(tp->path_prefix) + 32];
+    char tmp_path[sizeof(path) + 8];
+    snprintf(path, sizeof(path), "%s_%d.%s", tp->path_prefix, sheet_index, format->extension);
+    snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
+
+    int full_height = sheet->height;
+    int rows_used = (tiles_in_sheet + tp->columns - 1) / tp->columns;
+    sheet->height = rows_used * tp->tile_height;
+    int rc = thumbnail_encode(format, codec, sheet, tmp_path, NULL);
+    sheet->height = full_height;
+
+    if (rc < 0 || rename(tmp_path, path) != 0) {
+        remove(tmp_path);
+        return -1;
+    }
+    return 0;
+}
+
+int thumbnail_generate_trickplay(const char *video_path, const char *output_prefix, trickplay_t *tp) {
+    if (video_path == NULL || output_prefix == NULL || tp == NULL) {
+        return -1;
+    }
+    memset(tp, 0, sizeof(*tp));
+    snprintf(tp->path_prefix, sizeof(tp->path_prefix), "%s", output_prefix);
+    tp->interval_ms = TRICKPLAY_INTERVAL_MS;
+    tp->columns = TRICKPLAY_COLUMNS;
+    tp->rows = TRICKPLAY_ROWS;
+
+    // 썸네일과 같은 형식 표에서 WebP를 우선하고, 없으면 JPEG
+    const thumbnail_format_t *format = NULL;
+    const AVCodec *codec = NULL;
+    for (size_t f = 0; f < THUMBNAIL_FORMAT_COUNT && codec == NULL; f++) {
+        if (thumbnail_formats[f].muxer == NULL) {
+            format = &thumbnail_formats[f];
+            codec = thumbnail_find_encoder(format);
+        }
+    }
+    if (codec == NULL) {
+        return -1;
+    }
+    snprintf(tp->mime_type, sizeof(tp->mime_type), "%s", format->mime_type);
+
+    // 전체를 한 번 훑으므로 프레임 스레딩을 쓰고, 참조되지 않는 프레임(B 프레임 등)은 디코딩하지 않는다
+    thumbnail_input_t in;
+    if (thumbnail_open_input(video_path, 0, AVDISCARD_NONREF, &in) < 0) {
+        return -1;
+    }
+    AVStream *st = in.fmt->streams[in.stream];
+    int64_t start = (st->start_time != AV_NOPTS_VALUE) ? st->start_time : 0;
+    int64_t interval = av_rescale_q(tp->interval_ms, (AVRational){ 1, 1000 }, st->time_base);
+    if (interval <= 0) {
+        interval = 1;
+    }
+
+    AVFrame *frame = av_frame_alloc();
+    AVFrame *sheet = NULL;
+    struct SwsContext *sws = NULL;
+    int tiles_per_sheet = tp->columns * tp->rows;
+    int sheets = 0;
+    int rc = (frame != NULL) ? 0 : -1;
+
+    while (rc == 0 && thumbnail_next_frame(&in, frame) == 0) {
+        int64_t ts = frame->best_effort_timestamp;
+
+        if (sheet == NULL) {
+            // 첫 프레임에서 화면 비율(SAR 반영)로 타일 높이를 정한다
+            AVRational sar = av_guess_sample_aspect_ratio(in.fmt, st, frame);
+            double display_width = (double)frame->width;
+            if (sar.num > 0 && sar.den > 0) {
+                display_width = display_width * sar.num / sar.den;
+            }
+            tp->tile_width = TRICKPLAY_TILE_WIDTH;
+            tp->tile_height = ((int)((double)tp->tile_width * frame->height / display_width + 0.5) + 1) & ~1;
+            if (tp->tile_height < 2) {
+                tp->tile_height = 2;
+            }
+
+            sheet = av_frame_alloc();
+            if (sheet != NULL) {
+                sheet->format = format->pix_fmt;
+                sheet->width = tp->columns * tp->tile_width;
+                sheet->height = tp->rows * tp->tile_height;
+            }
+            if (sheet == NULL || av_frame_get_buffer(sheet, 0) < 0) {
+                rc = -1;
+                break;
+            }
+            trickplay_clear_sheet(sheet);
+        }
+
+        // 이 프레임이 경계를 넘은 모든 타일을 채운다 (구간보다 긴 장면 전환 없는 구간은 같은 그림)
+        while (rc == 0 && (ts == AV_NOPTS_VALUE || ts - start >= (int64_t)tp->tile_count * interval)) {
+            int slot = tp->tile_count % tiles_per_sheet;
+            rc = trickplay_place_tile(&sws, frame, sheet, (slot % tp->columns) * tp->tile_width,
+                                      (slot / tp->columns) * tp->tile_height, tp->tile_width, tp->tile_height);
+            if (rc < 0) {
+                break;
+            }
+            tp->tile_count++;
+            if (slot + 1 == tiles_per_sheet) {
+                rc = trickplay_write_sheet(format, codec, sheet, tp, sheets, tiles_per_sheet);
+                if (rc == 0) {
+                    sheets++;
+                    trickplay_clear_sheet(sheet);
+                }
+            }
+            if (ts == AV_NOPTS_VALUE) {
+                break;
+            }
+        }
+        av_frame_unref(frame);
+    }
+
+    if (rc == 0 && tp->tile_count % tiles_per_sheet != 0) {
+        rc = trickplay_write_sheet(format, codec, sheet, tp, sheets, tp->tile_count % tiles_per_sheet);
+        if (rc == 0) {
+            sheets++;
+        }
+    }
+
+    sws_freeContext(sws);
+    av_frame_free(&sheet);
+    av_frame_free(&frame);
+    thumbnail_close_input(&in);
+
+    if (rc < 0 || tp->tile_count == 0) {
+        log_error("탐색 미리보기 생성 실패: %s", video_path);
+        thumbnail_remove_trickplay(tp, sheets);
+        return -1;
+    }
+
+    log_info("탐색 미리보기 생성: %s (타일 %d개, 시트 %d장, %dx%d)", output_prefix, tp->tile_count, sheets,
+             tp->tile_width, tp->tile_height);
+    return 0;
+}
+
+void thumbnail_remove_trickplay(const trickplay_t *tp, int sheet_count) {
+    const char *extension = thumbnail_mime_extension(tp->mime_type);
+    for (int i = 0; i < sheet_count; i++) {
+        char path[sizeof(tp->path_prefix) + 32];
+        snprintf(path, sizeof(path), "%s_%d.%s", tp->path_prefix, i, extension);
+        remove(path);
+    }
+}
+
+int thumbnail_trickplay_and_save(const char *video_id, const char *video_path) {
+    if (video_id == NULL || video_path == NULL) {
+        return -1;
+    }
+
+    mkdir(THUMBNAIL_DIR, 0755);
+    char output_prefix[512];
+    snprintf(output_prefix, sizeof(output_prefix), "%s/%s_trickplay", THUMBNAIL_DIR, video_id);
+
+    trickplay_t tp;
+    if (thumbnail_generate_trickplay(video_path, output_prefix, &tp) < 0) {
+        return -1;
+    }
+    snprintf(tp.video_id, sizeof(tp.video_id), "%s", video_id);
+
+    if (db_save_trickplay(&tp) < 0) {
+        log_error("데이터베이스에 탐색 미리보기 저장 실패");
+        thumbnail_remove_trickplay(&tp, trickplay_sheet_count(&tp));
+        return -1;
+    }
     return 0;
 }
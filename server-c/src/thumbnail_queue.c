@@ -0,0 +1,154 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <time.h>
+#include "thumbnail_queue.h"
+#include "thumbnail.h"
+#include "thread_pool.h"
+#include "catalog.h"
+#include "types.h"
+#include "logger.h"
+#include "config.h"
+
+typedef enum {
+    SLOT_EMPTY = 0,
+    SLOT_PENDING,
+    SLOT_FAILED
+} slot_state_t;
+
+// 진행 중이거나 최근에 실패한 동영상 하나 (슬롯 수가 적어 선형 탐색)
+typedef struct {
+    ott_uuid_t video_id;
+    slot_state_t state;
+    time_t retry_after;             // SLOT_FAILED: 이 시각부터 다시 시도
+} thumbnail_slot_t;
+
+typedef struct {
+    int slot;
+    ott_uuid_t video_id;
+    char video_path[MAX_PATH_LEN];
+} thumbnail_job_t;
+
+static struct {
+    pthread_mutex_t mutex;          // slots 보호
+    thread_pool_t *pool;
+    atomic_bool stopping;
+    thumbnail_slot_t slots[THUMBNAIL_ONDEMAND_SLOTS];
+} queue = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER
+};
+
+static void thumbnail_queue_run(void *arg) {
+    thumbnail_job_t *job = arg;
+
+    int rc = -1;
+    if (!atomic_load(&queue.stopping)) {
+        rc = thumbnail_generate_and_save(job->video_id, job->video_path);
+        if (rc == 0) {
+            // 슬롯을 비우기 전에 게시해야 다음 요청이 같은 동영상을 다시 예약하지 않는다
+            catalog_refresh_if_changed();
+        } else {
+            log_warn("요청 시 썸네일 생성 실패: %s (%d초 뒤 다시 시도)", job->video_id,
+                     THUMBNAIL_ONDEMAND_RETRY_SEC);
+        }
+    }
+
+    pthread_mutex_lock(&queue.mutex);
+    thumbnail_slot_t *slot = &queue.slots[job->slot];
+    if (rc == 0 || atomic_load(&queue.stopping)) {
+        slot->state = SLOT_EMPTY;
+    } else {
+        slot->state = SLOT_FAILED;
+        slot->retry_after = time(NULL) + THUMBNAIL_ONDEMAND_RETRY_SEC;
+    }
+    pthread_mutex_unlock(&queue.mutex);
+
+    free(job);
+}
+
+int thumbnail_queue_start(void) {
+    atomic_store(&queue.stopping, false);
+    memset(queue.slots, 0, sizeof(queue.slots));
+    queue.pool = thread_pool_create_bounded(THUMBNAIL_ONDEMAND_WORKERS, THUMBNAIL_ONDEMAND_QUEUE);
+    if (queue.pool == NULL) {
+        log_error("썸네일 생성 스레드 풀 생성 실패");
+        return -1;
+    }
+    return 0;
+}
+
+thumbnail_queue_status_t thumbnail_queue_request(const char *video_id, const char *video_path) {
+    if (queue.pool == NULL) {
+        return THUMBNAIL_QUEUE_FAILED;
+    }
+    time_t now = time(NULL);
+
+    pthread_mutex_lock(&queue.mutex);
+    int match = -1;
+    int free_slot = -1;
+    for (int i = 0; i < THUMBNAIL_ONDEMAND_SLOTS; i++) {
+        const thumbnail_slot_t *slot = &queue.slots[i];
+        if (slot->state != SLOT_EMPTY && strcmp(slot->video_id, video_id) == 0) {
+            match = i;
+            break;
+        }
+        if (free_slot < 0 && (slot->state == SLOT_EMPTY ||
+                              (slot->state == SLOT_FAILED && now >= slot->retry_after))) {
+            free_slot = i;
+        }
+    }
+
+    // 이미 진행 중이면 합치고, 최근 실패는 다시 시도할 때까지 그대로 알린다
+    if (match >= 0) {
+        const thumbnail_slot_t *slot = &queue.slots[match];
+        if (slot->state == SLOT_PENDING || now < slot->retry_after) {
+            thumbnail_queue_status_t status = (slot->state == SLOT_PENDING) ? THUMBNAIL_QUEUE_PENDING
+                                                                             : THUMBNAIL_QUEUE_FAILED;
+            pthread_mutex_unlock(&queue.mutex);
+            return status;
+        }
+        free_slot = match;
+    }
+
+    thumbnail_job_t *job = NULL;
+    if (free_slot >= 0 && !atomic_load(&queue.stopping)) {
+        job = malloc(sizeof(*job));
+    }
+    if (job == NULL) {
+        pthread_mutex_unlock(&queue.mutex);
+        return THUMBNAIL_QUEUE_BUSY;
+    }
+    job->slot = free_slot;
+    snprintf(job->video_id, sizeof(job->video_id), "%s", video_id);
+    snprintf(job->video_path, sizeof(job->video_path), "%s", video_path);
+
+    thumbnail_slot_t *slot = &queue.slots[free_slot];
+    snprintf(slot->video_id, sizeof(slot->video_id), "%s", video_id);
+    slot->state = SLOT_PENDING;
+
+    // 가득 차 있으면 기다리지 않는다 (요청 스레드를 붙잡지 않도록)
+    if (thread_pool_submit_ex(queue.pool, thumbnail_queue_run, job, TP_PRIORITY_INTERACTIVE,
+                              NULL, 0, NULL) < 0) {
+        slot->state = SLOT_EMPTY;
+        pthread_mutex_unlock(&queue.mutex);
+        free(job);
+        return THUMBNAIL_QUEUE_BUSY;
+    }
+    pthread_mutex_unlock(&queue.mutex);
+
+    log_info("요청 시 썸네일 생성 예약: %s", video_id);
+    return THUMBNAIL_QUEUE_PENDING;
+}
+
+void thumbnail_queue_stop(void) {
+    if (queue.pool == NULL) {
+        return;
+    }
+
+    atomic_store(&queue.stopping, true);
+    thread_pool_destroy(queue.pool);
+    queue.pool = NULL;
+}
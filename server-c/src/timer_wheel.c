@@ -0,0 +1,157 @@
+#include <stddef.h>
+#include "timer_wheel.h"
+
+#define TIMER_WHEEL_MASK (TIMER_WHEEL_SLOTS - 1)
+
+static void timer_list_init(timer_node_t *head) {
+    head->prev = head;
+    head->next = head;
+}
+
+static void timer_list_append(timer_node_t *head, timer_node_t *node) {
+    node->prev = head->prev;
+    node->next = head;
+    head->prev->next = node;
+    head->prev = node;
+}
+
+static void timer_list_unlink(timer_node_t *node) {
+    node->prev->next = node->next;
+    node->next->prev = node->prev;
+    node->prev = node;
+    node->next = node;
+}
+
+timer_node_t* timer_list_pop(timer_node_t *head) {
+    if (head->next == head) {
+        return NULL;
+    }
+    timer_node_t *node = head->next;
+    timer_list_unlink(node);
+    return node;
+}
+
+void timer_wheel_init(timer_wheel_t *wheel, uint64_t now) {
+    wheel->now = now;
+    wheel->count = 0;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            timer_list_init(&wheel->slots[level][slot]);
+        }
+    }
+}
+
+void timer_node_init(timer_node_t *node) {
+    timer_list_init(node);
+    node->expires = 0;
+}
+
+// 남은 틱 수로 단계를 고르고, 그 단계에서 만료 틱의 해당 자리로 칸을 정한다
+static void timer_wheel_place(timer_wheel_t *wheel, timer_node_t *node) {
+    uint64_t expires = node->expires;
+    if (expires < wheel->now) {
+        expires = wheel->now;
+    }
+    uint64_t delta = expires - wheel->now;
+
+    int level = 0;
+    while (level < TIMER_WHEEL_LEVELS - 1 && delta >= (1ULL << (TIMER_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+    int slot = (int)((expires >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+    timer_list_append(&wheel->slots[level][slot], node);
+}
+
+void timer_wheel_add(timer_wheel_t *wheel, timer_node_t *node, uint64_t expires) {
+    if (expires > wheel->now + TIMER_WHEEL_MAX_TICKS) {
+        expires = wheel->now + TIMER_WHEEL_MAX_TICKS;
+    }
+    node->expires = expires;
+    timer_wheel_place(wheel, node);
+    wheel->count++;
+}
+
+void timer_wheel_remove(timer_wheel_t *wheel, timer_node_t *node) {
+    if (timer_node_pending(node)) {
+        timer_list_unlink(node);
+        wheel->count--;
+    }
+}
+
+// 상위 단계 칸 하나를 비우고 각 노드를 현재 시각 기준으로 다시 배치
+static void timer_wheel_cascade(timer_wheel_t *wheel, int level) {
+    int slot = (int)((wheel->now >> (TIMER_WHEEL_BITS * level)) & TIMER_WHEEL_MASK);
+    timer_node_t pending;
+    timer_list_init(&pending);
+
+    timer_node_t *node;
+    while ((node = timer_list_pop(&wheel->slots[level][slot])) != NULL) {
+        timer_list_append(&pending, node);
+    }
+    while ((node = timer_list_pop(&pending)) != NULL) {
+        timer_wheel_place(wheel, node);
+    }
+
+    if (slot == 0 && level + 1 < TIMER_WHEEL_LEVELS) {
+        timer_wheel_cascade(wheel, level + 1);
+    }
+}
+
+void timer_wheel_advance(timer_wheel_t *wheel, uint64_t now, timer_node_t *expired) {
+    while (wheel->now <= now) {
+        int slot = (int)(wheel->now & TIMER_WHEEL_MASK);
+        if (slot == 0 && wheel->now != 0) {
+            timer_wheel_cascade(wheel, 1);
+        }
+
+        timer_node_t *node;
+        while ((node = timer_list_pop(&wheel->slots[0][slot])) != NULL) {
+            timer_list_append(expired, node);
+            wheel->count--;
+        }
+        wheel->now++;
+    }
+}
+
+void timer_wheel_drain(timer_wheel_t *wheel, timer_node_t *expired) {
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        for (int slot = 0; slot < TIMER_WHEEL_SLOTS; slot++) {
+            timer_node_t *node;
+            while ((node = timer_list_pop(&wheel->slots[level][slot])) != NULL) {
+                timer_list_append(expired, node);
+            }
+        }
+    }
+    wheel->count = 0;
+}
+
+bool timer_wheel_next(const timer_wheel_t *wheel, uint64_t *tick) {
+    if (wheel->count == 0) {
+        return false;
+    }
+
+    uint64_t best = UINT64_MAX;
+    for (int level = 0; level < TIMER_WHEEL_LEVELS; level++) {
+        int shift = TIMER_WHEEL_BITS * level;
+        uint64_t base = wheel->now >> shift;
+        // 상위 단계의 현재 칸은 블록 경계에서 내려오므로, 경계를 지났으면 다음 칸부터 본다
+        int first = (wheel->now & ((1ULL << shift) - 1)) == 0 ? 0 : 1;
+        for (int i = first; i <= TIMER_WHEEL_SLOTS; i++) {
+            int slot = (int)((base + i) & TIMER_WHEEL_MASK);
+            const timer_node_t *head = &wheel->slots[level][slot];
+            if (head->next != head) {
+                uint64_t candidate = (base + i) << shift;
+                if (candidate < wheel->now) {
+                    candidate = wheel->now;
+                }
+                if (candidate < best) {
+                    best = candidate;
+                }
+                break;
+            }
+        }
+    }
+
+    *tick = best;
+    return true;
+}
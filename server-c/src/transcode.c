@@ -0,0 +1,335 @@
+#ifdef __linux__
+#define _GNU_SOURCE                     // setpriority, setpgid, pipe2
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <stdatomic.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+#include "transcode.h"
+#include "media_probe.h"
+#include "media_blob.h"
+#include "db.h"
+#include "logger.h"
+#include "config.h"
+
+static const transcode_rung_t ladder[] = TRANSCODE_LADDER;
+#define LADDER_SIZE ((int)(sizeof(ladder) / sizeof(ladder[0])))
+_Static_assert(sizeof(ladder) / sizeof(ladder[0]) <= TRANSCODE_MAX_RUNGS, "TRANSCODE_LADDER too long");
+
+// 진행률은 이만큼 오를 때마다 기록한다 (쓰기 연결을 자주 잡지 않도록)
+#define TRANSCODE_PROGRESS_STEP 0.05
+
+static struct {
+    thread_pool_t *pool;            // ffmpeg를 기다리는 워커 (TRANSCODE_MAX_JOBS개)
+    thread_pool_timer_t *timer;     // 백그라운드 풀의 주기 작업 (NULL이면 정지 상태)
+    atomic_int running;
+    atomic_bool stopping;
+    pthread_mutex_t mutex;          // children 보호
+    pid_t children[TRANSCODE_MAX_JOBS];
+} transcoder = {
+    .mutex = PTHREAD_MUTEX_INITIALIZER
+};
+
+int transcode_ladder_for(int source_height, const transcode_rung_t **rungs, int max_rungs) {
+    int n = 0;
+    for (int i = 0; i < LADDER_SIZE && n < max_rungs; i++) {
+        if (ladder[i].height < source_height) {
+            rungs[n++] = &ladder[i];
+        }
+    }
+    return n;
+}
+
+int transcode_enqueue(const char *video_id, int source_height) {
+    const transcode_rung_t *rungs[TRANSCODE_MAX_RUNGS];
+    int n = transcode_ladder_for(source_height, rungs, TRANSCODE_MAX_RUNGS);
+    for (int i = 0; i < n; i++) {
+        if (db_enqueue_transcode(video_id, rungs[i]->name, rungs[i]->height, rungs[i]->bitrate_kbps) < 0) {
+            return -1;
+        }
+    }
+    return n;
+}
+
+static void transcode_track_child(pid_t pid, pid_t expect) {
+    pthread_mutex_lock(&transcoder.mutex);
+    for (int i = 0; i < TRANSCODE_MAX_JOBS; i++) {
+        if (transcoder.children[i] == expect) {
+            transcoder.children[i] = pid;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&transcoder.mutex);
+}
+
+// ffmpeg 실행 (셸을 거치지 않고 인자를 그대로 넘긴다)
+// -progress pipe:1 출력으로 진행률을 갱신하고, 오류 출력의 마지막 줄을 error에 남긴다
+// 반환: 0 성공, -1 실패
+static int transcode_exec(const transcode_job_t *job, const char *out_path, char *error, size_t error_len) {
+    char scale[32], bitrate[16], maxrate[16], bufsize[16], threads[8], audio[16];
+    snprintf(scale, sizeof(scale), "scale=-2:%d", job->height);
+    snprintf(bitrate, sizeof(bitrate), "%dk", job->bitrate_kbps);
+    snprintf(maxrate, sizeof(maxrate), "%dk", job->bitrate_kbps * 107 / 100);
+    snprintf(bufsize, sizeof(bufsize), "%dk", job->bitrate_kbps * 2);
+    snprintf(threads, sizeof(threads), "%d", TRANSCODE_THREADS);
+    snprintf(audio, sizeof(audio), "%dk", TRANSCODE_AUDIO_KBPS);
+
+    const char *argv[] = {
+        FFMPEG_PATH, "-nostdin", "-hide_banner", "-loglevel", "error", "-y",
+        "-i", job->source_path,
+        "-map", "0:v:0", "-map", "0:a:0?", "-vf", scale,
+        "-c:v", "libx264", "-preset", TRANSCODE_PRESET,
+        "-b:v", bitrate, "-maxrate", maxrate, "-bufsize", bufsize, "-threads", threads,
+        "-c:a", "aac", "-b:a", audio, "-ac", "2",
+        "-movflags", "+faststart", "-progress", "pipe:1", "-nostats",
+        out_path, NULL
+    };
+
+    // 다른 워커가 동시에 띄우는 자식에게 이 파이프가 새지 않도록 만들 때부터 FD_CLOEXEC
+    // (자식의 dup2로 만든 stdout에는 붙지 않는다)
+    int fds[2];
+#ifdef __linux__
+    int rc = pipe2(fds, O_CLOEXEC);
+#else
+    // pipe2가 없는 플랫폼: pipe와 fcntl 사이에 다른 워커가 fork하면 파이프가 샐 수 있다
+    int rc = pipe(fds);
+    if (rc == 0) {
+        fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+        fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    }
+#endif
+    if (rc != 0) {
+        snprintf(error, error_len, "pipe: %s", strerror(errno));
+        return -1;
+    }
+
+    pid_t pid = fork();
+    if (pid < 0) {
+        snprintf(error, error_len, "fork: %s", strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        return -1;
+    }
+    if (pid == 0) {
+        // 자식: 터미널 시그널은 받지 않고(서버가 직접 정리), 서버 스레드의 시그널 마스크는 풀고,
+        // 낮은 우선순위로 실행한다
+        sigset_t none;
+        sigemptyset(&none);
+        sigprocmask(SIG_SETMASK, &none, NULL);
+        setpgid(0, 0);
+        setpriority(PRIO_PROCESS, 0, TRANSCODE_NICE);
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        execvp(FFMPEG_PATH, (char *const *)argv);
+        _exit(127);
+    }
+
+    close(fds[1]);
+    transcode_track_child(pid, 0);
+    // 등록 직전에 종료가 시작됐으면 transcode_stop이 이 자식을 보지 못했다
+    if (atomic_load(&transcoder.stopping)) {
+        kill(pid, SIGTERM);
+    }
+
+    FILE *fp = fdopen(fds[0], "r");
+    double reported = 0.0;
+    char line[512];
+    error[0] = '\0';
+    while (fp != NULL && fgets(line, sizeof(line), fp) != NULL) {
+        line[strcspn(line, "\r\n")] = '\0';
+        long long us;
+        if (sscanf(line, "out_time_us=%lld", &us) == 1) {
+            if (job->duration_sec > 0 && us > 0) {
+                double progress = us / 1e6 / job->duration_sec;
+                if (progress >= reported + TRANSCODE_PROGRESS_STEP && progress < 1.0) {
+                    reported = progress;
+                    db_transcode_set_progress(job->id, progress);
+                }
+            }
+        } else if (strchr(line, '=') == NULL && line[0] != '\0') {
+            snprintf(error, error_len, "%s", line);
+        }
+    }
+    if (fp != NULL) {
+        fclose(fp);
+    } else {
+        close(fds[0]);
+    }
+
+    int status = 0;
+    while (waitpid(pid, &status, 0) < 0 && errno == EINTR) {
+    }
+    transcode_track_child(0, pid);
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+        return 0;
+    }
+    if (error[0] == '\0') {
+        if (WIFEXITED(status) && WEXITSTATUS(status) == 127) {
+            snprintf(error, error_len, "%s 실행 실패", FFMPEG_PATH);
+        } else if (WIFSIGNALED(status)) {
+            snprintf(error, error_len, "ffmpeg 시그널 %d로 종료", WTERMSIG(status));
+        } else {
+            snprintf(error, error_len, "ffmpeg 종료 코드 %d", WEXITSTATUS(status));
+        }
+    }
+    return -1;
+}
+
+// 인코딩 결과를 저장소로 옮기고 실제 비트레이트/해상도로 파일 행 추가
+static int transcode_store(const transcode_job_t *job, const char *out_path, char *error, size_t error_len) {
+    media_info_t info;
+    if (media_probe(out_path, &info) < 0) {
+        snprintf(error, error_len, "출력 파일을 읽을 수 없음");
+        return -1;
+    }
+
+    char hash[MEDIA_HASH_HEX_LEN];
+    char blob_path[MAX_PATH_LEN];
+    int64_t size;
+    bool deduped;
+    if (media_hash_file(out_path, hash, &size) < 0 ||
+        media_blob_store(out_path, hash, size, true, blob_path, sizeof(blob_path), &deduped, NULL, NULL) < 0) {
+        snprintf(error, error_len, "저장소에 넣지 못함");
+        return -1;
+    }
+    if (deduped) {
+        unlink(out_path);
+    }
+
+    if (db_transcode_complete(job, blob_path, size, info.bitrate_kbps,
+                              info.resolution[0] != '\0' ? info.resolution : NULL,
+                              info.video_codec[0] != '\0' ? info.video_codec : NULL,
+                              info.audio_codec[0] != '\0' ? info.audio_codec : NULL, hash) < 0) {
+        snprintf(error, error_len, "DB 기록 실패");
+        return -1;
+    }
+
+    log_info("트랜스코딩 완료: %s %s (%s, %d kbps, %.1f MB)", job->video_id, job->rung, info.resolution,
+             info.bitrate_kbps, size / (1024.0 * 1024.0));
+    return 0;
+}
+
+static void transcode_run(void *arg) {
+    transcode_job_t *job = arg;
+    char out_path[MAX_PATH_LEN];
+    char error[256] = "";
+    snprintf(out_path, sizeof(out_path), "%s/%s_%s.mp4", TRANSCODE_WORK_DIR, job->video_id, job->rung);
+
+    log_info("트랜스코딩 시작: %s %s (%dp, %d kbps, 시도 %d)", job->video_id, job->rung, job->height,
+             job->bitrate_kbps, job->attempts);
+
+    int rc;
+    if (job->source_path[0] == '\0') {
+        snprintf(error, sizeof(error), "원본 파일 없음");
+        rc = -1;
+    } else {
+        rc = transcode_exec(job, out_path, error, sizeof(error));
+        if (rc == 0) {
+            rc = transcode_store(job, out_path, error, sizeof(error));
+        }
+    }
+
+    if (rc < 0) {
+        unlink(out_path);
+        if (atomic_load(&transcoder.stopping)) {
+            // 종료 때문에 멈춘 작업은 실패로 세지 않는다
+            db_transcode_release(job->id);
+        } else {
+            // 원본이 없으면 다시 시도해도 소용없으므로 바로 failed
+            int max_attempts = (job->source_path[0] == '\0') ? 1 : TRANSCODE_MAX_ATTEMPTS;
+            log_error("트랜스코딩 실패: %s %s (시도 %d/%d): %s", job->video_id, job->rung,
+                      job->attempts, max_attempts, error);
+            db_transcode_fail(job->id, error, max_attempts, TRANSCODE_RETRY_DELAY_SEC);
+        }
+    }
+
+    free(job);
+    atomic_fetch_sub(&transcoder.running, 1);
+}
+
+// 비어 있는 워커 수만큼 대기 작업을 가져와 넘긴다
+static void transcode_tick(void *arg) {
+    (void)arg;
+    while (!atomic_load(&transcoder.stopping) && atomic_load(&transcoder.running) < TRANSCODE_MAX_JOBS) {
+        transcode_job_t *job = malloc(sizeof(*job));
+        if (job == NULL) {
+            return;
+        }
+        if (db_transcode_claim(job) <= 0) {
+            free(job);
+            return;
+        }
+        atomic_fetch_add(&transcoder.running, 1);
+        if (thread_pool_submit(transcoder.pool, transcode_run, job) < 0) {
+            db_transcode_release(job->id);
+            free(job);
+            atomic_fetch_sub(&transcoder.running, 1);
+            return;
+        }
+    }
+}
+
+int transcode_start(thread_pool_t *background) {
+    int requeued = db_transcode_requeue_running();
+    if (requeued > 0) {
+        log_info("중단된 트랜스코딩 작업 %d개를 다시 대기열에 넣었습니다", requeued);
+    }
+    mkdir(TRANSCODE_WORK_DIR, 0755);
+
+    atomic_store(&transcoder.running, 0);
+    atomic_store(&transcoder.stopping, false);
+    transcoder.pool = thread_pool_create(TRANSCODE_MAX_JOBS);
+    if (transcoder.pool == NULL) {
+        log_error("트랜스코딩 스레드 풀 생성 실패");
+        return -1;
+    }
+
+    if (thread_pool_schedule_every(background, TRANSCODE_POLL_INTERVAL_SEC * 1000, transcode_tick, NULL,
+                                   TP_PRIORITY_BATCH, &transcoder.timer) < 0) {
+        log_error("트랜스코딩 작업 예약 실패");
+        thread_pool_destroy(transcoder.pool);
+        transcoder.pool = NULL;
+        return -1;
+    }
+
+    log_info("트랜스코딩 시작 (동시 작업 %d개 × 스레드 %d개, %d초마다 확인)",
+             TRANSCODE_MAX_JOBS, TRANSCODE_THREADS, TRANSCODE_POLL_INTERVAL_SEC);
+    return 0;
+}
+
+void transcode_stop(void) {
+    if (transcoder.timer == NULL) {
+        return;
+    }
+
+    atomic_store(&transcoder.stopping, true);
+    thread_pool_timer_cancel(transcoder.timer, true);
+    thread_pool_timer_release(transcoder.timer);
+    transcoder.timer = NULL;
+
+    // 실행 중인 ffmpeg를 멈추면 워커가 작업을 대기열로 되돌리고 끝난다
+    pthread_mutex_lock(&transcoder.mutex);
+    for (int i = 0; i < TRANSCODE_MAX_JOBS; i++) {
+        if (transcoder.children[i] > 0) {
+            kill(transcoder.children[i], SIGTERM);
+        }
+    }
+    pthread_mutex_unlock(&transcoder.mutex);
+
+    thread_pool_wait(transcoder.pool);
+    thread_pool_destroy(transcoder.pool);
+    transcoder.pool = NULL;
+
+    log_info("트랜스코딩 종료");
+}
@@ -1,30 +1,106 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <time.h>
+#include <pthread.h>
+#include <sys/time.h>
 #include "uuid.h"
 
-void uuid_generate(ott_uuid_t out) {
-    // Generate random bytes
-    unsigned char bytes[16];
-    
+static pthread_mutex_t v7_mutex = PTHREAD_MUTEX_INITIALIZER;
+static uint64_t v7_last_ms = 0;
+static uint16_t v7_seq = 0;
+
+static void uuid_random_bytes(unsigned char *bytes, size_t len) {
     // Use /dev/urandom for better randomness
     FILE *f = fopen("/dev/urandom", "rb");
-    if (f == NULL) {
+    if (f == NULL || fread(bytes, 1, len, f) != len) {
         // Fallback to rand() if /dev/urandom is not available
         srand(time(NULL));
-        for (int i = 0; i < 16; i++) {
+        for (size_t i = 0; i < len; i++) {
             bytes[i] = rand() % 256;
         }
-    } else {
-        fread(bytes, 1, 16, f);
+    }
+    if (f != NULL) {
         fclose(f);
     }
+}
+
+void uuid_generate(ott_uuid_t out) {
+    // Generate random bytes
+    unsigned char bytes[OTT_UUID_BYTES];
+    uuid_random_bytes(bytes, sizeof(bytes));
     
     // Set version (4) and variant bits
     bytes[6] = (bytes[6] & 0x0F) | 0x40;  // Version 4
     bytes[8] = (bytes[8] & 0x3F) | 0x80;  // Variant 10
     
     // Format as UUID string: xxxxxxxx-xxxx-4xxx-yxxx-xxxxxxxxxxxx
+    uuid_format(bytes, out);
+}
+
+void uuid_generate_v7(ott_uuid_t out) {
+    unsigned char bytes[OTT_UUID_BYTES];
+    uuid_random_bytes(bytes, sizeof(bytes));
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    uint64_t now_ms = (uint64_t)tv.tv_sec * 1000 + (uint64_t)tv.tv_usec / 1000;
+
+    // 같은 밀리초 안에서는 12비트 카운터로 순서를 보장 (넘치면 다음 밀리초로 이월)
+    pthread_mutex_lock(&v7_mutex);
+    if (now_ms <= v7_last_ms) {
+        now_ms = v7_last_ms;
+        if (++v7_seq > 0x0FFF) {
+            now_ms++;
+            v7_seq = 0;
+        }
+    } else {
+        v7_seq = 0;
+    }
+    v7_last_ms = now_ms;
+    uint16_t seq = v7_seq;
+    pthread_mutex_unlock(&v7_mutex);
+
+    // 48비트 유닉스 타임스탬프 (밀리초, 빅 엔디언)
+    for (int i = 0; i < 6; i++) {
+        bytes[i] = (unsigned char)(now_ms >> (40 - 8 * i));
+    }
+    bytes[6] = 0x70 | ((seq >> 8) & 0x0F);  // Version 7 + counter high bits
+    bytes[7] = seq & 0xFF;
+    bytes[8] = (bytes[8] & 0x3F) | 0x80;    // Variant 10
+
+    uuid_format(bytes, out);
+}
+
+static int uuid_hex_value(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+int uuid_parse(const char *str, uint8_t out[OTT_UUID_BYTES]) {
+    if (str == NULL) {
+        return -1;
+    }
+
+    int n = 0;
+    for (int i = 0; i < 36; i++) {
+        if (i == 8 || i == 13 || i == 18 || i == 23) {
+            if (str[i] != '-') return -1;
+            continue;
+        }
+        int hi = uuid_hex_value(str[i]);
+        int lo = (hi < 0) ? -1 : uuid_hex_value(str[++i]);
+        if (hi < 0 || lo < 0) {
+            return -1;
+        }
+        out[n++] = (uint8_t)((hi << 4) | lo);
+    }
+
+    return (str[36] == '\0') ? 0 : -1;
+}
+
+void uuid_format(const uint8_t bytes[OTT_UUID_BYTES], ott_uuid_t out) {
     snprintf(out, 37,
         "%02x%02x%02x%02x-%02x%02x-%02x%02x-%02x%02x-%02x%02x%02x%02x%02x%02x",
         bytes[0], bytes[1], bytes[2], bytes[3],
@@ -0,0 +1,161 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include "video_page.h"
+#include "logger.h"
+
+// 항목당 아레나 예상 크기 (제목 + 짧은 설명 + 썸네일 URL)
+#define VIDEO_PAGE_BYTES_PER_ITEM 192
+
+// MIME 테이블: 항목은 추가만 되고 바뀌지 않으므로 읽기는 개수만 원자적으로 확인한다
+static const char *mime_table[MIME_MAX_TYPES] = {
+    "video/mp4",
+    "video/webm",
+    "video/x-matroska",
+    "video/quicktime",
+    "video/mp2t",
+    "application/vnd.apple.mpegurl",
+    "image/jpeg",
+    "image/webp",
+    "image/avif",
+};
+static atomic_int mime_count = 9;
+static pthread_mutex_t mime_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int mime_find(const char *mime_type, int count) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(mime_table[i], mime_type) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+mime_id_t mime_intern(const char *mime_type) {
+    if (mime_type == NULL || mime_type[0] == '\0') {
+        return 0;
+    }
+
+    int idx = mime_find(mime_type, atomic_load_explicit(&mime_count, memory_order_acquire));
+    if (idx >= 0) {
+        return (mime_id_t)idx;
+    }
+
+    pthread_mutex_lock(&mime_mutex);
+    int count = atomic_load_explicit(&mime_count, memory_order_relaxed);
+    idx = mime_find(mime_type, count);
+    if (idx < 0) {
+        if (count < MIME_MAX_TYPES) {
+            size_t len = strlen(mime_type);
+            char *copy = malloc(len + 1);
+            if (copy != NULL) {
+                memcpy(copy, mime_type, len + 1);
+                mime_table[count] = copy;
+                atomic_store_explicit(&mime_count, count + 1, memory_order_release);
+                idx = count;
+            }
+        }
+        if (idx < 0) {
+            log_warn("MIME 테이블이 가득 차 기본값을 사용합니다: %s", mime_type);
+            idx = 0;
+        }
+    }
+    pthread_mutex_unlock(&mime_mutex);
+
+    return (mime_id_t)idx;
+}
+
+const char* mime_name(mime_id_t id) {
+    if (id >= atomic_load_explicit(&mime_count, memory_order_acquire)) {
+        return mime_table[0];
+    }
+    return mime_table[id];
+}
+
+int video_page_init(video_page_t *page, int capacity) {
+    memset(page, 0, sizeof(*page));
+
+    page->items = malloc(sizeof(video_record_t) * capacity);
+    page->arena_cap = (size_t)capacity * VIDEO_PAGE_BYTES_PER_ITEM;
+    page->arena = malloc(page->arena_cap);
+    if (page->items == NULL || page->arena == NULL) {
+        log_error("동영상 목록 메모리 할당 실패");
+        video_page_free(page);
+        return -1;
+    }
+
+    page->capacity = capacity;
+    return 0;
+}
+
+static int video_page_reserve(video_page_t *page, size_t need) {
+    if (page->arena_size + need <= page->arena_cap) {
+        return 0;
+    }
+
+    size_t new_cap = page->arena_cap ? page->arena_cap * 2 : VIDEO_PAGE_BYTES_PER_ITEM;
+    while (new_cap < page->arena_size + need) {
+        new_cap *= 2;
+    }
+    if (new_cap > UINT32_MAX) {
+        return -1;
+    }
+
+    char *arena = realloc(page->arena, new_cap);
+    if (arena == NULL) {
+        return -1;
+    }
+    page->arena = arena;
+    page->arena_cap = new_cap;
+    return 0;
+}
+
+static page_str_t video_page_put(video_page_t *page, const char *s, size_t len) {
+    page_str_t str = { (uint32_t)page->arena_size, (uint32_t)len };
+    if (len > 0) {
+        memcpy(page->arena + page->arena_size, s, len);
+    }
+    page->arena[page->arena_size + len] = '\0';
+    page->arena_size += len + 1;
+    return str;
+}
+
+int video_page_add(video_page_t *page, const char *id,
+                   const char *title, size_t title_len,
+                   const char *description, size_t description_len,
+                   mime_id_t mime, int duration_sec, int64_t created_at) {
+    if (page->count >= page->capacity) {
+        return -1;
+    }
+
+    char thumbnail_url[96];
+    int url_len = snprintf(thumbnail_url, sizeof(thumbnail_url), "/api/videos/%s/thumbnail", id);
+
+    if (video_page_reserve(page, title_len + description_len + (size_t)url_len + 3) < 0) {
+        log_error("동영상 목록 메모리 할당 실패");
+        return -1;
+    }
+
+    video_record_t *rec = &page->items[page->count++];
+    snprintf(rec->id, sizeof(rec->id), "%s", id);
+    rec->title = video_page_put(page, title, title_len);
+    rec->description = video_page_put(page, description, description_len);
+    rec->thumbnail_url = video_page_put(page, thumbnail_url, (size_t)url_len);
+    rec->duration_sec = duration_sec;
+    rec->mime = mime;
+    rec->created_at = created_at;
+    return 0;
+}
+
+void video_page_free(video_page_t *page) {
+    free(page->items);
+    free(page->arena);
+    page->items = NULL;
+    page->arena = NULL;
+    page->count = 0;
+    page->capacity = 0;
+    page->arena_size = 0;
+    page->arena_cap = 0;
+}